@@ -74,6 +74,9 @@ cmake_dependent_option(ENABLE_VTKM_RENDERING
 
 option(ENABLE_OPTS "A version of the getopt function" ON)
 option(ENABLE_PROFILER "Enable the internal profiler" OFF)
+cmake_dependent_option(ENABLE_ALLOCATION_TRACKING
+  "Replace operator new/delete and malloc/free to attribute heap use to analyses" OFF
+  "ENABLE_PROFILER" OFF)
 option(ENABLE_OSCILLATORS "Enable Oscillators miniapp" ON)
 option(ENABLE_MANDELBROT "Enable Mandelbrot AMR miniapp" ON)
 option(ENABLE_VORTEX "Enable Vortex miniapp (experimental)" OFF)
@@ -100,6 +103,7 @@ message(STATUS "ENABLE_VTK_FILTERS=${ENABLE_VTK_FILTERS}")
 message(STATUS "ENABLE_VTKM=${ENABLE_VTKM}")
 message(STATUS "ENABLE_VTKM_RENDERING=${ENABLE_VTKM_RENDERING}")
 message(STATUS "ENABLE_PROFILER=${ENABLE_PROFILER}")
+message(STATUS "ENABLE_ALLOCATION_TRACKING=${ENABLE_ALLOCATION_TRACKING}")
 message(STATUS "ENABLE_OPTS=${ENABLE_OPTS}")
 message(STATUS "ENABLE_OSCILLATORS=${ENABLE_OSCILLATORS}")
 message(STATUS "ENABLE_CONDUITTEST=${ENABLE_CONDUITTEST}")
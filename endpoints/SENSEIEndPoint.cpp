@@ -1,13 +1,20 @@
 #include "ConfigurableInTransitDataAdaptor.h"
 #include "ConfigurableAnalysis.h"
+#include "ElasticPartitioner.h"
+#include "BlockPartitioner.h"
+#include "MeshMetadata.h"
 #include "MPIManager.h"
+#include "XMLUtils.h"
 #include "Profiler.h"
 #include "Error.h"
 
 #include <opts/opts.h>
+#include <pugixml.hpp>
 
 #include <mpi.h>
 #include <iostream>
+#include <algorithm>
+#include <map>
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
 #include <vtkDataSet.h>
@@ -15,14 +22,100 @@
 using DataAdaptorPtr = vtkSmartPointer<sensei::ConfigurableInTransitDataAdaptor>;
 using AnalysisAdaptorPtr = vtkSmartPointer<sensei::ConfigurableAnalysis>;
 
+// In elastic mode only the first N ranks run the analysis. Blocks are
+// partitioned over them and the rest idle until they are needed. N is
+// doubled when the analysis takes up more than the high water mark of the
+// time between steps, and halved when it takes up less than the low water
+// mark. One analysis instance is initialized on each size of communicator
+// used. The data adaptor keeps the full communicator, idle ranks do not call
+// GetMesh or AddArray, so elastic mode requires a transport that reads
+// independently on each rank.
+struct ElasticControl
+{
+  ElasticControl() : Enabled(false), MinRanks(1), MaxRanks(1),
+    NumActive(1), HighWater(0.9), LowWater(0.4), Settle(false) {}
+
+  // decide how many ranks are needed for the next step given the time spent
+  // in the analysis and the time between steps. all ranks of comm must call
+  // this. returns true if the number of active ranks changed.
+  bool Update(MPI_Comm comm, double execTime, double stepTime)
+  {
+    // the slowest rank determines the time taken
+    double times[2] = {execTime, stepTime};
+    MPI_Allreduce(MPI_IN_PLACE, times, 2, MPI_DOUBLE, MPI_MAX, comm);
+
+    // skip the step after a change, it includes the cost of
+    // repartitioning and initializing the analysis.
+    if (this->Settle)
+      {
+      this->Settle = false;
+      return false;
+      }
+
+    double use = times[1] > 0.0 ? times[0]/times[1] : 0.0;
+
+    int nActive = this->NumActive;
+    if (use > this->HighWater)
+      nActive = std::min(this->MaxRanks, 2*this->NumActive);
+    else if ((use < this->LowWater) && (2.0*use < this->HighWater))
+      nActive = std::max(this->MinRanks, (this->NumActive + 1)/2);
+
+    if (nActive == this->NumActive)
+      return false;
+
+    SENSEI_STATUS("Analysis used " << 100.0*use << "% of the "
+      << times[1] << "s between steps. Changing from " << this->NumActive
+      << " to " << nActive << " active ranks")
+
+    this->NumActive = nActive;
+    this->Settle = true;
+
+    return true;
+  }
+
+  // check that the transport reads independently on each rank. aggregated
+  // reads are collective over the data adaptor's communicator and would wait
+  // forever on the idle ranks. all ranks of comm must call this.
+  static int CheckTransport(MPI_Comm comm, const std::string &transportXml)
+  {
+    pugi::xml_document doc;
+    if (sensei::XMLUtils::Parse(comm, transportXml, doc))
+      {
+      SENSEI_ERROR("Failed to parse \"" << transportXml << "\"")
+      return -1;
+      }
+
+    pugi::xml_node node = doc.child("sensei").child("transport");
+    if (node.attribute("aggregators").as_int(0) > 0)
+      {
+      SENSEI_ERROR("Elastic mode requires independent reads. Remove the "
+        "aggregators attribute from the " << node.attribute("type").value()
+        << " transport")
+      return -1;
+      }
+
+    return 0;
+  }
+
+  bool Enabled;
+  int MinRanks;
+  int MaxRanks;
+  int NumActive;
+  double HighWater;
+  double LowWater;
+  bool Settle;
+};
+
 int main(int argc, char **argv)
 {
   sensei::MPIManager mpiMan(argc, argv);
   int rank = mpiMan.GetCommRank();
+  int nRanks = mpiMan.GetCommSize();
 
   std::string transportXml;
   std::string analysisXml;
   std::string connectionInfo;
+  ElasticControl elastic;
 
   opts::Options ops(argc, argv);
 
@@ -33,7 +126,21 @@ int main(int argc, char **argv)
       "SENSEI analysis XML configuration file")
 
     >> opts::Option('c', "connection-info", connectionInfo,
-       "transport specific connection information");
+       "transport specific connection information")
+
+    >> opts::Option('m', "min-ranks", elastic.MinRanks,
+       "in elastic mode the fewest ranks the analysis will run on")
+
+    >> opts::Option('u', "high-water", elastic.HighWater,
+       "in elastic mode the fraction of the time between steps above which "
+       "the number of analysis ranks is increased")
+
+    >> opts::Option('l', "low-water", elastic.LowWater,
+       "in elastic mode the fraction of the time between steps below which "
+       "the number of analysis ranks is decreased");
+
+  elastic.Enabled = ops >> opts::Present('e', "elastic",
+    "vary the number of ranks running the analysis between steps");
 
   if (ops >> opts::Present('h', "help", "show help"))
     {
@@ -50,6 +157,9 @@ int main(int argc, char **argv)
     MPI_Abort(MPI_COMM_WORLD, 1);
     }
 
+  if (elastic.Enabled && ElasticControl::CheckTransport(MPI_COMM_WORLD, transportXml))
+    MPI_Abort(MPI_COMM_WORLD, -1);
+
   // create the reead side of the transport
   SENSEI_STATUS("Creating transport data adaptor. transport-xml=\""
     << transportXml << "\"")
@@ -62,6 +172,35 @@ int main(int argc, char **argv)
     MPI_Abort(MPI_COMM_WORLD, -1);
     }
 
+  // in elastic mode blocks are only partitioned onto the active ranks
+  sensei::ElasticPartitionerPtr elasticPart;
+  if (elastic.Enabled)
+    {
+    elastic.MaxRanks = nRanks;
+    elastic.MinRanks = std::max(1, std::min(elastic.MinRanks, nRanks));
+    elastic.NumActive = nRanks;
+
+    // the first step includes the cost of starting up
+    elastic.Settle = true;
+
+    sensei::PartitionerPtr part = dataAdaptor->GetPartitioner();
+    if (!part)
+      part = sensei::BlockPartitioner::New();
+
+    elasticPart = sensei::ElasticPartitioner::New(part);
+    elasticPart->SetNumberOfActiveRanks(nRanks);
+    dataAdaptor->SetPartitioner(elasticPart);
+
+    SENSEI_STATUS("Elastic mode enabled. min-ranks=" << elastic.MinRanks
+      << " high-water=" << elastic.HighWater << " low-water="
+      << elastic.LowWater)
+    }
+  else
+    {
+    elastic.MaxRanks = nRanks;
+    elastic.NumActive = nRanks;
+    }
+
   // connect and open the stream
   if (dataAdaptor->OpenStream())
     {
@@ -70,20 +209,46 @@ int main(int argc, char **argv)
     MPI_Abort(MPI_COMM_WORLD, -1);
     }
 
-  // initlaize the analysis using the XML configurable adaptor
-  SENSEI_STATUS("Creating the analysis adaptor. analysis-xml=\""
-    << analysisXml << "\"")
+  // initlaize the analysis using the XML configurable adaptor. there is one
+  // instance per number of active ranks, and it is only present on the
+  // active ranks. all ranks must call this.
+  std::map<int, AnalysisAdaptorPtr> analyses;
 
-  AnalysisAdaptorPtr analysisAdaptor = AnalysisAdaptorPtr::New();
-  if (analysisAdaptor->Initialize(analysisXml))
+  auto activate = [&](int nActive)
     {
-    SENSEI_ERROR("Failed to initialize analysis adaptor")
-    MPI_Abort(MPI_COMM_WORLD, -1);
-    }
+    if (analyses.count(nActive))
+      return;
+
+    SENSEI_STATUS("Creating the analysis adaptor on " << nActive
+      << " ranks. analysis-xml=\"" << analysisXml << "\"")
+
+    MPI_Comm comm = MPI_COMM_NULL;
+    MPI_Comm_split(dataAdaptor->GetCommunicator(),
+      rank < nActive ? 0 : MPI_UNDEFINED,
+      rank, &comm);
+
+    AnalysisAdaptorPtr analysisAdaptor;
+    if (comm != MPI_COMM_NULL)
+      {
+      analysisAdaptor = AnalysisAdaptorPtr::New();
+      analysisAdaptor->SetCommunicator(comm);
+      if (analysisAdaptor->Initialize(analysisXml))
+        {
+        SENSEI_ERROR("Failed to initialize analysis adaptor")
+        MPI_Abort(MPI_COMM_WORLD, -1);
+        }
+      MPI_Comm_free(&comm);
+      }
+
+    analyses[nActive] = analysisAdaptor;
+    };
+
+  activate(elastic.NumActive);
 
   // read from the stream until all steps have been
   // processed
   unsigned int nSteps = 0;
+  double stepStart = MPI_Wtime();
   do
     {
     // gte the current simulation time and time step
@@ -93,16 +258,55 @@ int main(int argc, char **argv)
 
     SENSEI_STATUS("Processing time step " << timeStep << " time " << time)
 
-    // execute the analysis
-    if (!analysisAdaptor->Execute(dataAdaptor.Get()))
+    // partition the data on all ranks before the analysis runs on the
+    // active ones. the result is cached by the data adaptor
+    if (elastic.Enabled)
+      {
+      unsigned int nMeshes = 0;
+      if (dataAdaptor->GetNumberOfMeshes(nMeshes))
+        {
+        SENSEI_ERROR("Failed to get the number of meshes")
+        MPI_Abort(MPI_COMM_WORLD, -1);
+        }
+
+      for (unsigned int i = 0; i < nMeshes; ++i)
+        {
+        sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
+        if (dataAdaptor->GetMeshMetadata(i, md))
+          {
+          SENSEI_ERROR("Failed to partition mesh " << i)
+          MPI_Abort(MPI_COMM_WORLD, -1);
+          }
+        }
+      }
+
+    // execute the analysis. idle ranks have nothing to do
+    AnalysisAdaptorPtr &analysisAdaptor = analyses[elastic.NumActive];
+
+    double execStart = MPI_Wtime();
+    if (analysisAdaptor && !analysisAdaptor->Execute(dataAdaptor.Get()))
       {
       SENSEI_ERROR("Execute failed")
       MPI_Abort(MPI_COMM_WORLD, -1);
       }
+    double execTime = MPI_Wtime() - execStart;
 
     // let the data adaptor release the mesh and data from this
     // time step
     dataAdaptor->ReleaseData();
+
+    // size the analysis for the next step
+    if (elastic.Enabled)
+      {
+      double stepEnd = MPI_Wtime();
+      if (elastic.Update(dataAdaptor->GetCommunicator(), execTime,
+        stepEnd - stepStart))
+        {
+        activate(elastic.NumActive);
+        elasticPart->SetNumberOfActiveRanks(elastic.NumActive);
+        }
+      stepStart = stepEnd;
+      }
     }
   while (!dataAdaptor->AdvanceStream());
 
@@ -112,12 +316,17 @@ int main(int argc, char **argv)
   dataAdaptor->CloseStream();
   dataAdaptor->Finalize();
 
-  analysisAdaptor->Finalize();
+  for (auto &it : analyses)
+    {
+    if (it.second)
+      it.second->Finalize();
+    }
 
   // we must force these to be destroyed before mpi finalize some of the analysis
   // adaptors (eg Catalyst) make MPI calls in the destructor
   dataAdaptor = nullptr;
-  analysisAdaptor = nullptr;
+  analyses.clear();
+  elasticPart = nullptr;
 
   return 0;
 }
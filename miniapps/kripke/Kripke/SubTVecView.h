@@ -0,0 +1,61 @@
+#ifndef KRIPKE_SUBTVECVIEW_H__
+#define KRIPKE_SUBTVECVIEW_H__
+
+#include <Kripke/SubTVec.h>
+#include <conduit.hpp>
+
+/**
+ *  A strided view of the zones of a SubTVec at a fixed (group, direction)
+ *  or (group, moment) pair.
+ *
+ *  The view works in SubTVec's internal index space, so it is valid for all
+ *  six nestings: zones are contiguous for GDZ and DGZ, and strided by
+ *  groups*directions, groups or directions for the others. No data is
+ *  copied; the view aliases the SubTVec's storage.
+ */
+struct SubTVecView {
+  SubTVecView(SubTVec const &v, int g, int d):
+    data(v.data_pointer),
+    count(v.zones),
+    offset(g*extStride(v, 0) + d*extStride(v, 1)),
+    stride(extStride(v, 2))
+  {}
+
+  // stride, in elements, of external index ext (0=group, 1=dir/moment, 2=zone)
+  static inline int extStride(SubTVec const &v, int ext){
+    int s = 1;
+    for(int i = v.ext_to_int[ext]+1; i < 3; ++i){
+      s *= v.size_int[i];
+    }
+    return s;
+  }
+
+  inline bool contiguous(void) const {
+    return stride == 1;
+  }
+
+  inline double &operator()(int z) {
+    return data[offset + z*stride];
+  }
+  inline double operator()(int z) const {
+    return data[offset + z*stride];
+  }
+
+  /**
+   * Describes the view to conduit as an external float64 array, offset and
+   * stride are given in bytes. Consumers of the node read Kripke's storage
+   * in place.
+   */
+  inline void setExternal(conduit::Node &n) const {
+    n.set_external(conduit::DataType::float64(count,
+        offset*sizeof(double), stride*sizeof(double), sizeof(double)),
+        data);
+  }
+
+  double *data;
+  int count;   // number of zones
+  int offset;  // elements from data to zone 0
+  int stride;  // elements between consecutive zones
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <Kripke.h>
 #include <Kripke/Subdomain.h>
 #include <Kripke/SubTVec.h>
+#include <Kripke/SubTVecView.h>
 #include <Kripke/ParallelComm.h>
 #include <Kripke/Grid.h>
 #include <vector>
@@ -77,28 +78,28 @@ void writeData(Grid_Data *grid_data, int timeStep, const std::string& file)
     data["fields/phi/topology"] = "mesh";
     data["fields/phi/type"] = "scalar";
   
-    data["fields/phi/values"].set(conduit::DataType::float64(sdom.num_zones));
-    conduit::float64 * phi_scalars = data["fields/phi/values"].value();
+    // phi and psi are passed as strided external views of Kripke's own
+    // storage, group 0 moment 0 and group 0 direction 0 respectively. this
+    // works for every nesting and nothing is copied here
+    SubTVecView(*sdom.phi, 0, 0).setExternal(data["fields/phi/values"]);
 
-    // TODO can we do this with strides and not copy?
-    for(int i = 0; i < sdom.num_zones; i++)
-    {
-      phi_scalars[i] = (*sdom.phi)(0,0,i);  
-    } 
+    data["fields/psi/association"] = "element";
+    data["fields/psi/topology"] = "mesh";
+    data["fields/psi/type"] = "scalar";
+    SubTVecView(*sdom.psi, 0, 0).setExternal(data["fields/psi/values"]);
 
   }//each sdom
   
    //------- end wrapping with Conduit here -------//
-  conduit::Node verify_info;
-  if(!conduit::blueprint::mesh::verify(data,verify_info))
-  {
-      CONDUIT_INFO("blueprint verify failed!" + verify_info.to_json());
-  }
-  else
+  // the layout of the node does not change between steps, verify it once
+  if(timeStep == 0)
   {
-      CONDUIT_INFO("blueprint verify succeeded");
+    conduit::Node verify_info;
+    if(!conduit::blueprint::mesh::verify(data,verify_info))
+    {
+        CONDUIT_INFO("blueprint verify failed!" + verify_info.to_json());
+    }
   }
-  data.print();
 
   //Pass data to SENSEI
   if(timeStep == 0)
@@ -325,6 +325,12 @@ int MandelbrotDataAdaptor::GetMeshMetadata(unsigned int id,
 
   metadata->NumLevels = internals.sim->max_levels + 1;
 
+  // an analysis may only need the coarse levels. the finer levels are left
+  // out of both the metadata and the mesh
+  int maxLevel = this->GetMaxLevel("mesh");
+  if ((maxLevel >= 0) && (maxLevel < metadata->NumLevels))
+    metadata->NumLevels = maxLevel + 1;
+
   metadata->RefRatio.resize(metadata->NumLevels,
     std::array<int,3>({2,2,1}));
 
@@ -55,15 +55,23 @@ void Block::move_particles(float dt, const sdiy::Master::ProxyWithLink& cp)
 {
     auto link = static_cast<sdiy::RegularGridLink*>(cp.link());
 
-    auto particle = particles.begin();
-    while (particle != particles.end())
+    // particles leaving this block, binned by neighbor so that each
+    // neighbor receives them in a single enqueue
+    std::vector<std::vector<Particle>> outgoing(link->size());
+
+    sdiy::Bounds<float> wsdom = world_space_bounds(domain, origin, spacing);
+
+    size_t nkeep = 0;
+    size_t nparticles = particles.size();
+    for (size_t j = 0; j < nparticles; ++j)
     {
+        Particle *particle = &particles[j];
+
         // update particle position
         particle->position += particle->velocity * dt;
 
         // warp position if needed
         // applies periodic bci
-        sdiy::Bounds<float> wsdom = world_space_bounds(domain, origin, spacing);
         for (int i = 0; i < 3; ++i)
         {
             if ((particle->position[i] > wsdom.max[i]) ||
@@ -99,7 +107,7 @@ void Block::move_particles(float dt, const sdiy::Master::ProxyWithLink& cp)
                     /*std::cerr << "moving " << *particle << " from " << gid
                       << " to " << link->target(i).gid << std::endl;*/
 
-                    cp.enqueue(link->target(i), *particle);
+                    outgoing[i].push_back(*particle);
 
                     enqueued = true;
                     break;
@@ -113,14 +121,23 @@ void Block::move_particles(float dt, const sdiy::Master::ProxyWithLink& cp)
 
                 abort();
             }
-
-            particle = particles.erase(particle);
         }
         else
         {
-            ++particle;
+            // compact the particles that stay in place
+            if (nkeep != j)
+                particles[nkeep] = *particle;
+            ++nkeep;
         }
     }
+
+    particles.resize(nkeep);
+
+    for (int i = 0; i < link->size(); ++i)
+    {
+        if (!outgoing[i].empty())
+            cp.enqueue_span(link->target(i), outgoing[i].data(), outgoing[i].size());
+    }
 }
 
 // --------------------------------------------------------------------------
@@ -132,9 +149,9 @@ void Block::handle_incoming_particles(const sdiy::Master::ProxyWithLink& cp)
         auto nbr = link->target(i).gid;
         while(cp.incoming(nbr))
         {
-            Particle particle;
-            cp.dequeue(nbr, particle);
-            particles.push_back(particle);
+            std::vector<Particle> incoming;
+            cp.dequeue(nbr, incoming);
+            particles.insert(particles.end(), incoming.begin(), incoming.end());
         }
     }
 }
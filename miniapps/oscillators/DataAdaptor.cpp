@@ -172,18 +172,35 @@ vtkPolyData *newParticleBlock(const std::vector<Particle> *particles,
   if (structureOnly)
     return block;
 
-  vtkNew<vtkPoints> points;
-  vtkNew<vtkCellArray> cells;
-  points->Allocate(particles->size());
-  cells->Allocate(particles->size());
+  // fill the coordinates and the vertex connectivity directly, this
+  // avoids per particle calls into VTK
+  vtkIdType np = particles->size();
+
+  vtkNew<vtkFloatArray> coords;
+  coords->SetNumberOfComponents(3);
+  coords->SetNumberOfTuples(np);
+  float *pc = coords->GetPointer(0);
+
+  vtkNew<vtkIdTypeArray> conn;
+  conn->SetNumberOfTuples(2*np);
+  vtkIdType *pconn = conn->GetPointer(0);
 
-  vtkIdType pointId = 0;
-  for (const auto &p : *particles)
+  for (vtkIdType i = 0; i < np; ++i)
     {
-    points->InsertNextPoint(p.position[0], p.position[1], p.position[2]);
-    cells->InsertNextCell(1, &pointId);
-    ++pointId;
+    const Particle &p = (*particles)[i];
+    pc[3*i] = p.position[0];
+    pc[3*i+1] = p.position[1];
+    pc[3*i+2] = p.position[2];
+    pconn[2*i] = 1;
+    pconn[2*i+1] = i;
     }
+
+  vtkNew<vtkPoints> points;
+  points->SetData(coords.Get());
+
+  vtkNew<vtkCellArray> cells;
+  cells->SetCells(np, conn.Get());
+
   block->SetPoints(points.Get());
   block->SetVerts(cells.Get());
 
@@ -333,7 +350,7 @@ namespace oscillators
 struct DataAdaptor::InternalsType
 {
   InternalsType() : NumBlocks(0), Origin{},
-    Spacing{1,1,1}, Shape{}, NumGhostCells(0) {}
+    Spacing{1,1,1}, Shape{}, NumGhostCells(0), HaveParticles(false) {}
 
   long NumBlocks;                                   // total number of blocks on all ranks
   sdiy::DiscreteBounds DomainExtent;                 // global index space
@@ -346,6 +363,7 @@ struct DataAdaptor::InternalsType
 
   int Shape[3];
   int NumGhostCells;                                // number of ghost cells
+  bool HaveParticles;                               // provide the particles mesh
 };
 
 //-----------------------------------------------------------------------------
@@ -431,16 +449,24 @@ void DataAdaptor::SetParticleData(int gid, const std::vector<Particle> &particle
   this->Internals->ParticleData[gid] = &particles;
 }
 
+//-----------------------------------------------------------------------------
+void DataAdaptor::SetHaveParticles(bool val)
+{
+  this->Internals->HaveParticles = val;
+}
+
 //-----------------------------------------------------------------------------
 int DataAdaptor::GetMesh(const std::string &meshName, bool structureOnly,
     vtkDataObject *&mesh)
 {
   mesh = nullptr;
 
-  if ((meshName != "mesh") && (meshName != "ucdmesh") && (meshName != "particles"))
+  if ((meshName != "mesh") && (meshName != "ucdmesh") &&
+    ((meshName != "particles") || !this->Internals->HaveParticles))
     {
     SENSEI_ERROR("the miniapp provides meshes named \"mesh\", \"ucdmesh\","
-      " and \"particles\". you requested \"" << meshName << "\"")
+      " and, when run with particles, \"particles\". you requested \""
+      << meshName << "\"")
     return -1;
     }
 
@@ -618,14 +644,15 @@ int DataAdaptor::AddGhostCellsArray(vtkDataObject *mesh, const std::string &mesh
 //-----------------------------------------------------------------------------
 int DataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
 {
-  numMeshes = 2;
+  // the particles mesh is only present when particles were requested
+  numMeshes = this->Internals->HaveParticles ? 3 : 2;
   return 0;
 }
 
 //-----------------------------------------------------------------------------
 int DataAdaptor::GetMeshMetadata(unsigned int id, sensei::MeshMetadataPtr &metadata)
 {
-  if (id > 1)
+  if ((id > 2) || ((id == 2) && !this->Internals->HaveParticles))
     {
     SENSEI_ERROR("invalid mesh id " << id)
     return -1;
@@ -637,6 +664,66 @@ int DataAdaptor::GetMeshMetadata(unsigned int id, sensei::MeshMetadataPtr &metad
   MPI_Comm_rank(this->GetCommunicator(), &rank);
   MPI_Comm_size(this->GetCommunicator(), &nRanks);
 
+  // mesh 2 is a multiblock with the particles of each block in a polydata
+  if (id == 2)
+    {
+    int nParticleBlocks = this->Internals->ParticleData.size();
+
+    metadata->MeshName = "particles";
+    metadata->MeshType = VTK_MULTIBLOCK_DATA_SET;
+    metadata->BlockType = VTK_POLY_DATA;
+    metadata->CoordinateType = VTK_FLOAT;
+    metadata->NumBlocks = this->Internals->NumBlocks;
+    metadata->NumBlocksLocal = {nParticleBlocks};
+    metadata->NumArrays = 3;
+    metadata->ArrayName = {"pid", "velocity", "velocityMagnitude"};
+    metadata->ArrayCentering = {vtkDataObject::POINT, vtkDataObject::POINT,
+      vtkDataObject::POINT};
+    metadata->ArrayComponents = {1, 3, 1};
+    metadata->ArrayType = {VTK_FLOAT, VTK_FLOAT, VTK_FLOAT};
+    metadata->StaticMesh = 0;
+
+    // particles are held by the block whose bounds contain them
+    if (metadata->Flags.BlockBoundsSet())
+      {
+      std::array<double,6> bounds;
+      getBlockBounds(this->Internals->DomainExtent,
+        this->Internals->Origin, this->Internals->Spacing,
+        bounds.data());
+      metadata->Bounds = std::move(bounds);
+      }
+
+    auto it = this->Internals->ParticleData.begin();
+    auto end = this->Internals->ParticleData.end();
+    for (; it != end; ++it)
+      {
+      long np = it->second ? it->second->size() : 0;
+
+      if (metadata->Flags.BlockSizeSet())
+        {
+        metadata->BlockNumPoints.push_back(np);
+        metadata->BlockNumCells.push_back(np);
+        metadata->BlockCellArraySize.push_back(2*np);
+        }
+
+      if (metadata->Flags.BlockDecompSet())
+        {
+        metadata->BlockOwner.push_back(rank);
+        metadata->BlockIds.push_back(it->first);
+        }
+
+      if (metadata->Flags.BlockBoundsSet())
+        {
+        std::array<double,6> bounds;
+        getBlockBounds(this->Internals->BlockExtents[it->first],
+          this->Internals->Origin, this->Internals->Spacing, bounds.data());
+        metadata->BlockBounds.emplace_back(std::move(bounds));
+        }
+      }
+
+    return 0;
+    }
+
   // this exercises the multimesh api
   // mesh 0 is a multiblock with uniform Cartesian blocks
   // mesh 1 is a multiblock with unstructured blocks
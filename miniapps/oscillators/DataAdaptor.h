@@ -39,6 +39,10 @@ public:
   /// Set particles for a specific block
   void SetParticleData(int gid, const std::vector<Particle> &particles);
 
+  /// Advertise the "particles" mesh. This must be the same on all ranks.
+  /// When not set, the default, only "mesh" and "ucdmesh" are provided.
+  void SetHaveParticles(bool val);
+
   // SENSEI API
   int GetNumberOfMeshes(unsigned int &numMeshes) override;
 
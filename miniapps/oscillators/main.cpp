@@ -248,7 +248,7 @@ int main(int argc, char** argv)
                        &gids[0],
                        &from_x[0], &from_y[0], &from_z[0],
                        &to_x[0],   &to_y[0],   &to_z[0],
-                       &shape[0], ghostCells,
+                       &shape[0], ghostCells, numberOfParticles > 0,
                        config_file);
 #else
     init_analysis(world, window, gids.size(),
@@ -32,6 +32,7 @@ struct VortexDataAdaptor::DInternals
 #else
   vtkSmartPointer<vtkMultiBlockDataSet> Mesh;
 #endif
+  int MeshLevels;
   simulation_data *sim;
 };
 
@@ -71,7 +72,15 @@ int VortexDataAdaptor::GetMesh(const std::string &meshName, bool /*structureOnly
     }
 
   DInternals& internals = (*this->Internals);
-  if (!internals.Mesh)
+
+  // an analysis may only need the coarse levels, the patches of finer
+  // levels are then not made
+  int nLevels = internals.sim->max_levels + 1;
+  int maxLevel = this->GetMaxLevel("AMR_mesh");
+  if ((maxLevel >= 0) && (maxLevel < nLevels))
+    nLevels = maxLevel + 1;
+
+  if (!internals.Mesh || (internals.MeshLevels != nLevels))
     {
 //#define DEBUG_GET_MESH
 #ifdef DEBUG_GET_MESH
@@ -88,8 +97,9 @@ int VortexDataAdaptor::GetMesh(const std::string &meshName, bool /*structureOnly
     // Make the dataset, set the blocks per level. The blocks per level is the
     // global number of patches per level.
     internals.Mesh = vtkSmartPointer<vtkOverlappingAMR>::New();
-    internals.Mesh->Initialize(internals.sim->max_levels+1,
+    internals.Mesh->Initialize(nLevels,
                                internals.sim->npatches_per_level);
+    internals.MeshLevels = nLevels;
 
     // Set the origin. Use the origin of patch 0, the root patch. All ranks
     // compute the root patch in this simulation.
@@ -122,6 +132,10 @@ int VortexDataAdaptor::GetMesh(const std::string &meshName, bool /*structureOnly
 #endif
     for(int i = 0; i < np; ++i)
       {
+      // Skip patches of levels that were not requested.
+      if(patches_this_rank[i]->level >= nLevels)
+        continue;
+
       // Compute just a little information for this patch.
       int low[3], high[3];
       low[0] = patches_this_rank[i]->logical_extents[0];
@@ -235,7 +249,7 @@ int VortexDataAdaptor::GetMesh(const std::string &meshName, bool /*structureOnly
       }
 
     // Set the refinement ratio for each level.
-    for(int i = 0; i < internals.sim->max_levels+1; ++i)
+    for(int i = 0; i < nLevels; ++i)
       {
 #ifdef DEBUG_GET_MESH
       if(f != NULL)
@@ -281,8 +295,13 @@ int VortexDataAdaptor::AddArray(vtkDataObject* mesh, const std::string &meshName
   // Set the arrays for the local domains.
   int np = 0;
   patch_t **patches_this_rank = patch_flat_array(&internals.sim->patch, &np);
+  int nLevels = ds->GetNumberOfLevels();
   for(int i = 0; i < np; ++i)
     {
+    // Skip patches of levels that were not requested.
+    if(patches_this_rank[i]->level >= nLevels)
+      continue;
+
     // Skip any duplicate patches not owned by this rank.
     if(patches_this_rank[i]->nowners > 1)
       {
@@ -92,6 +92,7 @@ VTK_SWIG_INTEROP(vtkDataObject)
     return *self;
   }
 }
+%ignore sensei::MaxLevelScope;
 %include "DataRequirements.h"
 
 /****************************************************************************
@@ -192,6 +193,36 @@ VTK_DERIVED(Histogram)
  ***************************************************************************/
 VTK_DERIVED(Autocorrelation)
 
+/****************************************************************************
+ * Statistics
+ ***************************************************************************/
+%extend sensei::Statistics
+{
+  /* return a list (count, min, max, mean, variance, skewness, kurtosis)
+     or raise an exception if an error occurred */
+  PyObject *GetStatistics(const std::string &meshName, int association,
+    const std::string &arrayName, int windowed = 0)
+  {
+    std::vector<double> stats;
+    if (self->GetStatistics(meshName, association, arrayName, stats, windowed))
+      {
+      PyErr_Format(PyExc_RuntimeError,
+        "Failed to get the statistics of \"%s\"", arrayName.c_str());
+      return nullptr;
+      }
+
+    return senseiPySequence::NewList<double>(stats);
+  }
+}
+%ignore sensei::Statistics::GetStatistics;
+VTK_DERIVED(Statistics)
+
+/****************************************************************************
+ * ParticleDeposition
+ ***************************************************************************/
+VTK_SWIG_INTEROP(vtkImageData)
+VTK_DERIVED(ParticleDeposition)
+
 /****************************************************************************
  * CatalystAnalysisAdaptor
  ***************************************************************************/
@@ -264,13 +264,19 @@ int ADIOS1AnalysisAdaptor::WriteTimestep(unsigned long timeStep,
     timeStep == 0 ? "w" : "a", this->GetCommunicator());
   Profiler::EndEvent("adios_open");
 
-  // TODO -- what are the implications of not setting the group
-  // size? it's a lot of work to calculate the size. user manual
-  // indicates that it is optional. would setting a fixed size
-  // like 200MB be better than not setting the size?
-  /*uint64_t group_size = this->Schema->GetSize(
-    this->GetCommunicator(), metadata, objects);
-  adios_group_size(handle, group_size, &group_size);*/
+  // size the buffers from the metadata so that ADIOS need not grow
+  // them while the step is written
+  uint64_t group_size = 0;
+  uint64_t total_size = 0;
+  if (this->Schema->GetSize(this->GetCommunicator(), metadata, group_size))
+    {
+    SENSEI_ERROR("Failed to compute the size of step " << timeStep)
+    ierr = -1;
+    }
+  else
+    {
+    adios_group_size(handle, group_size, &total_size);
+    }
 
   if (this->Schema->Write(this->GetCommunicator(),
     handle, timeStep, time, metadata, objects))
@@ -2,7 +2,6 @@
 
 #include "MeshMetadata.h"
 #include "Partitioner.h"
-#include "BlockPartitioner.h"
 #include "Error.h"
 #include "Profiler.h"
 #include "ADIOS1Schema.h"
@@ -228,34 +227,22 @@ int ADIOS1DataAdaptor::GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadat
     if (metadata)
        return 0;
 
-    // first time through. use the partitioner to figure it out.
-    // get the sender layout.
-    MeshMetadataPtr senderMd;
-    if (this->GetSenderMeshMetadata(id, senderMd))
+    // first time through this step. use the partitioner to lay out all of
+    // the meshes at once.
+    std::vector<MeshMetadataPtr> receiverMd;
+    if (this->PartitionMeshes(receiverMd) || (id >= receiverMd.size()))
       {
-      SENSEI_ERROR("Failed to get sender metadata")
+      SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
       this->CloseStream();
       return -1;
       }
 
-    // get the partitioner, default to the block partitioner
-    PartitionerPtr part = this->GetPartitioner();
-    if (!part)
-      {
-      SENSEI_WARNING("No partitoner specified, using BlockParititoner")
-      part = BlockPartitioner::New();
-      }
-
-    MeshMetadataPtr receiverMd;
-    if (part->GetPartition(this->GetCommunicator(), senderMd, receiverMd))
-      {
-      SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
-      this->CloseStream();
-      }
+    // cache and return the new layouts
+    unsigned int nMeshes = receiverMd.size();
+    for (unsigned int i = 0; i < nMeshes; ++i)
+      this->Internals->Schema.SetReceiverMeshMetadata(i, receiverMd[i]);
 
-    // cache and return the new layout
-    this->Internals->Schema.SetReceiverMeshMetadata(id, receiverMd);
-    metadata = receiverMd;
+    metadata = receiverMd[id];
     }
 
   return 0;
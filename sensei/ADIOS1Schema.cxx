@@ -55,6 +55,7 @@
 #include <string>
 #include <functional>
 #include <sstream>
+#include <cstring>
 
 namespace senseiADIOS1
 {
@@ -315,6 +316,26 @@ unsigned int getNumberOfDatasets(MPI_Comm comm, vtkDataObject *dobj,
   return number_of_datasets;
 }
 
+// --------------------------------------------------------------------------
+// writes a run of blocks as a single contiguous variable. a single block is
+// written in place when possible, otherwise the run is serialized into the
+// staging buffer first. returns the number of bytes written.
+long long writeBlockRun(int64_t fh, int64_t write_id,
+  const std::vector<vtkDataSet*> &blocks,
+  sensei::VTKUtils::BlockSerializer &serializer,
+  std::vector<unsigned char> &staging)
+{
+  const void *data = nullptr;
+  unsigned long long num_bytes = 0;
+
+  if (sensei::VTKUtils::Serialize(blocks, serializer, staging, data, num_bytes))
+    return -1;
+
+  adios_write_byid(fh, write_id, const_cast<void*>(data));
+
+  return num_bytes;
+}
+
 
 
 
@@ -582,18 +603,16 @@ struct ArraySchema
 
   int DefineVariable(MPI_Comm comm, int64_t gh, const std::string &ons,
     int i, int array_type, int num_components, int array_cen,
-    unsigned long long num_points_total, unsigned long long num_cells_total,
-    unsigned int num_blocks, const std::vector<long> &block_num_points,
+    const std::vector<long> &block_num_points,
     const std::vector<long> &block_num_cells,
-    const std::vector<int> &block_owner, std::vector<int64_t> &write_ids);
+    const std::vector<sensei::VTKUtils::BlockRun> &runs, std::vector<int64_t> &write_ids);
 
   int Write(MPI_Comm comm, int64_t fh,
     const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
 
   int Write(MPI_Comm comm, int64_t fh, unsigned int i,
     const std::string &array_name, int array_cen, vtkCompositeDataSet *dobj,
-    unsigned int num_blocks, const std::vector<int> &block_owner,
-    const std::vector<int64_t> &writeIds);
+    const std::vector<sensei::VTKUtils::BlockRun> &runs, const std::vector<int64_t> &writeIds);
 
   int Read(MPI_Comm comm, ADIOS_FILE *fh, const std::string &ons,
     const std::string &array_name, int centering,
@@ -606,23 +625,23 @@ struct ArraySchema
     const std::vector<long> &block_num_cells, const std::vector<int> &block_owner,
     vtkCompositeDataSet *dobj);
 
+  // write ids are indexed by array*num_runs + run
   std::map<std::string,std::vector<int64_t>> WriteIds;
+  std::map<std::string,std::vector<sensei::VTKUtils::BlockRun>> LocalRuns;
+  std::vector<unsigned char> Staging;
 };
 
 
 // --------------------------------------------------------------------------
 int ArraySchema::DefineVariable(MPI_Comm comm, int64_t gh,
   const std::string &ons, int i, int array_type, int num_components,
-  int array_cen, unsigned long long num_points_total,
-  unsigned long long num_cells_total, unsigned int num_blocks,
-  const std::vector<long> &block_num_points,
+  int array_cen, const std::vector<long> &block_num_points,
   const std::vector<long> &block_num_cells,
-  const std::vector<int> &block_owner, std::vector<int64_t> &write_ids)
+  const std::vector<sensei::VTKUtils::BlockRun> &runs, std::vector<int64_t> &write_ids)
 {
   sensei::TimeEvent<128> mark("senseiADIOS1::ArraySchema::DefineVariable");
 
-  int rank = 0;
-  MPI_Comm_rank(comm, &rank);
+  (void)comm;
 
   // validate centering
   if ((array_cen != vtkDataObject::POINT) && (array_cen != vtkDataObject::CELL))
@@ -635,47 +654,45 @@ int ArraySchema::DefineVariable(MPI_Comm comm, int64_t gh,
   std::ostringstream ans;
   ans << ons << "data_array_" << i << "/";
 
-  // select global size either point or cell data
-  unsigned long long num_elem_total = (array_cen == vtkDataObject::POINT ?
-    num_points_total : num_cells_total)*num_components;
+  // compute the offset of each block, and the global size, from
+  // either point or cell data
+  const std::vector<long> &block_num_elem =
+    array_cen == vtkDataObject::POINT ? block_num_points : block_num_cells;
+
+  unsigned int num_blocks = block_num_elem.size();
+  std::vector<unsigned long long> block_offset(num_blocks + 1, 0);
+  for (unsigned int j = 0; j < num_blocks; ++j)
+    block_offset[j+1] = block_offset[j] + block_num_elem[j]*num_components;
 
   // global size as a string
   std::ostringstream gdims;
-  gdims << num_elem_total;
+  gdims << block_offset[num_blocks];
 
   // adios type of the array
   ADIOS_DATATYPES elem_type = adiosType(array_type);
 
-  // define the variable once for each block
-  unsigned long long block_offset = 0;
-  for (unsigned int j = 0; j < num_blocks; ++j)
+  // define the variable once for each run of local blocks
+  unsigned int num_runs = runs.size();
+  for (unsigned int r = 0; r < num_runs; ++r)
     {
-    // get the block size
-    unsigned long long num_elem_local = (array_cen == vtkDataObject::POINT ?
-      block_num_points[j] : block_num_cells[j])*num_components;
+    unsigned long long run_offset = block_offset[runs[r].First];
+    unsigned long long num_elem_local = block_offset[runs[r].End] - run_offset;
 
-    // define the variable for a local block
-    if (block_owner[j] ==  rank)
-      {
-      // local size as a string
-      std::ostringstream ldims;
-      ldims << num_elem_local;
+    // local size as a string
+    std::ostringstream ldims;
+    ldims << num_elem_local;
 
-      // offset as a string
-      std::ostringstream boffs;
-      boffs << block_offset;
-
-      // /data_object_<id>/data_array_<id>/data
-      std::string path = ans.str() + "data";
-      int64_t write_id = adios_define_var(gh, path.c_str(), "", elem_type,
-         ldims.str().c_str(), gdims.str().c_str(), boffs.str().c_str());
+    // offset as a string
+    std::ostringstream boffs;
+    boffs << run_offset;
 
-      // save the write id to tell adios which block we are writing later
-      write_ids[i*num_blocks + j] = write_id;
-      }
+    // /data_object_<id>/data_array_<id>/data
+    std::string path = ans.str() + "data";
+    int64_t write_id = adios_define_var(gh, path.c_str(), "", elem_type,
+       ldims.str().c_str(), gdims.str().c_str(), boffs.str().c_str());
 
-    // update the block offset
-    block_offset += num_elem_local;
+    // save the write id to tell adios which run we are writing later
+    write_ids[i*num_runs + r] = write_id;
     }
 
   return 0;
@@ -687,33 +704,29 @@ int ArraySchema::DefineVariables(MPI_Comm comm, int64_t gh,
 {
   sensei::TimeEvent<128> mark("senseiADIOS1::ArraySchema::DefineVariables");
 
-  std::vector<int64_t> &writeIds = this->WriteIds[md->MeshName];
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // build the local index
+  std::vector<sensei::VTKUtils::BlockRun> &runs = this->LocalRuns[md->MeshName];
+  sensei::VTKUtils::GetLocalBlockRuns(rank, md->BlockOwner, runs);
 
   // allocate write ids
-  unsigned int num_blocks = md->NumBlocks;
+  unsigned int num_runs = runs.size();
   unsigned int num_arrays = md->NumArrays;
 
   unsigned int num_ghost_arrays =
-    md->NumGhostCells ? 1 : 0 + md->NumGhostNodes ? 1 : 0;
-
-  writeIds.resize(num_blocks*(num_arrays + num_ghost_arrays));
+    (md->NumGhostCells ? 1 : 0) + (md->NumGhostNodes ? 1 : 0);
 
-  // compute global sizes
-  unsigned long long num_points_total = 0;
-  unsigned long long num_cells_total = 0;
-  for (unsigned int j = 0; j < num_blocks; ++j)
-    {
-    num_points_total += md->BlockNumPoints[j];
-    num_cells_total += md->BlockNumCells[j];
-    }
+  std::vector<int64_t> &writeIds = this->WriteIds[md->MeshName];
+  writeIds.resize(num_runs*(num_arrays + num_ghost_arrays));
 
   // define data arrays
   for (unsigned int i = 0; i < num_arrays; ++i)
     {
     if (this->DefineVariable(comm, gh, ons, i, md->ArrayType[i],
-      md->ArrayComponents[i], md->ArrayCentering[i], num_points_total,
-      num_cells_total, num_blocks, md->BlockNumPoints, md->BlockNumCells,
-      md->BlockOwner, writeIds))
+      md->ArrayComponents[i], md->ArrayCentering[i], md->BlockNumPoints,
+      md->BlockNumCells, runs, writeIds))
       return -1;
     }
 
@@ -721,16 +734,15 @@ int ArraySchema::DefineVariables(MPI_Comm comm, int64_t gh,
   if (md->NumGhostCells)
     {
     if (this->DefineVariable(comm, gh, ons, num_arrays, VTK_UNSIGNED_CHAR,
-      1, vtkDataObject::CELL, num_points_total, num_cells_total, num_blocks,
-      md->BlockNumPoints, md->BlockNumCells, md->BlockOwner, writeIds))
+      1, vtkDataObject::CELL, md->BlockNumPoints, md->BlockNumCells,
+      runs, writeIds))
       return -1;
     num_arrays += 1;
     }
 
   if (md->NumGhostNodes && this->DefineVariable(comm, gh, ons, num_arrays,
-      VTK_UNSIGNED_CHAR, 1, vtkDataObject::POINT, num_points_total,
-      num_cells_total, num_blocks, md->BlockNumPoints, md->BlockNumCells,
-      md->BlockOwner, writeIds))
+      VTK_UNSIGNED_CHAR, 1, vtkDataObject::POINT, md->BlockNumPoints,
+      md->BlockNumCells, runs, writeIds))
       return -1;
 
   return 0;
@@ -740,48 +752,55 @@ int ArraySchema::DefineVariables(MPI_Comm comm, int64_t gh,
 // --------------------------------------------------------------------------
 int ArraySchema::Write(MPI_Comm comm, int64_t fh, unsigned int i,
   const std::string &array_name, int array_cen, vtkCompositeDataSet *dobj,
-  unsigned int num_blocks, const std::vector<int> &block_owner,
-  const std::vector<int64_t> &writeIds)
+  const std::vector<sensei::VTKUtils::BlockRun> &runs, const std::vector<int64_t> &writeIds)
 {
   sensei::Profiler::StartEvent("senseiADIOS1::ArraySchema::Write");
   long long numBytes = 0ll;
 
-  int rank = 0;
-  MPI_Comm_rank(comm, &rank);
+  (void)comm;
 
   vtkCompositeDataIterator *it = dobj->NewIterator();
   it->SetSkipEmptyNodes(0);
   it->InitTraversal();
 
-  for (unsigned int j = 0; j < num_blocks; ++j)
+  sensei::VTKUtils::DataArraySerializer serializer(array_name, array_cen);
+  std::vector<vtkDataSet*> blocks;
+
+  unsigned int j = 0;
+  unsigned int num_runs = runs.size();
+  for (unsigned int r = 0; r < num_runs; ++r)
     {
-    if (block_owner[j] == rank)
+    // skip to the first block of the run
+    for (; j < runs[r].First; ++j)
+      it->GoToNextItem();
+
+    // gather the run's blocks
+    blocks.clear();
+    for (; j < runs[r].End; ++j)
       {
       vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
       if (!ds)
         {
         SENSEI_ERROR("Failed to get block " << j)
+        it->Delete();
         return -1;
         }
 
-      vtkDataSetAttributes *dsa = array_cen == vtkDataObject::POINT ?
-        dynamic_cast<vtkDataSetAttributes*>(ds->GetPointData()) :
-        dynamic_cast<vtkDataSetAttributes*>(ds->GetCellData());
+      blocks.push_back(ds);
 
-      vtkDataArray *da = dsa->GetArray(array_name.c_str());
-      if (!da)
-        {
-        SENSEI_ERROR("Failed to get array \"" << array_name << "\"")
-        return -1;
-        }
-
-      adios_write_byid(fh, writeIds[i*num_blocks + j], da->GetVoidPointer(0));
+      it->GoToNextItem();
+      }
 
-      numBytes += da->GetNumberOfTuples()*
-        da->GetNumberOfComponents()*sensei::VTKUtils::Size(da->GetDataType());
+    long long nb = writeBlockRun(fh, writeIds[i*num_runs + r],
+      blocks, serializer, this->Staging);
+    if (nb < 0)
+      {
+      SENSEI_ERROR("Failed to write array \"" << array_name << "\"")
+      it->Delete();
+      return -1;
       }
 
-    it->GoToNextItem();
+    numBytes += nb;
     }
 
   it->Delete();
@@ -796,17 +815,15 @@ int ArraySchema::Write(MPI_Comm comm, int64_t fh,
 {
   sensei::TimeEvent<128> mark("senseiADIOS1::ArraySchema::Write");
 
-  int rank = 0;
-  MPI_Comm_rank(comm, &rank);
-
   std::vector<int64_t> &writeIds = this->WriteIds[md->MeshName];
+  std::vector<sensei::VTKUtils::BlockRun> &runs = this->LocalRuns[md->MeshName];
 
   // write data arrays
   unsigned int num_arrays = md->NumArrays;
   for (unsigned int i = 0; i < num_arrays; ++i)
     {
     if (this->Write(comm, fh, i, md->ArrayName[i], md->ArrayCentering[i],
-      dobj, md->NumBlocks, md->BlockOwner, writeIds))
+      dobj, runs, writeIds))
       return -1;
     }
 
@@ -814,14 +831,13 @@ int ArraySchema::Write(MPI_Comm comm, int64_t fh,
   if (md->NumGhostCells)
     {
     if (this->Write(comm, fh, num_arrays, "vtkGhostType", vtkDataObject::CELL,
-      dobj, md->NumBlocks, md->BlockOwner, writeIds))
+      dobj, runs, writeIds))
       return -1;
     num_arrays += 1;
     }
 
   if (md->NumGhostNodes && this->Write(comm, fh, num_arrays,
-    "vtkGhostType", vtkDataObject::POINT, dobj, md->NumBlocks,
-     md->BlockOwner, writeIds))
+    "vtkGhostType", vtkDataObject::POINT, dobj, runs, writeIds))
     return -1;
 
   return 0;
@@ -964,7 +980,10 @@ struct PointSchema
   int Read(MPI_Comm comm, ADIOS_FILE *fh, const std::string &ons,
     const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
 
+  // write ids are indexed by run
   std::map<std::string, std::vector<int64_t>> WriteIds;
+  std::map<std::string, std::vector<sensei::VTKUtils::BlockRun>> LocalRuns;
+  std::vector<unsigned char> Staging;
 };
 
 // --------------------------------------------------------------------------
@@ -979,55 +998,49 @@ int PointSchema::DefineVariables(MPI_Comm comm, int64_t gh,
     int rank = 0;
     MPI_Comm_rank(comm, &rank);
 
+    // build the local index
+    std::vector<sensei::VTKUtils::BlockRun> &runs = this->LocalRuns[md->MeshName];
+    sensei::VTKUtils::GetLocalBlockRuns(rank, md->BlockOwner, runs);
+
     // allocate write ids
+    unsigned int num_runs = runs.size();
     std::vector<int64_t> &writeIds = this->WriteIds[md->MeshName];
-    unsigned int num_blocks = md->NumBlocks;
-    writeIds.resize(num_blocks);
+    writeIds.resize(num_runs);
 
-    // calc global size
-    unsigned long long num_total = 0;
+    // calc the offset of each block and the global size
+    unsigned int num_blocks = md->NumBlocks;
+    std::vector<unsigned long long> block_offset(num_blocks + 1, 0);
     for (unsigned int j = 0; j < num_blocks; ++j)
-      {
-      num_total += md->BlockNumPoints[j];
-      }
+      block_offset[j+1] = block_offset[j] + md->BlockNumPoints[j];
 
     // data type for points
     ADIOS_DATATYPES type = adiosType(md->CoordinateType);
 
     // global sizes as a strings
     std::ostringstream gdims;
-    gdims << 3*num_total;
-
-    // define the variable once for each block
-    unsigned long long block_offset = 0;
+    gdims << 3*block_offset[num_blocks];
 
-    for (unsigned int j = 0; j < num_blocks; ++j)
+    // define the variable once for each run of local blocks
+    for (unsigned int r = 0; r < num_runs; ++r)
       {
-      // get the block size
-      unsigned long long num_local = md->BlockNumPoints[j];
-
-      // define the variable for a local block
-      if (md->BlockOwner[j] ==  rank)
-        {
-        // local size as a string
-        std::ostringstream ldims;
-        ldims << 3*num_local;
+      unsigned long long run_offset = block_offset[runs[r].First];
+      unsigned long long num_local = block_offset[runs[r].End] - run_offset;
 
-        // offset as a string
-        std::ostringstream boffs;
-        boffs << 3*block_offset;
+      // local size as a string
+      std::ostringstream ldims;
+      ldims << 3*num_local;
 
-        // /data_object_<id>/data_array_<id>/points
-        std::string path_pts = ons + "points";
-        int64_t write_id = adios_define_var(gh, path_pts.c_str(), "",
-           type, ldims.str().c_str(), gdims.str().c_str(), boffs.str().c_str());
+      // offset as a string
+      std::ostringstream boffs;
+      boffs << 3*run_offset;
 
-        // save the id for subsequent write
-        writeIds[j] = write_id;
-        }
+      // /data_object_<id>/data_array_<id>/points
+      std::string path_pts = ons + "points";
+      int64_t write_id = adios_define_var(gh, path_pts.c_str(), "",
+         type, ldims.str().c_str(), gdims.str().c_str(), boffs.str().c_str());
 
-      // update the block offset
-      block_offset += num_local;
+      // save the id for subsequent write
+      writeIds[r] = write_id;
       }
     }
 
@@ -1044,35 +1057,53 @@ int PointSchema::Write(MPI_Comm comm, int64_t fh,
     sensei::Profiler::StartEvent("senseiADIOS1::PointSchema::Write");
     long long numBytes = 0ll;
 
-    int rank = 0;
-    MPI_Comm_rank(comm, &rank);
+    (void)comm;
 
     std::vector<int64_t> &writeIds = this->WriteIds[md->MeshName];
+    std::vector<sensei::VTKUtils::BlockRun> &runs = this->LocalRuns[md->MeshName];
 
     vtkCompositeDataIterator *it = dobj->NewIterator();
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
 
-    unsigned int num_blocks = md->NumBlocks;
-    for (unsigned int j = 0; j < num_blocks; ++j)
+    sensei::VTKUtils::PointsSerializer serializer;
+    std::vector<vtkDataSet*> blocks;
+
+    unsigned int j = 0;
+    unsigned int num_runs = runs.size();
+    for (unsigned int r = 0; r < num_runs; ++r)
       {
-      if (md->BlockOwner[j] == rank)
+      // skip to the first block of the run
+      for (; j < runs[r].First; ++j)
+        it->GoToNextItem();
+
+      // gather the run's blocks
+      blocks.clear();
+      for (; j < runs[r].End; ++j)
         {
         vtkPointSet *ds = dynamic_cast<vtkPointSet*>(it->GetCurrentDataObject());
         if (!ds)
           {
           SENSEI_ERROR("Failed to get block " << j)
+          it->Delete();
           return -1;
           }
 
-        vtkDataArray *da = ds->GetPoints()->GetData();
-        adios_write_byid(fh, writeIds[j], da->GetVoidPointer(0));
+        blocks.push_back(ds);
 
-        numBytes += da->GetNumberOfTuples()*
-          da->GetNumberOfComponents()*sensei::VTKUtils::Size(da->GetDataType());
+        it->GoToNextItem();
         }
 
-      it->GoToNextItem();
+      long long nb = writeBlockRun(fh, writeIds[r],
+        blocks, serializer, this->Staging);
+      if (nb < 0)
+        {
+        SENSEI_ERROR("Failed to write points")
+        it->Delete();
+        return -1;
+        }
+
+      numBytes += nb;
       }
     it->Delete();
 
@@ -1575,6 +1606,11 @@ int PolydataCellSchema::Write(MPI_Comm comm, int64_t fh,
     std::vector<int64_t> &typeWriteIds = this->TypeWriteIds[md->MeshName];
     std::vector<int64_t> &arrayWriteIds = this->ArrayWriteIds[md->MeshName];
 
+    sensei::VTKUtils::CellTypesSerializer typeSerializer;
+    sensei::VTKUtils::CellArraySerializer cellSerializer;
+    std::vector<unsigned char> types;
+    std::vector<unsigned char> cells;
+
     vtkCompositeDataIterator *it = dobj->NewIterator();
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
@@ -1591,49 +1627,27 @@ int PolydataCellSchema::Write(MPI_Comm comm, int64_t fh,
           return -1;
           }
 
-        // first move the polydata's various cell arrays into a single
-        // contiguous array. and build a cell types array. doing it this
-        // way simplifies the file format as we don't need to keep track
-        // of all 4 cells arrays.
-        std::vector<char> types;
-        std::vector<vtkIdType> cells;
-
-        vtkIdType nv = pd->GetNumberOfVerts();
-        if (nv)
-          {
-          types.insert(types.end(), nv, VTK_VERTEX);
-          vtkIdType *pv = pd->GetVerts()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), pv, pv + pd->GetVerts()->GetData()->GetNumberOfTuples());
-          }
-
-        vtkIdType nl = pd->GetNumberOfLines();
-        if (nl)
-          {
-          types.insert(types.end(), nl, VTK_LINE);
-          vtkIdType *pl = pd->GetLines()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), pl, pl + pd->GetLines()->GetData()->GetNumberOfTuples());
-          }
-
-        vtkIdType np = pd->GetNumberOfPolys();
-        if (np)
-          {
-          types.insert(types.end(), np, VTK_POLYGON);
-          vtkIdType *pp = pd->GetPolys()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), pp, pp + pd->GetPolys()->GetData()->GetNumberOfTuples());
-          }
-
-        vtkIdType ns = pd->GetNumberOfStrips();
-        if (ns)
+        // the serializers move the polydata's various cell arrays into a
+        // single contiguous array and build a cell types array. doing it
+        // this way simplifies the file format as we don't need to keep
+        // track of all 4 cells arrays.
+        const void *pTypes = nullptr;
+        const void *pCells = nullptr;
+        unsigned long long typeBytes = 0;
+        unsigned long long cellBytes = 0;
+
+        if (sensei::VTKUtils::Serialize(pd, typeSerializer, types, pTypes, typeBytes) ||
+          sensei::VTKUtils::Serialize(pd, cellSerializer, cells, pCells, cellBytes))
           {
-          types.insert(types.end(), ns, VTK_TRIANGLE_STRIP);
-          vtkIdType *ps = pd->GetStrips()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), ps, ps + pd->GetStrips()->GetData()->GetNumberOfTuples());
+          SENSEI_ERROR("Failed to serialize the cells of block " << j)
+          it->Delete();
+          return -1;
           }
 
-        adios_write_byid(fh, typeWriteIds[j], types.data());
-        adios_write_byid(fh, arrayWriteIds[j], cells.data());
+        adios_write_byid(fh, typeWriteIds[j], const_cast<void*>(pTypes));
+        adios_write_byid(fh, arrayWriteIds[j], const_cast<void*>(pCells));
 
-        numBytes += types.size()*sizeof(unsigned char) + cells.size()*sizeof(vtkIdType);
+        numBytes += typeBytes + cellBytes;
         }
 
       // go to the next block
@@ -2736,6 +2750,102 @@ int DataObjectSchema::InitializeDataObject(MPI_Comm comm,
 
 
 
+// --------------------------------------------------------------------------
+// serializes the parts of the metadata that determine the variable
+// definitions. when these do not change, the definitions are reused.
+void packDefinitionKey(const std::vector<sensei::MeshMetadataPtr> &metadata,
+  sensei::BinaryStream &bs)
+{
+  unsigned int n_objects = metadata.size();
+  bs.Pack(n_objects);
+
+  for (unsigned int i = 0; i < n_objects; ++i)
+    {
+    const sensei::MeshMetadataPtr &md = metadata[i];
+    bs.Pack(md->MeshName);
+    bs.Pack(md->MeshType);
+    bs.Pack(md->BlockType);
+    bs.Pack(md->CoordinateType);
+    bs.Pack(md->NumBlocks);
+    bs.Pack(md->BlockOwner);
+    bs.Pack(md->BlockNumPoints);
+    bs.Pack(md->BlockNumCells);
+    bs.Pack(md->BlockCellArraySize);
+    bs.Pack(md->BlockExtents);
+    bs.Pack(md->NumArrays);
+    bs.Pack(md->ArrayName);
+    bs.Pack(md->ArrayCentering);
+    bs.Pack(md->ArrayComponents);
+    bs.Pack(md->ArrayType);
+    bs.Pack(md->NumGhostCells);
+    bs.Pack(md->NumGhostNodes);
+    }
+}
+
+// --------------------------------------------------------------------------
+// computes the number of bytes this rank writes for a data object from its
+// metadata
+uint64_t getLocalSize(int rank, const sensei::MeshMetadataPtr &md)
+{
+  uint64_t n_bytes = 0;
+
+  // /data_object_<id>/metadata
+  sensei::BinaryStream bs;
+  md->ToStream(bs);
+  n_bytes += bs.Size() + sizeof(int);
+
+  unsigned int num_blocks = md->NumBlocks;
+  unsigned int num_arrays = md->NumArrays;
+  for (unsigned int j = 0; j < num_blocks; ++j)
+    {
+    if (md->BlockOwner[j] != rank)
+      continue;
+
+    uint64_t num_points = md->BlockNumPoints[j];
+    uint64_t num_cells = md->BlockNumCells[j];
+
+    // data arrays
+    for (unsigned int i = 0; i < num_arrays; ++i)
+      {
+      n_bytes += (md->ArrayCentering[i] == vtkDataObject::POINT ?
+        num_points : num_cells)*md->ArrayComponents[i]*
+        sensei::VTKUtils::Size(md->ArrayType[i]);
+      }
+
+    // ghost arrays
+    if (md->NumGhostCells)
+      n_bytes += num_cells;
+
+    if (md->NumGhostNodes)
+      n_bytes += num_points;
+
+    // points
+    if (sensei::VTKUtils::Unstructured(md) || sensei::VTKUtils::Structured(md)
+      || sensei::VTKUtils::Polydata(md))
+      n_bytes += 3*num_points*sensei::VTKUtils::Size(md->CoordinateType);
+
+    // cells
+    if (sensei::VTKUtils::Unstructured(md) || sensei::VTKUtils::Polydata(md))
+      n_bytes += num_cells + md->BlockCellArraySize[j]*sizeof(vtkIdType);
+
+    // coordinate axes
+    if (sensei::VTKUtils::StretchedCartesian(md))
+      {
+      const int *ext = md->BlockExtents[j].data();
+      n_bytes += (ext[1] - ext[0] + ext[3] - ext[2] + ext[5] - ext[4] + 6)*
+        sensei::VTKUtils::Size(md->CoordinateType);
+      }
+
+    // extent, origin and spacing
+    if (sensei::VTKUtils::LogicallyCartesian(md))
+      n_bytes += 6*sizeof(int) + 6*sizeof(double);
+    }
+
+  return n_bytes;
+}
+
+
+
 struct DataObjectCollectionSchema::InternalsType
 {
   InternalsType() : BlockOwnerArrayMetadata(0) {}
@@ -2744,6 +2854,7 @@ struct DataObjectCollectionSchema::InternalsType
   sensei::MeshMetadataMap SenderMdMap;
   sensei::MeshMetadataMap ReceiverMdMap;
   int BlockOwnerArrayMetadata;
+  std::vector<unsigned char> DefinitionKey;
 };
 
 // --------------------------------------------------------------------------
@@ -2904,7 +3015,25 @@ int DataObjectCollectionSchema::GetObjectId(MPI_Comm comm,
 int DataObjectCollectionSchema::DefineVariables(MPI_Comm comm, int64_t gh,
   const std::vector<sensei::MeshMetadataPtr> &metadata)
 {
-  sensei::TimeEvent<128>("senseiADIOS1::DataObjectCollectionSchema::DefineVariables");
+  sensei::TimeEvent<128> mark("senseiADIOS1::DataObjectCollectionSchema::DefineVariables");
+
+  // the definitions depend only on the layout of the data. when that is
+  // unchanged, as it is for static meshes, the existing definitions are
+  // reused.
+  sensei::BinaryStream key;
+  packDefinitionKey(metadata, key);
+
+  std::vector<unsigned char> &cachedKey = this->Internals->DefinitionKey;
+  if ((cachedKey.size() == key.Size()) &&
+    (memcmp(cachedKey.data(), key.GetData(), key.Size()) == 0))
+    return 0;
+
+#if ADIOS_VERSION_GE(1,11,0)
+  // discard the definitions made for the previous layout
+  if (!cachedKey.empty())
+    adios_delete_vardefs(gh);
+#endif
+  cachedKey.clear();
 
   // mark the file as ours and declare version it is written with
   this->Internals->Version.DefineVariables(gh);
@@ -2943,6 +3072,36 @@ int DataObjectCollectionSchema::DefineVariables(MPI_Comm comm, int64_t gh,
       }
     }
 
+  cachedKey.assign(key.GetData(), key.GetData() + key.Size());
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataObjectCollectionSchema::GetSize(MPI_Comm comm,
+  const std::vector<sensei::MeshMetadataPtr> &metadata, uint64_t &n_bytes)
+{
+  sensei::TimeEvent<128> mark("senseiADIOS1::DataObjectCollectionSchema::GetSize");
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // version, time_step, time, number_of_data_objects
+  n_bytes = sizeof(unsigned int) + sizeof(unsigned long)
+    + sizeof(double) + sizeof(int);
+
+  unsigned int n_objects = metadata.size();
+  for (unsigned int i = 0; i < n_objects; ++i)
+    {
+    if (!metadata[i]->GlobalView)
+      {
+      SENSEI_ERROR("A global view of metadata is required")
+      return -1;
+      }
+
+    n_bytes += getLocalSize(rank, metadata[i]);
+    }
+
   return 0;
 }
 
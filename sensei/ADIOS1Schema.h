@@ -34,10 +34,16 @@ public:
   DataObjectCollectionSchema();
   ~DataObjectCollectionSchema();
 
-  // declare variables for adios write
+  // declare variables for adios write. the definitions are cached and
+  // only redeclared when the layout described by the metadata changes
   int DefineVariables(MPI_Comm comm, int64_t gh,
     const std::vector<sensei::MeshMetadataPtr> &metadata);
 
+  // compute the number of bytes this rank will write, from the metadata.
+  // this is used to size the ADIOS buffers up front
+  int GetSize(MPI_Comm comm,
+    const std::vector<sensei::MeshMetadataPtr> &metadata, uint64_t &n_bytes);
+
   // discover names of data objects on disk(or stream)
   int ReadMeshMetadata(MPI_Comm comm, InputStream &iStream);
 
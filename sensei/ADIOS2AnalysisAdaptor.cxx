@@ -34,6 +34,7 @@
 #include <mpi.h>
 #include <vector>
 #include <regex>
+#include <strings.h>
 #include <pugixml.hpp>
 
 using senseiADIOS2::adios2_strerror;
@@ -47,7 +48,7 @@ senseiNewMacro(ADIOS2AnalysisAdaptor);
 //----------------------------------------------------------------------------
 ADIOS2AnalysisAdaptor::ADIOS2AnalysisAdaptor() :
     Schema(nullptr), FileName("sensei.bp"), DebugMode(0),
-    StepsPerFile(0), StepIndex(0), FileIndex(0)
+    LatestOnly(0), StepsPerFile(0), StepIndex(0), FileIndex(0)
 {
   this->Handles.io = nullptr;
   this->Handles.engine = nullptr;
@@ -74,7 +75,44 @@ int ADIOS2AnalysisAdaptor::AddDataRequirement(const std::string &meshName,
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int ADIOS2AnalysisAdaptor::AddArrayReduction(const std::string &meshName,
+  int association, const std::string &arrayName, const std::string &method,
+  double errorBound,
+  const std::vector<std::pair<std::string,std::string>> &parameters)
+{
+  ReductionSpec spec;
+  spec.MeshName = meshName;
+  spec.Association = association;
+  spec.ArrayName = arrayName;
+  spec.Method = method;
 
+  if (method == "quantize")
+    {
+    if (errorBound <= 0.0)
+      {
+      SENSEI_ERROR("Quantizing array \"" << arrayName
+        << "\" requires a positive error bound")
+      return -1;
+      }
+    spec.Reduction.Method = senseiADIOS2::ArrayReduction::QUANTIZE;
+    spec.Reduction.ErrorBound = errorBound;
+    }
+  else if (!method.empty())
+    {
+    spec.Reduction.Method = senseiADIOS2::ArrayReduction::OPERATOR;
+    spec.Reduction.Parameters = parameters;
+    }
+  else
+    {
+    SENSEI_ERROR("No reduction method given for array \"" << arrayName << "\"")
+    return -1;
+    }
+
+  this->Reductions.push_back(spec);
+
+  return 0;
+}
 
 //-----------------------------------------------------------------------------
 int ADIOS2AnalysisAdaptor::FetchFromProducer(
@@ -195,10 +233,13 @@ bool ADIOS2AnalysisAdaptor::Execute(DataAdaptor* dataAdaptor)
     SENSEI_WARNING("No subset specified. Writing all available data")
     }
 
-  // collect the specified data objects and metadata
+  // collect the specified data objects and metadata. AMR level limits are
+  // passed to the simulation so that finer patches are never built nor sent
   std::vector<vtkCompositeDataSet*> objects;
   std::vector<MeshMetadataPtr> metadata;
 
+  MaxLevelScope levels(this->Requirements, dataAdaptor);
+
   if (this->FetchFromProducer(dataAdaptor, objects, metadata))
     {
     SENSEI_ERROR("Failed to fetch data from the producer")
@@ -212,7 +253,7 @@ bool ADIOS2AnalysisAdaptor::Execute(DataAdaptor* dataAdaptor)
   unsigned long timeStep = dataAdaptor->GetDataTimeStep();
   double time = dataAdaptor->GetDataTime();
 
-  if (this->DefineVariables(metadata) ||
+  if (this->DefineVariables(metadata, objects) ||
     this->WriteTimestep(timeStep, time, metadata, objects))
     return false;
 
@@ -255,6 +296,17 @@ int ADIOS2AnalysisAdaptor::Initialize(pugi::xml_node &node)
   // turn on/off debug output
   this->SetDebugMode(node.attribute("debug_mode").as_int(0));
 
+  // valid policies are all or latest. with latest the simulation never
+  // waits for the reader
+  std::string stepPolicy = node.attribute("step_policy").as_string("all");
+  if ((stepPolicy != "all") && (stepPolicy != "latest"))
+    {
+    SENSEI_ERROR("Invalid step_policy \"" << stepPolicy
+      << "\". Use one of all or latest")
+    return -1;
+    }
+  this->SetLatestOnly(stepPolicy == "latest");
+
   // enable file series for file based engines
   this->SetStepsPerFile(node.attribute("steps_per_file").as_int(0));
 
@@ -279,8 +331,59 @@ int ADIOS2AnalysisAdaptor::Initialize(pugi::xml_node &node)
     }
   this->SetDataRequirements(req);
 
+  // set the array reductions. these are given in the mesh elements
+  // alongside the data requirements
+  for (pugi::xml_node meshNode = node.child("mesh"); meshNode;
+    meshNode = meshNode.next_sibling("mesh"))
+    {
+    std::string meshName = meshNode.attribute("name").as_string();
+
+    for (pugi::xml_node redNode = meshNode.child("reduction"); redNode;
+      redNode = redNode.next_sibling("reduction"))
+      {
+      if (XMLUtils::RequireAttribute(redNode, "array") ||
+        XMLUtils::RequireAttribute(redNode, "method"))
+        {
+        SENSEI_ERROR("Failed to initialize ADIOS 2.")
+        return -1;
+        }
+
+      int association = 0;
+      std::string assocStr = redNode.attribute("association").as_string("point");
+      if (VTKUtils::GetAssociation(assocStr, association))
+        {
+        SENSEI_ERROR("Failed to initialize ADIOS 2.")
+        return -1;
+        }
+
+      std::string arrayName = redNode.attribute("array").value();
+      std::string method = redNode.attribute("method").value();
+      double errorBound = redNode.attribute("error_bound").as_double(0.0);
+
+      std::vector<std::string> name;
+      std::vector<std::string> value;
+      XMLUtils::ParseNameValuePairs(redNode, name, value);
+
+      std::vector<std::pair<std::string,std::string>> params;
+      size_t n = name.size();
+      for (size_t i = 0; i < n; ++i)
+        params.emplace_back(name[i], value[i]);
+
+      if (this->AddArrayReduction(meshName, association, arrayName,
+        method, errorBound, params))
+        {
+        SENSEI_ERROR("Failed to initialize ADIOS 2.")
+        return -1;
+        }
+
+      SENSEI_STATUS("Configured " << method << " reduction of "
+        << assocStr << " data array \"" << arrayName << "\" on mesh \""
+        << meshName << "\"")
+      }
+    }
+
   SENSEI_STATUS("Configured ADIOSAnalysisAdaptor filename=\""
-    << filename << "\" engine=" << engine
+    << filename << "\" engine=" << engine << " step_policy=" << stepPolicy
     << (!bufferMode.empty() ? "buffer_mode=" : "")
     << (!bufferMode.empty() ? bufferMode.c_str() : "")
     << (!bufferSize.empty() ? "buffer_size=" : "")
@@ -331,6 +434,32 @@ int ADIOS2AnalysisAdaptor::InitializeADIOS2()
   // create space for ADIOS2 variables
   this->Schema = new senseiADIOS2::DataObjectCollectionSchema;
 
+  // pass the array reductions to the schema. an operator is defined once
+  // and shared by all arrays that use it
+  unsigned int nReductions = this->Reductions.size();
+  for (unsigned int i = 0; i < nReductions; ++i)
+    {
+    ReductionSpec &spec = this->Reductions[i];
+
+    if (spec.Reduction.Method == senseiADIOS2::ArrayReduction::OPERATOR)
+      {
+      const char *opName = spec.Method.c_str();
+
+      adios2_operator *op = adios2_inquire_operator(this->Adios, opName);
+      if (!op && !(op = adios2_define_operator(this->Adios, opName, opName)))
+        {
+        SENSEI_ERROR("Failed to define the ADIOS2 \"" << spec.Method
+          << "\" operator. Check that ADIOS2 was built with it")
+        return -1;
+        }
+
+      spec.Reduction.Operator = op;
+      }
+
+    this->Schema->SetArrayReduction(spec.MeshName, spec.Association,
+      spec.ArrayName, spec.Reduction);
+    }
+
   // Open the engine
   if (adios2_set_engine(this->Handles.io, this->EngineName.c_str()))
     {
@@ -338,6 +467,23 @@ int ADIOS2AnalysisAdaptor::InitializeADIOS2()
     return -1;
     }
 
+  // discard steps rather than block when the queue is full. a short queue
+  // bounds the reader's lag. these come first so that user provided
+  // parameters take precedence
+  if (this->LatestOnly)
+    {
+    if (strcasecmp(this->EngineName.c_str(), "SST"))
+      {
+      SENSEI_WARNING("The latest step policy is not supported by the "
+        << this->EngineName << " engine. All steps will be written")
+      }
+    else
+      {
+      adios2_set_parameter(this->Handles.io, "QueueLimit", "1");
+      adios2_set_parameter(this->Handles.io, "QueueFullPolicy", "Discard");
+      }
+    }
+
   // If the user set additional parameters, add them now to ADIOS2
   for (unsigned int j = 0; j < this->Parameters.size(); j++)
     {
@@ -351,7 +497,8 @@ int ADIOS2AnalysisAdaptor::InitializeADIOS2()
 
 //----------------------------------------------------------------------------
 int ADIOS2AnalysisAdaptor::DefineVariables(
-  const std::vector<MeshMetadataPtr> &metadata)
+  const std::vector<MeshMetadataPtr> &metadata,
+  const std::vector<vtkCompositeDataSet*> &objects)
 {
   // On subsequent ts we need to clear the existing variables so we don't try to
   // redefine existing variables
@@ -365,7 +512,7 @@ int ADIOS2AnalysisAdaptor::DefineVariables(
 
   // (re)define variables to support meshes that evovle in time
   if (this->Schema->DefineVariables(this->GetCommunicator(),
-    this->Handles, metadata))
+    this->Handles, metadata, objects))
     {
     SENSEI_ERROR("Failed to define variables")
     return -1;
@@ -70,6 +70,15 @@ public:
   void SetDebugMode(int mode)
   { this->DebugMode = mode; }
 
+  /// @brief Never wait for the reader.
+  /// When set, steps are discarded rather than blocking the simulation when
+  /// the engine's queue is full. Used with a reader in latest only mode the
+  /// analysis lags the simulation by at most the queue length. Only the SST
+  /// engine supports this. Parameters passed with AddParameter take
+  /// precedence. Default value is 0
+  void SetLatestOnly(int val)
+  { this->LatestOnly = val; }
+
   /// data requirements tell the adaptor what to push
   /// if none are given then all data is pushed.
   int SetDataRequirements(const DataRequirements &reqs);
@@ -77,6 +86,17 @@ public:
   int AddDataRequirement(const std::string &meshName,
     int association, const std::vector<std::string> &arrays);
 
+  /// @brief Reduce an array before it is written.
+  /// The method is either quantize or the type of an ADIOS2 operator such as
+  /// zfp, sz, or blosc. quantize stores floating point values in the smallest
+  /// unsigned integer type that covers the array's range in steps of twice
+  /// the error bound. Operator parameters are passed in name value pairs.
+  /// The reader reconstructs the array transparently in both cases.
+  int AddArrayReduction(const std::string &meshName, int association,
+    const std::string &arrayName, const std::string &method,
+    double errorBound,
+    const std::vector<std::pair<std::string,std::string>> &parameters);
+
   // SENSEI AnalysisAdaptor API
   bool Execute(DataAdaptor* data) override;
   int Finalize() override;
@@ -89,7 +109,8 @@ protected:
   int InitializeADIOS2();
 
   // tells ADIOS what we will write
-  int DefineVariables(const std::vector<MeshMetadataPtr> &metadata);
+  int DefineVariables(const std::vector<MeshMetadataPtr> &metadata,
+    const std::vector<vtkCompositeDataSet*> &objects);
 
   // initializes the output stream, and in the case of writing
   // file series advances to the next file in the series.
@@ -108,14 +129,26 @@ protected:
     std::vector<vtkCompositeDataSet*> &objects,
     std::vector<MeshMetadataPtr> &metadata);
 
+  // an array and the reduction applied to it
+  struct ReductionSpec
+  {
+    std::string MeshName;
+    int Association;
+    std::string ArrayName;
+    std::string Method;
+    senseiADIOS2::ArrayReduction Reduction;
+  };
+
   senseiADIOS2::DataObjectCollectionSchema *Schema;
   sensei::DataRequirements Requirements;
+  std::vector<ReductionSpec> Reductions;
   std::string EngineName;
   std::string FileName;
   senseiADIOS2::AdiosHandle Handles;
   adios2_adios *Adios;
   std::vector<std::pair<std::string,std::string>> Parameters;
   int DebugMode;
+  int LatestOnly;
   long StepsPerFile;
   long StepIndex;
   long FileIndex;
@@ -1,7 +1,6 @@
 #include "ADIOS2DataAdaptor.h"
 #include "MeshMetadata.h"
 #include "Partitioner.h"
-#include "BlockPartitioner.h"
 #include "Error.h"
 #include "Profiler.h"
 #include "ADIOS2Schema.h"
@@ -62,6 +61,12 @@ void ADIOS2DataAdaptor::SetDebugMode(int mode)
   this->Internals->Stream.SetDebugMode(mode);
 }
 
+//----------------------------------------------------------------------------
+void ADIOS2DataAdaptor::SetLatestOnly(int val)
+{
+  this->Internals->Stream.SetLatestOnly(val);
+}
+
 //----------------------------------------------------------------------------
 void ADIOS2DataAdaptor::AddParameter(const std::string &name,
   const std::string &value)
@@ -98,6 +103,16 @@ int ADIOS2DataAdaptor::Initialize(pugi::xml_node &node)
 
   this->SetDebugMode(node.attribute("debug_mode").as_int(0));
 
+  // valid policies are all or latest
+  std::string stepPolicy = node.attribute("step_policy").as_string("all");
+  if ((stepPolicy != "all") && (stepPolicy != "latest"))
+    {
+    SENSEI_ERROR("Invalid step_policy \"" << stepPolicy
+      << "\". Use one of all or latest")
+    return -1;
+    }
+  this->SetLatestOnly(stepPolicy == "latest");
+
   pugi::xml_node params = node.child("engine_parameters");
   if (params)
     {
@@ -155,6 +170,10 @@ int ADIOS2DataAdaptor::CloseStream()
 {
   TimeEvent<128> mark("ADIOS2DataAdaptor::CloseStream");
 
+  unsigned long nDropped = this->Internals->Stream.GetDroppedSteps();
+  if (nDropped)
+    SENSEI_STATUS("Dropped " << nDropped << " steps in total")
+
   this->Internals->Stream.Close();
   this->Internals->Stream.Finalize();
 
@@ -255,34 +274,22 @@ int ADIOS2DataAdaptor::GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadat
     if (metadata)
        return 0;
 
-    // first time through. use the partitioner to figure it out.
-    // get the sender layout.
-    MeshMetadataPtr senderMd;
-    if (this->GetSenderMeshMetadata(id, senderMd))
+    // first time through this step. use the partitioner to lay out all of
+    // the meshes at once.
+    std::vector<MeshMetadataPtr> receiverMd;
+    if (this->PartitionMeshes(receiverMd) || (id >= receiverMd.size()))
       {
-      SENSEI_ERROR("Failed to get sender metadata")
+      SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
       this->CloseStream();
       return -1;
       }
 
-    // get the partitioner, default to the block partitioner
-    PartitionerPtr part = this->GetPartitioner();
-    if (!part)
-      {
-      SENSEI_WARNING("No partitoner specified, using BlockParititoner")
-      part = BlockPartitioner::New();
-      }
-
-    MeshMetadataPtr receiverMd;
-    if (part->GetPartition(this->GetCommunicator(), senderMd, receiverMd))
-      {
-      SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
-      this->CloseStream();
-      }
+    // cache and return the new layouts
+    unsigned int nMeshes = receiverMd.size();
+    for (unsigned int i = 0; i < nMeshes; ++i)
+      this->Internals->Schema.SetReceiverMeshMetadata(i, receiverMd[i]);
 
-    // cache and return the new layout
-    this->Internals->Schema.SetReceiverMeshMetadata(id, receiverMd);
-    metadata = receiverMd;
+    metadata = receiverMd[id];
     }
 
   return 0;
@@ -298,7 +305,8 @@ int ADIOS2DataAdaptor::GetMesh(const std::string &meshName,
 
   // other wise we need to read the mesh at the current time step
   if (this->Internals->Schema.ReadObject(this->GetCommunicator(),
-    this->Internals->Stream, meshName, mesh, structureOnly))
+    this->Internals->Stream, meshName, mesh, structureOnly,
+    this->GetMaxLevel(meshName)))
     {
     SENSEI_ERROR("Failed to read mesh \"" << meshName << "\"")
     return -1;
@@ -338,7 +346,8 @@ int ADIOS2DataAdaptor::AddArray(vtkDataObject* mesh,
     }
 
   if (this->Internals->Schema.ReadArray(this->GetCommunicator(),
-    this->Internals->Stream, meshName, association, arrayName, mesh))
+    this->Internals->Stream, meshName, association, arrayName, mesh,
+    this->GetMaxLevel(meshName)))
     {
     SENSEI_ERROR("Failed to read " << VTKUtils::GetAttributesName(association)
       << " data array \"" << arrayName << "\" from mesh \"" << meshName << "\"")
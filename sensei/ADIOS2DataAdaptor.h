@@ -33,6 +33,12 @@ public:
   // enable/disable adios internal debug messages
   void SetDebugMode(int mode);
 
+  // when set, skip to the newest step available rather than reading every
+  // step. the analysis falls behind by at most the writer's queue length.
+  // only the SST engine supports this. the number of steps that were never
+  // read is reported when the stream is closed and in the timer log.
+  void SetLatestOnly(int val);
+
   // add name value pairs to pass into ADIOS after the
   // engine has been created
   void AddParameter(const std::string &name, const std::string &value);
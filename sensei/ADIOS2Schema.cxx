@@ -23,6 +23,8 @@
 #include <vtkCharArray.h>
 #include <vtkUnsignedCharArray.h>
 #include <vtkIdTypeArray.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
 #include <vtkCellArray.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
@@ -43,6 +45,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkSmartPointer.h>
+#include <vtkVersionMacros.h>
 
 #include <mpi.h>
 #include <adios2_c.h>
@@ -52,8 +55,12 @@
 #include <set>
 #include <string>
 #include <functional>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 #include <sstream>
 #include <regex>
+#include <strings.h>
 
 namespace senseiADIOS2
 {
@@ -174,6 +181,12 @@ adios2_type adiosType(int vtkt)
     case VTK_UNSIGNED_CHAR:
       return adios2_type_uint8_t;
       break;
+    case VTK_SHORT:
+      return adios2_type_int16_t;
+      break;
+    case VTK_UNSIGNED_SHORT:
+      return adios2_type_uint16_t;
+      break;
     case VTK_INT:
       return adios2_type_int32_t;
       break;
@@ -226,6 +239,12 @@ unsigned int size(int vtkt)
     case VTK_UNSIGNED_CHAR:
       return sizeof(unsigned char);
       break;
+    case VTK_SHORT:
+      return sizeof(short);
+      break;
+    case VTK_UNSIGNED_SHORT:
+      return sizeof(unsigned short);
+      break;
     case VTK_INT:
       return sizeof(int);
       break;
@@ -541,6 +560,24 @@ int InputStream::Open()
     return -1;
     }
 
+  // have the engine hand us the newest step rather than the next one.
+  // this comes first so that user provided parameters take precedence
+  if (this->LatestOnly)
+    {
+    if (strcasecmp(this->ReadEngine.c_str(), "SST"))
+      {
+      SENSEI_WARNING("The latest step policy is not supported by the "
+        << this->ReadEngine << " engine. All steps will be read")
+      }
+    else if ((aerr = adios2_set_parameter(this->Handles.io,
+      "AlwaysProvideLatestTimestep", "true")))
+      {
+      SENSEI_ERROR("adios2_set_paramter AlwaysProvideLatestTimestep = true"
+        " failed. " << adios2_strerror(aerr))
+      return -1;
+      }
+    }
+
   // pass additional engine control parameters
   unsigned int nParms = this->Parameters.size();
   for (unsigned int j = 0; j < nParms; ++j)
@@ -618,6 +655,32 @@ int InputStream::BeginStep()
     return -1;
     }
 
+  // look for gaps in the writer's step numbers. these are steps discarded
+  // by the writer or skipped by the reader. step numbers start over in each
+  // file of a series so they are not tracked there.
+  size_t step = 0;
+  if (!this->FileSeries && !adios2_current_step(&step, this->Handles.engine))
+    {
+    if (this->HaveStep && (step > this->CurrentStep + 1))
+      {
+      unsigned long nDropped = step - this->CurrentStep - 1;
+      this->DroppedSteps += nDropped;
+
+      // record it in the timer log
+      char eventName[128];
+      snprintf(eventName, 128,
+        "senseiADIOS2::InputStream::DroppedSteps n=%lu", nDropped);
+      sensei::Profiler::StartEvent(eventName);
+      sensei::Profiler::EndEvent(eventName);
+
+      if (this->DebugMode)
+        SENSEI_STATUS("Dropped " << nDropped << " steps before step " << step)
+      }
+
+    this->CurrentStep = step;
+    this->HaveStep = 1;
+    }
+
   return 0;
 }
 
@@ -819,10 +882,12 @@ int BinaryStreamSchema::Write(AdiosHandle handles, const std::string &path,
 
 
 
+// revision 4 sends cells as offsets and connectivity, see CompactCellSchema.
+// streams of revision 3 are still read.
 class VersionSchema
 {
 public:
-  VersionSchema() : Revision(3), LowestCompatibleRevision(3) {}
+  VersionSchema() : Revision(4), LowestCompatibleRevision(3) {}
 
   int DefineVariables(AdiosHandle handles);
 
@@ -896,10 +961,125 @@ int VersionSchema::Read(InputStream &iStream)
 }
 
 
+// the transform applied to a data array on the write side. Type is the VTK
+// type of the stored values, or 0 if the array is stored as is. the values
+// are reconstructed as Offset + q*Step.
+struct Quantization
+{
+  Quantization() : Type(0), SourceType(0), Offset(0.0), Step(1.0) {}
+
+  int Type;
+  int SourceType;
+  double Offset;
+  double Step;
+};
+
+// --------------------------------------------------------------------------
+template <typename src_t, typename q_t>
+void quantize(const src_t *src, size_t n, double offset, double step,
+  q_t *q)
+{
+  double qMax = std::numeric_limits<q_t>::max();
+  for (size_t i = 0; i < n; ++i)
+    {
+    double v = std::floor((src[i] - offset)/step + 0.5);
+    v = v < 0.0 ? 0.0 : (v > qMax ? qMax : v);
+    q[i] = static_cast<q_t>(v);
+    }
+}
+
+// --------------------------------------------------------------------------
+template <typename src_t>
+int quantize(const Quantization &quant, const src_t *src, size_t n, void *q)
+{
+  switch (quant.Type)
+    {
+    case VTK_UNSIGNED_CHAR:
+      quantize(src, n, quant.Offset, quant.Step, static_cast<unsigned char*>(q));
+      break;
+    case VTK_UNSIGNED_SHORT:
+      quantize(src, n, quant.Offset, quant.Step, static_cast<unsigned short*>(q));
+      break;
+    case VTK_UNSIGNED_INT:
+      quantize(src, n, quant.Offset, quant.Step, static_cast<unsigned int*>(q));
+      break;
+    default:
+      SENSEI_ERROR("Invalid quantized type " << quant.Type)
+      return -1;
+    }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int quantize(const Quantization &quant, const void *src, size_t n, void *q)
+{
+  switch (quant.SourceType)
+    {
+    case VTK_FLOAT:
+      return quantize(quant, static_cast<const float*>(src), n, q);
+      break;
+    case VTK_DOUBLE:
+      return quantize(quant, static_cast<const double*>(src), n, q);
+      break;
+    }
+  SENSEI_ERROR("Invalid source type " << quant.SourceType)
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+template <typename q_t, typename dest_t>
+void dequantize(const q_t *q, size_t n, double offset, double step,
+  dest_t *dest)
+{
+  for (size_t i = 0; i < n; ++i)
+    dest[i] = static_cast<dest_t>(offset + q[i]*step);
+}
+
+// --------------------------------------------------------------------------
+template <typename dest_t>
+int dequantize(const Quantization &quant, const void *q, size_t n, dest_t *dest)
+{
+  switch (quant.Type)
+    {
+    case VTK_UNSIGNED_CHAR:
+      dequantize(static_cast<const unsigned char*>(q), n, quant.Offset, quant.Step, dest);
+      break;
+    case VTK_UNSIGNED_SHORT:
+      dequantize(static_cast<const unsigned short*>(q), n, quant.Offset, quant.Step, dest);
+      break;
+    case VTK_UNSIGNED_INT:
+      dequantize(static_cast<const unsigned int*>(q), n, quant.Offset, quant.Step, dest);
+      break;
+    default:
+      SENSEI_ERROR("Invalid quantized type " << quant.Type)
+      return -1;
+    }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int dequantize(const Quantization &quant, const void *q, size_t n,
+  vtkDataArray *da)
+{
+  switch (da->GetDataType())
+    {
+    case VTK_FLOAT:
+      return dequantize(quant, q, n, static_cast<float*>(da->GetVoidPointer(0)));
+      break;
+    case VTK_DOUBLE:
+      return dequantize(quant, q, n, static_cast<double*>(da->GetVoidPointer(0)));
+      break;
+    }
+  SENSEI_ERROR("Invalid destination type " << da->GetDataType())
+  return -1;
+}
+
+
 struct ArraySchema
 {
   int DefineVariables(MPI_Comm comm, AdiosHandle handles,
-    const std::string &ons, const sensei::MeshMetadataPtr &md);
+    const std::string &ons, const sensei::MeshMetadataPtr &md,
+    vtkCompositeDataSet *dobj);
 
   int DefineVariable(MPI_Comm comm, AdiosHandle handles, const std::string &ons,
     int i, int array_type, int num_components, int array_cen,
@@ -909,6 +1089,11 @@ struct ArraySchema
     const std::vector<int> &block_owner, std::vector<size_t> &putVarsStart,
     std::vector<size_t> &putVarsCount, adios2_variable *&putVar);
 
+  // find the global range of the arrays that are quantized and select the
+  // type that will hold the quantized values
+  int DefineQuantization(MPI_Comm comm, const sensei::MeshMetadataPtr &md,
+    vtkCompositeDataSet *dobj, std::vector<Quantization> &quant);
+
   int Write(MPI_Comm comm, AdiosHandle handles,
     const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
 
@@ -916,7 +1101,7 @@ struct ArraySchema
     const std::string &array_name, int array_cen, vtkCompositeDataSet *dobj,
     unsigned int num_blocks, const std::vector<int> &block_owner,
     const std::vector<size_t> &putVarsStart, const std::vector<size_t> &putVarsCount,
-    adios2_variable *putVar);
+    adios2_variable *putVar, const Quantization *quant = nullptr);
 
   int Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons,
     const std::string &array_name, int centering,
@@ -929,11 +1114,173 @@ struct ArraySchema
     const std::vector<long> &block_num_cells, const std::vector<int> &block_owner,
     vtkCompositeDataSet *dobj);
 
+  // read the transform applied by the writer, if any
+  int ReadQuantization(AdiosHandle handles, const std::string &ans,
+    Quantization &quant);
+
+  // set/get how an array is reduced before it is written
+  void SetArrayReduction(const std::string &mesh_name, int array_cen,
+    const std::string &array_name, const ArrayReduction &reduction);
+
+  const ArrayReduction *GetArrayReduction(const std::string &mesh_name,
+    int array_cen, const std::string &array_name) const;
+
+  static std::string GetReductionKey(const std::string &mesh_name,
+    int array_cen, const std::string &array_name)
+  {
+    return mesh_name + "/" + sensei::VTKUtils::GetAttributesName(array_cen)
+      + "/" + array_name;
+  }
+
   std::map<std::string,std::vector<size_t>> PutVarsStart;
   std::map<std::string,std::vector<size_t>> PutVarsCount;
   std::map<std::string,std::vector<adios2_variable*>> PutVars;
+  std::map<std::string,std::vector<adios2_variable*>> TransformVars;
+  std::map<std::string,std::vector<Quantization>> Quantizations;
+  std::map<std::string,ArrayReduction> Reductions;
 };
 
+// --------------------------------------------------------------------------
+void ArraySchema::SetArrayReduction(const std::string &mesh_name,
+  int array_cen, const std::string &array_name,
+  const ArrayReduction &reduction)
+{
+  this->Reductions[GetReductionKey(mesh_name, array_cen, array_name)] = reduction;
+}
+
+// --------------------------------------------------------------------------
+const ArrayReduction *ArraySchema::GetArrayReduction(
+  const std::string &mesh_name, int array_cen,
+  const std::string &array_name) const
+{
+  std::map<std::string,ArrayReduction>::const_iterator it =
+    this->Reductions.find(GetReductionKey(mesh_name, array_cen, array_name));
+
+  if ((it == this->Reductions.end()) ||
+    (it->second.Method == ArrayReduction::NONE))
+    return nullptr;
+
+  return &it->second;
+}
+
+// --------------------------------------------------------------------------
+int ArraySchema::DefineQuantization(MPI_Comm comm,
+  const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj,
+  std::vector<Quantization> &quant)
+{
+  sensei::TimeEvent<128> mark(
+    "senseiADIOS2::ArraySchema::DefineQuantization");
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  unsigned int num_arrays = md->NumArrays;
+  quant.assign(num_arrays, Quantization());
+
+  // find the arrays to quantize
+  std::vector<unsigned int> ids;
+  std::vector<double> error_bound;
+  for (unsigned int i = 0; i < num_arrays; ++i)
+    {
+    const ArrayReduction *red = this->GetArrayReduction(md->MeshName,
+      md->ArrayCentering[i], md->ArrayName[i]);
+
+    if (!red || (red->Method != ArrayReduction::QUANTIZE))
+      continue;
+
+    if (((md->ArrayType[i] != VTK_FLOAT) && (md->ArrayType[i] != VTK_DOUBLE))
+      || (red->ErrorBound <= 0.0))
+      {
+      if (rank == 0)
+        SENSEI_WARNING("Array \"" << md->ArrayName[i] << "\" is not quantized. "
+          "Quantization requires a floating point array and a positive error bound")
+      continue;
+      }
+
+    ids.push_back(i);
+    error_bound.push_back(red->ErrorBound);
+    }
+
+  unsigned int num_quant = ids.size();
+  if (num_quant == 0)
+    return 0;
+
+  // find the range over all components of the local blocks. the max is
+  // negated so that both are found in a single reduction
+  std::vector<double> range(2*num_quant, std::numeric_limits<double>::max());
+
+  vtkCompositeDataIterator *it = dobj->NewIterator();
+  for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
+    {
+    vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
+    if (!ds)
+      continue;
+
+    for (unsigned int k = 0; k < num_quant; ++k)
+      {
+      unsigned int i = ids[k];
+
+      vtkDataSetAttributes *dsa = md->ArrayCentering[i] == vtkDataObject::POINT ?
+        dynamic_cast<vtkDataSetAttributes*>(ds->GetPointData()) :
+        dynamic_cast<vtkDataSetAttributes*>(ds->GetCellData());
+
+      vtkDataArray *da = dsa->GetArray(md->ArrayName[i].c_str());
+      if (!da)
+        continue;
+
+      int nc = da->GetNumberOfComponents();
+      for (int c = 0; c < nc; ++c)
+        {
+        double rng[2];
+        da->GetRange(rng, c);
+        range[2*k] = std::min(range[2*k], rng[0]);
+        range[2*k+1] = std::min(range[2*k+1], -rng[1]);
+        }
+      }
+    }
+  it->Delete();
+
+  MPI_Allreduce(MPI_IN_PLACE, range.data(), 2*num_quant,
+    MPI_DOUBLE, MPI_MIN, comm);
+
+  // select the smallest type that holds the quantized range
+  for (unsigned int k = 0; k < num_quant; ++k)
+    {
+    unsigned int i = ids[k];
+
+    double lo = range[2*k];
+    double hi = -range[2*k+1];
+    if (lo > hi)
+      {
+      lo = 0.0;
+      hi = 0.0;
+      }
+
+    double step = 2.0*error_bound[k];
+    double levels = std::ceil((hi - lo)/step);
+
+    int type = levels <= std::numeric_limits<unsigned char>::max() ?
+      VTK_UNSIGNED_CHAR : (levels <= std::numeric_limits<unsigned short>::max() ?
+      VTK_UNSIGNED_SHORT : (levels <= std::numeric_limits<unsigned int>::max() ?
+      VTK_UNSIGNED_INT : 0));
+
+    if (!type || (size(type) >= size(md->ArrayType[i])))
+      {
+      if (rank == 0)
+        SENSEI_WARNING("Array \"" << md->ArrayName[i] << "\" is not quantized. "
+          "The error bound " << error_bound[k] << " is too small for the range ["
+          << lo << ", " << hi << "]")
+      continue;
+      }
+
+    quant[i].Type = type;
+    quant[i].SourceType = md->ArrayType[i];
+    quant[i].Offset = lo;
+    quant[i].Step = step;
+    }
+
+  return 0;
+}
 
 // --------------------------------------------------------------------------
 int ArraySchema::DefineVariable(MPI_Comm comm, AdiosHandle handles,
@@ -1016,7 +1363,8 @@ int ArraySchema::DefineVariable(MPI_Comm comm, AdiosHandle handles,
 
 // --------------------------------------------------------------------------
 int ArraySchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
-  const std::string &ons, const sensei::MeshMetadataPtr &md)
+  const std::string &ons, const sensei::MeshMetadataPtr &md,
+  vtkCompositeDataSet *dobj)
 {
   sensei::TimeEvent<128> mark(
     "senseiADIOS2::ArraySchema::DefineVariables");
@@ -1024,6 +1372,8 @@ int ArraySchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
   std::vector<size_t> &putVarsStart = this->PutVarsStart[md->MeshName];
   std::vector<size_t> &putVarsCount = this->PutVarsCount[md->MeshName];
   std::vector<adios2_variable*> &putVars = this->PutVars[md->MeshName];
+  std::vector<adios2_variable*> &transformVars = this->TransformVars[md->MeshName];
+  std::vector<Quantization> &quant = this->Quantizations[md->MeshName];
 
   // allocate write ids
   unsigned int num_blocks = md->NumBlocks;
@@ -1049,14 +1399,79 @@ int ArraySchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
     num_cells_total += md->BlockNumCells[j];
     }
 
+  // select the arrays that are quantized
+  if (this->DefineQuantization(comm, md, dobj, quant))
+    return -1;
+
+  transformVars.assign(num_arrays, nullptr);
+
   // define data arrays
   for (unsigned int i = 0; i < num_arrays; ++i)
     {
-    if (this->DefineVariable(comm, handles, ons, i, md->ArrayType[i],
+    // quantized arrays are stored in the quantized type
+    int array_type = quant[i].Type ? quant[i].Type : md->ArrayType[i];
+
+    if (this->DefineVariable(comm, handles, ons, i, array_type,
       md->ArrayComponents[i], md->ArrayCentering[i], num_points_total,
       num_cells_total, num_blocks, md->BlockNumPoints, md->BlockNumCells,
       md->BlockOwner, putVarsStart, putVarsCount, putVars[i]))
       return -1;
+
+    // the reader needs the offset and step to reconstruct the values
+    // /data_object_<id>/data_array_<id>/transform
+    if (quant[i].Type)
+      {
+      std::ostringstream tns;
+      tns << ons << "data_array_" << i << "/transform";
+
+      size_t shape = 3;
+      size_t start = 0;
+      size_t count = 3;
+
+      transformVars[i] = adios2_define_variable(handles.io,
+        tns.str().c_str(), adios2_type_double, 1, &shape, &start, &count,
+        adios2_constant_dims_true);
+
+      if (!transformVars[i])
+        {
+        SENSEI_ERROR("adios2_define_variable \"" << tns.str() << "\" failed")
+        return -1;
+        }
+      }
+
+    // attach the operator, the reader reconstructs transparently
+    const ArrayReduction *red = this->GetArrayReduction(md->MeshName,
+      md->ArrayCentering[i], md->ArrayName[i]);
+
+    if (red && (red->Method == ArrayReduction::OPERATOR))
+      {
+      std::string key = red->Parameters.empty() ? "" : red->Parameters[0].first;
+      std::string val = red->Parameters.empty() ? "" : red->Parameters[0].second;
+
+      size_t op_id = 0;
+      adios2_error aerr = adios2_error_none;
+      if ((aerr = adios2_add_operation(&op_id, putVars[i], red->Operator,
+        key.c_str(), val.c_str())))
+        {
+        SENSEI_ERROR("adios2_add_operation failed on array \""
+          << md->ArrayName[i] << "\". " << adios2_strerror(aerr))
+        return -1;
+        }
+
+      size_t num_params = red->Parameters.size();
+      for (size_t k = 1; k < num_params; ++k)
+        {
+        if ((aerr = adios2_set_operation_parameter(putVars[i], op_id,
+          red->Parameters[k].first.c_str(), red->Parameters[k].second.c_str())))
+          {
+          SENSEI_ERROR("adios2_set_operation_parameter "
+            << red->Parameters[k].first << "=" << red->Parameters[k].second
+            << " failed on array \"" << md->ArrayName[i] << "\". "
+            << adios2_strerror(aerr))
+          return -1;
+          }
+        }
+      }
     }
 
   // define ghost arrays
@@ -1077,18 +1492,11 @@ int ArraySchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
 }
 
 // --------------------------------------------------------------------------
-int ArraySchema::Write(MPI_Comm comm, AdiosHandle handles, unsigned int i,
-  const std::string &array_name, int array_cen, vtkCompositeDataSet *dobj,
-  unsigned int num_blocks, const std::vector<int> &block_owner,
-  const std::vector<size_t> &putVarsStart,
-  const std::vector<size_t> &putVarsCount,
-  adios2_variable *putVar)
+// gets the blocks owned by rank, the other entries are null
+int getLocalBlocks(int rank, vtkCompositeDataSet *dobj, unsigned int num_blocks,
+  const std::vector<int> &block_owner, std::vector<vtkDataSet*> &blocks)
 {
-  sensei::Profiler::StartEvent("senseiADIOS2::ArraySchema::Write");
-  long long numBytes = 0ll;
-
-  int rank = 0;
-  MPI_Comm_rank(comm, &rank);
+  blocks.assign(num_blocks, nullptr);
 
   vtkCompositeDataIterator *it = dobj->NewIterator();
   it->SetSkipEmptyNodes(0);
@@ -1098,53 +1506,104 @@ int ArraySchema::Write(MPI_Comm comm, AdiosHandle handles, unsigned int i,
     {
     if (block_owner[j] == rank)
       {
-      vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
-      if (!ds)
+      blocks[j] = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
+      if (!blocks[j])
         {
         SENSEI_ERROR("Failed to get block " << j)
+        it->Delete();
         return -1;
         }
+      }
+    it->GoToNextItem();
+    }
 
-      vtkDataSetAttributes *dsa = array_cen == vtkDataObject::POINT ?
-        dynamic_cast<vtkDataSetAttributes*>(ds->GetPointData()) :
-        dynamic_cast<vtkDataSetAttributes*>(ds->GetCellData());
+  it->Delete();
 
-      vtkDataArray *da = dsa->GetArray(array_name.c_str());
-      if (!da)
-        {
-        SENSEI_ERROR("Failed to get array \"" << array_name
-          << "\" block " << j << " array " << i)
-        return -1;
-        }
+  return 0;
+}
 
-      // select the spot in the global array that this block's
-      // data will land
-      size_t start = putVarsStart[i*num_blocks + j];
-      size_t count = putVarsCount[i*num_blocks + j];
-      if (adios2_set_selection(putVar, 1, &start, &count))
-        {
-        SENSEI_ERROR("adios2_set_selection start=" << start
-          << " count=" << count << " block " << j << " array "
-          << i << " failed")
-        return -1;
-        }
+// --------------------------------------------------------------------------
+int ArraySchema::Write(MPI_Comm comm, AdiosHandle handles, unsigned int i,
+  const std::string &array_name, int array_cen, vtkCompositeDataSet *dobj,
+  unsigned int num_blocks, const std::vector<int> &block_owner,
+  const std::vector<size_t> &putVarsStart,
+  const std::vector<size_t> &putVarsCount,
+  adios2_variable *putVar, const Quantization *quant)
+{
+  sensei::Profiler::StartEvent("senseiADIOS2::ArraySchema::Write");
+  long long numBytes = 0ll;
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  std::vector<vtkDataSet*> blocks;
+  if (getLocalBlocks(rank, dobj, num_blocks, block_owner, blocks))
+    return -1;
+
+  // blocks are laid out in block order, each run of consecutive local
+  // blocks is written from a single contiguous buffer
+  std::vector<sensei::VTKUtils::BlockRun> runs;
+  sensei::VTKUtils::GetLocalBlockRuns(rank, block_owner, runs);
+
+  sensei::VTKUtils::DataArraySerializer serializer(array_name, array_cen);
+  std::vector<unsigned char> staging;
+  std::vector<unsigned char> qstaging;
+
+  unsigned int num_runs = runs.size();
+  for (unsigned int r = 0; r < num_runs; ++r)
+    {
+    unsigned int first = runs[r].First;
+    unsigned int end = runs[r].End;
+
+    std::vector<vtkDataSet*> run(blocks.begin() + first, blocks.begin() + end);
+
+    const void *data = nullptr;
+    unsigned long long nBytes = 0;
+    if (sensei::VTKUtils::Serialize(run, serializer, staging, data, nBytes))
+      {
+      SENSEI_ERROR("Failed to serialize array \"" << array_name
+        << "\" blocks " << first << " to " << end - 1 << " array " << i)
+      return -1;
+      }
+
+    // select the spot in the global array that this run's data will land
+    size_t start = putVarsStart[i*num_blocks + first];
+    size_t count = 0;
+    for (unsigned int j = first; j < end; ++j)
+      count += putVarsCount[i*num_blocks + j];
 
-      // do the write
-      if (adios2_put(handles.engine, putVar,
-        da->GetVoidPointer(0), adios2_mode_sync))
+    // convert to the quantized type
+    if (quant && quant->Type)
+      {
+      qstaging.resize(count*size(quant->Type));
+      if (quantize(*quant, data, count, qstaging.data()))
         {
-        SENSEI_ERROR("adios2_put block " << j << " array "
-          << i << " failed")
+        SENSEI_ERROR("Failed to quantize array \"" << array_name
+          << "\" blocks " << first << " to " << end - 1 << " array " << i)
         return -1;
         }
+      data = qstaging.data();
+      nBytes = qstaging.size();
+      }
 
-      numBytes += count*size(da->GetDataType());
+    if (adios2_set_selection(putVar, 1, &start, &count))
+      {
+      SENSEI_ERROR("adios2_set_selection start=" << start
+        << " count=" << count << " blocks " << first << " to "
+        << end - 1 << " array " << i << " failed")
+      return -1;
       }
 
-    it->GoToNextItem();
-    }
+    // do the write
+    if (adios2_put(handles.engine, putVar, data, adios2_mode_sync))
+      {
+      SENSEI_ERROR("adios2_put blocks " << first << " to " << end - 1
+        << " array " << i << " failed")
+      return -1;
+      }
 
-  it->Delete();
+    numBytes += nBytes;
+    }
 
   sensei::Profiler::EndEvent("senseiADIOS2::ArraySchema::Write", numBytes);
   return 0;
@@ -1162,6 +1621,8 @@ int ArraySchema::Write(MPI_Comm comm, AdiosHandle handles,
   std::vector<size_t> &putVarsStart = this->PutVarsStart[md->MeshName];
   std::vector<size_t> &putVarsCount = this->PutVarsCount[md->MeshName];
   std::vector<adios2_variable*> &putVars = this->PutVars[md->MeshName];
+  std::vector<adios2_variable*> &transformVars = this->TransformVars[md->MeshName];
+  std::vector<Quantization> &quant = this->Quantizations[md->MeshName];
 
   // write data arrays
   unsigned int num_arrays = md->NumArrays;
@@ -1170,13 +1631,28 @@ int ArraySchema::Write(MPI_Comm comm, AdiosHandle handles,
   for (unsigned int i = 0; i < num_arrays; ++i)
     {
     if (this->Write(comm, handles, i, md->ArrayName[i], md->ArrayCentering[i],
-      dobj, md->NumBlocks, md->BlockOwner, putVarsStart, putVarsCount, putVars[i]))
+      dobj, md->NumBlocks, md->BlockOwner, putVarsStart, putVarsCount,
+      putVars[i], &quant[i]))
       return -1;
-    }
 
-  // write ghost arrays
-  if (have_ghost_cells && this->Write(comm, handles, num_arrays, "vtkGhostType",
-    vtkDataObject::CELL, dobj, md->NumBlocks, md->BlockOwner, putVarsStart,
+    // /data_object_<id>/data_array_<id>/transform
+    if ((rank == 0) && quant[i].Type)
+      {
+      double transform[3] = {double(quant[i].Type),
+        quant[i].Offset, quant[i].Step};
+
+      if (adios2_put(handles.engine, transformVars[i], transform,
+        adios2_mode_sync))
+        {
+        SENSEI_ERROR("adios2_put transform array " << i << " failed")
+        return -1;
+        }
+      }
+    }
+
+  // write ghost arrays
+  if (have_ghost_cells && this->Write(comm, handles, num_arrays, "vtkGhostType",
+    vtkDataObject::CELL, dobj, md->NumBlocks, md->BlockOwner, putVarsStart,
     putVarsCount, putVars[num_arrays]))
       return -1;
 
@@ -1207,6 +1683,13 @@ int ArraySchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons
   std::ostringstream ans;
   ans << ons << "data_array_" << i << "/";
 
+  // check if the writer quantized the array
+  Quantization quant;
+  if (this->ReadQuantization(handles, ans.str(), quant))
+    return -1;
+
+  std::vector<unsigned char> qstaging;
+
   vtkCompositeDataIterator *it = dobj->NewIterator();
   it->SetSkipEmptyNodes(0);
   it->InitTraversal();
@@ -1247,14 +1730,28 @@ int ArraySchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons
       array->SetName(array_name.c_str());
 
       // /data_object_<id>/data_array_<id>/data
-      if (adios2_get(handles.engine, vinfo, array->GetVoidPointer(0),
-        adios2_mode_sync))
+      void *dest = array->GetVoidPointer(0);
+      if (quant.Type)
+        {
+        qstaging.resize(num_elem_local*size(quant.Type));
+        dest = qstaging.data();
+        }
+
+      if (adios2_get(handles.engine, vinfo, dest, adios2_mode_sync))
         {
         SENSEI_ERROR("adios2_get \"" << array_name
           << "\" block " << j << " array " << i << " failed")
         return -1;
         }
 
+      // reconstruct the values
+      if (quant.Type && dequantize(quant, dest, num_elem_local, array))
+        {
+        SENSEI_ERROR("Failed to reconstruct quantized array \""
+          << array_name << "\" block " << j << " array " << i)
+        return -1;
+        }
+
       // pass to vtk
       vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
       if (!ds)
@@ -1270,7 +1767,7 @@ int ArraySchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons
       dsa->AddArray(array);
       array->Delete();
 
-      numBytes += num_elem_local*size(array_type);
+      numBytes += num_elem_local*size(quant.Type ? quant.Type : array_type);
       }
 
     // update the block offset
@@ -1286,6 +1783,41 @@ int ArraySchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int ArraySchema::ReadQuantization(AdiosHandle handles, const std::string &ans,
+  Quantization &quant)
+{
+  quant = Quantization();
+
+  // /data_object_<id>/data_array_<id>/transform
+  // when not present the array was written as is
+  std::string path = ans + "transform";
+  adios2_variable *vinfo = adios2_inquire_variable(handles.io, path.c_str());
+  if (!vinfo)
+    return 0;
+
+  size_t start = 0;
+  size_t count = 3;
+  if (adios2_set_selection(vinfo, 1, &start, &count))
+    {
+    SENSEI_ERROR("adios2_set_selection \"" << path << "\" failed")
+    return -1;
+    }
+
+  double transform[3] = {0.0};
+  if (adios2_get(handles.engine, vinfo, transform, adios2_mode_sync))
+    {
+    SENSEI_ERROR("adios2_get \"" << path << "\" failed")
+    return -1;
+    }
+
+  quant.Type = transform[0];
+  quant.Offset = transform[1];
+  quant.Step = transform[2];
+
+  return 0;
+}
+
 // --------------------------------------------------------------------------
 int ArraySchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons,
   const std::string &name, int centering, const sensei::MeshMetadataPtr &md,
@@ -1384,26 +1916,531 @@ int PointSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
       return -1;
       }
 
-    // save the id for subsequent write
-    this->PutVars[md->MeshName] = var;
+    // save the id for subsequent write
+    this->PutVars[md->MeshName] = var;
+
+    // calculate the starts and counts for each write
+    std::vector<size_t> &starts = this->Starts[md->MeshName];
+    std::vector<size_t> &counts = this->Counts[md->MeshName];
+
+    starts.resize(num_blocks);
+    counts.resize(num_blocks);
+
+    unsigned long long block_offset = 0;
+
+    for (unsigned int j = 0; j < num_blocks; ++j)
+      {
+      unsigned long long num_local = md->BlockNumPoints[j];
+
+      counts[j] = 3*num_local;
+      starts[j] = 3*block_offset;
+
+      block_offset += num_local;
+      }
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int PointSchema::Write(MPI_Comm comm, AdiosHandle handles,
+  const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj)
+{
+  if (sensei::VTKUtils::Unstructured(md) || sensei::VTKUtils::Structured(md)
+    || sensei::VTKUtils::Polydata(md))
+    {
+    sensei::Profiler::StartEvent("senseiADIOS2::PointSchema::Write");
+    long long numBytes = 0ll;
+
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    const std::vector<size_t> &starts = this->Starts[md->MeshName];
+    const std::vector<size_t> &counts = this->Counts[md->MeshName];
+    adios2_variable *putVar = this->PutVars[md->MeshName];
+
+    std::vector<vtkDataSet*> blocks;
+    if (getLocalBlocks(rank, dobj, md->NumBlocks, md->BlockOwner, blocks))
+      return -1;
+
+    // blocks are laid out in block order, each run of consecutive local
+    // blocks is written from a single contiguous buffer
+    std::vector<sensei::VTKUtils::BlockRun> runs;
+    sensei::VTKUtils::GetLocalBlockRuns(rank, md->BlockOwner, runs);
+
+    sensei::VTKUtils::PointsSerializer serializer;
+    std::vector<unsigned char> staging;
+
+    unsigned int num_runs = runs.size();
+    for (unsigned int r = 0; r < num_runs; ++r)
+      {
+      unsigned int first = runs[r].First;
+      unsigned int end = runs[r].End;
+
+      std::vector<vtkDataSet*> run(blocks.begin() + first, blocks.begin() + end);
+
+      // select the spot in the global array that this run's data will land
+      size_t start = starts[first];
+      size_t count = 0;
+      for (unsigned int j = first; j < end; ++j)
+        count += counts[j];
+
+      if (adios2_set_selection(putVar, 1, &start, &count))
+        {
+        SENSEI_ERROR("adios2_set_selection start=" << start
+          << " count=" << count << " blocks " << first << " to "
+          << end - 1 << " failed")
+        return -1;
+        }
+
+      const void *data = nullptr;
+      unsigned long long nBytes = 0;
+      if (sensei::VTKUtils::Serialize(run, serializer, staging, data, nBytes) ||
+        adios2_put(handles.engine, putVar, data, adios2_mode_sync))
+        {
+        SENSEI_ERROR("adios2_put \"" << md->MeshName
+          << "\" blocks " << first << " to " << end - 1 << " points failed")
+        return -1;
+        }
+
+      numBytes += nBytes;
+      }
+
+    sensei::Profiler::EndEvent("senseiADIOS2::PointSchema::Write", numBytes);
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int PointSchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons,
+  const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj)
+{
+  if (sensei::VTKUtils::Unstructured(md) || sensei::VTKUtils::Structured(md)
+    || sensei::VTKUtils::Polydata(md))
+    {
+    sensei::Profiler::StartEvent("senseiADIOS2::PointSchema::Read");
+    long long numBytes = 0ll;
+
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    vtkCompositeDataIterator *it = dobj->NewIterator();
+    it->SetSkipEmptyNodes(0);
+    it->InitTraversal();
+
+    // read local blocks
+    unsigned long long block_offset = 0;
+    unsigned int num_blocks = md->NumBlocks;
+    for (unsigned int j = 0; j < num_blocks; ++j)
+      {
+      // get the block size
+      unsigned long long num_local = md->BlockNumPoints[j];
+
+      // read local block
+      if (md->BlockOwner[j] ==  rank)
+        {
+        std::string path = ons + "points";
+        adios2_variable *vinfo = adios2_inquire_variable(handles.io, path.c_str());
+        if (!vinfo)
+          {
+          SENSEI_ERROR("ADIOS2 stream is missing \"" << path << "\"")
+          return -1;
+          }
+
+        size_t start = 3*block_offset;
+        size_t count = 3*num_local;
+        if (adios2_set_selection(vinfo, 1, &start, &count))
+          {
+          SENSEI_ERROR("adios2_set_selection points block " << j
+            << " start=" << start << " count=" << count << " failed")
+          return -1;
+          }
+
+        vtkDataArray *points = vtkDataArray::CreateDataArray(md->CoordinateType);
+        points->SetNumberOfComponents(3);
+        points->SetNumberOfTuples(num_local);
+        points->SetName("points");
+
+        adios2_error getErr = adios2_get(handles.engine,
+          vinfo, points->GetVoidPointer(0), adios2_mode_sync);
+
+        if (getErr != 0)
+          {
+          SENSEI_ERROR("adios2_get points "
+            << " block " << j <<  " failed. " << getErr)
+          return -1;
+          }
+
+        // pass into vtk
+        vtkPoints *pts = vtkPoints::New();
+        pts->SetData(points);
+        points->Delete();
+
+        vtkPointSet *ds = dynamic_cast<vtkPointSet*>(it->GetCurrentDataObject());
+        if (!ds)
+          {
+          SENSEI_ERROR("Failed to get block " << j)
+          return -1;
+          }
+
+        ds->SetPoints(pts);
+        pts->Delete();
+
+        numBytes += count*size(md->CoordinateType);
+        }
+
+      // update the block offset
+      block_offset += num_local;
+
+      // next block
+      it->GoToNextItem();
+      }
+
+    it->Delete();
+
+    sensei::Profiler::EndEvent("senseiADIOS2::PointSchema::Read", numBytes);
+    }
+
+  return 0;
+}
+
+
+
+#if VTK_MAJOR_VERSION >= 9
+// revision 4 of the schema sends cells as VTK's offsets and connectivity
+// arrays rather than the legacy count prefixed cell array. the index type is
+// 32 bit when the point ids and offsets of every block fit and 64 bit
+// otherwise, both match VTK's own storage so the reader passes the arrays to
+// vtkCellArray without conversion. the cells of a block are split into
+// sections, unstructured grids have one and polydata four, verts, lines,
+// polys, and strips. a section whose cells all have the same number of
+// points is sent without offsets, and an unstructured block whose cells all
+// have the same type is sent without cell types. the sections are described
+// by /data_object_<id>/cell_sections, which holds for each section the
+// number of cells, the connectivity size, the cell size (0 when cells differ
+// in size), and the cell type (0 when cells differ in type).
+struct CompactCellSchema
+{
+  enum {NUM_CELLS=0, CONN_SIZE=1, CELL_SIZE=2, CELL_TYPE=3, SECTION_SIZE=4};
+
+  int DefineVariables(MPI_Comm comm, AdiosHandle handles,
+    const std::string &ons, const sensei::MeshMetadataPtr &md,
+    vtkCompositeDataSet *dobj);
+
+  int Write(MPI_Comm comm, AdiosHandle handles,
+    const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
+
+  int Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons,
+    const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
+
+  // the start of each section's types, offsets and connectivity in the
+  // global arrays. returns the global size of each array in the last
+  // element.
+  static void GetStarts(const std::vector<uint64_t> &info,
+    std::vector<size_t> &typeStarts, std::vector<size_t> &offsStarts,
+    std::vector<size_t> &connStarts);
+
+  // get the cell arrays of a block, polydata always has 4
+  static int GetSections(vtkDataObject *dobj, std::vector<vtkCellArray*> &secs);
+
+  static unsigned int GetNumberOfSections(const sensei::MeshMetadataPtr &md)
+  { return sensei::VTKUtils::Polydata(md) ? 4 : 1; }
+
+  struct MeshVariables
+  {
+    MeshVariables() : Sections(nullptr), Types(nullptr), Offsets(nullptr),
+      Connectivity(nullptr), IndexType(adios2_type_int32_t) {}
+
+    adios2_variable *Sections;
+    adios2_variable *Types;
+    adios2_variable *Offsets;
+    adios2_variable *Connectivity;
+    adios2_type IndexType;
+    std::vector<uint64_t> Info;
+    std::vector<size_t> TypeStarts;
+    std::vector<size_t> OffsetStarts;
+    std::vector<size_t> ConnStarts;
+  };
+
+  std::map<std::string, MeshVariables> Variables;
+};
+
+// --------------------------------------------------------------------------
+// gets a pointer to the offsets or connectivity in the stream's index type.
+// the values are converted only when VTK stores them in the other type.
+const void *getIndices(vtkDataArray *da, adios2_type indexType,
+  std::vector<unsigned char> &staging)
+{
+  bool stream64 = indexType == adios2_type_int64_t;
+  bool data64 = da->GetDataTypeSize() == sizeof(int64_t);
+
+  if (stream64 == data64)
+    return da->GetVoidPointer(0);
+
+  size_t n = da->GetNumberOfTuples();
+  if (stream64)
+    {
+    staging.resize(n*sizeof(int64_t));
+    const int32_t *src = static_cast<const int32_t*>(da->GetVoidPointer(0));
+    std::copy(src, src + n, reinterpret_cast<int64_t*>(staging.data()));
+    }
+  else
+    {
+    staging.resize(n*sizeof(int32_t));
+    const int64_t *src = static_cast<const int64_t*>(da->GetVoidPointer(0));
+    std::copy(src, src + n, reinterpret_cast<int32_t*>(staging.data()));
+    }
+
+  return staging.data();
+}
+
+// --------------------------------------------------------------------------
+vtkDataArray *newIndexArray(adios2_type indexType, size_t n)
+{
+  vtkDataArray *da = nullptr;
+  if (indexType == adios2_type_int64_t)
+    da = vtkTypeInt64Array::New();
+  else
+    da = vtkTypeInt32Array::New();
+
+  da->SetNumberOfTuples(n);
+  return da;
+}
+
+// --------------------------------------------------------------------------
+int adiosPut(AdiosHandle handles, adios2_variable *var, size_t start,
+  size_t count, const void *data)
+{
+  if (adios2_set_selection(var, 1, &start, &count) ||
+    adios2_put(handles.engine, var, data, adios2_mode_sync))
+    {
+    SENSEI_ERROR("adios2_put start=" << start << " count=" << count
+      << " failed")
+    return -1;
+    }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int adiosGet(AdiosHandle handles, const std::string &path, size_t start,
+  size_t count, void *data)
+{
+  adios2_variable *var = adios2_inquire_variable(handles.io, path.c_str());
+  if (!var)
+    {
+    SENSEI_ERROR("ADIOS2 stream is missing \"" << path << "\"")
+    return -1;
+    }
+
+  if (adios2_set_selection(var, 1, &start, &count) ||
+    adios2_get(handles.engine, var, data, adios2_mode_sync))
+    {
+    SENSEI_ERROR("adios2_get \"" << path << "\" start=" << start
+      << " count=" << count << " failed")
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int CompactCellSchema::GetSections(vtkDataObject *dobj,
+  std::vector<vtkCellArray*> &secs)
+{
+  secs.clear();
+  if (vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(dobj))
+    {
+    secs.push_back(ug->GetCells());
+    }
+  else if (vtkPolyData *pd = dynamic_cast<vtkPolyData*>(dobj))
+    {
+    secs.push_back(pd->GetVerts());
+    secs.push_back(pd->GetLines());
+    secs.push_back(pd->GetPolys());
+    secs.push_back(pd->GetStrips());
+    }
+  else
+    {
+    SENSEI_ERROR("Invalid dataset type "
+      << (dobj ? dobj->GetClassName() : "nullptr"))
+    return -1;
+    }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void CompactCellSchema::GetStarts(const std::vector<uint64_t> &info,
+  std::vector<size_t> &typeStarts, std::vector<size_t> &offsStarts,
+  std::vector<size_t> &connStarts)
+{
+  size_t nSecs = info.size()/SECTION_SIZE;
+
+  typeStarts.resize(nSecs + 1);
+  offsStarts.resize(nSecs + 1);
+  connStarts.resize(nSecs + 1);
+
+  typeStarts[0] = 0;
+  offsStarts[0] = 0;
+  connStarts[0] = 0;
+
+  for (size_t i = 0; i < nSecs; ++i)
+    {
+    const uint64_t *sec = info.data() + i*SECTION_SIZE;
+
+    typeStarts[i+1] = typeStarts[i] +
+      ((sec[NUM_CELLS] && !sec[CELL_TYPE]) ? sec[NUM_CELLS] : 0);
+
+    offsStarts[i+1] = offsStarts[i] +
+      ((sec[NUM_CELLS] && !sec[CELL_SIZE]) ? sec[NUM_CELLS] + 1 : 0);
+
+    connStarts[i+1] = connStarts[i] + sec[CONN_SIZE];
+    }
+}
+
+// --------------------------------------------------------------------------
+int CompactCellSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
+  const std::string &ons, const sensei::MeshMetadataPtr &md,
+  vtkCompositeDataSet *dobj)
+{
+  sensei::TimeEvent<128> mark("senseiADIOS2::CompactCellSchema::DefineVariables");
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  MeshVariables &vars = this->Variables[md->MeshName];
+
+  // describe the local blocks' sections. the last value flags the need for
+  // 64 bit indices
+  unsigned int numBlocks = md->NumBlocks;
+  unsigned int numSecs = GetNumberOfSections(md);
+  unsigned long nInfo = numBlocks*numSecs*SECTION_SIZE;
+
+  std::vector<uint64_t> info(nInfo + 1, 0);
+
+  vtkCompositeDataIterator *it = dobj->NewIterator();
+  it->SetSkipEmptyNodes(0);
+  it->InitTraversal();
+
+  std::vector<vtkCellArray*> secs;
+  for (unsigned int j = 0; j < numBlocks; ++j)
+    {
+    if (md->BlockOwner[j] == rank)
+      {
+      vtkDataObject *bobj = it->GetCurrentDataObject();
+      if (GetSections(bobj, secs))
+        {
+        SENSEI_ERROR("Failed to get the cells of block " << j)
+        it->Delete();
+        return -1;
+        }
+
+      vtkDataSet *ds = static_cast<vtkDataSet*>(bobj);
+      if (ds->GetNumberOfPoints() > std::numeric_limits<int32_t>::max())
+        info[nInfo] = 1;
+
+      for (unsigned int s = 0; s < numSecs; ++s)
+        {
+        vtkCellArray *ca = secs[s];
+        uint64_t *sec = info.data() + (j*numSecs + s)*SECTION_SIZE;
+
+        vtkIdType nCells = ca ? ca->GetNumberOfCells() : 0;
+        if (nCells < 1)
+          continue;
+
+        vtkIdType nConn = ca->GetNumberOfConnectivityIds();
+        vtkIdType cellSize = ca->IsHomogeneous();
+
+        sec[NUM_CELLS] = nCells;
+        sec[CONN_SIZE] = nConn;
+        sec[CELL_SIZE] = cellSize > 0 ? cellSize : 0;
+
+        if (nConn > std::numeric_limits<int32_t>::max())
+          info[nInfo] = 1;
+
+        // a single cell type lets the reader skip the cell types. the type
+        // of polydata cells is implied by the section
+        if (vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(ds))
+          {
+          const unsigned char *types = ug->GetCellTypesArray()->GetPointer(0);
+          unsigned char type = types[0];
+          if (std::all_of(types, types + nCells,
+            [type](unsigned char t) -> bool { return t == type; }))
+            sec[CELL_TYPE] = type;
+          }
+        else
+          {
+          const int pdTypes[] = {VTK_VERTEX, VTK_LINE, VTK_POLYGON,
+            VTK_TRIANGLE_STRIP};
+          sec[CELL_TYPE] = pdTypes[s];
+          }
+        }
+      }
+    it->GoToNextItem();
+    }
+
+  it->Delete();
+
+  // each block has a single owner, the max gives everyone the layout
+  MPI_Allreduce(MPI_IN_PLACE, info.data(), nInfo + 1,
+    MPI_UINT64_T, MPI_MAX, comm);
 
-    // calculate the starts and counts for each write
-    std::vector<size_t> &starts = this->Starts[md->MeshName];
-    std::vector<size_t> &counts = this->Counts[md->MeshName];
+  vars.IndexType = info[nInfo] ? adios2_type_int64_t : adios2_type_int32_t;
 
-    starts.resize(num_blocks);
-    counts.resize(num_blocks);
+  info.resize(nInfo);
+  vars.Info.swap(info);
 
-    unsigned long long block_offset = 0;
+  GetStarts(vars.Info, vars.TypeStarts, vars.OffsetStarts, vars.ConnStarts);
 
-    for (unsigned int j = 0; j < num_blocks; ++j)
+  size_t start = 0;
+  size_t count = 0;
+
+  // /data_object_<id>/cell_sections
+  std::string path = ons + "cell_sections";
+  size_t gdims = nInfo;
+  if (!(vars.Sections = adios2_define_variable(handles.io, path.c_str(),
+    adios2_type_uint64_t, 1, &gdims, &start, &count, adios2_constant_dims_false)))
+    {
+    SENSEI_ERROR("adios2_define_variable \"" << path << "\" failed")
+    return -1;
+    }
+
+  // /data_object_<id>/cell_types, only for blocks of mixed cell types
+  vars.Types = nullptr;
+  if ((gdims = vars.TypeStarts.back()))
+    {
+    path = ons + "cell_types";
+    if (!(vars.Types = adios2_define_variable(handles.io, path.c_str(),
+      adios2_type_uint8_t, 1, &gdims, &start, &count, adios2_constant_dims_false)))
       {
-      unsigned long long num_local = md->BlockNumPoints[j];
+      SENSEI_ERROR("adios2_define_variable \"" << path << "\" failed")
+      return -1;
+      }
+    }
 
-      counts[j] = 3*num_local;
-      starts[j] = 3*block_offset;
+  // /data_object_<id>/cell_offsets, only for cells of mixed size
+  vars.Offsets = nullptr;
+  if ((gdims = vars.OffsetStarts.back()))
+    {
+    path = ons + "cell_offsets";
+    if (!(vars.Offsets = adios2_define_variable(handles.io, path.c_str(),
+      vars.IndexType, 1, &gdims, &start, &count, adios2_constant_dims_false)))
+      {
+      SENSEI_ERROR("adios2_define_variable \"" << path << "\" failed")
+      return -1;
+      }
+    }
 
-      block_offset += num_local;
+  // /data_object_<id>/cell_connectivity
+  vars.Connectivity = nullptr;
+  if ((gdims = vars.ConnStarts.back()))
+    {
+    path = ons + "cell_connectivity";
+    if (!(vars.Connectivity = adios2_define_variable(handles.io, path.c_str(),
+      vars.IndexType, 1, &gdims, &start, &count, adios2_constant_dims_false)))
+      {
+      SENSEI_ERROR("adios2_define_variable \"" << path << "\" failed")
+      return -1;
       }
     }
 
@@ -1411,170 +2448,266 @@ int PointSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
 }
 
 // --------------------------------------------------------------------------
-int PointSchema::Write(MPI_Comm comm, AdiosHandle handles,
+int CompactCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
   const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj)
 {
-  if (sensei::VTKUtils::Unstructured(md) || sensei::VTKUtils::Structured(md)
-    || sensei::VTKUtils::Polydata(md))
+  sensei::Profiler::StartEvent("senseiADIOS2::CompactCellSchema::Write");
+  long long numBytes = 0ll;
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  MeshVariables &vars = this->Variables[md->MeshName];
+
+  // the layout is known everywhere, one rank writes it
+  if ((rank == 0) && adiosPut(handles, vars.Sections, 0,
+    vars.Info.size(), vars.Info.data()))
     {
-    sensei::Profiler::StartEvent("senseiADIOS2::PointSchema::Write");
-    long long numBytes = 0ll;
+    SENSEI_ERROR("Failed to write the cell sections of mesh \""
+      << md->MeshName << "\"")
+    return -1;
+    }
 
-    int rank = 0;
-    MPI_Comm_rank(comm, &rank);
+  size_t indexSize = vars.IndexType == adios2_type_int64_t ?
+    sizeof(int64_t) : sizeof(int32_t);
 
-    const std::vector<size_t> &starts = this->Starts[md->MeshName];
-    const std::vector<size_t> &counts = this->Counts[md->MeshName];
-    adios2_variable *putVar = this->PutVars[md->MeshName];
+  std::vector<unsigned char> staging;
+  std::vector<vtkCellArray*> secs;
 
-    vtkCompositeDataIterator *it = dobj->NewIterator();
-    it->SetSkipEmptyNodes(0);
-    it->InitTraversal();
+  vtkCompositeDataIterator *it = dobj->NewIterator();
+  it->SetSkipEmptyNodes(0);
+  it->InitTraversal();
 
-    unsigned int num_blocks = md->NumBlocks;
-    for (unsigned int j = 0; j < num_blocks; ++j)
+  unsigned int numBlocks = md->NumBlocks;
+  unsigned int numSecs = GetNumberOfSections(md);
+  for (unsigned int j = 0; j < numBlocks; ++j)
+    {
+    if (md->BlockOwner[j] == rank)
       {
-      if (md->BlockOwner[j] == rank)
+      vtkDataObject *bobj = it->GetCurrentDataObject();
+      if (GetSections(bobj, secs))
         {
-        vtkPointSet *ds = dynamic_cast<vtkPointSet*>(it->GetCurrentDataObject());
-        if (!ds)
+        SENSEI_ERROR("Failed to get the cells of block " << j)
+        it->Delete();
+        return -1;
+        }
+
+      for (unsigned int s = 0; s < numSecs; ++s)
+        {
+        unsigned int i = j*numSecs + s;
+        const uint64_t *sec = vars.Info.data() + i*SECTION_SIZE;
+
+        if (!sec[NUM_CELLS])
+          continue;
+
+        vtkCellArray *ca = secs[s];
+
+        if (!sec[CELL_TYPE])
           {
-          SENSEI_ERROR("Failed to get block " << j)
-          return -1;
+          vtkUnstructuredGrid *ug = static_cast<vtkUnstructuredGrid*>(bobj);
+          if (adiosPut(handles, vars.Types, vars.TypeStarts[i],
+            sec[NUM_CELLS], ug->GetCellTypesArray()->GetPointer(0)))
+            {
+            SENSEI_ERROR("Failed to write cell types of block " << j)
+            it->Delete();
+            return -1;
+            }
+          numBytes += sec[NUM_CELLS];
           }
 
-        // select the spot in the global array that this block's
-        // data will land
-        size_t start = starts[j];
-        size_t count = counts[j];
-        if (adios2_set_selection(putVar, 1, &start, &count))
+        if (!sec[CELL_SIZE])
           {
-          SENSEI_ERROR("adios2_set_selection start=" << start
-            << " count=" << count << " block " << j << " failed")
-          return -1;
+          if (adiosPut(handles, vars.Offsets, vars.OffsetStarts[i],
+            sec[NUM_CELLS] + 1, getIndices(ca->GetOffsetsArray(),
+            vars.IndexType, staging)))
+            {
+            SENSEI_ERROR("Failed to write cell offsets of block " << j)
+            it->Delete();
+            return -1;
+            }
+          numBytes += (sec[NUM_CELLS] + 1)*indexSize;
           }
 
-        vtkDataArray *da = ds->GetPoints()->GetData();
-        if (adios2_put(handles.engine, putVar,
-          da->GetVoidPointer(0), adios2_mode_sync))
+        if (sec[CONN_SIZE] && adiosPut(handles, vars.Connectivity,
+          vars.ConnStarts[i], sec[CONN_SIZE],
+          getIndices(ca->GetConnectivityArray(), vars.IndexType, staging)))
           {
-          SENSEI_ERROR("adios2_put \"" << md->MeshName
-            << "\" block " << j << " points failed")
+          SENSEI_ERROR("Failed to write cell connectivity of block " << j)
+          it->Delete();
           return -1;
           }
-
-        numBytes += count*size(da->GetDataType());
+        numBytes += sec[CONN_SIZE]*indexSize;
         }
-
-      it->GoToNextItem();
       }
-    it->Delete();
-
-    sensei::Profiler::EndEvent("senseiADIOS2::PointSchema::Write", numBytes);
+    it->GoToNextItem();
     }
 
+  it->Delete();
+
+  sensei::Profiler::EndEvent("senseiADIOS2::CompactCellSchema::Write",
+    numBytes);
+
   return 0;
 }
 
 // --------------------------------------------------------------------------
-int PointSchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons,
-  const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj)
+int CompactCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
+  const std::string &ons, const sensei::MeshMetadataPtr &md,
+  vtkCompositeDataSet *dobj)
 {
-  if (sensei::VTKUtils::Unstructured(md) || sensei::VTKUtils::Structured(md)
-    || sensei::VTKUtils::Polydata(md))
+  sensei::Profiler::StartEvent("senseiADIOS2::CompactCellSchema::Read");
+  long long numBytes = 0ll;
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  unsigned int numBlocks = md->NumBlocks;
+  unsigned int numSecs = GetNumberOfSections(md);
+
+  // get the layout
+  std::vector<uint64_t> info(numBlocks*numSecs*SECTION_SIZE);
+  if (adiosGet(handles, ons + "cell_sections", 0, info.size(), info.data()))
     {
-    sensei::Profiler::StartEvent("senseiADIOS2::PointSchema::Read");
-    long long numBytes = 0ll;
+    SENSEI_ERROR("Failed to read the cell sections of mesh \""
+      << md->MeshName << "\"")
+    return -1;
+    }
 
-    int rank = 0;
-    MPI_Comm_rank(comm, &rank);
+  std::vector<size_t> typeStarts;
+  std::vector<size_t> offsStarts;
+  std::vector<size_t> connStarts;
+  GetStarts(info, typeStarts, offsStarts, connStarts);
 
-    vtkCompositeDataIterator *it = dobj->NewIterator();
-    it->SetSkipEmptyNodes(0);
-    it->InitTraversal();
+  // the index type is whatever the writer chose
+  adios2_type indexType = adios2_type_int32_t;
+  std::string connPath = ons + "cell_connectivity";
+  if (adios2_variable *var = adios2_inquire_variable(handles.io, connPath.c_str()))
+    adios2_variable_type(&indexType, var);
 
-    // read local blocks
-    unsigned long long block_offset = 0;
-    unsigned int num_blocks = md->NumBlocks;
-    for (unsigned int j = 0; j < num_blocks; ++j)
-      {
-      // get the block size
-      unsigned long long num_local = md->BlockNumPoints[j];
+  size_t indexSize = indexType == adios2_type_int64_t ?
+    sizeof(int64_t) : sizeof(int32_t);
 
-      // read local block
-      if (md->BlockOwner[j] ==  rank)
-        {
-        std::string path = ons + "points";
-        adios2_variable *vinfo = adios2_inquire_variable(handles.io, path.c_str());
-        if (!vinfo)
-          {
-          SENSEI_ERROR("ADIOS2 stream is missing \"" << path << "\"")
-          return -1;
-          }
+  vtkCompositeDataIterator *it = dobj->NewIterator();
+  it->SetSkipEmptyNodes(0);
+  it->InitTraversal();
 
-        size_t start = 3*block_offset;
-        size_t count = 3*num_local;
-        if (adios2_set_selection(vinfo, 1, &start, &count))
-          {
-          SENSEI_ERROR("adios2_set_selection points block " << j
-            << " start=" << start << " count=" << count << " failed")
-          return -1;
-          }
+  for (unsigned int j = 0; j < numBlocks; ++j)
+    {
+    if (md->BlockOwner[j] == rank)
+      {
+      vtkDataObject *bobj = it->GetCurrentDataObject();
+      vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(bobj);
+      vtkPolyData *pd = dynamic_cast<vtkPolyData*>(bobj);
+      if (!ug && !pd)
+        {
+        SENSEI_ERROR("Failed to get block " << j)
+        it->Delete();
+        return -1;
+        }
 
-        vtkDataArray *points = vtkDataArray::CreateDataArray(md->CoordinateType);
-        points->SetNumberOfComponents(3);
-        points->SetNumberOfTuples(num_local);
-        points->SetName("points");
+      for (unsigned int s = 0; s < numSecs; ++s)
+        {
+        unsigned int i = j*numSecs + s;
+        const uint64_t *sec = info.data() + i*SECTION_SIZE;
 
-        adios2_error getErr = adios2_get(handles.engine,
-          vinfo, points->GetVoidPointer(0), adios2_mode_sync);
+        vtkCellArray *ca = vtkCellArray::New();
+        vtkUnsignedCharArray *types = nullptr;
 
-        if (getErr != 0)
+        if (sec[NUM_CELLS])
           {
-          SENSEI_ERROR("adios2_get points "
-            << " block " << j <<  " failed. " << getErr)
-          return -1;
+          // the arrays are read in VTK's storage type and handed over as is
+          vtkDataArray *conn = newIndexArray(indexType, sec[CONN_SIZE]);
+          if (sec[CONN_SIZE] && adiosGet(handles, connPath,
+            connStarts[i], sec[CONN_SIZE], conn->GetVoidPointer(0)))
+            {
+            SENSEI_ERROR("Failed to read the connectivity of block " << j)
+            conn->Delete();
+            ca->Delete();
+            it->Delete();
+            return -1;
+            }
+          numBytes += sec[CONN_SIZE]*indexSize;
+
+          if (sec[CELL_SIZE])
+            {
+            ca->SetData(sec[CELL_SIZE], conn);
+            }
+          else
+            {
+            vtkDataArray *offs = newIndexArray(indexType, sec[NUM_CELLS] + 1);
+            if (adiosGet(handles, ons + "cell_offsets", offsStarts[i],
+              sec[NUM_CELLS] + 1, offs->GetVoidPointer(0)))
+              {
+              SENSEI_ERROR("Failed to read the offsets of block " << j)
+              offs->Delete();
+              conn->Delete();
+              ca->Delete();
+              it->Delete();
+              return -1;
+              }
+            numBytes += (sec[NUM_CELLS] + 1)*indexSize;
+
+            ca->SetData(offs, conn);
+            offs->Delete();
+            }
+          conn->Delete();
+
+          if (ug && !sec[CELL_TYPE])
+            {
+            types = vtkUnsignedCharArray::New();
+            types->SetNumberOfTuples(sec[NUM_CELLS]);
+            if (adiosGet(handles, ons + "cell_types", typeStarts[i],
+              sec[NUM_CELLS], types->GetVoidPointer(0)))
+              {
+              SENSEI_ERROR("Failed to read the cell types of block " << j)
+              types->Delete();
+              ca->Delete();
+              it->Delete();
+              return -1;
+              }
+            numBytes += sec[NUM_CELLS];
+            }
           }
 
-        // pass into vtk
-        vtkPoints *pts = vtkPoints::New();
-        pts->SetData(points);
-        points->Delete();
-
-        vtkPointSet *ds = dynamic_cast<vtkPointSet*>(it->GetCurrentDataObject());
-        if (!ds)
+        if (ug)
           {
-          SENSEI_ERROR("Failed to get block " << j)
-          return -1;
+          if (types)
+            ug->SetCells(types, ca);
+          else
+            ug->SetCells(sec[CELL_TYPE] ? int(sec[CELL_TYPE]) : VTK_EMPTY_CELL, ca);
           }
-
-        ds->SetPoints(pts);
-        pts->Delete();
-
-        numBytes += count*size(md->CoordinateType);
+        else if (s == 0)
+          pd->SetVerts(ca);
+        else if (s == 1)
+          pd->SetLines(ca);
+        else if (s == 2)
+          pd->SetPolys(ca);
+        else
+          pd->SetStrips(ca);
+
+        if (types)
+          types->Delete();
+        ca->Delete();
         }
-
-      // update the block offset
-      block_offset += num_local;
-
-      // next block
-      it->GoToNextItem();
       }
+    it->GoToNextItem();
+    }
 
-    it->Delete();
+  it->Delete();
 
-    sensei::Profiler::EndEvent("senseiADIOS2::PointSchema::Read", numBytes);
-    }
+  sensei::Profiler::EndEvent("senseiADIOS2::CompactCellSchema::Read", numBytes);
 
   return 0;
 }
+#endif
 
 
 
 struct UnstructuredCellSchema
 {
   int DefineVariables(MPI_Comm comm, AdiosHandle handles,
-    const std::string &ons, const sensei::MeshMetadataPtr &md);
+    const std::string &ons, const sensei::MeshMetadataPtr &md,
+    vtkCompositeDataSet *dobj);
 
   int Write(MPI_Comm comm, AdiosHandle handles,
     const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
@@ -1589,16 +2722,26 @@ struct UnstructuredCellSchema
   std::map<std::string, adios2_variable*> CellArrayVars;
   std::map<std::string, std::vector<size_t>> CellArrayStarts;
   std::map<std::string, std::vector<size_t>> CellArrayCounts;
+
+#if VTK_MAJOR_VERSION >= 9
+  CompactCellSchema Compact;
+#endif
 };
 
 // --------------------------------------------------------------------------
 int UnstructuredCellSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
-  const std::string &ons, const sensei::MeshMetadataPtr &md)
+  const std::string &ons, const sensei::MeshMetadataPtr &md,
+  vtkCompositeDataSet *dobj)
 {
-  (void)comm;
-
   if (sensei::VTKUtils::Unstructured(md))
     {
+#if VTK_MAJOR_VERSION >= 9
+    // VTK stores offsets and connectivity, send them as they are
+    return this->Compact.DefineVariables(comm, handles, ons, md, dobj);
+#else
+    (void)comm;
+    (void)dobj;
+
     sensei::TimeEvent<128> mark(
       "senseiADIOS2::UnstructuredCellSchema::DefineVariables");
 
@@ -1686,6 +2829,7 @@ int UnstructuredCellSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
       cellTypesStart += numCellsLocal;
       cellArrayStart += cellArraySizeLocal;
       }
+#endif
     }
 
   return 0;
@@ -1697,6 +2841,9 @@ int UnstructuredCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
 {
   if (sensei::VTKUtils::Unstructured(md))
     {
+#if VTK_MAJOR_VERSION >= 9
+    return this->Compact.Write(comm, handles, md, dobj);
+#else
     sensei::Profiler::StartEvent("senseiADIOS2::UnstructuredCellSchema");
     long long numBytes = 0ll;
 
@@ -1782,6 +2929,7 @@ int UnstructuredCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
 
     sensei::Profiler::EndEvent("senseiADIOS2::UnstructuredCellSchema::Write",
       numBytes);
+#endif
     }
 
   return 0;
@@ -1793,6 +2941,18 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
 {
   if (sensei::VTKUtils::Unstructured(md))
     {
+    // streams of revision 4 carry offsets and connectivity
+    std::string sec_path = ons + "cell_sections";
+    if (adios2_inquire_variable(handles.io, sec_path.c_str()))
+      {
+#if VTK_MAJOR_VERSION >= 9
+      return this->Compact.Read(comm, handles, ons, md, dobj);
+#else
+      SENSEI_ERROR("Reading cells of schema revision 4 requires VTK 9")
+      return -1;
+#endif
+      }
+
     sensei::Profiler::StartEvent("senseiADIOS2::UnstructuredCellSchema::Read");
     long long numBytes = 0ll;
 
@@ -1930,7 +3090,8 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
 struct PolydataCellSchema
 {
   int DefineVariables(MPI_Comm comm, AdiosHandle handles,
-    const std::string &ons, const sensei::MeshMetadataPtr &md);
+    const std::string &ons, const sensei::MeshMetadataPtr &md,
+    vtkCompositeDataSet *dobj);
 
   int Write(MPI_Comm comm, AdiosHandle handles,
     const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
@@ -1946,16 +3107,26 @@ struct PolydataCellSchema
   std::map<std::string, adios2_variable*> CellArrayVars;
   std::map<std::string, std::vector<size_t>> CellArrayStarts;
   std::map<std::string, std::vector<size_t>> CellArrayCounts;
+
+#if VTK_MAJOR_VERSION >= 9
+  CompactCellSchema Compact;
+#endif
 };
 
 // --------------------------------------------------------------------------
 int PolydataCellSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
-  const std::string &ons, const sensei::MeshMetadataPtr &md)
+  const std::string &ons, const sensei::MeshMetadataPtr &md,
+  vtkCompositeDataSet *dobj)
 {
-  (void)comm;
-
   if (sensei::VTKUtils::Polydata(md))
     {
+#if VTK_MAJOR_VERSION >= 9
+    // VTK stores offsets and connectivity, send them as they are
+    return this->Compact.DefineVariables(comm, handles, ons, md, dobj);
+#else
+    (void)comm;
+    (void)dobj;
+
     sensei::TimeEvent<128> mark("senseiADIOS2::PolydataCellSchema::DefineVariables");
 
     // allocate write ids
@@ -2042,6 +3213,7 @@ int PolydataCellSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
       cellTypesStart += numCellsLocal;
       cellArrayStart += cellArraySizeLocal;
       }
+#endif
     }
 
   return 0;
@@ -2053,6 +3225,9 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
 {
   if (sensei::VTKUtils::Polydata(md))
     {
+#if VTK_MAJOR_VERSION >= 9
+    return this->Compact.Write(comm, handles, md, dobj);
+#else
     sensei::Profiler::StartEvent("senseiADIOS2::PolydataCellSchema::Write");
     long long numBytes = 0ll;
 
@@ -2067,6 +3242,11 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
     std::vector<size_t> &cellTypeStarts = this->CellTypeStarts[md->MeshName];
     std::vector<size_t> &cellTypeCounts = this->CellTypeCounts[md->MeshName];
 
+    sensei::VTKUtils::CellTypesSerializer typeSerializer;
+    sensei::VTKUtils::CellArraySerializer cellSerializer;
+    std::vector<unsigned char> types;
+    std::vector<unsigned char> cells;
+
     vtkCompositeDataIterator *it = dobj->NewIterator();
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
@@ -2083,43 +3263,20 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        // first move the polydata's various cell arrays into a single
-        // contiguous array. and build a cell types array. doing it this
-        // way simplifies the file format as we don't need to keep track
-        // of all 4 cells arrays.
-        std::vector<char> types;
-        std::vector<vtkIdType> cells;
-
-        vtkIdType nv = pd->GetNumberOfVerts();
-        if (nv)
-          {
-          types.insert(types.end(), nv, VTK_VERTEX);
-          vtkIdType *pv = pd->GetVerts()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), pv, pv + pd->GetVerts()->GetData()->GetNumberOfTuples());
-          }
-
-        vtkIdType nl = pd->GetNumberOfLines();
-        if (nl)
-          {
-          types.insert(types.end(), nl, VTK_LINE);
-          vtkIdType *pl = pd->GetLines()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), pl, pl + pd->GetLines()->GetData()->GetNumberOfTuples());
-          }
-
-        vtkIdType np = pd->GetNumberOfPolys();
-        if (np)
-          {
-          types.insert(types.end(), np, VTK_POLYGON);
-          vtkIdType *pp = pd->GetPolys()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), pp, pp + pd->GetPolys()->GetData()->GetNumberOfTuples());
-          }
-
-        vtkIdType ns = pd->GetNumberOfStrips();
-        if (ns)
+        // the serializers move the polydata's various cell arrays into a
+        // single contiguous array and build a cell types array. doing it
+        // this way simplifies the file format as we don't need to keep
+        // track of all 4 cells arrays.
+        const void *pTypes = nullptr;
+        const void *pCells = nullptr;
+        unsigned long long typeBytes = 0;
+        unsigned long long cellBytes = 0;
+
+        if (sensei::VTKUtils::Serialize(pd, typeSerializer, types, pTypes, typeBytes) ||
+          sensei::VTKUtils::Serialize(pd, cellSerializer, cells, pCells, cellBytes))
           {
-          types.insert(types.end(), ns, VTK_TRIANGLE_STRIP);
-          vtkIdType *ps = pd->GetStrips()->GetData()->GetPointer(0);
-          cells.insert(cells.end(), ps, ps + pd->GetStrips()->GetData()->GetNumberOfTuples());
+          SENSEI_ERROR("Failed to serialize the cells of block " << j)
+          return -1;
           }
 
         // select the spot in the global cellArray that this block's
@@ -2135,7 +3292,7 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
 
         // write cell cellTypes
         if (adios2_put(handles.engine, cellTypeVar,
-          types.data(), adios2_mode_sync))
+          pTypes, adios2_mode_sync))
           {
           SENSEI_ERROR("adios2_put cell types for mesh \""
             << md->MeshName << "\" block " << j << " failed")
@@ -2155,15 +3312,14 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
 
         // write cell cellArray
         if (adios2_put(handles.engine, cellArrayVar,
-          cells.data(), adios2_mode_sync))
+          pCells, adios2_mode_sync))
           {
           SENSEI_ERROR("adios2_put cell array for mesh \""
             << md->MeshName << "\" block " << j << " failed")
           return -1;
           }
 
-        numBytes += types.size()*sizeof(unsigned char) +
-          cells.size()*sizeof(vtkIdType);
+        numBytes += typeBytes + cellBytes;
         }
 
       // go to the next block
@@ -2173,6 +3329,7 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
 
     sensei::Profiler::EndEvent("senseiADIOS2::PolydataCellSchema::Write",
       numBytes);
+#endif
     }
 
   return 0;
@@ -2185,6 +3342,18 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
 {
   if (sensei::VTKUtils::Polydata(md))
     {
+    // streams of revision 4 carry offsets and connectivity
+    std::string sec_path = ons + "cell_sections";
+    if (adios2_inquire_variable(handles.io, sec_path.c_str()))
+      {
+#if VTK_MAJOR_VERSION >= 9
+      return this->Compact.Read(comm, handles, ons, md, dobj);
+#else
+      SENSEI_ERROR("Reading cells of schema revision 4 requires VTK 9")
+      return -1;
+#endif
+      }
+
     sensei::Profiler::StartEvent("senseiADIOS2::PolydataCellSchema::Read");
     long long numBytes = 0ll;
 
@@ -3333,7 +4502,8 @@ int StretchedCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
 struct DataObjectSchema
 {
   int DefineVariables(MPI_Comm comm, AdiosHandle handles,
-    unsigned int doid,  const sensei::MeshMetadataPtr &md);
+    unsigned int doid,  const sensei::MeshMetadataPtr &md,
+    vtkCompositeDataSet *dobj);
 
   int Write(MPI_Comm comm, AdiosHandle handles, unsigned int doid,
     const sensei::MeshMetadataPtr &md, vtkCompositeDataSet *dobj);
@@ -3360,7 +4530,8 @@ struct DataObjectSchema
 
 // --------------------------------------------------------------------------
 int DataObjectSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
-  unsigned int doid, const sensei::MeshMetadataPtr &md)
+  unsigned int doid, const sensei::MeshMetadataPtr &md,
+  vtkCompositeDataSet *dobj)
 {
   sensei::TimeEvent<128> mark(
     "senseiADIOS2::DataObjectSchema::DefineVariables");
@@ -3369,10 +4540,10 @@ int DataObjectSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
   std::ostringstream ons;
   ons << "data_object_" << doid << "/";
 
-  if (this->DataArrays.DefineVariables(comm, handles, ons.str(), md) ||
+  if (this->DataArrays.DefineVariables(comm, handles, ons.str(), md, dobj) ||
     this->Points.DefineVariables(comm, handles, ons.str(), md) ||
-    this->UnstructuredCells.DefineVariables(comm, handles, ons.str(), md) ||
-    this->PolydataCells.DefineVariables(comm, handles, ons.str(), md) ||
+    this->UnstructuredCells.DefineVariables(comm, handles, ons.str(), md, dobj) ||
+    this->PolydataCells.DefineVariables(comm, handles, ons.str(), md, dobj) ||
     this->UniformCartesian.DefineVariables(comm, handles, ons.str(), md) ||
     this->StretchedCartesian.DefineVariables(comm, handles, ons.str(), md) ||
     this->LogicallyCartesian.DefineVariables(comm, handles, ons.str(), md))
@@ -3494,6 +4665,30 @@ int DataObjectSchema::InitializeDataObject(MPI_Comm comm,
 
 
 
+// --------------------------------------------------------------------------
+// restricts the blocks that are read to the coarse levels of an AMR mesh.
+// the blocks of finer levels are given no owner in a copy of the metadata,
+// so they are neither created nor pulled across the wire.
+sensei::MeshMetadataPtr restrictLevels(const sensei::MeshMetadataPtr &md,
+  int maxLevel)
+{
+  if ((maxLevel < 0) || !sensei::VTKUtils::AMR(md) ||
+    (maxLevel >= md->NumLevels - 1) ||
+    (md->BlockLevel.size() != size_t(md->NumBlocks)))
+    return md;
+
+  sensei::MeshMetadataPtr rmd = md->NewCopy();
+  for (int i = 0; i < rmd->NumBlocks; ++i)
+    {
+    if (rmd->BlockLevel[i] > maxLevel)
+      rmd->BlockOwner[i] = -1;
+    }
+
+  return rmd;
+}
+
+
+
 struct DataObjectCollectionSchema::InternalsType
 {
   InternalsType() : BlockOwnerArrayMetadata(0) {}
@@ -3645,9 +4840,19 @@ int DataObjectCollectionSchema::GetObjectId(MPI_Comm comm,
   return 0;
 }
 
+// --------------------------------------------------------------------------
+void DataObjectCollectionSchema::SetArrayReduction(const std::string &meshName,
+  int association, const std::string &arrayName,
+  const ArrayReduction &reduction)
+{
+  this->Internals->DataObject.DataArrays.SetArrayReduction(meshName,
+    association, arrayName, reduction);
+}
+
 // --------------------------------------------------------------------------
 int DataObjectCollectionSchema::DefineVariables(MPI_Comm comm, AdiosHandle handles,
-  const std::vector<sensei::MeshMetadataPtr> &metadata)
+  const std::vector<sensei::MeshMetadataPtr> &metadata,
+  const std::vector<vtkCompositeDataSet*> &objects)
 {
   sensei::TimeEvent<128>("DataObjectCollectionSchema::DefineVariables");
 
@@ -3672,6 +4877,14 @@ int DataObjectCollectionSchema::DefineVariables(MPI_Comm comm, AdiosHandle handl
 
   // /number_of_data_objects
   unsigned int n_objects = metadata.size();
+  if (n_objects != objects.size())
+    {
+    SENSEI_ERROR("Missing metadata for some objects. "
+      << objects.size() << " data objects and " << n_objects
+      << " metadata")
+    return -1;
+    }
+
   if (!adios2_define_variable(handles.io, "number_of_data_objects",
     adios2_type_int32_t, 0, NULL, NULL, NULL, adios2_constant_dims_true))
     {
@@ -3695,7 +4908,8 @@ int DataObjectCollectionSchema::DefineVariables(MPI_Comm comm, AdiosHandle handl
     // /data_object_<id>/metadata
     BinaryStreamSchema::DefineVariables(handles, object_id + "metadata");
 
-    if (this->Internals->DataObject.DefineVariables(comm, handles, i, metadata[i]))
+    if (this->Internals->DataObject.DefineVariables(comm, handles, i,
+      metadata[i], objects[i]))
       {
       SENSEI_ERROR("Failed to define variables for object "
         << i << " " << metadata[i]->MeshName)
@@ -3793,7 +5007,7 @@ bool DataObjectCollectionSchema::CanRead(InputStream &iStream)
 // --------------------------------------------------------------------------
 int DataObjectCollectionSchema::ReadObject(MPI_Comm comm,
   InputStream &iStream, const std::string &object_name,
-  vtkDataObject *&dobj, bool structure_only)
+  vtkDataObject *&dobj, bool structure_only, int max_level)
 {
   sensei::TimeEvent<128> mark(
     "senseiADIOS2::DataObjectCollectionSchema::ReadObject");
@@ -3814,6 +5028,8 @@ int DataObjectCollectionSchema::ReadObject(MPI_Comm comm,
     return -1;
     }
 
+  md = restrictLevels(md, max_level);
+
   vtkCompositeDataSet *cd = dynamic_cast<vtkCompositeDataSet*>(dobj);
   if (this->Internals->DataObject.ReadMesh(comm,
     iStream.Handles, doid, md, cd, structure_only))
@@ -3830,7 +5046,7 @@ int DataObjectCollectionSchema::ReadObject(MPI_Comm comm,
 // --------------------------------------------------------------------------
 int DataObjectCollectionSchema::ReadArray(MPI_Comm comm,
   InputStream &iStream, const std::string &object_name, int association,
-  const std::string &array_name, vtkDataObject *dobj)
+  const std::string &array_name, vtkDataObject *dobj, int max_level)
 {
   sensei::TimeEvent<128> mark(
     "senseiADIOS2::DataObjectCollectionSchema::ReadArray");
@@ -3861,6 +5077,8 @@ int DataObjectCollectionSchema::ReadArray(MPI_Comm comm,
     return -1;
     }
 
+  md = restrictLevels(md, max_level);
+
   // handle a special case to let us visualize block owner for debugging
   if (array_name.rfind("BlockOwner") != std::string::npos)
     {
@@ -29,6 +29,25 @@ struct AdiosHandle
 
 struct InputStream;
 
+/// describes how a data array is reduced before it is written
+// QUANTIZE maps floating point values onto the smallest unsigned integer
+// type that represents the array's global range in steps of twice the error
+// bound. the reader reconstructs the values to within the error bound.
+// OPERATOR attaches an ADIOS2 operator, such as zfp, sz, or blosc, to the
+// array's variable. the operator's parameters are passed as name value
+// pairs. ADIOS2 reconstructs operator compressed data on the reader side.
+struct ArrayReduction
+{
+  enum {NONE=0, QUANTIZE=1, OPERATOR=2};
+
+  ArrayReduction() : Method(NONE), ErrorBound(0.0), Operator(nullptr) {}
+
+  int Method;
+  double ErrorBound;
+  adios2_operator *Operator;
+  std::vector<std::pair<std::string,std::string>> Parameters;
+};
+
 /// ADIOS representation of collections of vtkDataObject
 // This class provides the user facing API managing the lower level
 // objects internally. The write API defines variables needed for the
@@ -43,9 +62,15 @@ public:
   DataObjectCollectionSchema();
   ~DataObjectCollectionSchema();
 
-  // declare variables for adios write
+  // declare variables for adios write. the objects are used to compute the
+  // range of arrays that are quantized.
   int DefineVariables(MPI_Comm comm, AdiosHandle handles,
-    const std::vector<sensei::MeshMetadataPtr> &metadata);
+    const std::vector<sensei::MeshMetadataPtr> &metadata,
+    const std::vector<vtkCompositeDataSet*> &objects);
+
+  // set how the named array is reduced before it is written
+  void SetArrayReduction(const std::string &meshName, int association,
+    const std::string &arrayName, const ArrayReduction &reduction);
 
   // discover names of data objects on disk(or stream)
   int ReadMeshMetadata(MPI_Comm comm, InputStream &iStream);
@@ -74,14 +99,16 @@ public:
 
   // creates the mesh matching what is on disk(or stream), including a domain
   // decomposition, but does not read data arrays. If structure_only is true
-  // then points and cells are not read from disk.
+  // then points and cells are not read from disk. When max_level is 0 or
+  // larger the blocks of finer AMR levels are neither created nor read.
   int ReadObject(MPI_Comm comm, InputStream &iStream, const std::string &name,
-    vtkDataObject *&object, bool structure_only);
+    vtkDataObject *&object, bool structure_only, int max_level = -1);
 
-  // read a single array from disk(or stream), store it into the mesh
+  // read a single array from disk(or stream), store it into the mesh. the
+  // max_level passed here must match the one passed to ReadObject.
   int ReadArray(MPI_Comm comm, InputStream &iStream,
     const std::string &object_name, int association,
-    const std::string &array_name, vtkDataObject *dobj);
+    const std::string &array_name, vtkDataObject *dobj, int max_level = -1);
 
   // returns the current time and time step
   int ReadTimeStep(MPI_Comm comm, InputStream &iStream,
@@ -108,7 +135,8 @@ struct InputStream
   InputStream() : Handles(), Adios(nullptr),
     ReadEngine(""), FileName(""), FileSeries(0),
     StepsPerFile(0), FileIndex(0), StepIndex(0),
-    DebugMode(0) {}
+    DebugMode(0), LatestOnly(0), CurrentStep(0), HaveStep(0),
+    DroppedSteps(0) {}
 
   // pass engine parameters to ADIOS2 in key value pairs
   void AddParameter(const std::string &key, const std::string &value);
@@ -122,6 +150,16 @@ struct InputStream
   void SetDebugMode(int mode)
   { this->DebugMode = mode; }
 
+  // when set, skip to the latest step the writer has made available rather
+  // than reading every step. only the SST engine supports this.
+  void SetLatestOnly(int val)
+  { this->LatestOnly = val; }
+
+  // get the number of steps the writer made that were never read, either
+  // because the writer discarded them or the reader skipped them.
+  unsigned long GetDroppedSteps() const
+  { return this->DroppedSteps; }
+
   /// @brief Set the filename.
   /// Default value is "sensei.bp" which is suitable for use with streams or
   /// transport engines such as SST. When writing files to disk using the BP4
@@ -164,6 +202,10 @@ struct InputStream
   int StepIndex;
   std::vector<std::pair<std::string,std::string>> Parameters;
   int DebugMode;
+  int LatestOnly;
+  size_t CurrentStep;
+  int HaveStep;
+  unsigned long DroppedSteps;
 };
 
 }
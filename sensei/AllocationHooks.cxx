@@ -0,0 +1,342 @@
+// Replacements for the global operator new and delete that report to the
+// AllocationTracker. This file is only compiled when SENSEI is configured
+// with ENABLE_ALLOCATION_TRACKING. An application that defines its own
+// operator new and delete takes precedence over these, and may call
+// AllocationTracker::RecordAllocation/RecordFree itself.
+//
+// With glibc malloc, calloc, realloc, free and the aligned variants are
+// replaced as well, so that the buffers of VTK's data arrays, which are
+// allocated with malloc and realloc, are accounted for. The replacements
+// call glibc's own implementation. Elsewhere only allocations made through
+// operator new are seen.
+#include "AllocationTracker.h"
+
+#include <cstdlib>
+#include <cerrno>
+#include <new>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define sensei_malloc_size(p) malloc_size(p)
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#define sensei_malloc_size(p) malloc_usable_size(p)
+#else
+// the size of a block can not be queried, frees are counted but not
+// their size
+#define sensei_malloc_size(p) 0
+#endif
+
+#if defined(__GLIBC__)
+#define SENSEI_HOOK_MALLOC
+extern "C"
+{
+void *__libc_malloc(size_t nBytes);
+void *__libc_calloc(size_t n, size_t nBytes);
+void *__libc_realloc(void *ptr, size_t nBytes);
+void *__libc_memalign(size_t alignment, size_t nBytes);
+void *__libc_valloc(size_t nBytes);
+void *__libc_pvalloc(size_t nBytes);
+void __libc_free(void *ptr);
+}
+#define sensei_raw_malloc(n) __libc_malloc(n)
+#define sensei_raw_memalign(a, n) __libc_memalign(a, n)
+#define sensei_raw_free(p) __libc_free(p)
+#else
+#define sensei_raw_malloc(n) malloc(n)
+#define sensei_raw_free(p) free(p)
+static inline void *sensei_raw_memalign(size_t alignment, size_t nBytes)
+{
+  void *ptr = nullptr;
+  return posix_memalign(&ptr, alignment, nBytes) ? nullptr : ptr;
+}
+#endif
+
+namespace
+{
+// --------------------------------------------------------------------------
+void *Recorded(void *ptr)
+{
+  if (ptr)
+    sensei::AllocationTracker::RecordAllocation(sensei_malloc_size(ptr));
+  return ptr;
+}
+
+// --------------------------------------------------------------------------
+void *TrackedAlloc(std::size_t nBytes)
+{
+  return Recorded(sensei_raw_malloc(nBytes ? nBytes : 1));
+}
+
+// --------------------------------------------------------------------------
+void TrackedFree(void *ptr)
+{
+  if (!ptr)
+    return;
+  sensei::AllocationTracker::RecordFree(sensei_malloc_size(ptr));
+  sensei_raw_free(ptr);
+}
+
+// --------------------------------------------------------------------------
+void *TrackedNew(std::size_t nBytes)
+{
+  void *ptr = nullptr;
+  while (!(ptr = TrackedAlloc(nBytes)))
+    {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler)
+      throw std::bad_alloc();
+    handler();
+    }
+  return ptr;
+}
+
+#if defined(__cpp_aligned_new)
+// --------------------------------------------------------------------------
+void *TrackedAlignedAlloc(std::size_t alignment, std::size_t nBytes)
+{
+  return Recorded(sensei_raw_memalign(alignment, nBytes ? nBytes : 1));
+}
+
+// --------------------------------------------------------------------------
+void *TrackedAlignedNew(std::size_t nBytes, std::align_val_t alignment)
+{
+  void *ptr = nullptr;
+  while (!(ptr = TrackedAlignedAlloc(static_cast<std::size_t>(alignment), nBytes)))
+    {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler)
+      throw std::bad_alloc();
+    handler();
+    }
+  return ptr;
+}
+#endif
+}
+
+#if defined(SENSEI_HOOK_MALLOC)
+// --------------------------------------------------------------------------
+extern "C" void *malloc(size_t nBytes)
+{
+  return Recorded(__libc_malloc(nBytes));
+}
+
+// --------------------------------------------------------------------------
+extern "C" void *calloc(size_t n, size_t nBytes)
+{
+  return Recorded(__libc_calloc(n, nBytes));
+}
+
+// --------------------------------------------------------------------------
+extern "C" void *realloc(void *ptr, size_t nBytes)
+{
+  // a realloc is a free of the old block and an allocation of the new one
+  size_t oldBytes = ptr ? sensei_malloc_size(ptr) : 0;
+
+  void *newPtr = __libc_realloc(ptr, nBytes);
+
+  if (ptr && (newPtr || !nBytes))
+    sensei::AllocationTracker::RecordFree(oldBytes);
+
+  return Recorded(newPtr);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void free(void *ptr)
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void *memalign(size_t alignment, size_t nBytes)
+{
+  return Recorded(__libc_memalign(alignment, nBytes));
+}
+
+// --------------------------------------------------------------------------
+extern "C" void *aligned_alloc(size_t alignment, size_t nBytes)
+{
+  return Recorded(__libc_memalign(alignment, nBytes));
+}
+
+// --------------------------------------------------------------------------
+extern "C" void *valloc(size_t nBytes)
+{
+  return Recorded(__libc_valloc(nBytes));
+}
+
+// --------------------------------------------------------------------------
+extern "C" void *pvalloc(size_t nBytes)
+{
+  return Recorded(__libc_pvalloc(nBytes));
+}
+
+// --------------------------------------------------------------------------
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t nBytes)
+{
+  if ((alignment % sizeof(void*)) || (alignment & (alignment - 1)))
+    return EINVAL;
+
+  void *tmp = Recorded(__libc_memalign(alignment, nBytes));
+  if (!tmp)
+    return ENOMEM;
+
+  *ptr = tmp;
+  return 0;
+}
+#endif
+
+// --------------------------------------------------------------------------
+void *operator new(std::size_t nBytes)
+{
+  return TrackedNew(nBytes);
+}
+
+// --------------------------------------------------------------------------
+void *operator new[](std::size_t nBytes)
+{
+  return TrackedNew(nBytes);
+}
+
+// --------------------------------------------------------------------------
+void *operator new(std::size_t nBytes, const std::nothrow_t &) noexcept
+{
+  try
+    {
+    return TrackedNew(nBytes);
+    }
+  catch (...)
+    {
+    return nullptr;
+    }
+}
+
+// --------------------------------------------------------------------------
+void *operator new[](std::size_t nBytes, const std::nothrow_t &) noexcept
+{
+  try
+    {
+    return TrackedNew(nBytes);
+    }
+  catch (...)
+    {
+    return nullptr;
+    }
+}
+
+// --------------------------------------------------------------------------
+void operator delete(void *ptr) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete[](void *ptr) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+  TrackedFree(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+// --------------------------------------------------------------------------
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  TrackedFree(ptr);
+}
+#endif
+
+#if defined(__cpp_aligned_new)
+// --------------------------------------------------------------------------
+void *operator new(std::size_t nBytes, std::align_val_t alignment)
+{
+  return TrackedAlignedNew(nBytes, alignment);
+}
+
+// --------------------------------------------------------------------------
+void *operator new[](std::size_t nBytes, std::align_val_t alignment)
+{
+  return TrackedAlignedNew(nBytes, alignment);
+}
+
+// --------------------------------------------------------------------------
+void *operator new(std::size_t nBytes, std::align_val_t alignment,
+  const std::nothrow_t &) noexcept
+{
+  try
+    {
+    return TrackedAlignedNew(nBytes, alignment);
+    }
+  catch (...)
+    {
+    return nullptr;
+    }
+}
+
+// --------------------------------------------------------------------------
+void *operator new[](std::size_t nBytes, std::align_val_t alignment,
+  const std::nothrow_t &) noexcept
+{
+  try
+    {
+    return TrackedAlignedNew(nBytes, alignment);
+    }
+  catch (...)
+    {
+    return nullptr;
+    }
+}
+
+// --------------------------------------------------------------------------
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  TrackedFree(ptr);
+}
+#if defined(__cpp_sized_deallocation)
+// --------------------------------------------------------------------------
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+  TrackedFree(ptr);
+}
+
+// --------------------------------------------------------------------------
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept
+{
+  TrackedFree(ptr);
+}
+#endif
+#endif
@@ -0,0 +1,159 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+
+#if defined(ENABLE_ALLOCATION_TRACKING)
+#include <vtkDebugLeaks.h>
+#endif
+
+namespace
+{
+// per thread counters, flushed to the process wide totals. these are
+// plain old data, so they can be used from operator new at any point
+// in the thread's life.
+struct ThreadCounters
+{
+  long long Allocated;
+  long long Freed;
+  long long NumAllocations;
+  long long NumFrees;
+};
+
+thread_local ThreadCounters threadCounters = {0, 0, 0, 0};
+
+// number of bytes accumulated on a thread before flushing
+const long long flushThreshold = 64*1024;
+
+std::atomic<long long> totalAllocated(0);
+std::atomic<long long> totalFreed(0);
+std::atomic<long long> totalNumAllocations(0);
+std::atomic<long long> totalNumFrees(0);
+std::atomic<long long> peakInUse(0);
+std::atomic<long long> vtkObjects(-1);
+std::atomic<long long> vtkObjectsFreed(-1);
+
+// --------------------------------------------------------------------------
+void Flush(ThreadCounters &tc)
+{
+  long long allocated = totalAllocated.fetch_add(tc.Allocated,
+    std::memory_order_relaxed) + tc.Allocated;
+
+  long long freed = totalFreed.fetch_add(tc.Freed,
+    std::memory_order_relaxed) + tc.Freed;
+
+  totalNumAllocations.fetch_add(tc.NumAllocations, std::memory_order_relaxed);
+  totalNumFrees.fetch_add(tc.NumFrees, std::memory_order_relaxed);
+
+  tc.Allocated = 0;
+  tc.Freed = 0;
+  tc.NumAllocations = 0;
+  tc.NumFrees = 0;
+
+  // update the high water mark
+  long long inUse = allocated - freed;
+  long long peak = peakInUse.load(std::memory_order_relaxed);
+  while ((inUse > peak) && !peakInUse.compare_exchange_weak(peak, inUse,
+    std::memory_order_relaxed));
+}
+
+#if defined(ENABLE_ALLOCATION_TRACKING) && defined(VTK_DEBUG_LEAKS)
+// counts vtkObject construction and destruction
+class VTKObjectCounter : public vtkDebugLeaksObserver
+{
+public:
+  VTKObjectCounter()
+  {
+    vtkObjects = 0;
+    vtkObjectsFreed = 0;
+    vtkDebugLeaks::SetDebugLeaksObserver(this);
+  }
+
+  ~VTKObjectCounter() { vtkDebugLeaks::SetDebugLeaksObserver(nullptr); }
+
+  void ConstructingObject(vtkObjectBase *) override
+  { vtkObjects.fetch_add(1, std::memory_order_relaxed); }
+
+  void DestructingObject(vtkObjectBase *) override
+  { vtkObjectsFreed.fetch_add(1, std::memory_order_relaxed); }
+};
+
+VTKObjectCounter vtkObjectCounter;
+#endif
+}
+
+namespace sensei
+{
+namespace AllocationTracker
+{
+
+// --------------------------------------------------------------------------
+bool Enabled()
+{
+#if defined(ENABLE_ALLOCATION_TRACKING)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// --------------------------------------------------------------------------
+void RecordAllocation(std::size_t nBytes)
+{
+  ThreadCounters &tc = threadCounters;
+  tc.Allocated += nBytes;
+  tc.NumAllocations += 1;
+  if ((tc.Allocated >= flushThreshold) || (tc.Freed >= flushThreshold))
+    Flush(tc);
+}
+
+// --------------------------------------------------------------------------
+void RecordFree(std::size_t nBytes)
+{
+  ThreadCounters &tc = threadCounters;
+  tc.Freed += nBytes;
+  tc.NumFrees += 1;
+  if ((tc.Allocated >= flushThreshold) || (tc.Freed >= flushThreshold))
+    Flush(tc);
+}
+
+// --------------------------------------------------------------------------
+void GetCounters(Counters &counters)
+{
+  Flush(threadCounters);
+
+  counters.Allocated = totalAllocated.load(std::memory_order_relaxed);
+  counters.Freed = totalFreed.load(std::memory_order_relaxed);
+  counters.NumAllocations = totalNumAllocations.load(std::memory_order_relaxed);
+  counters.NumFrees = totalNumFrees.load(std::memory_order_relaxed);
+  counters.Peak = peakInUse.load(std::memory_order_relaxed);
+  counters.VTKObjects = vtkObjects.load(std::memory_order_relaxed);
+  counters.VTKObjectsFreed = vtkObjectsFreed.load(std::memory_order_relaxed);
+}
+
+// --------------------------------------------------------------------------
+void ResetPeak()
+{
+  Flush(threadCounters);
+
+  long long inUse = totalAllocated.load(std::memory_order_relaxed) -
+    totalFreed.load(std::memory_order_relaxed);
+
+  peakInUse.store(inUse, std::memory_order_relaxed);
+}
+
+// --------------------------------------------------------------------------
+void Difference(const Counters &start, const Counters &end, Counters &diff)
+{
+  diff.Allocated = end.Allocated - start.Allocated;
+  diff.Freed = end.Freed - start.Freed;
+  diff.NumAllocations = end.NumAllocations - start.NumAllocations;
+  diff.NumFrees = end.NumFrees - start.NumFrees;
+  diff.Peak = end.Peak - (start.Allocated - start.Freed);
+  diff.VTKObjects = start.VTKObjects < 0 ? -1 :
+    end.VTKObjects - start.VTKObjects;
+  diff.VTKObjectsFreed = start.VTKObjectsFreed < 0 ? -1 :
+    end.VTKObjectsFreed - start.VTKObjectsFreed;
+}
+
+}
+}
@@ -0,0 +1,58 @@
+#ifndef sensei_AllocationTracker_h
+#define sensei_AllocationTracker_h
+
+#include "senseiConfig.h"
+
+#include <cstddef>
+
+namespace sensei
+{
+// AllocationTracker - opt-in accounting of heap allocations
+//
+// When SENSEI is configured with ENABLE_ALLOCATION_TRACKING, global
+// operator new/delete, and with glibc malloc/realloc/free, are replaced
+// (see AllocationHooks.cxx) by versions that report to the functions
+// below. An application can provide its own operator new/delete, or a
+// malloc wrapper, and call RecordAllocation and RecordFree to take part in
+// the accounting. When VTK is built with VTK_DEBUG_LEAKS the number of
+// vtkObjects constructed and destructed is also counted.
+//
+// Counters are accumulated per thread without synchronization and are
+// folded into process wide totals every few KiB, hence totals may lag by
+// a small amount per thread. GetCounters flushes the calling thread.
+namespace AllocationTracker
+{
+
+struct Counters
+{
+  long long Allocated;       // bytes allocated
+  long long Freed;           // bytes freed
+  long long NumAllocations;  // number of allocations
+  long long NumFrees;        // number of frees
+  long long Peak;            // high water mark of bytes in use since ResetPeak
+  long long VTKObjects;      // vtkObjects constructed, -1 without VTK_DEBUG_LEAKS
+  long long VTKObjectsFreed; // vtkObjects destructed, -1 without VTK_DEBUG_LEAKS
+};
+
+// returns true if the allocation hooks are compiled in
+bool Enabled();
+
+// called by the hooks on every allocation and deallocation
+void RecordAllocation(std::size_t nBytes);
+void RecordFree(std::size_t nBytes);
+
+// get the process wide totals
+void GetCounters(Counters &counters);
+
+// reset the high water mark to the number of bytes currently in use
+void ResetPeak();
+
+// the differences between two snapshots, bytes allocated, freed, and the
+// peak number of bytes in use above the number in use at the first
+// snapshot. ResetPeak should be called when the first snapshot is taken.
+void Difference(const Counters &start, const Counters &end, Counters &diff);
+
+}
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "senseiConfig.h"
 #include "Error.h"
 
+#include <mpi.h>
 #include <cstdlib>
 #include <cstring>
 #include <string>
@@ -109,6 +110,10 @@ public:
   // broadcast the stream from the root process to all other processes
   int Broadcast(int rootRank=0);
 
+  // broadcast the stream from the root process to all other processes in
+  // the given communicator
+  int Broadcast(MPI_Comm comm, int rootRank=0);
+
 private:
   // re-allocation size
   static
@@ -1,6 +1,8 @@
 #include "BlockPartitioner.h"
 #include "Profiler.h"
 
+#include <algorithm>
+
 namespace sensei
 {
 
@@ -35,4 +37,29 @@ int BlockPartitioner::GetPartition(MPI_Comm comm, const MeshMetadataPtr &mdIn,
   return 0;
 }
 
+// --------------------------------------------------------------------------
+void BlockPartitioner::GetWeightedPartition(int nRanks,
+  const std::vector<double> &weights, std::vector<int> &owner)
+{
+  unsigned int nBlocks = weights.size();
+  owner.resize(nBlocks);
+
+  double total = 0.0;
+  for (unsigned int i = 0; i < nBlocks; ++i)
+    total += weights[i];
+
+  bool uniform = total <= 0.0;
+  if (uniform)
+    total = nBlocks;
+
+  double sum = 0.0;
+  for (unsigned int i = 0; i < nBlocks; ++i)
+    {
+    double w = uniform ? 1.0 : weights[i];
+    int rank = (sum + 0.5*w)/total*nRanks;
+    owner[i] = std::min(rank, nRanks - 1);
+    sum += w;
+    }
+}
+
 }
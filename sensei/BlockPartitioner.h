@@ -3,6 +3,8 @@
 
 #include "Partitioner.h"
 
+#include <vector>
+
 namespace sensei
 {
 
@@ -26,6 +28,13 @@ public:
   int GetPartition(MPI_Comm comm, const sensei::MeshMetadataPtr &in,
     sensei::MeshMetadataPtr &out) override;
 
+  // assign consecutive spans of blocks to ranks such that each rank gets
+  // approximately the same total weight. a block goes to the rank whose
+  // share of the total contains the block's midpoint. when the weights sum
+  // to zero each block is given the same weight.
+  static void GetWeightedPartition(int nRanks,
+    const std::vector<double> &weights, std::vector<int> &owner);
+
 protected:
   BlockPartitioner() = default;
   BlockPartitioner(const BlockPartitioner &) = default;
@@ -1,11 +1,18 @@
 #include "CinemaHelper.h"
+#include "ImageCompositor.h"
 #include "Profiler.h"
 
 #include <vector>
 #include <map>
 #include <math.h>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <vtksys/SystemTools.hxx>
 
@@ -18,6 +25,7 @@
 #endif
 #include <vtkPointData.h>
 #include <vtkSmartPointer.h>
+#include <vtkNew.h>
 #ifdef ENABLE_CATALYST
 #  include <vtkSMPropertyHelper.h>
 #  include <vtkSMRenderViewProxy.h>
@@ -32,6 +40,9 @@
 #  include <vtkRenderWindow.h>
 #  include <vtkRenderer.h>
 #  include <vtkWindowToImageFilter.h>
+#  include <vtkImageWriter.h>
+#  include <vtkJPEGWriter.h>
+#  include <vtkPNGWriter.h>
 #endif
 #ifdef ENABLE_CATALYST
 #  include <vtkIceTCompositePass.h>
@@ -235,6 +246,195 @@ bool pixelComp(Pixel& a, Pixel& b)
   return a.Depth < b.Depth;
 }
 
+// --------------------------------------------------------------------------
+// Asynchronous writer
+// --------------------------------------------------------------------------
+
+// Runs image encoding and file writing tasks on a few background threads so
+// that the caller can move on to the next camera position. The queue is
+// bounded, a slow file system blocks the caller rather than letting images
+// pile up in memory. With no threads tasks run immediately.
+class AsyncWriter
+{
+public:
+  using Task = std::function<void()>;
+
+  AsyncWriter() : MaxQueued(64), Active(0), Stop(false) {}
+  ~AsyncWriter() { this->SetNumberOfThreads(0); }
+
+  void SetNumberOfThreads(int n)
+  {
+    // finish queued work and stop the current threads
+    {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->Stop = true;
+    }
+    this->WorkReady.notify_all();
+    for (size_t i = 0; i < this->Threads.size(); ++i)
+      {
+      this->Threads[i].join();
+      }
+    this->Threads.clear();
+    this->Stop = false;
+
+    for (int i = 0; i < n; ++i)
+      {
+      this->Threads.emplace_back(&AsyncWriter::Work, this);
+      }
+  }
+
+  int GetNumberOfThreads() const { return static_cast<int>(this->Threads.size()); }
+
+  void Push(Task task)
+  {
+    if (this->Threads.empty())
+      {
+      task();
+      return;
+      }
+
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->SpaceReady.wait(lock, [this]() { return this->Tasks.size() < this->MaxQueued; });
+    this->Tasks.push_back(std::move(task));
+    lock.unlock();
+
+    this->WorkReady.notify_one();
+  }
+
+  // blocks until every task pushed so far is done
+  void Flush()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->SpaceReady.wait(lock, [this]() { return this->Tasks.empty() && (this->Active == 0); });
+  }
+
+private:
+  void Work()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (true)
+      {
+      this->WorkReady.wait(lock, [this]() { return this->Stop || !this->Tasks.empty(); });
+      if (this->Tasks.empty())
+        {
+        return; // stopping and drained
+        }
+
+      Task task = std::move(this->Tasks.front());
+      this->Tasks.pop_front();
+      ++this->Active;
+      lock.unlock();
+
+      task();
+
+      lock.lock();
+      --this->Active;
+      this->SpaceReady.notify_all();
+      }
+  }
+
+  size_t MaxQueued;
+  int Active;
+  bool Stop;
+  std::deque<Task> Tasks;
+  std::vector<std::thread> Threads;
+  std::mutex Mutex;
+  std::condition_variable WorkReady;
+  std::condition_variable SpaceReady;
+};
+
+// --------------------------------------------------------------------------
+void writeBuffer(const std::string& fileName, const char* data, size_t nBytes)
+{
+  std::ofstream fp(fileName.c_str(), ios::out | ios::binary);
+  if (fp.fail())
+    {
+    std::cout << "Unable to open file: "<< fileName.c_str() << std::endl;
+    return;
+    }
+  fp.write(data, nBytes);
+  fp.flush();
+  fp.close();
+}
+
+#if defined(ENABLE_CATALYST) || defined (ENABLE_VTK_RENDERING)
+// --------------------------------------------------------------------------
+// Encodes an image with the named writer, vtkJPEGWriter or vtkPNGWriter
+void writeImage(vtkImageData* image, const std::string& fileName, const std::string& writerName)
+{
+  vtkSmartPointer<vtkImageWriter> writer;
+  if (writerName == "vtkJPEGWriter")
+    {
+    writer = vtkSmartPointer<vtkJPEGWriter>::New();
+    }
+  else
+    {
+    writer = vtkSmartPointer<vtkPNGWriter>::New();
+    }
+  writer->SetInputData(image);
+  writer->SetFileName(fileName.c_str());
+  writer->Write();
+}
+#endif
+
+// --------------------------------------------------------------------------
+// Sorts the layers of each pixel by depth and writes the order and intensity
+// stacks of a sorted composite image
+void writeSortedComposite(const std::vector<vtkSmartPointer<vtkFloatArray>>& zBuffers,
+  const std::vector<vtkSmartPointer<vtkUnsignedCharArray>>& luminances,
+  const std::string& orderFileName, const std::string& intensityFileName)
+{
+  size_t compositeSize = zBuffers.size();
+  size_t linearSize = compositeSize ? zBuffers[0]->GetNumberOfTuples() : 0;
+  size_t stackSize = linearSize * compositeSize;
+
+  std::vector<unsigned char> orderArray(stackSize);
+  std::vector<Pixel> pixelSorter(compositeSize);
+
+  for (size_t pixelId = 0; pixelId < linearSize; pixelId++)
+    {
+    // Fill pixelSorter
+    for (size_t layerIdx = 0; layerIdx < compositeSize; layerIdx++)
+      {
+      float depth = zBuffers[layerIdx]->GetValue(pixelId);
+      if (depth < 1.0)
+        {
+        pixelSorter[layerIdx].Index = (unsigned char)layerIdx;
+        pixelSorter[layerIdx].Depth = depth;
+        }
+      else
+        {
+        pixelSorter[layerIdx].Index = 255;
+        pixelSorter[layerIdx].Depth = 1.0;
+        }
+      }
+
+    // Sort pixels
+    std::sort(pixelSorter.begin(), pixelSorter.end(), pixelComp);
+
+    // Fill sortedOrder array
+    for (size_t layerIdx = 0; layerIdx < compositeSize; layerIdx++)
+      {
+      orderArray[layerIdx * linearSize + pixelId] = pixelSorter[layerIdx].Index;
+      }
+    }
+
+  // Write order file
+  writeBuffer(orderFileName, (char*)orderArray.data(), stackSize);
+
+  // Compute intensity data
+  std::vector<unsigned char> intensityArray(stackSize);
+  for (size_t idx = 0; idx < stackSize; idx++)
+    {
+    size_t layerIdx = orderArray[idx];
+    intensityArray[idx] = layerIdx < 255 ?
+      luminances[layerIdx]->GetValue(idx % linearSize) : 0;
+    }
+
+  // Write light intensity file
+  writeBuffer(intensityFileName, (char*)intensityArray.data(), stackSize);
+}
+
 // --------------------------------------------------------------------------
 // Internals
 // --------------------------------------------------------------------------
@@ -251,7 +451,10 @@ struct CinemaHelper::Internals
   double* CameraArgs;
   bool IsRoot;
   int PID;
+  int NumberOfProcesses;
   int CurrentCameraPosition;
+  AsyncWriter Writer;
+  bool RoundRobinWriting;
 #ifdef ENABLE_CATALYST
   std::vector<vtkSmartPointer<vtkSMRepresentationProxy>> Representations;
 #endif
@@ -274,7 +477,7 @@ struct CinemaHelper::Internals
   std::vector<std::string> JSONCompositePipeline;
 
 
-  Internals() : NumberOfTimeSteps(0), NumberOfCameraPositions(0), CameraPositions(nullptr), NumberOfCameraArgs(0), CameraArgs(nullptr), CurrentCameraPosition(0), LAYER_CODES("ABCDEFGHIJKLMNOPQRSTUVWXYZ")
+  Internals() : NumberOfTimeSteps(0), NumberOfCameraPositions(0), CameraPositions(nullptr), NumberOfCameraArgs(0), CameraArgs(nullptr), CurrentCameraPosition(0), RoundRobinWriting(false), LAYER_CODES("ABCDEFGHIJKLMNOPQRSTUVWXYZ")
   {
     this->ImageSize[0] = this->ImageSize[1] = 512;
     this->SampleSize = 1024;
@@ -282,12 +485,21 @@ struct CinemaHelper::Internals
     vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
     this->IsRoot = (controller->GetLocalProcessId() == 0);
     this->PID = controller->GetLocalProcessId();
+    this->NumberOfProcesses = controller->GetNumberOfProcesses();
 #else
     this->IsRoot = true;
     this->PID = 0;
+    this->NumberOfProcesses = 1;
 #endif
   }
 
+  // the rank that writes the output of the current time step
+  int GetWriterRank()
+  {
+    return this->RoundRobinWriting ?
+      this->NumberOfTimeSteps % this->NumberOfProcesses : 0;
+  }
+
   ~Internals()
   {
     if (this->CameraPositions)
@@ -329,6 +541,121 @@ struct CinemaHelper::Internals
     return resultPath.str();
   }
 
+#if defined(ENABLE_CATALYST) || defined (ENABLE_VTK_MPI)
+  // moves the layers captured on rank 0 to the rank that writes the current
+  // time step. this is collective, returns true on the writing rank.
+  bool MoveToWriter(std::vector<vtkSmartPointer<vtkFloatArray>>& zBuffers,
+    std::vector<vtkSmartPointer<vtkUnsignedCharArray>>& luminances, size_t nLayers)
+  {
+    int writer = this->GetWriterRank();
+    if (writer == 0)
+      {
+      return this->IsRoot;
+      }
+
+    vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+    if (this->IsRoot)
+      {
+      for (size_t i = 0; i < nLayers; ++i)
+        {
+        controller->Send(zBuffers[i].GetPointer(), writer, 7001);
+        controller->Send(luminances[i].GetPointer(), writer, 7002);
+        }
+      zBuffers.clear();
+      luminances.clear();
+      return false;
+      }
+
+    if (this->PID == writer)
+      {
+      zBuffers.resize(nLayers);
+      luminances.resize(nLayers);
+      for (size_t i = 0; i < nLayers; ++i)
+        {
+        zBuffers[i] = vtkSmartPointer<vtkFloatArray>::New();
+        controller->Receive(zBuffers[i].GetPointer(), 0, 7001);
+        luminances[i] = vtkSmartPointer<vtkUnsignedCharArray>::New();
+        controller->Receive(luminances[i].GetPointer(), 0, 7002);
+        }
+      return true;
+      }
+
+    return false;
+  }
+
+  // moves an image on rank 0 to the rank that writes the current time step.
+  // this is collective, returns true on the writing rank.
+  bool MoveToWriter(vtkSmartPointer<vtkImageData>& image)
+  {
+    int writer = this->GetWriterRank();
+    if (writer == 0)
+      {
+      return this->IsRoot;
+      }
+
+    vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+    if (this->IsRoot)
+      {
+      controller->Send(image.GetPointer(), writer, 7003);
+      image = nullptr;
+      return false;
+      }
+
+    if (this->PID == writer)
+      {
+      image = vtkSmartPointer<vtkImageData>::New();
+      controller->Receive(image.GetPointer(), 0, 7003);
+      return true;
+      }
+
+    return false;
+  }
+
+  // moves SampleSize values on rank 0 to the rank that writes the current
+  // time step. this is collective, returns true on the writing rank.
+  bool MoveToWriter(std::vector<float>& values)
+  {
+    int writer = this->GetWriterRank();
+    if (writer == 0)
+      {
+      return this->IsRoot;
+      }
+
+    vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+    if (this->IsRoot)
+      {
+      controller->Send(values.data(), values.size(), writer, 7004);
+      values.clear();
+      return false;
+      }
+
+    if (this->PID == writer)
+      {
+      values.resize(this->SampleSize);
+      controller->Receive(values.data(), values.size(), 0, 7004);
+      return true;
+      }
+
+    return false;
+  }
+#else
+  bool MoveToWriter(std::vector<vtkSmartPointer<vtkFloatArray>>&,
+    std::vector<vtkSmartPointer<vtkUnsignedCharArray>>&, size_t)
+  {
+    return this->IsRoot;
+  }
+
+  bool MoveToWriter(vtkSmartPointer<vtkImageData>&)
+  {
+    return this->IsRoot;
+  }
+
+  bool MoveToWriter(std::vector<float>&)
+  {
+    return this->IsRoot;
+  }
+#endif
+
   void UpdateSphericalCameraPosition(double* initialFocalPoint, double* initialPosition, double* initialViewUp, int numberOfPhi, double* phiAngles, int numberOfTheta, double* thetaAngles)
   {
     // Reserve args for Phi and Theta
@@ -492,6 +819,31 @@ void CinemaHelper::SetSampleSize(int ssz)
   this->Data->SampleSize = ssz;
 }
 
+// --------------------------------------------------------------------------
+void CinemaHelper::SetNumberOfWriterThreads(int n)
+{
+  this->Data->Writer.SetNumberOfThreads(n);
+}
+
+// --------------------------------------------------------------------------
+int CinemaHelper::GetNumberOfWriterThreads()
+{
+  return this->Data->Writer.GetNumberOfThreads();
+}
+
+// --------------------------------------------------------------------------
+void CinemaHelper::SetRoundRobinWriting(bool val)
+{
+  this->Data->RoundRobinWriting = val;
+}
+
+// --------------------------------------------------------------------------
+void CinemaHelper::Flush()
+{
+  TimeEvent<128> mark("CinemaHelper::Flush");
+  this->Data->Writer.Flush();
+}
+
 // --------------------------------------------------------------------------
 void CinemaHelper::AddTimeEntry()
 {
@@ -1033,98 +1385,21 @@ void CinemaHelper::CaptureSortedCompositeData(vtkSMRenderViewProxy* view)
     view->InvokeCommand("StopCaptureLuminance");
     }
 
-  // Post process arrays to write proper data structure
-  if (!this->Data->IsRoot)
+  // Post process arrays to write proper data structure. this happens on
+  // the rank that writes this time step, in the background if writer
+  // threads are enabled
+  if (!this->Data->MoveToWriter(zBuffers, luminances, compositeSize))
     {
-    // Skip post processing if not root...
     return;
     }
 
-  int stackSize = linearSize * compositeSize;
-  vtkNew<vtkUnsignedCharArray> orderArray;
-  orderArray->SetNumberOfComponents(1);
-  orderArray->SetNumberOfTuples(stackSize);
-  std::vector<Pixel> pixelSorter;
-  while (pixelSorter.size() < compositeSize)
-    {
-    pixelSorter.push_back(Pixel());
-    }
-
-  for (int pixelId = 0; pixelId < linearSize; pixelId++)
-    {
-    // Fill pixelSorter
-    for (size_t layerIdx = 0; layerIdx < compositeSize; layerIdx++)
-      {
-      float depth = zBuffers[layerIdx]->GetValue(pixelId);
-      if (depth < 1.0)
-        {
-        pixelSorter[layerIdx].Index = (unsigned char)layerIdx;
-        pixelSorter[layerIdx].Depth = depth;
-        }
-      else
-        {
-        pixelSorter[layerIdx].Index = 255;
-        pixelSorter[layerIdx].Depth = 1.0;
-        }
-      }
-
-    // Sort pixels
-    std::sort(pixelSorter.begin(), pixelSorter.end(), pixelComp);
-
-    // Fill sortedOrder array
-    for (size_t layerIdx = 0; layerIdx < compositeSize; layerIdx++)
-      {
-      orderArray->SetValue(layerIdx * linearSize + pixelId, pixelSorter[layerIdx].Index);
-      }
-    }
-
-  // Write order file
   std::string orderFileName = this->Data->getDataAbsoluteFilePath("order.uint8", true);
-  std::ofstream fp(orderFileName.c_str(), ios::out | ios::binary);
-
-  if (fp.fail())
-    {
-    std::cout << "Unable to open file: "<< orderFileName.c_str() << std::endl;
-    }
-  else
-    {
-    fp.write((char*)orderArray->GetPointer(0), stackSize);
-    fp.flush();
-    fp.close();
-    }
-
-  // Compute intensity data
-  vtkNew<vtkUnsignedCharArray> intensityArray;
-  intensityArray->SetNumberOfComponents(1);
-  intensityArray->SetNumberOfTuples(stackSize);
-  for (int idx = 0; idx < stackSize; idx++)
-    {
-    int layerIdx = orderArray->GetValue(idx);
-    if (layerIdx < 255)
-      {
-      intensityArray->SetValue(idx, luminances[layerIdx]->GetValue(idx % linearSize));
-      }
-    else
-      {
-      intensityArray->SetValue(idx, 0);
-      }
-
-    }
-
-  // Write light intensity file
   std::string intensityFileName = this->Data->getDataAbsoluteFilePath("intensity.uint8", true);
-  std::ofstream fpItensity(intensityFileName.c_str(), ios::out | ios::binary);
 
-  if (fpItensity.fail())
-    {
-    std::cout << "Unable to open file: "<< intensityFileName.c_str() << std::endl;
-    }
-  else
+  this->Data->Writer.Push([zBuffers, luminances, orderFileName, intensityFileName]()
     {
-    fpItensity.write((char*)intensityArray->GetPointer(0), stackSize);
-    fpItensity.flush();
-    fpItensity.close();
-    }
+    writeSortedComposite(zBuffers, luminances, orderFileName, intensityFileName);
+    });
 }
 #endif // ENABLE_CATALYST
 
@@ -1180,6 +1455,114 @@ vtkImageData* CinemaHelper::CaptureWindow(vtkRenderWindow* renderWindow)
 }
 #endif
 
+#if defined(ENABLE_CATALYST) || defined (ENABLE_VTK_RENDERING)
+// --------------------------------------------------------------------------
+void CinemaHelper::Capture(vtkRenderWindow* renderWindow, vtkRenderer* renderer)
+{
+  if (this->Data->CaptureMethod == "CaptureImage")
+    {
+    this->CaptureCompositedImages(renderWindow, renderer, "_.jpg", "vtkJPEGWriter");
+    }
+}
+
+// --------------------------------------------------------------------------
+void CinemaHelper::CaptureCompositedImages(vtkRenderWindow* renderWindow,
+  vtkRenderer* renderer, const std::string& fileName, const std::string& writerName)
+{
+  TimeEvent<128> mark("CinemaHelper::CaptureCompositedImages");
+
+  int width = static_cast<int>(this->Data->ImageSize[0]);
+  int height = static_cast<int>(this->Data->ImageSize[1]);
+  long nPixels = static_cast<long>(width) * height;
+
+  int nViews = std::max(1, this->Data->NumberOfCameraPositions);
+
+  // the depths of the ranks are only comparable when all use the same
+  // clipping range, it's set from the bounds of all of the data
+  double bounds[6];
+  renderer->ComputeVisiblePropBounds(bounds);
+  for (int q = 0; q < 3; ++q)
+    {
+    bounds[2 * q + 1] = -bounds[2 * q + 1];
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, bounds, 6, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+
+  for (int q = 0; q < 3; ++q)
+    {
+    bounds[2 * q + 1] = -bounds[2 * q + 1];
+    }
+
+  // render the local data only from each camera position, the views are
+  // stacked and composited below in one exchange
+  std::vector<float> depth(nViews * nPixels);
+  std::vector<unsigned char> rgba(4 * nViews * nPixels);
+
+  int swapBuffers = renderWindow->GetSwapBuffers();
+  renderWindow->SwapBuffersOff();
+  renderWindow->SetSize(width, height);
+
+  vtkNew<vtkUnsignedCharArray> pixels;
+  for (int i = 0; i < nViews; ++i)
+    {
+    this->ApplyCameraPosition(renderer->GetActiveCamera(), i);
+    renderer->ResetCameraClippingRange(bounds);
+    renderWindow->Render();
+
+    renderWindow->GetZbufferData(0, 0, width - 1, height - 1, depth.data() + i * nPixels);
+
+    renderWindow->GetRGBACharPixelData(0, 0, width - 1, height - 1, 0, pixels.Get());
+    const unsigned char* ppx = pixels->GetPointer(0);
+    std::copy(ppx, ppx + 4 * nPixels, rgba.begin() + 4 * i * nPixels);
+    }
+
+  renderWindow->SetSwapBuffers(swapBuffers);
+
+  ImageCompositor compositor;
+  compositor.SetRoot(this->Data->GetWriterRank());
+  if (compositor.Composite(width, height, nViews, depth, rgba))
+    {
+    return;
+    }
+
+  // only the root holds the composited images
+  long first = 0, last = 0;
+  compositor.GetPixelRange(first, last);
+  if (last - first != nViews * nPixels)
+    {
+    return;
+    }
+
+  for (int i = 0; i < nViews; ++i)
+    {
+    vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+    image->SetDimensions(width, height, 1);
+
+    vtkNew<vtkUnsignedCharArray> rgb;
+    rgb->SetName("RGB");
+    rgb->SetNumberOfComponents(3);
+    rgb->SetNumberOfTuples(nPixels);
+    unsigned char* prgb = rgb->GetPointer(0);
+    const unsigned char* prgba = rgba.data() + 4 * i * nPixels;
+    for (long j = 0; j < nPixels; ++j)
+      {
+      prgb[3 * j] = prgba[4 * j];
+      prgb[3 * j + 1] = prgba[4 * j + 1];
+      prgb[3 * j + 2] = prgba[4 * j + 2];
+      }
+    image->GetPointData()->SetScalars(rgb.Get());
+
+    this->Data->CurrentCameraPosition = i;
+    std::string filePath = this->Data->getDataAbsoluteFilePath(fileName, true);
+
+    this->Data->Writer.Push([image, filePath, writerName]()
+      {
+      writeImage(image, filePath, writerName);
+      });
+    }
+}
+#endif
+
 #ifdef ENABLE_CATALYST
 // --------------------------------------------------------------------------
 void CinemaHelper::CaptureSortedCompositeData(vtkRenderWindow* renderWindow, vtkRenderer* renderer,
@@ -1263,104 +1646,49 @@ void CinemaHelper::CaptureSortedCompositeData(vtkRenderWindow* renderWindow, vtk
       }
     }
 
-  // Post process arrays to write proper data structure
-  if (!this->Data->IsRoot)
+  // Post process arrays to write proper data structure. this happens on
+  // the rank that writes this time step, in the background if writer
+  // threads are enabled
+  if (!this->Data->MoveToWriter(zBuffers, luminances, compositeSize))
     {
-    // Skip post processing if not root...
     return;
     }
 
-  size_t stackSize = linearSize * compositeSize;
-  vtkNew<vtkUnsignedCharArray> orderArray;
-  orderArray->SetNumberOfComponents(1);
-  orderArray->SetNumberOfTuples(stackSize);
-  std::vector<Pixel> pixelSorter;
-  while (pixelSorter.size() < compositeSize)
-    {
-    pixelSorter.push_back(Pixel());
-    }
+  std::string orderFileName = this->Data->getDataAbsoluteFilePath("order.uint8", true);
+  std::string intensityFileName = this->Data->getDataAbsoluteFilePath("intensity.uint8", true);
 
-  for (size_t pixelId = 0; pixelId < linearSize; pixelId++)
+  this->Data->Writer.Push([zBuffers, luminances, orderFileName, intensityFileName]()
     {
-    // Fill pixelSorter
-    for (size_t layerIdx = 0; layerIdx < compositeSize; layerIdx++)
-      {
-      float depth = zBuffers[layerIdx]->GetValue(pixelId);
-      if (depth < 1.0)
-        {
-        pixelSorter[layerIdx].Index = (unsigned char)layerIdx;
-        pixelSorter[layerIdx].Depth = depth;
-        }
-      else
-        {
-        pixelSorter[layerIdx].Index = 255;
-        pixelSorter[layerIdx].Depth = 1.0;
-        }
-      }
-
-    // Sort pixels
-    std::sort(pixelSorter.begin(), pixelSorter.end(), pixelComp);
-
-    // Fill sortedOrder array
-    for (size_t layerIdx = 0; layerIdx < compositeSize; layerIdx++)
-      {
-      orderArray->SetValue(layerIdx * linearSize + pixelId, pixelSorter[layerIdx].Index);
-      }
-    }
+    writeSortedComposite(zBuffers, luminances, orderFileName, intensityFileName);
+    });
+}
 
-  // Write order file
-  std::string orderFileName = this->Data->getDataAbsoluteFilePath("order.uint8", true);
-  std::ofstream fp(orderFileName.c_str(), ios::out | ios::binary);
+// --------------------------------------------------------------------------
+void CinemaHelper::CaptureImage(vtkSMViewProxy* view, const std::string fileName, const std::string writerName, double scale, bool createDirectory)
+{
+  TimeEvent<128> mark("CinemaHelper::CaptureImage");
 
-  if (fp.fail())
-    {
-    std::cout << "Unable to open file: "<< orderFileName.c_str() << std::endl;
-    }
-  else
+  // the composited image is available on rank 0
+  vtkSmartPointer<vtkImageData> image;
+  image.TakeReference(view->CaptureImage(static_cast<int>(scale)));
+  if (!this->Data->IsRoot)
     {
-    fp.write((char*)orderArray->GetPointer(0), stackSize);
-    fp.flush();
-    fp.close();
+    image = nullptr;
     }
 
-  // Compute intensity data
-  vtkNew<vtkUnsignedCharArray> intensityArray;
-  intensityArray->SetNumberOfComponents(1);
-  intensityArray->SetNumberOfTuples(stackSize);
-  for (size_t idx = 0; idx < stackSize; idx++)
+  // encode and write on the rank that writes this time step, in the
+  // background if writer threads are enabled
+  if (!this->Data->MoveToWriter(image) || !image)
     {
-    size_t layerIdx = orderArray->GetValue(idx);
-    if (layerIdx < 255)
-      {
-      intensityArray->SetValue(idx, luminances[layerIdx]->GetValue(idx % linearSize));
-      }
-    else
-      {
-      intensityArray->SetValue(idx, 0);
-      }
-
+    return;
     }
 
-  // Write light intensity file
-  std::string intensityFileName = this->Data->getDataAbsoluteFilePath("intensity.uint8", true);
-  std::ofstream fpItensity(intensityFileName.c_str(), ios::out | ios::binary);
+  std::string filePath = this->Data->getDataAbsoluteFilePath(fileName, createDirectory);
 
-  if (fpItensity.fail())
+  this->Data->Writer.Push([image, filePath, writerName]()
     {
-    std::cout << "Unable to open file: "<< intensityFileName.c_str() << std::endl;
-    }
-  else
-    {
-    fpItensity.write((char*)intensityArray->GetPointer(0), stackSize);
-    fpItensity.flush();
-    fpItensity.close();
-    }
-}
-
-// --------------------------------------------------------------------------
-void CinemaHelper::CaptureImage(vtkSMViewProxy* view, const std::string fileName, const std::string writerName, double scale, bool createDirectory)
-{
-  view->WriteImage(this->Data->getDataAbsoluteFilePath(fileName, createDirectory).c_str(), writerName.c_str(), scale);
+    writeImage(image, filePath, writerName);
+    });
 }
 #endif // ENABLE_CATALYST
 
@@ -1433,62 +1761,53 @@ void CinemaHelper::WriteVolume(vtkImageData* image)
   // Write volume.data
   std::string dataFileName = this->Data->getDataAbsoluteFilePath(dataName, true);
   // std::cout << "write volume: " << dataFileName.c_str() << std::endl;
-  std::ofstream filePointer(dataFileName.c_str(), ios::out | ios::binary);
 
-  if (filePointer.fail())
-    {
-    std::cout << "Unable to open file: "<< dataFileName.c_str() << std::endl;
-    }
-  else
+  vtkSmartPointer<vtkFloatArray> data = vtkSmartPointer<vtkFloatArray>::New();
+  data->DeepCopy(array);
+
+  this->Data->Writer.Push([data, dataFileName]()
     {
-    int stackSize = array->GetNumberOfTuples() * 4;
-    filePointer.write((char*)array->GetVoidPointer(0), stackSize);
-    filePointer.flush();
-    filePointer.close();
-    }
+    writeBuffer(dataFileName, (char*)data->GetVoidPointer(0),
+      data->GetNumberOfTuples() * 4);
+    });
 }
 
 void CinemaHelper::WriteCDF(long long totalArraySize, const double* cdfValues)
 {
-  if (!this->Data->IsRoot)
-  {
-    return;
-  }
-  std::string dataName = "cdf.float32";
-  std::string dataFilePath = this->Data->getDataAbsoluteFilePath(dataName, true);
-  std::ofstream dataFilePathPointer(dataFilePath.c_str(), std::ios::out | std::ios::binary);
-  if (dataFilePathPointer.fail())
+  // the CDF is on rank 0, it is written by the rank that writes this time
+  // step
+  std::vector<float> cdfFloats;
+  if (this->Data->IsRoot)
   {
-    std::cout << "Unable to open file: " << dataFilePath.c_str() << std::endl;
+    cdfFloats.assign(cdfValues, cdfValues + this->Data->SampleSize);
   }
-  else
+
+  if (this->Data->MoveToWriter(cdfFloats))
   {
-    long long stackSize = this->Data->SampleSize * 4;
-    std::vector<float> cdfFloats(cdfValues, cdfValues + this->Data->SampleSize);
-    /*
-    float* cdfFloats = new float[cdfSize];
-    for (int i = 0; i < cdfSize; i++)
+    std::string dataName = "cdf.float32";
+    std::string dataFilePath = this->Data->getDataAbsoluteFilePath(dataName, true);
+
+    this->Data->Writer.Push([cdfFloats, dataFilePath]()
     {
-    cdfFloats[i] = (float)cdfValues[i];
-    }
+      writeBuffer(dataFilePath, (char*)cdfFloats.data(), cdfFloats.size() * 4);
+    });
+  }
 
-    dataFilePathPointer.write((char*)cdfFloats, stackSize);
-    */
-    dataFilePathPointer.write((char*)&cdfFloats[0], stackSize);
-    dataFilePathPointer.flush();
-    dataFilePathPointer.close();
-    this->Data->JSONData["cdf"] =
-      "{\n"
-      "    \"pattern\": \"{time}/cdf.float32\",\n"
-      "    \"name\": \"cdf\",\n"
-      "    \"type\": \"arraybuffer\"\n"
-      "}\n"
-      ;
-    std::ostringstream xmeta;
-    xmeta << "   ,\"totalCount\": " << totalArraySize;
-    this->Data->JSONExtraMetadata = xmeta.str();
-    //delete[] cdfFloats;
+  if (!this->Data->IsRoot)
+  {
+    return;
   }
+
+  this->Data->JSONData["cdf"] =
+    "{\n"
+    "    \"pattern\": \"{time}/cdf.float32\",\n"
+    "    \"name\": \"cdf\",\n"
+    "    \"type\": \"arraybuffer\"\n"
+    "}\n"
+    ;
+  std::ostringstream xmeta;
+  xmeta << "   ,\"totalCount\": " << totalArraySize;
+  this->Data->JSONExtraMetadata = xmeta.str();
 }
 
 }
@@ -32,6 +32,18 @@ public:
     void AddTimeEntry();
     void WriteMetadata();
 
+    // Output handling
+    // With n > 0 threads, images are encoded and written in the background
+    // and the caller moves on to the next camera position. 0 (the default)
+    // writes synchronously.
+    void SetNumberOfWriterThreads(int n);
+    int GetNumberOfWriterThreads();
+    // Write the images, composites and CDF of time step i on rank i % size
+    // rather than on rank 0
+    void SetRoundRobinWriting(bool val);
+    // Block until all queued output is on disk
+    void Flush();
+
     // Camera handling
     void SetCameraConfig(const std::string& config);
     int GetNumberOfCameraPositions();
@@ -68,6 +80,16 @@ public:
 #if defined(ENABLE_CATALYST) || defined (ENABLE_VTK_RENDERING)
     void Render(vtkRenderWindow* renderWindow);
     vtkImageData* CaptureWindow(vtkRenderWindow* renderWindow);
+    // Render the local data of each rank from every camera position and
+    // composite all of the views by depth with ImageCompositor in a single
+    // exchange. The images are written by the rank that writes the current
+    // time step. This is collective.
+    void CaptureCompositedImages(vtkRenderWindow* renderWindow, vtkRenderer* renderer,
+      const std::string& fileName, const std::string& writerName);
+
+    // Generic Methods. Unlike the view proxy version this captures every
+    // camera position of the time step.
+    void Capture(vtkRenderWindow* renderWindow, vtkRenderer* renderer);
 #endif
 
 #ifdef ENABLE_CATALYST
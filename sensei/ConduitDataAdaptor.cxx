@@ -15,6 +15,7 @@
 #include <vtkUnsignedLongLongArray.h>
 #include <vtkFloatArray.h>
 #include <vtkDoubleArray.h>
+#include <vtkAOSDataArrayTemplate.h>
 
 #include <vtkDataSetAttributes.h>
 #include <vtkImageData.h>
@@ -82,44 +83,52 @@ static inline int VTKCellTypeSize( int cell_type )
 }
 
 //-----------------------------------------------------------------------------
-template<typename T> void Blueprint_MultiCompArray_To_VTKDataArray( const conduit::Node &n, int ncomps, int ntuples, vtkDataArray *darray )
+template<typename T> void Blueprint_MultiCompArray_To_VTKDataArray( const conduit::Node &n, int ncomps, int ntuples, vtkAOSDataArrayTemplate<T> *darray )
 {
+  if( (n.number_of_children() == 0) && n.dtype().is_compact() )
+  {
+    // contiguous single component data, for instance an external view of
+    // simulation memory, is passed to VTK zero-copy. the node is only valid
+    // until ReleaseData, as is the VTK data built from it.
+    darray->SetNumberOfComponents( 1 );
+    darray->SetArray( static_cast<T*>(const_cast<void*>(n.element_ptr(0))), ntuples, 1 );
+    return;
+  }
+
   // vtk reqs us to set number of comps before number of tuples
-  if( ncomps == 2 ) // we need 3 comps for vectors
-    darray->SetNumberOfComponents( 3 );
-  else
-    darray->SetNumberOfComponents( ncomps );
- 
+  int vtk_ncomps = ncomps == 2 ? 3 : ncomps; // we need 3 comps for vectors
+  darray->SetNumberOfComponents( vtk_ncomps );
+
   // set number of tuples
   darray->SetNumberOfTuples( ntuples );
-        
+
+  // gather strided and/or multi-component data, conduit::DataArray handles
+  // the offset and stride of each component
+  T *dest = darray->GetPointer( 0 );
   if( n.number_of_children() > 0 )
   {
     // handle multi-component case
-    for(vtkIdType c=0; c < ncomps ;++c)
+    for(int c = 0; c < ncomps ;++c)
     {
       conduit::DataArray<T> vals_array = n[c].value();
 
       for(vtkIdType i = 0; i < ntuples ;++i)
-      {
-        darray->SetComponent( i, c, (double)vals_array[i] );
+        dest[i*vtk_ncomps + c] = vals_array[i];
+    }
 
-        if( ncomps == 2 )
-        {
-          darray->SetComponent( i, 2, 0.0 );
-        }
-      }
+    if( ncomps == 2 )
+    {
+      for(vtkIdType i = 0; i < ntuples ;++i)
+        dest[i*vtk_ncomps + 2] = T(0);
     }
   }
   else
   {
-    // single array case
+    // single strided array case
     conduit::DataArray<T> vals_array = n.value();
 
     for(vtkIdType i = 0; i < ntuples ;++i)
-    {
-      darray->SetComponent( i, 0, (double)vals_array[i] );
-    }
+      dest[i] = vals_array[i];
   }
 }
 
@@ -158,48 +167,57 @@ vtkDataArray * ConduitArrayToVTKDataArray( const conduit::Node &n )
     
   if( vals_dtype.is_unsigned_char() )
   {
-    retval = vtkUnsignedCharArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_UNSIGNED_CHAR>( n, ncomps, ntuples, retval );
+    vtkUnsignedCharArray *darray = vtkUnsignedCharArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_UNSIGNED_CHAR>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_unsigned_short() )
   {
-    retval = vtkUnsignedShortArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_UNSIGNED_SHORT>( n, ncomps, ntuples, retval );
+    vtkUnsignedShortArray *darray = vtkUnsignedShortArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_UNSIGNED_SHORT>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_unsigned_int() )
   {
-    retval = vtkUnsignedIntArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_UNSIGNED_INT>( n, ncomps, ntuples, retval );
+    vtkUnsignedIntArray *darray = vtkUnsignedIntArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_UNSIGNED_INT>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_char() )
   {
-    retval = vtkCharArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_CHAR>( n, ncomps, ntuples, retval );
+    vtkCharArray *darray = vtkCharArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_CHAR>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_short() )
   {
-    retval = vtkShortArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_SHORT>( n, ncomps, ntuples, retval );
+    vtkShortArray *darray = vtkShortArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_SHORT>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_int() )
   {
-    retval = vtkIntArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_INT>( n, ncomps, ntuples, retval );
+    vtkIntArray *darray = vtkIntArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_INT>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_long() )
   {
-    retval = vtkLongArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_LONG>( n, ncomps, ntuples, retval );
+    vtkLongArray *darray = vtkLongArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_LONG>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_float() )
   {
-    retval = vtkFloatArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_FLOAT>( n, ncomps, ntuples, retval );
+    vtkFloatArray *darray = vtkFloatArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_FLOAT>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else if( vals_dtype.is_double() )
   {
-    retval = vtkDoubleArray::New();
-    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_DOUBLE>( n, ncomps, ntuples, retval );
+    vtkDoubleArray *darray = vtkDoubleArray::New();
+    Blueprint_MultiCompArray_To_VTKDataArray<CONDUIT_NATIVE_DOUBLE>( n, ncomps, ntuples, darray );
+    retval = darray;
   }
   else
   {
@@ -13,6 +13,7 @@
 #include "senseiConfig.h"
 #include "Error.h"
 #include "Profiler.h"
+#include "AllocationTracker.h"
 #include "VTKUtils.h"
 #include "XMLUtils.h"
 #include "STLUtils.h"
@@ -20,6 +21,8 @@
 
 #include "Autocorrelation.h"
 #include "Histogram.h"
+#include "Statistics.h"
+#include "ParticleDeposition.h"
 #ifdef ENABLE_VTK_IO
 #include "VTKPosthocIO.h"
 #ifdef ENABLE_VTK_MPI
@@ -42,6 +45,8 @@
 #ifdef ENABLE_HDF5
 #include "HDF5AnalysisAdaptor.h"
 #endif
+#include "MMapAnalysisAdaptor.h"
+#include "MPIAnalysisAdaptor.h"
 #ifdef ENABLE_CATALYST
 #include "CatalystAnalysisAdaptor.h"
 #include "CatalystParticle.h"
@@ -96,10 +101,14 @@ struct ConfigurableAnalysis::InternalsType
   int AddAdios1(pugi::xml_node node);
   int AddAdios2(pugi::xml_node node);
   int AddHDF5(pugi::xml_node node);
+  int AddMMap(pugi::xml_node node);
+  int AddMPI(pugi::xml_node node);
   int AddAscent(pugi::xml_node node);
   int AddCatalyst(pugi::xml_node node);
   int AddLibsim(pugi::xml_node node);
   int AddAutoCorrelation(pugi::xml_node node);
+  int AddStatistics(pugi::xml_node node);
+  int AddParticleDeposition(pugi::xml_node node);
   int AddPosthocIO(pugi::xml_node node);
   int AddVTKAmrWriter(pugi::xml_node node);
   int AddPythonAnalysis(pugi::xml_node node);
@@ -264,6 +273,8 @@ int ConfigurableAnalysis::InternalsType::AddVTKmVolumeReduction(pugi::xml_node n
   auto reducer = vtkSmartPointer<VTKmVolumeReductionAnalysis>::New();
   this->TimeInitialization(reducer, [&]() {
     reducer->Initialize(mesh, field, assoc, workDir, reduction, this->Comm);
+    reducer->SetNumberOfWriterThreads(node.attribute("writer-threads").as_int(0));
+    reducer->SetRoundRobinWriting(node.attribute("round-robin").as_int(0));
     return 0;
   });
   this->Analyses.push_back(reducer.GetPointer());
@@ -304,6 +315,8 @@ int ConfigurableAnalysis::InternalsType::AddVTKmCDF(pugi::xml_node node)
   auto analysis = vtkSmartPointer<VTKmCDFAnalysis>::New();
   this->TimeInitialization(analysis, [&]() {
     analysis->Initialize(mesh, field, assoc, workDir, quantiles, exchangeSize, this->Comm);
+    analysis->SetNumberOfWriterThreads(node.attribute("writer-threads").as_int(0));
+    analysis->SetRoundRobinWriting(node.attribute("round-robin").as_int(0));
     return 0;
   });
   this->Analyses.push_back(analysis.GetPointer());
@@ -492,6 +505,45 @@ int ConfigurableAnalysis::InternalsType::AddHDF5(pugi::xml_node node)
 #endif
 }
 
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddMMap(pugi::xml_node node)
+{
+  auto mmapAdaptor = vtkSmartPointer<MMapAnalysisAdaptor>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    mmapAdaptor->SetCommunicator(this->Comm);
+
+  if (mmapAdaptor->Initialize(node))
+    {
+    SENSEI_ERROR("Failed to configure the mmap adaptor from XML")
+    return -1;
+    }
+
+  this->TimeInitialization(mmapAdaptor);
+  this->Analyses.push_back(mmapAdaptor.GetPointer());
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddMPI(pugi::xml_node node)
+{
+  auto mpiAdaptor = vtkSmartPointer<MPIAnalysisAdaptor>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    mpiAdaptor->SetCommunicator(this->Comm);
+
+  if (mpiAdaptor->Initialize(node))
+    {
+    SENSEI_ERROR("Failed to configure the MPI adaptor from XML")
+    return -1;
+    }
+
+  this->TimeInitialization(mpiAdaptor);
+  this->Analyses.push_back(mpiAdaptor.GetPointer());
+
+  return 0;
+}
 
 // --------------------------------------------------------------------------
 int ConfigurableAnalysis::InternalsType::AddCatalyst(pugi::xml_node node)
@@ -644,6 +696,9 @@ int ConfigurableAnalysis::InternalsType::AddCatalyst(pugi::xml_node node)
 #else
     if (node.attribute("filename"))
       {
+      // the script is read by rank 0 and broadcast by the Catalyst
+      // script pipeline
+      TimeEvent<128> event("ConfigurableAnalysis::AddCatalyst::LoadScript");
       std::string fileName = node.attribute("filename").value();
       this->CatalystAdaptor->AddPythonScriptPipeline(fileName);
       }
@@ -838,6 +893,119 @@ int ConfigurableAnalysis::InternalsType::AddAutoCorrelation(pugi::xml_node node)
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddStatistics(pugi::xml_node node)
+{
+  DataRequirements req;
+  if (req.Initialize(node) || req.Empty())
+    {
+    SENSEI_ERROR("Failed to initialize Statistics. At least one mesh "
+      "with one or more arrays is required")
+    return -1;
+    }
+
+  int window = node.attribute("window").as_int(0);
+  int perBlock = node.attribute("per_block").as_int(0);
+  std::string fileName = node.attribute("file").value();
+
+  auto adaptor = vtkSmartPointer<Statistics>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    adaptor->SetCommunicator(this->Comm);
+
+  adaptor->SetDataRequirements(req);
+  adaptor->SetWindow(window);
+  adaptor->SetPerBlock(perBlock);
+  adaptor->SetFileName(fileName);
+
+  this->TimeInitialization(adaptor);
+  this->Analyses.push_back(adaptor.GetPointer());
+
+  SENSEI_STATUS("Configured Statistics window " << window
+    << " per_block " << perBlock << " writing output to "
+    << (fileName.empty() ? "cout" : "file"))
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddParticleDeposition(pugi::xml_node node)
+{
+  DataRequirements req;
+  if (req.Initialize(node) || req.Empty())
+    {
+    SENSEI_ERROR("Failed to initialize ParticleDeposition. At least one "
+      "mesh is required")
+    return -1;
+    }
+
+  std::ostringstream oss;
+  oss << "Configured ParticleDeposition";
+
+  auto adaptor = vtkSmartPointer<ParticleDeposition>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    adaptor->SetCommunicator(this->Comm);
+
+  adaptor->SetDataRequirements(req);
+
+  std::string method = node.attribute("method").as_string("cic");
+  int numThreads = node.attribute("n-threads").as_int(1);
+
+  if (adaptor->SetMethod(method))
+    return -1;
+
+  adaptor->SetNumberOfThreads(numThreads);
+
+  oss << " method=" << method << " n-threads=" << numThreads;
+
+  // the number of cells in each direction
+  pugi::xml_node resNode = node.child("resolution");
+  if (resNode)
+    {
+    std::array<int,3> res{0,0,0};
+    if (XMLUtils::ParseNumeric(resNode, res) || adaptor->SetResolution(res))
+      return -1;
+
+    oss << " resolution=" << res;
+    }
+
+  // the region covered by the grid, when not given the bounds of the
+  // particles are used
+  pugi::xml_node boundsNode = node.child("bounds");
+  if (boundsNode)
+    {
+    std::array<double,6> bounds{0.,0.,0.,0.,0.,0.};
+    if (XMLUtils::ParseNumeric(boundsNode, bounds) || adaptor->SetBounds(bounds))
+      return -1;
+
+    oss << " bounds=" << bounds;
+    }
+
+  // parse writer parameters
+  pugi::xml_node writerNode = node.child("writer");
+  if (writerNode)
+    {
+    std::string outputDir = writerNode.attribute("output_dir").as_string("./");
+    std::string mode = writerNode.attribute("mode").as_string("visit");
+    std::string writer = writerNode.attribute("writer").as_string("xml");
+
+    if (adaptor->SetWriterOutputDir(outputDir) || adaptor->SetWriterMode(mode) ||
+      adaptor->SetWriterWriter(writer))
+      return -1;
+
+    oss << " writer.mode=" << mode << " writer.outputDir=" << outputDir
+      << " writer.writer=" << writer;
+    }
+
+  this->TimeInitialization(adaptor);
+  this->Analyses.push_back(adaptor.GetPointer());
+
+  SENSEI_STATUS(<< oss.str())
+
+  return 0;
+}
+
 // --------------------------------------------------------------------------
 int ConfigurableAnalysis::InternalsType::AddPosthocIO(pugi::xml_node node)
 {
@@ -1177,14 +1345,21 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
       continue;
 
     std::string type = node.attribute("type").value();
+
+    TimeEvent<128> addEvent("ConfigurableAnalysis::Add::", type.c_str());
+
     if (!(((type == "histogram") && !this->Internals->AddHistogram(node))
       || ((type == "autocorrelation") && !this->Internals->AddAutoCorrelation(node))
+      || ((type == "statistics") && !this->Internals->AddStatistics(node))
+      || ((type == "particle_deposition") && !this->Internals->AddParticleDeposition(node))
       || ((type == "adios1") && !this->Internals->AddAdios1(node))
       || ((type == "adios2") && !this->Internals->AddAdios2(node))
       || ((type == "ascent") && !this->Internals->AddAscent(node))
       || ((type == "catalyst") && !this->Internals->AddCatalyst(node))
       || ((type == "hdf5") && !this->Internals->AddHDF5(node))
       || ((type == "libsim") && !this->Internals->AddLibsim(node))
+      || ((type == "mmap") && !this->Internals->AddMMap(node))
+      || ((type == "mpi") && !this->Internals->AddMPI(node))
       || ((type == "PosthocIO") && !this->Internals->AddPosthocIO(node))
       || ((type == "VTKAmrWriter") && !this->Internals->AddVTKAmrWriter(node))
       || ((type == "vtkmcontour") && !this->Internals->AddVTKmContour(node))
@@ -1206,9 +1381,14 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
       continue;
 
     std::string type = node.attribute("type").value();
+
+    TimeEvent<128> addEvent("ConfigurableAnalysis::AddTransport::", type.c_str());
+
     if (!(((type == "adios1") && !this->Internals->AddAdios1(node))
       || ((type == "adios2") && !this->Internals->AddAdios2(node))
-      || ((type == "hdf5") && !this->Internals->AddHDF5(node))))
+      || ((type == "hdf5") && !this->Internals->AddHDF5(node))
+      || ((type == "mmap") && !this->Internals->AddMMap(node))
+      || ((type == "mpi") && !this->Internals->AddMPI(node))))
       {
       SENSEI_ERROR("Failed to add \"" << type << "\" transport")
       MPI_Abort(this->GetCommunicator(), -1);
@@ -1230,10 +1410,19 @@ bool ConfigurableAnalysis::Execute(DataAdaptor* data)
     {
     const char* analysisName = nullptr;
     bool logEnabled = Profiler::Enabled();
+    bool trackAllocs = logEnabled && AllocationTracker::Enabled();
+    AllocationTracker::Counters allocStart;
     if (logEnabled)
       {
       analysisName = this->Internals->LogEventNames[3 * ai + 1].c_str();
       Profiler::StartEvent(analysisName);
+
+      // snapshot heap use so that it can be attributed to this analysis
+      if (trackAllocs)
+        {
+        AllocationTracker::ResetPeak();
+        AllocationTracker::GetCounters(allocStart);
+        }
       }
 
     if (!(*iter)->Execute(data))
@@ -1242,6 +1431,18 @@ bool ConfigurableAnalysis::Execute(DataAdaptor* data)
       MPI_Abort(this->GetCommunicator(), -1);
       }
 
+    if (trackAllocs)
+      {
+      AllocationTracker::Counters allocEnd;
+      AllocationTracker::GetCounters(allocEnd);
+
+      AllocationTracker::Counters allocs;
+      AllocationTracker::Difference(allocStart, allocEnd, allocs);
+
+      Profiler::SetEventAllocations(allocs.Allocated, allocs.Freed,
+        allocs.Peak, allocs.VTKObjects, allocs.VTKObjectsFreed);
+      }
+
     if (logEnabled)
       Profiler::EndEvent(analysisName);
     }
@@ -2,6 +2,7 @@
 #include "InTransitDataAdaptor.h"
 #include "XMLUtils.h"
 #include "Error.h"
+#include "Profiler.h"
 #ifdef ENABLE_ADIOS1
 #include "ADIOS1DataAdaptor.h"
 #endif
@@ -51,6 +52,8 @@ ConfigurableInTransitDataAdaptor::~ConfigurableInTransitDataAdaptor()
 // -------------------------------------------------------------------------------
 int ConfigurableInTransitDataAdaptor::Initialize(const std::string &fileName)
 {
+  TimeEvent<128> event("ConfigurableInTransitDataAdaptor::Initialize");
+
   MPI_Comm comm = this->GetCommunicator();
 
   int rank = 0;
@@ -138,6 +141,7 @@ int ConfigurableInTransitDataAdaptor::Initialize(pugi::xml_node &root)
 
   // intialize the adaptor. the partitioner is typically iniitialized
   // by the default initialize in the InTransitDataAdaptor
+  TimeEvent<128> initEvent("ConfigurableInTransitDataAdaptor::Initialize::", type.c_str());
   if (adaptor->SetConnectionInfo(this->GetConnectionInfo()) ||
     adaptor->Initialize(node))
     {
@@ -46,6 +46,21 @@ int ConfigurablePartitioner::GetPartition(MPI_Comm comm, const MeshMetadataPtr &
   return this->Internals->Part->GetPartition(comm, in, out);
 }
 
+// ---------------------------------------------------------------------------
+int ConfigurablePartitioner::GetPartitions(MPI_Comm comm,
+  const std::vector<MeshMetadataPtr> &in, std::vector<MeshMetadataPtr> &out)
+{
+  TimeEvent<128> mark("ConfigurablePartitioner::GetPartitions");
+
+  if (!this->Internals->Part)
+    {
+    SENSEI_ERROR("Partitioner has not been initialized")
+    return -1;
+    }
+
+  return this->Internals->Part->GetPartitions(comm, in, out);
+}
+
 // ---------------------------------------------------------------------------
 int ConfigurablePartitioner::Initialize(pugi::xml_node &partNode)
 {
@@ -26,6 +26,11 @@ public:
   int GetPartition(MPI_Comm comm, const sensei::MeshMetadataPtr &in,
     sensei::MeshMetadataPtr &out) override;
 
+  // partition a set of meshes using the configured partitioner
+  int GetPartitions(MPI_Comm comm,
+    const std::vector<sensei::MeshMetadataPtr> &in,
+    std::vector<sensei::MeshMetadataPtr> &out) override;
+
   // initialize the partitioner from the XML node.  recognizes the following
   // Partitioner's: block, cyclic, planar, and mapped. The XML schema is as
   // follows:
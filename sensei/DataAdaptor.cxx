@@ -22,6 +22,7 @@ struct DataAdaptor::InternalsType
 
   MeshMetadataFlags Flags;
   std::vector<MeshMetadataPtr> Metadata;
+  std::map<std::string, int> MaxLevels;
   double Time;
   long TimeStep;
 };
@@ -48,6 +49,33 @@ int DataAdaptor::SetCommunicator(MPI_Comm comm)
   return 0;
 }
 
+//----------------------------------------------------------------------------
+void DataAdaptor::SetMaxLevel(const std::string &meshName, int level)
+{
+  if (level < 0)
+    this->Internals->MaxLevels.erase(meshName);
+  else
+    this->Internals->MaxLevels[meshName] = level;
+}
+
+//----------------------------------------------------------------------------
+int DataAdaptor::GetMaxLevel(const std::string &meshName)
+{
+  std::map<std::string, int>::iterator it =
+    this->Internals->MaxLevels.find(meshName);
+
+  if (it == this->Internals->MaxLevels.end())
+    return -1;
+
+  return it->second;
+}
+
+//----------------------------------------------------------------------------
+void DataAdaptor::ClearMaxLevels()
+{
+  this->Internals->MaxLevels.clear();
+}
+
 //----------------------------------------------------------------------------
 double DataAdaptor::GetDataTime()
 {
@@ -142,6 +142,25 @@ public:
   /// @returns zero if successful, non zero if an error occurred
   virtual int ReleaseData() = 0;
 
+  /// @brief Limit an AMR mesh to its coarse levels.
+  ///
+  /// Analyses that only need the coarse levels of an AMR mesh set the finest
+  /// level they need before getting the metadata and the mesh. Adaptors that
+  /// support the limit neither build nor report the patches of finer levels,
+  /// adaptors that do not support it provide all levels. Levels are numbered
+  /// from 0, the coarsest. A level less than 0 removes the limit. Limits
+  /// remain in effect until cleared, see sensei::MaxLevelScope.
+  ///
+  /// @param[in] meshName the name of the mesh
+  /// @param[in] level the finest level to provide
+  void SetMaxLevel(const std::string &meshName, int level);
+
+  /// @brief Get the finest AMR level to provide, or -1 for all levels.
+  int GetMaxLevel(const std::string &meshName);
+
+  /// @brief Remove the level limits of all meshes
+  void ClearMaxLevels();
+
   /// @brief Set/get the current simulated time.
   virtual double GetDataTime();
   virtual void SetDataTime(double time);
@@ -247,6 +247,9 @@ PARTITIONER_API(PlanarSlicePartitioner)
 PARTITIONER_API(IsoSurfacePartitioner)
 PARTITIONER_API(ConfigurablePartitioner)
 
+%ignore sensei::Partitioner::GetPartitions;
+%ignore sensei::ConfigurablePartitioner::GetPartitions;
+
 %include "Partitioner.h"
 %include "BlockPartitioner.h"
 %include "PlanarPartitioner.h"
@@ -53,6 +53,7 @@ void DataRequirements::Clear()
 {
   this->MeshNames.clear();
   this->MeshArrayMap.clear();
+  this->MaxLevels.clear();
 }
 
 // --------------------------------------------------------------------------
@@ -81,6 +82,11 @@ int DataRequirements::Initialize(pugi::xml_node parent)
 
     this->MeshNames.insert(std::make_pair(meshName, structureOnly));
 
+    // get the finest AMR level, optional
+    int maxLevel = node.attribute("max_level").as_int(-1);
+    if (maxLevel >= 0)
+      this->MaxLevels[meshName] = maxLevel;
+
     // get cell data arrays, optional
     std::vector<std::string> arrays;
     if (getArrayNames(node.child("cell_arrays"), arrays))
@@ -178,6 +184,41 @@ int DataRequirements::AddRequirement(const std::string &meshName,
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int DataRequirements::SetMaxLevel(const std::string &meshName, int level)
+{
+  if (meshName.empty())
+    {
+    SENSEI_ERROR("A mesh name is required")
+    return -1;
+    }
+
+  if (level < 0)
+    this->MaxLevels.erase(meshName);
+  else
+    this->MaxLevels[meshName] = level;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataRequirements::GetMaxLevel(const std::string &meshName) const
+{
+  MeshLevelMapType::const_iterator it = this->MaxLevels.find(meshName);
+  if (it == this->MaxLevels.end())
+    return -1;
+  return it->second;
+}
+
+// --------------------------------------------------------------------------
+void DataRequirements::ApplyMaxLevels(DataAdaptor *adaptor) const
+{
+  MeshLevelMapType::const_iterator it = this->MaxLevels.begin();
+  MeshLevelMapType::const_iterator end = this->MaxLevels.end();
+  for (; it != end; ++it)
+    adaptor->SetMaxLevel(it->first, it->second);
+}
+
 // --------------------------------------------------------------------------
 int DataRequirements::GetRequiredMesh(unsigned int id, std::string &mesh) const
 {
@@ -278,4 +319,17 @@ ArrayRequirementsIterator DataRequirements::GetArrayRequirementsIterator(
   return ArrayRequirementsIterator();
 }
 
+// --------------------------------------------------------------------------
+MaxLevelScope::MaxLevelScope(const DataRequirements &reqs,
+  DataAdaptor *adaptor) : Adaptor(adaptor)
+{
+  reqs.ApplyMaxLevels(adaptor);
+}
+
+// --------------------------------------------------------------------------
+MaxLevelScope::~MaxLevelScope()
+{
+  this->Adaptor->ClearMaxLevels();
+}
+
 }
@@ -41,12 +41,15 @@ public:
   ///   .
   ///   .
   ///   .
-  ///   <mesh name="mesh_n" structure_only="0">
+  ///   <mesh name="mesh_n" structure_only="0" max_level="1">
   ///     <cell_arrays>  array_1, ... array_n </cell_arrays>
   ///     <point_arrays>  array_1, ... array_n </point_arrays>
   ///   </mesh>
   /// </parent>
   ///
+  /// the optional max_level attribute limits an AMR mesh to its coarse
+  /// levels, see SetMaxLevel.
+  ///
   /// @param[in] parent  XML node which contains mesh elements
   /// @returns the number of mesh elements processed.
   int Initialize(pugi::xml_node parent);
@@ -105,6 +108,18 @@ public:
   int GetNumberOfRequiredArrays(const std::string &meshName,
     int association, unsigned int &nArrays) const;
 
+  /// Set/get the finest AMR level required on the named mesh. Levels are
+  /// numbered from 0, the coarsest. A level less than 0, the default,
+  /// requires all levels.
+  /// @param[in] meshName the name of the mesh
+  /// @param[in] level the finest level required
+  /// @returns zero if successful
+  int SetMaxLevel(const std::string &meshName, int level);
+  int GetMaxLevel(const std::string &meshName) const;
+
+  /// Passes the level limits to a data adaptor, see DataAdaptor::SetMaxLevel
+  void ApplyMaxLevels(DataAdaptor *adaptor) const;
+
   /// Clear the contents of the container
   void Clear();
 
@@ -119,6 +134,7 @@ public:
   using AssocArrayMapType = std::map<int, std::vector<std::string>>;
   using MeshArrayMapType = std::map<std::string, AssocArrayMapType>;
   using MeshNamesType = std::map<std::string, bool>;
+  using MeshLevelMapType = std::map<std::string, int>;
 
 private:
   friend class ArrayRequirementsIterator;
@@ -126,6 +142,24 @@ private:
 
   MeshNamesType MeshNames;
   MeshArrayMapType MeshArrayMap;
+  MeshLevelMapType MaxLevels;
+};
+
+/// Passes the AMR level limits of a set of requirements to a data adaptor
+/// and clears them again when it goes out of scope. Analyses use it around
+/// the calls that fetch metadata and meshes so that the limits do not
+/// affect other analyses sharing the data adaptor.
+class MaxLevelScope
+{
+public:
+  MaxLevelScope(const DataRequirements &reqs, DataAdaptor *adaptor);
+  ~MaxLevelScope();
+
+  MaxLevelScope(const MaxLevelScope &) = delete;
+  void operator=(const MaxLevelScope &) = delete;
+
+private:
+  DataAdaptor *Adaptor;
 };
 
 // iterate over the meshes
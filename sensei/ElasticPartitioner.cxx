@@ -0,0 +1,145 @@
+#include "ElasticPartitioner.h"
+#include "BinaryStream.h"
+#include "Profiler.h"
+#include "Error.h"
+
+namespace sensei
+{
+
+// --------------------------------------------------------------------------
+ElasticPartitioner::~ElasticPartitioner()
+{
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+
+  if (!finalized && (this->ActiveComm != MPI_COMM_NULL))
+    MPI_Comm_free(&this->ActiveComm);
+}
+
+// --------------------------------------------------------------------------
+void ElasticPartitioner::SetVerbose(int val)
+{
+  this->Partitioner::SetVerbose(val);
+  if (this->Part)
+    this->Part->SetVerbose(val);
+}
+
+// --------------------------------------------------------------------------
+int ElasticPartitioner::UpdateActiveCommunicator(MPI_Comm comm, int nActive)
+{
+  if ((comm == this->ParentComm) && (nActive == this->ActiveCommSize))
+    return 0;
+
+  TimeEvent<128> mark("ElasticPartitioner::UpdateActiveCommunicator");
+
+  if (this->ActiveComm != MPI_COMM_NULL)
+    MPI_Comm_free(&this->ActiveComm);
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // keep the rank order so that ranks in the active communicator are the
+  // same as in the parent
+  if (MPI_Comm_split(comm, rank < nActive ? 0 : MPI_UNDEFINED,
+    rank, &this->ActiveComm) != MPI_SUCCESS)
+    {
+    SENSEI_ERROR("Failed to split the active ranks")
+    this->ParentComm = MPI_COMM_NULL;
+    this->ActiveCommSize = 0;
+    return -1;
+    }
+
+  this->ParentComm = comm;
+  this->ActiveCommSize = nActive;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ElasticPartitioner::GetPartition(MPI_Comm comm, const MeshMetadataPtr &in,
+  MeshMetadataPtr &out)
+{
+  std::vector<MeshMetadataPtr> tmpIn(1, in);
+  std::vector<MeshMetadataPtr> tmpOut;
+
+  if (this->GetPartitions(comm, tmpIn, tmpOut))
+    return -1;
+
+  out = tmpOut[0];
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ElasticPartitioner::GetPartitions(MPI_Comm comm,
+  const std::vector<MeshMetadataPtr> &in, std::vector<MeshMetadataPtr> &out)
+{
+  TimeEvent<128> mark("ElasticPartitioner::GetPartitions");
+
+  if (!this->Part)
+    {
+    SENSEI_ERROR("No partitioner was set")
+    return -1;
+    }
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  int nActive = this->NumberOfActiveRanks;
+  if ((nActive < 1) || (nActive > nRanks))
+    nActive = nRanks;
+
+  // all ranks are active, nothing to do
+  if (nActive == nRanks)
+    return this->Part->GetPartitions(comm, in, out);
+
+  if (this->UpdateActiveCommunicator(comm, nActive))
+    return -1;
+
+  // partition over the active ranks. rank 0 sends the result, and whether
+  // or not it succeeded, to the idle ranks in one message.
+  unsigned int nMeshes = in.size();
+
+  BinaryStream bs;
+  if (rank < nActive)
+    {
+    int ierr = this->Part->GetPartitions(this->ActiveComm, in, out);
+    if (rank == 0)
+      {
+      bs.Pack(ierr);
+      for (unsigned int i = 0; !ierr && (i < nMeshes); ++i)
+        out[i]->ToStream(bs);
+      }
+    }
+
+  bs.Broadcast(comm, 0);
+
+  int ierr = 0;
+  bs.Unpack(ierr);
+  if (ierr)
+    {
+    SENSEI_ERROR("The " << this->Part->GetClassName()
+      << " failed to partition over " << nActive << " ranks")
+    return -1;
+    }
+
+  if (rank >= nActive)
+    {
+    out.resize(nMeshes);
+    for (unsigned int i = 0; i < nMeshes; ++i)
+      {
+      out[i] = MeshMetadata::New();
+      out[i]->FromStream(bs);
+      }
+    }
+
+  if (this->Verbose && (rank == 0))
+    SENSEI_STATUS("Partitioned " << nMeshes << " meshes over "
+      << nActive << " of " << nRanks << " ranks")
+
+  return 0;
+}
+
+}
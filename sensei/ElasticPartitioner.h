@@ -0,0 +1,75 @@
+#ifndef sensei_ElasticPartitioner_h
+#define sensei_ElasticPartitioner_h
+
+#include "Partitioner.h"
+
+namespace sensei
+{
+
+class ElasticPartitioner;
+using ElasticPartitionerPtr = std::shared_ptr<sensei::ElasticPartitioner>;
+
+/// @class ElasticPartitioner
+/// @brief restricts another partitioner to a subset of the receiving ranks.
+///
+/// The wrapped partitioner is run on a communicator made of the first N
+/// ranks, and its result is broadcast to the rest so that every rank knows
+/// who owns what. The remaining ranks are assigned no blocks. The number of
+/// active ranks may be changed between steps, the communicator is split again
+/// the next time a partition is requested. GetPartition must be called by all
+/// ranks of the communicator passed to it.
+class ElasticPartitioner : public sensei::Partitioner
+{
+public:
+  static sensei::ElasticPartitionerPtr New(const sensei::PartitionerPtr &part)
+  { return ElasticPartitionerPtr(new ElasticPartitioner(part)); }
+
+  const char *GetClassName() override { return "ElasticPartitioner"; }
+
+  ~ElasticPartitioner();
+
+  // Set/get the partitioner used on the active ranks
+  void SetPartitioner(const sensei::PartitionerPtr &part) { this->Part = part; }
+  sensei::PartitionerPtr GetPartitioner() { return this->Part; }
+
+  // Set/get the number of active ranks. A value less than 1 or larger than
+  // the size of the communicator makes all ranks active.
+  void SetNumberOfActiveRanks(int n) { this->NumberOfActiveRanks = n; }
+  int GetNumberOfActiveRanks() { return this->NumberOfActiveRanks; }
+
+  // given an existing partitioning of data passed in the first MeshMetadata
+  // argument,return a new partittioning in the second MeshMetadata argument.
+  // blocks are only assigned to the active ranks.
+  int GetPartition(MPI_Comm comm, const sensei::MeshMetadataPtr &in,
+    sensei::MeshMetadataPtr &out) override;
+
+  // partition a set of meshes over the active ranks. the idle ranks receive
+  // the result of all of them in a single broadcast.
+  int GetPartitions(MPI_Comm comm,
+    const std::vector<sensei::MeshMetadataPtr> &in,
+    std::vector<sensei::MeshMetadataPtr> &out) override;
+
+  void SetVerbose(int val) override;
+
+protected:
+  ElasticPartitioner(const sensei::PartitionerPtr &part) : Part(part),
+    NumberOfActiveRanks(0), ParentComm(MPI_COMM_NULL),
+    ActiveComm(MPI_COMM_NULL), ActiveCommSize(0) {}
+
+  ElasticPartitioner(const ElasticPartitioner &) = delete;
+  void operator=(const ElasticPartitioner &) = delete;
+
+  // split the active ranks from comm if it has not already been done
+  int UpdateActiveCommunicator(MPI_Comm comm, int nActive);
+
+private:
+  sensei::PartitionerPtr Part;
+  int NumberOfActiveRanks;
+  MPI_Comm ParentComm;
+  MPI_Comm ActiveComm;
+  int ActiveCommSize;
+};
+
+}
+
+#endif
@@ -75,6 +75,10 @@ bool HDF5AnalysisAdaptor::Execute(DataAdaptor* dataAdaptor)
 {
   TimeEvent<128> mark("HDF5AnalysisAdaptor::Execute");
 
+  // pass AMR level limits to the simulation so that finer patches
+  // are never built nor written
+  MaxLevelScope levels(this->Requirements, dataAdaptor);
+
   // figure out what the simulation can provide
   MeshMetadataFlags flags;
   flags.SetBlockDecomp();
@@ -3,7 +3,6 @@
 #include "Error.h"
 #include "Profiler.h"
 
-#include "BlockPartitioner.h"
 #include "MeshMetadata.h"
 #include "Partitioner.h"
 #include "VTKUtils.h"
@@ -52,6 +51,8 @@ int HDF5DataAdaptor::Initialize(pugi::xml_node& node)
   pugi::xml_attribute filename = node.attribute("filename");
   pugi::xml_attribute file_name = node.attribute("file_name");
   pugi::xml_attribute methodAttr = node.attribute("method");
+  pugi::xml_attribute prefetchAttr = node.attribute("prefetch");
+  pugi::xml_attribute aggregatorsAttr = node.attribute("aggregators");
 
   if (filename)
     SetStreamName(filename.value());
@@ -73,6 +74,12 @@ int HDF5DataAdaptor::Initialize(pugi::xml_node& node)
         }
     }
 
+  if (prefetchAttr)
+    SetPrefetch(prefetchAttr.as_int());
+
+  if (aggregatorsAttr)
+    SetAggregators(aggregatorsAttr.as_int());
+
   return 0;
 }
 
@@ -91,6 +98,8 @@ int HDF5DataAdaptor::OpenStream()
     {
       this->m_HDF5Reader =
         new senseiHDF5::ReadStream(this->GetCommunicator(), m_Streaming);
+      this->m_HDF5Reader->SetAggregators(m_Aggregators);
+      this->m_HDF5Reader->SetPrefetch(m_Prefetch);
     }
 
   if (!this->m_HDF5Reader->Init(m_StreamName))
@@ -171,6 +180,9 @@ int HDF5DataAdaptor::UpdateTimeStep()
   this->SetDataTimeStep(timeStep);
   this->SetDataTime(time);
 
+  // the layout is recomputed for each step
+  m_Partitioned = false;
+
   // read metadata
 
   unsigned int nMeshes = 0;
@@ -223,35 +235,34 @@ int HDF5DataAdaptor::GetMeshMetadata(unsigned int id, MeshMetadataPtr& metadata)
   // passing in reciever metadata
   if (this->GetReceiverMeshMetadata(id, metadata))
     {
-      // none set, we'll use the partitioner to figure it out
-      // first take a look at what's available
-      MeshMetadataPtr senderMd;
-      if (this->GetSenderMeshMetadata(id, senderMd))
+      // none set, we'll use the partitioner to figure it out. the first
+      // time through in each step all of the meshes are laid out at once
+      if (!m_Partitioned)
         {
-          SENSEI_ERROR("Failed to get sender metadata")
-          return -1;
+          std::vector<MeshMetadataPtr> recverMd;
+          if (this->PartitionMeshes(recverMd))
+            {
+              SENSEI_ERROR(
+                "Failed to determine a suitable layout to receive the data");
+              this->CloseStream();
+              return -1;
+            }
+
+          //
+          // use this meshmetadata to read objects
+          //
+          unsigned int nMeshes = recverMd.size();
+          for (unsigned int i = 0; i < nMeshes; ++i)
+            this->m_HDF5Reader->m_AllMeshInfoReceiver.SetMeshMetadata(i, recverMd[i]);
+
+          m_Partitioned = true;
         }
 
-      // get the partitioner, default to the block based layout
-      PartitionerPtr part = this->GetPartitioner();
-      if (!part)
+      if (!this->m_HDF5Reader->ReadReceiverMeshMetaData(id, metadata))
         {
-          part = BlockPartitioner::New();
-        }
-
-      MeshMetadataPtr recverMd;
-      if (part->GetPartition(this->GetCommunicator(), senderMd, recverMd))
-        {
-          SENSEI_ERROR(
-            "Failed to determine a suitable layout to receive the data");
-          this->CloseStream();
+          SENSEI_ERROR("Failed to get the layout of mesh " << id);
+          return -1;
         }
-
-      metadata = recverMd;
-      //
-      // use this meshmetadata to read objects
-      //
-      this->m_HDF5Reader->m_AllMeshInfoReceiver.SetMeshMetadata(id, recverMd);
     }
 
   return 0;
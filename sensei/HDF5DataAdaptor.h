@@ -27,6 +27,17 @@ public:
   void SetStreaming(bool s) { m_Streaming = s; }
   void SetCollective(bool s) { m_Collective = s; }
 
+  // read the arrays used in one step from the next step in the background
+  void SetPrefetch(bool s) { m_Prefetch = s; }
+
+  // number of ranks that read for all ranks and scatter the blocks to their
+  // owners. 0, the default, has every rank read its own blocks. With
+  // aggregation GetMesh and AddArray become collective: every rank of the
+  // communicator must call them, for the same meshes and arrays in the same
+  // order. Ranks asking for different arrays fall back to independent reads,
+  // but ranks that skip a call leave the others waiting.
+  void SetAggregators(int n) { m_Aggregators = n; }
+
   // int Advance(); now is AdvanceStream()
 
   // int Close(); now is CloseStream()
@@ -74,6 +85,9 @@ private:
 
   bool m_Streaming = false;
   bool m_Collective = false;
+  bool m_Prefetch = false;
+  int m_Aggregators = 0;
+  bool m_Partitioned = false;
 
   std::string m_StreamName;
 
@@ -40,6 +40,9 @@
 #include <vtkUnsignedLongLongArray.h>
 #include <vtkUnstructuredGrid.h>
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <map>
 #include <set>
 #include <sstream>
@@ -56,6 +59,7 @@ static const std::string ATTRNAME_TIMESTEP = "timestep";
 static const std::string ATTRNAME_TIME = "time";
 static const std::string ATTRNAME_NUM_TIMESTEP = "num_timestep";
 static const std::string ATTRNAME_NUM_MESH = "num_meshs";
+static const std::string ATTRNAME_MESHDATA_HASH = "meshdata_hash";
 static const std::string TAG_MESH = "mesh_";
 static const std::string TAG_ARRAY = "array_";
 static const std::string TAG_VTK_GHOST =
@@ -66,6 +70,21 @@ static bool gCheckSenseiCall(int code)
   return (code == 0); // burlen return 0 for success
 }
 
+// FNV-1a, accumulates a hash of n bytes into h
+static unsigned long long gHashBytes(unsigned long long h,
+                                     const unsigned char *data,
+                                     size_t n)
+{
+  for(size_t i = 0; i < n; ++i)
+    {
+      h ^= data[i];
+      h *= 1099511628211ull;
+    }
+  return h;
+}
+
+static const unsigned long long gHashSeed = 14695981039346656037ull;
+
 static void gGetTimeStepString(std::string &stepName, int ts)
 {
   stepName = "/Step" + std::to_string(ts);
@@ -268,6 +287,40 @@ void HDF5VarGuard::ReadSlice(void *buf,
   H5Sclose(memDataSpace);
 }
 
+bool HDF5VarGuard::ReadRanges(void *buf,
+                              const std::vector<hsize_t> &start,
+                              const std::vector<hsize_t> &count)
+{
+  size_t n = start.size();
+  if(n == 0)
+    return true;
+
+  // the file selection is the union of the ranges. HDF5 transfers the
+  // elements of a selection in file order, which is the order the ranges
+  // are given in
+  hsize_t total = 0;
+  for(size_t i = 0; i < n; ++i)
+    {
+      H5Sselect_hyperslab(m_VarSpace,
+                          i == 0 ? H5S_SELECT_SET : H5S_SELECT_OR,
+                          &start[i], NULL, &count[i], NULL);
+      total += count[i];
+    }
+
+  hid_t memDataSpace = H5Screate_simple(1, &total, NULL);
+
+  std::ostringstream  oss;   oss<<"H5BytesRead="<<total;
+  std::string evtName = oss.str();
+  sensei::TimeEvent<128> mark(evtName.c_str());
+
+  herr_t ierr =
+    H5Dread(m_VarID, m_VarType, memDataSpace, m_VarSpace, H5P_DEFAULT, buf);
+
+  H5Sclose(memDataSpace);
+
+  return ierr >= 0;
+}
+
 //
 //
 //
@@ -379,6 +432,23 @@ bool DefaultStreamHandler::AdvanceStream()
   return true;
 }
 
+hid_t DefaultStreamHandler::OpenStep(unsigned int ts)
+{
+  if(!m_InReadMode || (ts >= m_TimeStepTotal))
+    return -1;
+
+  // steps are groups in one file, opening one is an independent operation
+  std::string stepName;
+  gGetTimeStepString(stepName, ts);
+  return H5Gopen(m_HostFileId, stepName.c_str(), H5P_DEFAULT);
+}
+
+void DefaultStreamHandler::CloseStep(hid_t stepId)
+{
+  if(stepId >= 0)
+    H5Gclose(stepId);
+}
+
 bool DefaultStreamHandler::Summary()
 {
   if(m_InReadMode)
@@ -694,16 +764,195 @@ ReadStream::ReadStream(MPI_Comm comm, bool streaming)
 
 ReadStream::~ReadStream()
 {
+  FinishPrefetch();
+  ClearVarCache();
   m_Streamer->Summary();
 }
 
+void ReadStream::SetPrefetch(bool val)
+{
+  m_Prefetch = false;
+  if(!val)
+    return;
+
+  int threadLevel = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&threadLevel);
+  if(threadLevel < MPI_THREAD_MULTIPLE)
+    {
+      SENSEI_WARNING("HDF5 prefetch disabled, it requires MPI_THREAD_MULTIPLE")
+      return;
+    }
+
+  if(m_Aggregators > 0)
+    {
+      SENSEI_WARNING("HDF5 prefetch disabled, it can not be combined with "
+                     "aggregated reads")
+      return;
+    }
+
+  if(m_StreamingOn)
+    {
+      SENSEI_WARNING("HDF5 prefetch disabled, steps written in streaming "
+                     "mode can not be opened independently")
+      return;
+    }
+
+  m_Prefetch = true;
+}
+
+void ReadStream::SetAggregators(int n)
+{
+  m_Aggregators = std::max(0, std::min(n, m_Size));
+
+  // the prefetch thread reads independently
+  if(m_Aggregators && m_Prefetch)
+    {
+      SENSEI_WARNING("HDF5 prefetch disabled, it can not be combined with "
+                     "aggregated reads")
+      m_Prefetch = false;
+    }
+}
+
+bool ReadStream::SameVarOnAllRanks(const std::string &name)
+{
+  // the min of the hash and of its complement give the min and max hash
+  unsigned long long h = std::hash<std::string>()(name);
+  unsigned long long hr[2] = {h, ~h};
+  MPI_Allreduce(MPI_IN_PLACE, hr, 2, MPI_UNSIGNED_LONG_LONG, MPI_MIN, m_Comm);
+  return hr[0] == ~hr[1];
+}
+
+bool ReadStream::AllRanks(bool val)
+{
+  int v = val ? 1 : 0;
+  MPI_Allreduce(MPI_IN_PLACE, &v, 1, MPI_INT, MPI_MIN, m_Comm);
+  return v;
+}
+
+HDF5VarGuard *ReadStream::GetVar(const std::string &name)
+{
+  std::map<std::string, HDF5VarGuard *>::iterator it = m_VarCache.find(name);
+  if(it != m_VarCache.end())
+    return it->second;
+
+  hid_t varId = H5Dopen(m_Streamer->m_TimeStepId, name.c_str(), H5P_DEFAULT);
+  if(varId < 0)
+    {
+      SENSEI_ERROR("Failed to open H5 dataset: " << name);
+      return nullptr;
+    }
+
+  HDF5VarGuard *var = new HDF5VarGuard(varId);
+  m_VarCache[name] = var;
+
+  return var;
+}
+
+void ReadStream::ClearVarCache()
+{
+  // datasets must be closed before the step that holds them
+  std::lock_guard<std::mutex> lock(m_H5Mutex);
+
+  std::map<std::string, HDF5VarGuard *>::iterator it = m_VarCache.begin();
+  std::map<std::string, HDF5VarGuard *>::iterator end = m_VarCache.end();
+  for(; it != end; ++it)
+    delete it->second;
+
+  m_VarCache.clear();
+}
+
+void ReadStream::StartPrefetch()
+{
+  if(!m_Prefetch || m_ReadRanges.empty())
+    return;
+
+  // the step after the one just opened, read what was read the step before
+  m_NextPrefetched.clear();
+  m_PrefetchThread = std::thread(ReadStream::Prefetch, m_Streamer,
+    m_Streamer->m_TimeStepCounter, m_ReadRanges, &m_H5Mutex,
+    &m_NextPrefetched);
+
+  m_ReadRanges.clear();
+}
+
+void ReadStream::FinishPrefetch()
+{
+  m_Prefetched.clear();
+
+  if(!m_PrefetchThread.joinable())
+    return;
+
+  m_PrefetchThread.join();
+  m_Prefetched.swap(m_NextPrefetched);
+}
+
+void ReadStream::Prefetch(StreamHandler *streamer,
+                          unsigned int step,
+                          RangeMap ranges,
+                          std::mutex *h5Mutex,
+                          std::map<std::string, PrefetchData> *result)
+{
+  sensei::TimeEvent<128> mark("ReadStream::Prefetch");
+
+  hid_t stepId = -1;
+  {
+    std::lock_guard<std::mutex> lock(*h5Mutex);
+    stepId = streamer->OpenStep(step);
+  }
+
+  if(stepId < 0)
+    return;
+
+  RangeMap::iterator it = ranges.begin();
+  RangeMap::iterator end = ranges.end();
+  for(; it != end; ++it)
+    {
+      // one dataset at a time so that reads on the main thread are not held
+      // up for long
+      std::lock_guard<std::mutex> lock(*h5Mutex);
+
+      if(H5Lexists(stepId, it->first.c_str(), H5P_DEFAULT) <= 0)
+        continue;
+
+      hid_t varId = H5Dopen(stepId, it->first.c_str(), H5P_DEFAULT);
+      if(varId < 0)
+        continue;
+
+      HDF5VarGuard g(varId);
+
+      PrefetchData &pd = (*result)[it->first];
+      pd.Start.swap(it->second.first);
+      pd.Count.swap(it->second.second);
+      pd.ElementSize = H5Tget_size(g.m_VarType);
+
+      hsize_t total = 0;
+      size_t n = pd.Count.size();
+      for(size_t i = 0; i < n; ++i)
+        total += pd.Count[i];
+
+      pd.Data.resize(total * pd.ElementSize);
+
+      if(!g.ReadRanges(pd.Data.data(), pd.Start, pd.Count))
+        result->erase(it->first);
+    }
+
+  std::lock_guard<std::mutex> lock(*h5Mutex);
+  streamer->CloseStep(stepId);
+}
+
 bool ReadStream::AdvanceTimeStep(unsigned long &time_step, double &time)
 {
+  FinishPrefetch();
+  ClearVarCache();
+
   m_AllMeshInfo.Clear();
   m_AllMeshInfoReceiver.Clear();
 
-  if(!m_Streamer->AdvanceStream())
-    return false;
+  {
+    std::lock_guard<std::mutex> lock(m_H5Mutex);
+    if(!m_Streamer->AdvanceStream())
+      return false;
+  }
 
   if(!ReadNativeAttr(
         senseiHDF5::ATTRNAME_TIMESTEP, &time_step, H5T_NATIVE_ULONG, -1))
@@ -711,6 +960,8 @@ bool ReadStream::AdvanceTimeStep(unsigned long &time_step, double &time)
   if(!ReadNativeAttr(senseiHDF5::ATTRNAME_TIME, &time, H5T_NATIVE_DOUBLE, -1))
     return false;
 
+  StartPrefetch();
+
   return true;
 }
 
@@ -719,6 +970,8 @@ bool ReadStream::ReadNativeAttr(const std::string &name,
                                 hid_t h5Type,
                                 hid_t hid)
 {
+  std::lock_guard<std::mutex> lock(m_H5Mutex);
+
   if(hid == -1)
     hid = m_Streamer->m_TimeStepId;
 
@@ -741,36 +994,317 @@ bool ReadStream::ReadVar1D(const std::string &name,
                            hsize_t c,
                            void *data)
 {
-  hid_t varId = H5Dopen(m_Streamer->m_TimeStepId, name.c_str(), H5P_DEFAULT);
+  std::lock_guard<std::mutex> lock(m_H5Mutex);
 
-  if(varId < 0)
-    {
-      SENSEI_ERROR("Failed to open H5 dataset: " << name);
-      return false;
-    }
-
-  HDF5VarGuard g(varId);
+  HDF5VarGuard *var = GetVar(name);
+  if(!var)
+    return false;
 
   hsize_t start[1] = { s };
   hsize_t count[1] = { c };
   hsize_t stride[1] = { 1 };
 
-  g.ReadSlice(data, 1, start, stride, count, NULL);
+  var->ReadSlice(data, 1, start, stride, count, NULL);
 
   return true;
 }
 
-bool ReadStream::ReadBinary(const std::string &name, sensei::BinaryStream &str)
+bool ReadStream::ReadVar1D(const std::string &name,
+                           const std::vector<hsize_t> &s,
+                           const std::vector<hsize_t> &c,
+                           const std::vector<void *> &data)
 {
-  hid_t varID = H5Dopen(m_Streamer->m_TimeStepId, name.c_str(), H5P_DEFAULT);
+  size_t n = s.size();
+  if(n == 0)
+    return true;
 
-  if(varID < 0)
+  // a single H5Dread delivers the ranges in file order, fall back to one
+  // read per range if they are not increasing
+  for(size_t i = 1; i < n; ++i)
     {
-      SENSEI_ERROR("Failed to open H5 dataset: " << name);
-      return false;
+      if(s[i] < s[i-1] + c[i-1])
+        {
+          for(size_t j = 0; j < n; ++j)
+            {
+              if(!ReadVar1D(name, s[j], c[j], data[j]))
+                return false;
+            }
+          return true;
+        }
+    }
+
+  if(m_Prefetch)
+    {
+      m_ReadRanges[name] = std::make_pair(s, c);
+    }
+
+  std::lock_guard<std::mutex> lock(m_H5Mutex);
+
+  HDF5VarGuard *var = GetVar(name);
+  if(!var)
+    return false;
+
+  size_t elemSize = H5Tget_size(var->m_VarType);
+
+  // use data read ahead by the prefetch thread if it is what's asked for
+  const std::vector<char> *buf = nullptr;
+  std::vector<char> tmp;
+
+  std::map<std::string, PrefetchData>::iterator pit = m_Prefetched.find(name);
+  if((pit != m_Prefetched.end()) && (pit->second.ElementSize == elemSize) &&
+     (pit->second.Start == s) && (pit->second.Count == c))
+    {
+      buf = &pit->second.Data;
+    }
+  else if(n == 1)
+    {
+      // read in place
+      hsize_t stride[1] = { 1 };
+      var->ReadSlice(data[0], 1, &s[0], stride, &c[0], NULL);
+      return true;
+    }
+  else
+    {
+      hsize_t total = 0;
+      for(size_t i = 0; i < n; ++i)
+        total += c[i];
+
+      tmp.resize(total * elemSize);
+
+      if(!var->ReadRanges(tmp.data(), s, c))
+        {
+          SENSEI_ERROR("Failed to read H5 dataset: " << name);
+          return false;
+        }
+
+      buf = &tmp;
+    }
+
+  // scatter to the blocks
+  const char *src = buf->data();
+  for(size_t i = 0; i < n; ++i)
+    {
+      size_t nBytes = c[i] * elemSize;
+      memcpy(data[i], src, nBytes);
+      src += nBytes;
+    }
+
+  if(buf != &tmp)
+    m_Prefetched.erase(pit);
+
+  return true;
+}
+
+bool ReadStream::ReadVar1DAggregated(const std::string &name,
+                                     const std::vector<int> &owner,
+                                     const std::vector<hsize_t> &s,
+                                     const std::vector<hsize_t> &c,
+                                     const std::vector<void *> &data)
+{
+  sensei::TimeEvent<128> mark("ReadStream::ReadVar1DAggregated");
+
+  std::lock_guard<std::mutex> lock(m_H5Mutex);
+
+  HDF5VarGuard *var = GetVar(name);
+  if(!var)
+    return false;
+
+  size_t elemSize = H5Tget_size(var->m_VarType);
+  hsize_t nTotal = H5Sget_simple_extent_npoints(var->m_VarSpace);
+
+  // the dataset is split evenly into one contiguous domain per aggregator.
+  // aggregator a is rank a*size/nAgg and reads the part of its domain that
+  // some rank asked for
+  int nAgg = m_Aggregators;
+  size_t nBlocks = s.size();
+
+  std::vector<hsize_t> aggLo(nAgg);
+  std::vector<hsize_t> aggHi(nAgg);
+  int myAgg = -1;
+  for(int a = 0; a < nAgg; ++a)
+    {
+      hsize_t domLo = nTotal * a / nAgg;
+      hsize_t domHi = nTotal * (a + 1) / nAgg;
+
+      aggLo[a] = domHi;
+      aggHi[a] = domLo;
+      for(size_t i = 0; i < nBlocks; ++i)
+        {
+          hsize_t lo = std::max(s[i], domLo);
+          hsize_t hi = std::min(s[i] + c[i], domHi);
+          if(lo < hi)
+            {
+              aggLo[a] = std::min(aggLo[a], lo);
+              aggHi[a] = std::max(aggHi[a], hi);
+            }
+        }
+
+      if(a * m_Size / nAgg == m_Rank)
+        myAgg = a;
+    }
+
+  // collective read, ranks that are not aggregators select nothing
+  hsize_t nRead = 0;
+  if((myAgg >= 0) && (aggLo[myAgg] < aggHi[myAgg]))
+    {
+      nRead = aggHi[myAgg] - aggLo[myAgg];
+      H5Sselect_hyperslab(var->m_VarSpace, H5S_SELECT_SET,
+                          &aggLo[myAgg], NULL, &nRead, NULL);
+    }
+  else
+    {
+      H5Sselect_none(var->m_VarSpace);
+    }
+
+  hsize_t nMem = std::max(nRead, hsize_t(1));
+  hid_t memDataSpace = H5Screate_simple(1, &nMem, NULL);
+  if(nRead == 0)
+    H5Sselect_none(memDataSpace);
+
+  std::vector<char> readBuf(nMem * elemSize);
+
+  hid_t xfer = H5Pcreate(H5P_DATASET_XFER);
+  H5Pset_dxpl_mpio(xfer, H5FD_MPIO_COLLECTIVE);
+
+  herr_t ierr = H5Dread(var->m_VarID, var->m_VarType, memDataSpace,
+                        var->m_VarSpace, xfer, readBuf.data());
+
+  H5Pclose(xfer);
+  H5Sclose(memDataSpace);
+
+  // the owners are waiting on the pieces, a failed read is reported after
+  // the exchange
+  bool ok = ierr >= 0;
+  if(!ok)
+    {
+      SENSEI_ERROR("Failed to read H5 dataset: " << name);
+    }
+
+  // send the pieces to the block owners. pieces are packed by destination
+  // and then by block, which is also the order the owner unpacks them in
+  std::vector<size_t> sendCounts(m_Size, 0);
+  std::vector<size_t> sendDispls(m_Size, 0);
+  std::vector<size_t> recvCounts(m_Size, 0);
+  std::vector<size_t> recvDispls(m_Size, 0);
+
+  std::vector<char> sendBuf;
+  if(nRead)
+    {
+      sendBuf.resize(nRead * elemSize);
+      char *dest = sendBuf.data();
+      for(int r = 0; r < m_Size; ++r)
+        {
+          sendDispls[r] = (dest - sendBuf.data()) / elemSize;
+          for(size_t i = 0; i < nBlocks; ++i)
+            {
+              if(owner[i] != r)
+                continue;
+
+              hsize_t lo = std::max(s[i], aggLo[myAgg]);
+              hsize_t hi = std::min(s[i] + c[i], aggHi[myAgg]);
+              if(lo >= hi)
+                continue;
+
+              size_t nBytes = (hi - lo) * elemSize;
+              memcpy(dest, readBuf.data() + (lo - aggLo[myAgg]) * elemSize,
+                     nBytes);
+
+              dest += nBytes;
+              sendCounts[r] += hi - lo;
+            }
+        }
+    }
+
+  size_t nRecv = 0;
+  for(int a = 0; a < nAgg; ++a)
+    {
+      int src = a * m_Size / nAgg;
+      recvDispls[src] = nRecv;
+      for(size_t i = 0; i < nBlocks; ++i)
+        {
+          if(owner[i] != m_Rank)
+            continue;
+
+          hsize_t lo = std::max(s[i], aggLo[a]);
+          hsize_t hi = std::min(s[i] + c[i], aggHi[a]);
+          if(lo < hi)
+            recvCounts[src] += hi - lo;
+        }
+      nRecv += recvCounts[src];
     }
 
-  HDF5VarGuard g(varID);
+  std::vector<char> recvBuf(std::max(nRecv, size_t(1)) * elemSize);
+
+  // the pieces may be larger than an int can count, they are exchanged
+  // point to point in chunks. messages between a pair of ranks are not
+  // overtaken, so the chunks arrive in order
+  const size_t maxChunk = 1ul << 30;
+  std::vector<MPI_Request> reqs;
+  for(int r = 0; r < m_Size; ++r)
+    {
+      char *p = recvBuf.data() + recvDispls[r] * elemSize;
+      size_t nBytes = recvCounts[r] * elemSize;
+      while(nBytes)
+        {
+          int n = std::min(nBytes, maxChunk);
+          reqs.push_back(MPI_REQUEST_NULL);
+          MPI_Irecv(p, n, MPI_BYTE, r, 0, m_Comm, &reqs.back());
+          p += n;
+          nBytes -= n;
+        }
+    }
+
+  for(int r = 0; r < m_Size; ++r)
+    {
+      char *p = sendBuf.data() + sendDispls[r] * elemSize;
+      size_t nBytes = sendCounts[r] * elemSize;
+      while(nBytes)
+        {
+          int n = std::min(nBytes, maxChunk);
+          reqs.push_back(MPI_REQUEST_NULL);
+          MPI_Isend(p, n, MPI_BYTE, r, 0, m_Comm, &reqs.back());
+          p += n;
+          nBytes -= n;
+        }
+    }
+
+  MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+
+  // unpack into the local blocks
+  const char *src = recvBuf.data();
+  for(int a = 0; a < nAgg; ++a)
+    {
+      size_t k = 0;
+      for(size_t i = 0; i < nBlocks; ++i)
+        {
+          if(owner[i] != m_Rank)
+            continue;
+
+          hsize_t lo = std::max(s[i], aggLo[a]);
+          hsize_t hi = std::min(s[i] + c[i], aggHi[a]);
+          if(lo < hi)
+            {
+              size_t nBytes = (hi - lo) * elemSize;
+              memcpy(static_cast<char *>(data[k]) + (lo - s[i]) * elemSize,
+                     src, nBytes);
+              src += nBytes;
+            }
+          ++k;
+        }
+    }
+
+  return ok;
+}
+
+bool ReadStream::ReadBinary(const std::string &name, sensei::BinaryStream &str)
+{
+  std::lock_guard<std::mutex> lock(m_H5Mutex);
+
+  HDF5VarGuard *var = GetVar(name);
+  if(!var)
+    return false;
+
+  HDF5VarGuard &g = *var;
 
   hsize_t nbytes = H5Sget_simple_extent_npoints(g.m_VarSpace);
   str.Resize(nbytes);
@@ -794,7 +1328,11 @@ bool ReadStream::Init(const std::string &filename)
   return m_Streamer->IsValid();
 }
 
-void ReadStream::Close() {}
+void ReadStream::Close()
+{
+  FinishPrefetch();
+  ClearVarCache();
+}
 
 bool ReadStream::ReadMetadata(unsigned int &nMesh)
 {
@@ -805,6 +1343,40 @@ bool ReadStream::ReadMetadata(unsigned int &nMesh)
   if(nMesh == 0)
     return false;
 
+  // the writer stores a hash of the serialized metadata with each step. a
+  // static mesh has the same metadata every step, in that case the metadata
+  // of the previous step is reused. files written without the hash are
+  // read every step
+  bool haveHash = false;
+  {
+    std::lock_guard<std::mutex> lock(m_H5Mutex);
+    haveHash = H5Aexists(m_Streamer->m_TimeStepId,
+                         senseiHDF5::ATTRNAME_MESHDATA_HASH.c_str()) > 0;
+  }
+
+  unsigned long long hash = 0;
+  if(haveHash &&
+     !ReadNativeAttr(senseiHDF5::ATTRNAME_MESHDATA_HASH,
+                     &hash, H5T_NATIVE_ULLONG, -1))
+    return false;
+
+  if(haveHash && (hash == m_MetadataHash) &&
+     (m_MetadataCache.size() == nMesh))
+    {
+      sensei::TimeEvent<128> mark("senseiHDF5::ReadStream::ReuseMetadata");
+      for(unsigned int i = 0; i < nMesh; ++i)
+        {
+          // the caller may modify the metadata, hand out a copy
+          sensei::MeshMetadataPtr md = m_MetadataCache[i]->NewCopy();
+          m_AllMeshInfo.PushBack(md);
+          m_AllMeshInfoReceiver.PushBack(md);
+        }
+      return true;
+    }
+
+  m_MetadataCache.clear();
+  m_MetadataHash = 0;
+
   for(unsigned int i = 0; i < nMesh; ++i)
     {
       std::string path;
@@ -830,10 +1402,17 @@ bool ReadStream::ReadMetadata(unsigned int &nMesh)
 
       md->NumArrays += 2;
 
+      if(haveHash)
+        m_MetadataCache.push_back(md->NewCopy());
+
       m_AllMeshInfo.PushBack(md);
       m_AllMeshInfoReceiver.PushBack(md);
 
     }
+
+  if(haveHash)
+    m_MetadataHash = hash;
+
   return true;
 }
 
@@ -1003,8 +1582,7 @@ bool MeshFlow::ReadArray(ReadStream *reader,
 
   if (array_name == TAG_VTK_GHOST) {
     ArrayFlow arrayFlow(m_MeshID, association, md);
-    Load(&arrayFlow, md, reader);
-    return true;
+    return Load(&arrayFlow, md, reader);
   }
 
   // read data arrays
@@ -1015,13 +1593,14 @@ bool MeshFlow::ReadArray(ReadStream *reader,
       continue;
 
     ArrayFlow arrayFlow(md, m_MeshID, i);
-    Load(&arrayFlow, md, reader);
+    if (!Load(&arrayFlow, md, reader))
+      return false;
   }
 
   return true;
 }
 
-void MeshFlow::Load(ArrayFlow *arrayFlowPtr, const sensei::MeshMetadataPtr &md,
+bool MeshFlow::Load(ArrayFlow *arrayFlowPtr, const sensei::MeshMetadataPtr &md,
                     ReadStream *reader) {
   unsigned int num_blocks = md->NumBlocks;
 
@@ -1029,15 +1608,26 @@ void MeshFlow::Load(ArrayFlow *arrayFlowPtr, const sensei::MeshMetadataPtr &md,
   it->SetSkipEmptyNodes(0);
   it->InitTraversal();
 
+  // finishLoad may be collective, it is called even if a block failed and
+  // skips the read on all ranks
+  bool ok = true;
   for (unsigned int j = 0; j < num_blocks; ++j) {
     if (md->BlockOwner[j] == reader->m_Rank) {
-      arrayFlowPtr->load(j, it, reader);
+      ok = arrayFlowPtr->load(j, it, reader) && ok;
     }
     arrayFlowPtr->update(j);
     it->GoToNextItem();
   }
 
   it->Delete();
+
+  if (!arrayFlowPtr->finishLoad(reader, ok)) {
+    SENSEI_ERROR("Failed to read array \"" << arrayFlowPtr->GetArrayName()
+                 << "\" of mesh " << m_MeshID);
+    return false;
+  }
+
+  return true;
 }
 
 
@@ -1157,20 +1747,48 @@ void MeshFlow::Unload(ArrayFlow *arrayFlowPtr,
 {
   unsigned int num_blocks = md->NumBlocks;
 
+  std::vector<vtkDataSet *> blocks(num_blocks, nullptr);
+
   vtkCompositeDataIterator *it = m_VtkPtr->NewIterator();
   it->SetSkipEmptyNodes(0);
   it->InitTraversal();
 
-  // ArrayFlow arrayFlow(md, m_MeshID, i);
   for (unsigned int j = 0; j < num_blocks; ++j) {
     if (output->m_Rank == md->BlockOwner[j]) {
-      arrayFlowPtr->unload(j, it, output);
+      blocks[j] = dynamic_cast<vtkDataSet *>(it->GetCurrentDataObject());
+      if (!blocks[j]) {
+        SENSEI_ERROR("Failed to get block " << j);
+        it->Delete();
+        return;
+      }
     }
-    arrayFlowPtr->update(j);
     it->GoToNextItem();
   }
 
   it->Delete();
+
+  // blocks are laid out in block order, each run of consecutive local
+  // blocks is written with one write
+  std::vector<sensei::VTKUtils::BlockRun> runs;
+  sensei::VTKUtils::GetLocalBlockRuns(output->m_Rank, md->BlockOwner, runs);
+
+  unsigned int j = 0;
+  unsigned int num_runs = runs.size();
+  for (unsigned int r = 0; r < num_runs; ++r) {
+    for (; j < runs[r].First; ++j)
+      arrayFlowPtr->update(j);
+
+    std::vector<vtkDataSet *> run(blocks.begin() + runs[r].First,
+                                  blocks.begin() + runs[r].End);
+
+    arrayFlowPtr->unloadRun(run, runs[r].First, output);
+
+    for (; j < runs[r].End; ++j)
+      arrayFlowPtr->update(j);
+  }
+
+  for (; j < num_blocks; ++j)
+    arrayFlowPtr->update(j);
 }
 
 //
@@ -1306,6 +1924,9 @@ ArrayFlow::~ArrayFlow()
 {
   if(-1 != m_ArrayVarID)
     H5Dclose(m_ArrayVarID);
+
+  for(size_t i = 0; i < m_ReadArrays.size(); ++i)
+    m_ReadArrays[i]->Delete();
 }
 
 int ArrayFlow::GetArrayType() {
@@ -1330,19 +1951,6 @@ bool ArrayFlow::load(unsigned int block_id,
                            ? m_Metadata->BlockNumPoints[block_id]
                            : m_Metadata->BlockNumCells[block_id]);
 
-  uint64_t start = m_BlockOffset;
-  uint64_t count = num_elem_local;
-  ;
-
-  vtkDataArray *array = vtkDataArray::CreateDataArray(GetArrayType());
-  array->SetNumberOfComponents(m_NumArrayComponent);
-  array->SetName(GetArrayName().c_str());
-  array->SetNumberOfTuples(num_elem_local);
-
-  if(!reader->ReadVar1D(m_ArrayPath, start, count, array->GetVoidPointer(0)))
-    return false;
-
-  // pass to vtk
   vtkDataSet *ds = dynamic_cast<vtkDataSet *>(it->GetCurrentDataObject());
   if(!ds)
     {
@@ -1351,17 +1959,69 @@ bool ArrayFlow::load(unsigned int block_id,
       return false;
     }
 
+  vtkDataArray *array = vtkDataArray::CreateDataArray(GetArrayType());
+  array->SetNumberOfComponents(m_NumArrayComponent);
+  array->SetName(GetArrayName().c_str());
+  array->SetNumberOfTuples(num_elem_local / m_NumArrayComponent);
+
   vtkDataSetAttributes *dsa =
     (m_ArrayCenter == vtkDataObject::POINT)
     ? dynamic_cast<vtkDataSetAttributes *>(ds->GetPointData())
     : dynamic_cast<vtkDataSetAttributes *>(ds->GetCellData());
 
-  dsa->AddArray(array);
-  array->Delete();
+  // the read happens in finishLoad, for all local blocks at once
+  m_ReadStart.push_back(m_BlockOffset);
+  m_ReadCount.push_back(num_elem_local);
+  m_ReadArrays.push_back(array);
+  m_ReadAttributes.push_back(dsa);
 
   return true;
 }
 
+bool ArrayFlow::finishLoad(ReadStream *reader, bool staged)
+{
+  size_t n = m_ReadArrays.size();
+
+  std::vector<void *> ptrs(n);
+  for(size_t i = 0; i < n; ++i)
+    ptrs[i] = m_ReadArrays[i]->GetVoidPointer(0);
+
+  // aggregated reads are collective. when the ranks are reading different
+  // arrays fall back to independent reads rather than mismatching the
+  // collective calls
+  bool aggregate = reader->GetAggregators() &&
+    reader->SameVarOnAllRanks(m_ArrayPath);
+
+  // an aggregated read delivers every owned block, so when a block failed
+  // to stage on any rank there is nowhere to put it and all ranks skip
+  // the read
+  if(aggregate)
+    staged = reader->AllRanks(staged);
+
+  bool ok = staged && (aggregate ?
+    reader->ReadVar1DAggregated(m_ArrayPath, m_BlockOwner, m_BlockStart,
+                                m_BlockCount, ptrs) :
+    reader->ReadVar1D(m_ArrayPath, m_ReadStart, m_ReadCount, ptrs));
+
+  // pass to vtk
+  for(size_t i = 0; i < n; ++i)
+    {
+      if(ok)
+        m_ReadAttributes[i]->AddArray(m_ReadArrays[i]);
+      m_ReadArrays[i]->Delete();
+    }
+
+  m_BlockOwner.clear();
+  m_BlockStart.clear();
+  m_BlockCount.clear();
+  m_ReadStart.clear();
+  m_ReadCount.clear();
+  m_ReadArrays.clear();
+  m_ReadAttributes.clear();
+
+  return ok;
+}
+
 bool ArrayFlow::unload(unsigned int block_id,
                        vtkCompositeDataIterator *it,
                        WriteStream *output)
@@ -1370,20 +2030,25 @@ bool ArrayFlow::unload(unsigned int block_id,
   if(!ds)
     {
       SENSEI_ERROR("Failed to get block " << block_id);
-      // dob->Print(std::cerr);
-      m_Metadata->ToStream(std::cerr);
-      it->Print(std::cerr);
-      vtkDataObject *d = it->GetCurrentDataObject();
-      d->Print(std::cerr);
       return false;
     }
 
+  std::vector<vtkDataSet *> blocks(1, ds);
+  return unloadRun(blocks, block_id, output);
+}
+
+bool ArrayFlow::unloadRun(const std::vector<vtkDataSet *> &blocks,
+                          unsigned int first_block,
+                          WriteStream *output)
+{
+  vtkDataSet *ds = blocks[0];
+
   vtkDataSetAttributes *dsa =
     m_ArrayCenter == vtkDataObject::POINT
     ? dynamic_cast<vtkDataSetAttributes *>(ds->GetPointData())
     : dynamic_cast<vtkDataSetAttributes *>(ds->GetCellData());
 
-  vtkDataArray *da = dsa->GetArray(GetArrayName().c_str()); 
+  vtkDataArray *da = dsa->GetArray(GetArrayName().c_str());
   if(!da)
     {
       SENSEI_ERROR("Failed to get array \"" << GetArrayName()
@@ -1391,20 +2056,33 @@ bool ArrayFlow::unload(unsigned int block_id,
       return false;
     }
 
+  // the blocks of the run are adjacent in the file, they are written from
+  // a single contiguous buffer
+  sensei::VTKUtils::DataArraySerializer serializer(GetArrayName(),
+                                                   m_ArrayCenter);
+  const void *data = nullptr;
+  unsigned long long nBytes = 0;
+  if(sensei::VTKUtils::Serialize(blocks, serializer, m_Staging, data, nBytes))
+    {
+      SENSEI_ERROR("Failed to serialize array \"" << GetArrayName()
+                   << "\"");
+      return false;
+    }
+
   hid_t h5TypeCurrArray = gGetHDF5Type(da);
-  unsigned long long num_elem_local =
-    m_NumArrayComponent * getLocalElement(block_id);
 
-  HDF5SpaceGuard arraySpace(m_ElementTotal, m_BlockOffset, num_elem_local);
+  unsigned long long num_elem_local = 0;
+  unsigned int num_blocks = blocks.size();
+  for(unsigned int j = 0; j < num_blocks; ++j)
+    num_elem_local += m_NumArrayComponent * getLocalElement(first_block + j);
 
-  // if (-1 == m_ArrayVarID)
-  // m_ArrayVarID = output->CreateVar(m_ArrayPath, arraySpace, h5TypeCurrArray);
+  HDF5SpaceGuard arraySpace(m_ElementTotal, m_BlockOffset, num_elem_local);
 
   output->WriteVar(m_ArrayVarID,
                    m_ArrayPath,
                    arraySpace,
                    h5TypeCurrArray,
-                   da->GetVoidPointer(0));
+                   const_cast<void *>(data));
 
   return true;
 }
@@ -1421,6 +2099,10 @@ bool ArrayFlow::update(unsigned int block_id)
   unsigned long long num_elem_local =
     m_NumArrayComponent * getLocalElement(block_id);
 
+  m_BlockOwner.push_back(m_Metadata->BlockOwner[block_id]);
+  m_BlockStart.push_back(m_BlockOffset);
+  m_BlockCount.push_back(num_elem_local);
+
   m_BlockOffset += num_elem_local;
 
   return true;
@@ -1608,43 +2290,22 @@ bool PolydataCellFlow::unload(unsigned int block_id,
       return false;
     }
 
-  std::vector<char> types;
-  std::vector<vtkIdType> cells;
+  // the serializers move the polydata's various cell arrays into a single
+  // contiguous array and build a cell types array
+  sensei::VTKUtils::CellTypesSerializer typeSerializer;
+  sensei::VTKUtils::CellArraySerializer cellSerializer;
+  std::vector<unsigned char> types;
+  std::vector<unsigned char> cells;
+  const void *pTypes = nullptr;
+  const void *pCells = nullptr;
+  unsigned long long typeBytes = 0;
+  unsigned long long cellBytes = 0;
 
-  vtkIdType nv = pd->GetNumberOfVerts();
-  if(nv)
+  if(sensei::VTKUtils::Serialize(pd, typeSerializer, types, pTypes, typeBytes) ||
+     sensei::VTKUtils::Serialize(pd, cellSerializer, cells, pCells, cellBytes))
     {
-      types.insert(types.end(), nv, VTK_VERTEX);
-      vtkIdType *pv = pd->GetVerts()->GetData()->GetPointer(0);
-      cells.insert(
-        cells.end(), pv, pv + pd->GetVerts()->GetData()->GetNumberOfTuples());
-    }
-
-  vtkIdType nl = pd->GetNumberOfLines();
-  if(nl)
-    {
-      types.insert(types.end(), nl, VTK_LINE);
-      vtkIdType *pl = pd->GetLines()->GetData()->GetPointer(0);
-      cells.insert(
-        cells.end(), pl, pl + pd->GetLines()->GetData()->GetNumberOfTuples());
-    }
-
-  vtkIdType np = pd->GetNumberOfPolys();
-  if(np)
-    {
-      types.insert(types.end(), np, VTK_POLYGON);
-      vtkIdType *pp = pd->GetPolys()->GetData()->GetPointer(0);
-      cells.insert(
-        cells.end(), pp, pp + pd->GetPolys()->GetData()->GetNumberOfTuples());
-    }
-
-  vtkIdType ns = pd->GetNumberOfStrips();
-  if(ns)
-    {
-      types.insert(types.end(), ns, VTK_TRIANGLE_STRIP);
-      vtkIdType *ps = pd->GetStrips()->GetData()->GetPointer(0);
-      cells.insert(
-        cells.end(), ps, ps + pd->GetStrips()->GetData()->GetNumberOfTuples());
+      SENSEI_ERROR("Failed to serialize the cells of block " << block_id);
+      return false;
     }
 
   HDF5SpaceGuard cellArraySpace(
@@ -1657,7 +2318,7 @@ bool PolydataCellFlow::unload(unsigned int block_id,
                    m_CellArrayVarName,
                    cellArraySpace,
                    h5TypeCellArray,
-                   cells.data());
+                   const_cast<void *>(pCells));
 
   HDF5SpaceGuard cellTypeSpace(
     m_TotalCell, m_CellTypesBlockOffset, num_cells_local);
@@ -1669,7 +2330,7 @@ bool PolydataCellFlow::unload(unsigned int block_id,
                    m_CellTypeVarName,
                    cellTypeSpace,
                    h5TypeCellType,
-                   types.data());
+                   const_cast<void *>(pTypes));
 
   return true;
 }
@@ -1918,6 +2579,16 @@ bool PointFlow::unload(unsigned int block_id,
       return false;
     }
 
+  sensei::VTKUtils::PointsSerializer serializer;
+  std::vector<unsigned char> staging;
+  const void *data = nullptr;
+  unsigned long long nBytes = 0;
+  if(sensei::VTKUtils::Serialize(ds, serializer, staging, data, nBytes))
+    {
+      SENSEI_ERROR("Failed to serialize the points of block " << block_id);
+      return false;
+    }
+
   HDF5SpaceGuard space(3 * m_GlobalTotal, start, count);
 
   // if (-1 == m_PointVarID)
@@ -1927,7 +2598,7 @@ bool PointFlow::unload(unsigned int block_id,
                    m_PointVarName,
                    space,
                    m_PointType,
-                   ds->GetPoints()->GetData()->GetVoidPointer(0));
+                   const_cast<void *>(data));
 
   return true;
 }
@@ -2281,6 +2952,7 @@ WriteStream::WriteStream(MPI_Comm comm, bool streaming)
   : BasicStream(comm, streaming)
 {
   m_MeshCounter = 0;
+  m_MetadataHash = gHashSeed;
 }
 
 bool WriteStream::Init(const std::string &filename)
@@ -2293,13 +2965,23 @@ bool WriteStream::Init(const std::string &filename)
   return m_Streamer->IsValid();
 }
 
+void WriteStream::WriteStepMetadataAttrs()
+{
+  WriteNativeAttr(
+    senseiHDF5::ATTRNAME_NUM_MESH, &(m_MeshCounter), H5T_NATIVE_UINT, -1);
+
+  // lets a reader skip reading the metadata when it did not change
+  WriteNativeAttr(senseiHDF5::ATTRNAME_MESHDATA_HASH,
+                  &(m_MetadataHash), H5T_NATIVE_ULLONG, -1);
+}
+
 bool WriteStream::AdvanceTimeStep(unsigned long &time_step, double &time)
 {
   if(m_Streamer->m_TimeStepCounter > 0)
-    WriteNativeAttr(
-      senseiHDF5::ATTRNAME_NUM_MESH, &(m_MeshCounter), H5T_NATIVE_UINT, -1);
+    WriteStepMetadataAttrs();
 
   m_MeshCounter = 0;
+  m_MetadataHash = gHashSeed;
   m_Streamer->AdvanceStream();
 
   WriteNativeAttr(
@@ -2403,6 +3085,12 @@ bool WriteStream::WriteMetadata(sensei::MeshMetadataPtr &md)
   sensei::BinaryStream bs;
   md->ToStream(bs);
 
+  // the size separates the meshes
+  unsigned long nBytes = bs.Size();
+  m_MetadataHash = gHashBytes(m_MetadataHash,
+    reinterpret_cast<const unsigned char *>(&nBytes), sizeof(nBytes));
+  m_MetadataHash = gHashBytes(m_MetadataHash, bs.GetData(), nBytes);
+
   WriteBinary(path, bs);
   return true;
 }
@@ -2412,8 +3100,7 @@ WriteStream::~WriteStream()
 {
   if(m_Streamer->m_TimeStepCounter > 0)
     {
-      WriteNativeAttr(
-        senseiHDF5::ATTRNAME_NUM_MESH, &(m_MeshCounter), H5T_NATIVE_UINT, -1);
+      WriteStepMetadataAttrs();
       CloseTimeStep();
     }
   m_Streamer->Summary();
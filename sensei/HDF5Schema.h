@@ -3,6 +3,8 @@
 
 class vtkDataSet;
 class vtkDataObject;
+class vtkDataArray;
+class vtkDataSetAttributes;
 typedef struct _ADIOS_FILE ADIOS_FILE;
 
 #include "MeshMetadata.h"
@@ -10,9 +12,12 @@ typedef struct _ADIOS_FILE ADIOS_FILE;
 #include "hdf5.h"
 //#include <adios_read.h>
 #include <cstdint>
+#include <map>
 #include <mpi.h>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 #include <vtkCompositeDataSet.h>
 #include <vtkDataObject.h>
@@ -54,6 +59,13 @@ public:
                  const hsize_t *count,
                  const hsize_t *block);
 
+  // reads the union of the 1D ranges [start[i], start[i]+count[i]) with a
+  // single H5Dread. the ranges must be increasing and disjoint, they land
+  // back to back in buf
+  bool ReadRanges(void *buf,
+                  const std::vector<hsize_t> &start,
+                  const std::vector<hsize_t> &count);
+
   hid_t m_VarID;
   hid_t m_VarType;
   hid_t m_VarSpace;
@@ -112,6 +124,12 @@ public:
   virtual bool IsValid() = 0;
   virtual bool Summary() = 0;
 
+  // opens step ts without touching the current step. this is used to read
+  // ahead from a background thread, so it must not be collective. returns
+  // -1 when the handler can not do this
+  virtual hid_t OpenStep(unsigned int) { return -1; }
+  virtual void CloseStep(hid_t) {}
+
   hid_t m_TimeStepId;
   unsigned int m_TimeStepCounter = 0;
 
@@ -135,6 +153,9 @@ public:
   bool IsValid();
   bool Summary();
 
+  hid_t OpenStep(unsigned int ts);
+  void CloseStep(hid_t stepId);
+
 private:
   hid_t m_HostFileId;
   unsigned int m_TimeStepTotal = 0;
@@ -238,7 +259,11 @@ public:
                 void *data);
 
 private:
+  // writes the number of meshes and the metadata hash of the current step
+  void WriteStepMetadataAttrs();
+
   unsigned int m_MeshCounter;
+  unsigned long long m_MetadataHash; // of the metadata written this step
 };
 
 class ReadStream : public BasicStream
@@ -273,8 +298,90 @@ public:
   bool ReadBinary(const std::string &name, sensei::BinaryStream &str);
   bool ReadVar1D(const std::string &name, hsize_t s, hsize_t c, void *data);
 
+  // reads a number of increasing, disjoint ranges of a 1D dataset with a
+  // single request. range i lands in data[i]
+  bool ReadVar1D(const std::string &name,
+                 const std::vector<hsize_t> &s,
+                 const std::vector<hsize_t> &c,
+                 const std::vector<void *> &data);
+
+  // collective over the stream's communicator. block i, the range
+  // [s[i], s[i]+c[i]), is delivered to rank owner[i]. a subset of ranks,
+  // the aggregators, read contiguous pieces of the dataset collectively and
+  // scatter them to the owners. the blocks this rank owns land in data, in
+  // order
+  bool ReadVar1DAggregated(const std::string &name,
+                           const std::vector<int> &owner,
+                           const std::vector<hsize_t> &s,
+                           const std::vector<hsize_t> &c,
+                           const std::vector<void *> &data);
+
+  // sets the number of ranks that read on behalf of all the others, 0 (the
+  // default) has each rank read its own blocks. aggregated reads are
+  // collective, see ReadVar1DAggregated
+  void SetAggregators(int n);
+  int GetAggregators() const { return m_Aggregators; }
+
+  // collective over the stream's communicator. returns true when every rank
+  // is about to read the same variable, in which case an aggregated read
+  // may be used
+  bool SameVarOnAllRanks(const std::string &name);
+
+  // collective over the stream's communicator. returns true when val is
+  // true on every rank
+  bool AllRanks(bool val);
+
+  // when enabled, the arrays read during a step are read from the following
+  // step by a background thread while the current step is processed. this
+  // needs MPI_THREAD_MULTIPLE and a stream whose steps can be opened
+  // independently, otherwise it is disabled with a warning
+  void SetPrefetch(bool val);
+  bool GetPrefetch() const { return m_Prefetch; }
+
 private:
+  // a range set read ahead of time, the data is the ranges back to back
+  struct PrefetchData
+  {
+    std::vector<hsize_t> Start;
+    std::vector<hsize_t> Count;
+    size_t ElementSize = 0;
+    std::vector<char> Data;
+  };
+
+  using RangeMap =
+    std::map<std::string, std::pair<std::vector<hsize_t>, std::vector<hsize_t>>>;
+
+  // returns a dataset in the current step, opened on first use and
+  // kept open until the step advances
+  HDF5VarGuard *GetVar(const std::string &name);
+  void ClearVarCache();
+
+  void StartPrefetch();
+  void FinishPrefetch();
+  static void Prefetch(StreamHandler *streamer, unsigned int step,
+                       RangeMap ranges, std::mutex *h5Mutex,
+                       std::map<std::string, PrefetchData> *result);
+
   unsigned int m_TimeStepTotal;
+
+  std::map<std::string, HDF5VarGuard *> m_VarCache;
+
+  // the metadata of the last step read. when the hash the writer stored
+  // with a step matches it is used rather than read again
+  std::vector<sensei::MeshMetadataPtr> m_MetadataCache;
+  unsigned long long m_MetadataHash = 0;
+
+  // serializes HDF5 calls with the prefetch thread, HDF5 is in general not
+  // built thread safe
+  std::mutex m_H5Mutex;
+
+  int m_Aggregators = 0;
+
+  bool m_Prefetch = false;
+  std::thread m_PrefetchThread;
+  RangeMap m_ReadRanges;       // what was read during this step
+  std::map<std::string, PrefetchData> m_Prefetched;  // this step, read ahead
+  std::map<std::string, PrefetchData> m_NextPrefetched; // being read ahead
 };
 
 class ArrayFlow;
@@ -308,7 +415,7 @@ private:
   void Unload(ArrayFlow *arrayFlowPtr, 
 	      const sensei::MeshMetadataPtr &md,
               WriteStream *output);
-  void Load(ArrayFlow *arrayFlowPtr, 
+  bool Load(ArrayFlow *arrayFlowPtr, 
 	    const sensei::MeshMetadataPtr &md,
             ReadStream *reader);
 
@@ -385,6 +492,17 @@ public:
               WriteStream *output);
   bool update(unsigned int block_id);
 
+  // writes a run of consecutive blocks, starting at first_block, from a
+  // single contiguous buffer
+  bool unloadRun(const std::vector<vtkDataSet *> &blocks,
+                 unsigned int first_block,
+                 WriteStream *output);
+
+  // load only stages the blocks, this reads all of the staged blocks with
+  // one request and passes them to VTK. staged is false when a block
+  // failed to stage, the read is skipped and false is returned
+  bool finishLoad(ReadStream *reader, bool staged);
+
   int GetArrayType();
   const std::string &GetArrayName();
 
@@ -401,7 +519,20 @@ private:
   int m_ArrayCenter;
   unsigned long long m_NumArrayComponent;
   unsigned long long m_ElementTotal = 0;
-  ;
+
+  // all blocks, for aggregated reads
+  std::vector<int> m_BlockOwner;
+  std::vector<hsize_t> m_BlockStart;
+  std::vector<hsize_t> m_BlockCount;
+
+  // reused by unloadRun
+  std::vector<unsigned char> m_Staging;
+
+  // blocks staged by load
+  std::vector<hsize_t> m_ReadStart;
+  std::vector<hsize_t> m_ReadCount;
+  std::vector<vtkDataArray *> m_ReadArrays;
+  std::vector<vtkDataSetAttributes *> m_ReadAttributes;
 };
 
 
@@ -0,0 +1,302 @@
+#include "ImageCompositor.h"
+#include "Profiler.h"
+#include "Error.h"
+
+#include <sdiy/master.hpp>
+#include <sdiy/assigner.hpp>
+#include <sdiy/decomposition.hpp>
+#include <sdiy/reduce.hpp>
+#include <sdiy/partners/swap.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace sensei
+{
+
+namespace
+{
+// the pixels [First, Last) a rank is responsible for during the reduction
+struct ImageBlock
+{
+  static void *create() { return new ImageBlock; }
+  static void destroy(void *b) { delete static_cast<ImageBlock*>(b); }
+
+  long First;
+  long Last;
+  std::vector<float> Depth;
+  std::vector<unsigned char> RGBA;
+};
+
+// encode pixels [p0, p1) of a block. only the runs of non-empty pixels are
+// kept, runs holds the first pixel and the length of each run followed by
+// the next run
+void Encode(const ImageBlock &b, long p0, long p1, std::vector<long> &runs,
+  std::vector<float> &depth, std::vector<unsigned char> &rgba)
+{
+  const float *pd = b.Depth.data();
+  const unsigned char *pc = b.RGBA.data();
+
+  long i = p0 - b.First;
+  long i1 = p1 - b.First;
+  while (i < i1)
+    {
+    while ((i < i1) && (pd[i] >= 1.0f))
+      ++i;
+
+    long r0 = i;
+    while ((i < i1) && (pd[i] < 1.0f))
+      ++i;
+
+    if (i > r0)
+      {
+      runs.push_back(b.First + r0);
+      runs.push_back(i - r0);
+      depth.insert(depth.end(), pd + r0, pd + i);
+      rgba.insert(rgba.end(), pc + 4*r0, pc + 4*i);
+      }
+    }
+}
+
+// composite the runs of pixels received from a partner into a block. the
+// nearest pixel wins
+void Merge(ImageBlock &b, const std::vector<long> &runs,
+  const std::vector<float> &depth, const std::vector<unsigned char> &rgba)
+{
+  float *pd = b.Depth.data();
+  unsigned char *pc = b.RGBA.data();
+
+  long q = 0;
+  unsigned long nRuns = runs.size();
+  for (unsigned long r = 0; r < nRuns; r += 2)
+    {
+    long i0 = runs[r] - b.First;
+    long i1 = i0 + runs[r+1];
+    for (long i = i0; i < i1; ++i, ++q)
+      {
+      if (depth[q] < pd[i])
+        {
+        pd[i] = depth[q];
+        memcpy(pc + 4*i, rgba.data() + 4*q, 4);
+        }
+      }
+    }
+}
+
+// a round of the swap reduction. the pixels received from the partners are
+// composited and then the pixels are split among the partners of the next
+// round, this rank keeps its own share
+void Swap(void *pb, const sdiy::ReduceProxy &rp,
+  const sdiy::RegularSwapPartners &)
+{
+  ImageBlock *b = static_cast<ImageBlock*>(pb);
+
+  int nIn = rp.in_link().size();
+  for (int i = 0; i < nIn; ++i)
+    {
+    int gid = rp.in_link().target(i).gid;
+    if (gid == rp.gid())
+      continue;
+
+    std::vector<long> runs;
+    std::vector<float> depth;
+    std::vector<unsigned char> rgba;
+
+    rp.dequeue(gid, runs);
+    rp.dequeue(gid, depth);
+    rp.dequeue(gid, rgba);
+
+    Merge(*b, runs, depth, rgba);
+    }
+
+  int nOut = rp.out_link().size();
+  if (nOut == 0)
+    return;
+
+  long n = b->Last - b->First;
+  long first = b->First;
+  long last = b->Last;
+  for (int i = 0; i < nOut; ++i)
+    {
+    long p0 = b->First + n*i/nOut;
+    long p1 = b->First + n*(i+1)/nOut;
+
+    sdiy::BlockID target = rp.out_link().target(i);
+    if (target.gid == rp.gid())
+      {
+      first = p0;
+      last = p1;
+      continue;
+      }
+
+    std::vector<long> runs;
+    std::vector<float> depth;
+    std::vector<unsigned char> rgba;
+
+    Encode(*b, p0, p1, runs, depth, rgba);
+
+    rp.enqueue(target, runs);
+    rp.enqueue(target, depth);
+    rp.enqueue(target, rgba);
+    }
+
+  // keep this rank's share
+  long i0 = first - b->First;
+  long i1 = last - b->First;
+
+  std::vector<float> depth(b->Depth.begin() + i0, b->Depth.begin() + i1);
+  std::vector<unsigned char> rgba(b->RGBA.begin() + 4*i0, b->RGBA.begin() + 4*i1);
+
+  b->Depth.swap(depth);
+  b->RGBA.swap(rgba);
+  b->First = first;
+  b->Last = last;
+}
+}
+
+// --------------------------------------------------------------------------
+ImageCompositor::ImageCompositor() : Comm(MPI_COMM_WORLD), Radix(4),
+  Root(0), First(0), Last(0)
+{
+}
+
+// --------------------------------------------------------------------------
+ImageCompositor::~ImageCompositor()
+{
+}
+
+// --------------------------------------------------------------------------
+void ImageCompositor::SetCommunicator(MPI_Comm comm)
+{
+  this->Comm = comm;
+}
+
+// --------------------------------------------------------------------------
+int ImageCompositor::Composite(int width, int height, int nImages,
+  std::vector<float> &depth, std::vector<unsigned char> &rgba)
+{
+  TimeEvent<128> mark("ImageCompositor::Composite");
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(this->Comm, &rank);
+  MPI_Comm_size(this->Comm, &nRanks);
+
+  long nPixels = long(width)*long(height)*long(nImages);
+
+  if ((long(depth.size()) != nPixels) || (long(rgba.size()) != 4*nPixels))
+    {
+    SENSEI_ERROR("Expected " << nImages << " images of " << width << " by "
+      << height << " pixels but got " << depth.size() << " depth and "
+      << rgba.size() << " color values")
+    return -1;
+    }
+
+  if (this->Root >= nRanks)
+    {
+    SENSEI_ERROR("Invalid root " << this->Root << " with " << nRanks << " ranks")
+    return -1;
+    }
+
+  this->First = 0;
+  this->Last = nPixels;
+
+  if (nRanks < 2)
+    return 0;
+
+  // one block per rank holding all of the pixels to start with
+  ImageBlock *b = new ImageBlock;
+  b->First = 0;
+  b->Last = nPixels;
+  b->Depth.swap(depth);
+  b->RGBA.swap(rgba);
+
+  {
+  sdiy::Master master(this->Comm, 1, -1, &ImageBlock::create,
+    &ImageBlock::destroy);
+
+  master.add(rank, b, new sdiy::Link);
+
+  sdiy::ContiguousAssigner assigner(nRanks, nRanks);
+
+  sdiy::RegularDecomposer<sdiy::DiscreteBounds> decomposer(1,
+    sdiy::interval(0, nRanks - 1), nRanks);
+
+  sdiy::RegularSwapPartners partners(decomposer, std::max(2, this->Radix), false);
+
+  sdiy::reduce(master, assigner, partners, &Swap);
+
+  // take the result before the master deletes the block
+  this->First = b->First;
+  this->Last = b->Last;
+  depth.swap(b->Depth);
+  rgba.swap(b->RGBA);
+  }
+
+  if (this->Root < 0)
+    return 0;
+
+  return this->Gather(nPixels, depth, rgba);
+}
+
+// --------------------------------------------------------------------------
+int ImageCompositor::Gather(long nPixels, std::vector<float> &depth,
+  std::vector<unsigned char> &rgba)
+{
+  TimeEvent<128> mark("ImageCompositor::Gather");
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(this->Comm, &rank);
+  MPI_Comm_size(this->Comm, &nRanks);
+
+  if (4*nPixels > std::numeric_limits<int>::max())
+    {
+    SENSEI_ERROR("Can't gather " << nPixels << " pixels")
+    return -1;
+    }
+
+  bool root = rank == this->Root;
+
+  // the pixels held by each rank
+  long range[2] = {this->First, this->Last};
+  std::vector<long> ranges(root ? 2*nRanks : 0);
+
+  MPI_Gather(range, 2, MPI_LONG, ranges.data(), 2, MPI_LONG,
+    this->Root, this->Comm);
+
+  std::vector<int> counts(root ? nRanks : 0);
+  std::vector<int> displ(root ? nRanks : 0);
+  for (int i = 0; root && (i < nRanks); ++i)
+    {
+    displ[i] = ranges[2*i];
+    counts[i] = ranges[2*i+1] - ranges[2*i];
+    }
+
+  std::vector<float> allDepth(root ? nPixels : 0);
+  std::vector<unsigned char> allRGBA(root ? 4*nPixels : 0);
+
+  MPI_Gatherv(depth.data(), depth.size(), MPI_FLOAT, allDepth.data(),
+    counts.data(), displ.data(), MPI_FLOAT, this->Root, this->Comm);
+
+  for (int i = 0; root && (i < nRanks); ++i)
+    {
+    displ[i] *= 4;
+    counts[i] *= 4;
+    }
+
+  MPI_Gatherv(rgba.data(), rgba.size(), MPI_UNSIGNED_CHAR, allRGBA.data(),
+    counts.data(), displ.data(), MPI_UNSIGNED_CHAR, this->Root, this->Comm);
+
+  depth.swap(allDepth);
+  rgba.swap(allRGBA);
+
+  this->First = 0;
+  this->Last = root ? nPixels : 0;
+
+  return 0;
+}
+
+}
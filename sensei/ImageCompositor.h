@@ -0,0 +1,75 @@
+#ifndef sensei_ImageCompositor_h
+#define sensei_ImageCompositor_h
+
+#include <mpi.h>
+#include <vector>
+
+namespace sensei
+{
+
+/// Composites images rendered in parallel using depth (sort-last
+/// compositing). Each rank provides one or more images of the same size made
+/// of a depth and an RGBA value per pixel, the pixel with the smallest depth
+/// wins. A depth of 1 marks an empty pixel.
+///
+/// Images are exchanged with sdiy's swap reduction using
+/// RegularSwapPartners. With a radix of 2 this is binary swap, larger values
+/// give radix-k which has fewer rounds. In each round a rank splits the pixels
+/// it is responsible for among its partners. Only the runs of non-empty
+/// pixels are sent. All images of a step, for instance the camera views of a
+/// Cinema run, are treated as a single long image so they are composited in
+/// the same number of rounds as a single one. The result is either gathered
+/// on a root rank or left distributed. CinemaHelper::CaptureCompositedImages
+/// uses it to composite the views rendered from the local data of each rank.
+class ImageCompositor
+{
+public:
+  ImageCompositor();
+  ~ImageCompositor();
+
+  /// set the communicator. the default is MPI_COMM_WORLD.
+  void SetCommunicator(MPI_Comm comm);
+  MPI_Comm GetCommunicator() const { return this->Comm; }
+
+  /// set the number of partners a rank exchanges pixels with in each round.
+  /// 2 gives binary swap. the default is 4.
+  void SetRadix(int k) { this->Radix = k; }
+  int GetRadix() const { return this->Radix; }
+
+  /// set the rank that receives the result. when negative the result is left
+  /// distributed, see GetPixelRange. the default is 0.
+  void SetRoot(int root) { this->Root = root; }
+  int GetRoot() const { return this->Root; }
+
+  /// composite nImages images of width by height pixels. depth holds a value
+  /// per pixel and rgba 4 values per pixel, image i starts at pixel
+  /// i*width*height. on return the arrays hold the pixels of the composited
+  /// images given by GetPixelRange. This is collective, all ranks must pass
+  /// the same number and size of images.
+  int Composite(int width, int height, int nImages, std::vector<float> &depth,
+    std::vector<unsigned char> &rgba);
+
+  /// get the range of pixels [first, last) this rank holds after the most
+  /// recent call to Composite. when a root is set this is all of the pixels
+  /// on the root and an empty range elsewhere.
+  void GetPixelRange(long &first, long &last) const
+  { first = this->First; last = this->Last; }
+
+private:
+  ImageCompositor(const ImageCompositor &) = delete;
+  void operator=(const ImageCompositor &) = delete;
+
+  // gather the distributed result on the root
+  int Gather(long nPixels, std::vector<float> &depth,
+    std::vector<unsigned char> &rgba);
+
+  MPI_Comm Comm;
+  int Radix;
+  int Root;
+  long First;
+  long Last;
+};
+
+}
+
+#endif
@@ -8,6 +8,8 @@
 #include "HDF5DataAdaptor.h"
 #endif
 
+#include "MMapDataAdaptor.h"
+#include "MPIDataAdaptor.h"
 #include "XMLUtils.h"
 #include "Error.h"
 
@@ -76,6 +78,14 @@ int Initialize(MPI_Comm comm, const pugi::xml_node &root, InTransitDataAdaptor *
     dataAdaptor = HDF5DataAdaptor::New();
 #endif
     }
+  else if (type == "mmap")
+    {
+    dataAdaptor = MMapDataAdaptor::New();
+    }
+  else if (type == "mpi")
+    {
+    dataAdaptor = MPIDataAdaptor::New();
+    }
   else if (type == "libis")
     {
     // Create LibIS InTransitDataAdaptor
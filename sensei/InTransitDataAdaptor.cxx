@@ -104,6 +104,62 @@ int InTransitDataAdaptor::GetReceiverMeshMetadata(unsigned int id,
   return 0;
 }
 
+//----------------------------------------------------------------------------
+int InTransitDataAdaptor::PartitionMeshes(std::vector<MeshMetadataPtr> &receiverMd)
+{
+  TimeEvent<128> mark("InTransitDataAdaptor::PartitionMeshes");
+
+  unsigned int nMeshes = 0;
+  if (this->GetNumberOfMeshes(nMeshes))
+    {
+    SENSEI_ERROR("Failed to get the number of meshes")
+    return -1;
+    }
+
+  receiverMd.resize(nMeshes);
+
+  // gather the sender layout of the meshes that an analysis has not
+  // already laid out
+  std::vector<unsigned int> ids;
+  std::vector<MeshMetadataPtr> senderMd;
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    if (!this->GetReceiverMeshMetadata(i, receiverMd[i]))
+      continue;
+
+    MeshMetadataPtr md;
+    if (this->GetSenderMeshMetadata(i, md))
+      {
+      SENSEI_ERROR("Failed to get sender metadata for mesh " << i)
+      return -1;
+      }
+
+    ids.push_back(i);
+    senderMd.push_back(md);
+    }
+
+  if (ids.empty())
+    return 0;
+
+  // get the partitioner, default to the block partitioner
+  PartitionerPtr part = this->GetPartitioner();
+  if (!part)
+    part = BlockPartitioner::New();
+
+  std::vector<MeshMetadataPtr> partMd;
+  if (part->GetPartitions(this->GetCommunicator(), senderMd, partMd))
+    {
+    SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
+    return -1;
+    }
+
+  unsigned int nIds = ids.size();
+  for (unsigned int i = 0; i < nIds; ++i)
+    receiverMd[ids[i]] = partMd[i];
+
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 int InTransitDataAdaptor::SetReceiverMeshMetadata(unsigned int id,
   MeshMetadataPtr &metadata)
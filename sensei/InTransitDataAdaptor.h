@@ -86,6 +86,14 @@ protected:
   InTransitDataAdaptor();
   ~InTransitDataAdaptor();
 
+  // Get the receiver metadata of every mesh. Meshes with receiver metadata
+  // set by an analysis use it, the rest are passed to the partitioner in a
+  // single call to Partitioner::GetPartitions so that any communication
+  // needed happens once per step rather than once per mesh. This must be
+  // called by all ranks. Derived classes use it the first time a layout is
+  // requested in a step and cache the result for the rest of the step.
+  int PartitionMeshes(std::vector<MeshMetadataPtr> &receiverMd);
+
   InTransitDataAdaptor(const InTransitDataAdaptor&) = delete;
   void operator=(const InTransitDataAdaptor&) = delete;
 
@@ -1,10 +1,13 @@
 #include "IsoSurfacePartitioner.h"
+#include "BlockPartitioner.h"
 #include "XMLUtils.h"
 #include "STLUtils.h"
 #include "VTKUtils.h"
 #include "Profiler.h"
 
 #include <array>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <sstream>
 
@@ -34,6 +37,7 @@ void IsoSurfacePartitioner::SetIsoValues(const std::string &meshName,
   this->ArrayName = arrayName;
   this->ArrayCentering = arrayCentering;
   this->IsoValues = isoVals;
+  this->Cache.clear();
 }
 
 // --------------------------------------------------------------------------
@@ -51,6 +55,32 @@ int IsoSurfacePartitioner::GetIsoValues(std::string &meshName,
   return 0;
 }
 
+// --------------------------------------------------------------------------
+double IsoSurfacePartitioner::GetBlockWeight(long numCells,
+  const std::array<double,2> &rng) const
+{
+  // the surface through a block grows like the area of its cross section.
+  // a value near the middle of the range is likely to cut through more of
+  // the block than one near either end. blocks that don't contain any of
+  // the values aren't needed.
+  double area = std::pow(std::max(numCells, 1l), 2.0/3.0);
+  double width = rng[1] - rng[0];
+
+  double weight = 0.0;
+  int nVals = this->IsoValues.size();
+  for (int k = 0; k < nVals; ++k)
+    {
+    double val = this->IsoValues[k];
+    if ((val < rng[0]) || (val > rng[1]))
+      continue;
+
+    double pos = width > 0.0 ? 2.0*(val - rng[0])/width - 1.0 : 0.0;
+    weight += std::max(1.0 - std::fabs(pos), 0.1);
+    }
+
+  return area*weight;
+}
+
 // --------------------------------------------------------------------------
 int IsoSurfacePartitioner::GetPartition(MPI_Comm comm,
   const MeshMetadataPtr &mdIn, MeshMetadataPtr &mdOut)
@@ -64,67 +94,83 @@ int IsoSurfacePartitioner::GetPartition(MPI_Comm comm,
     return -1;
     }
 
-  // locate the active blocks
-  std::set<int> activeBlocks;
-  for (int i = 0; i < mdIn->NumArrays; ++i)
+  // find the array
+  int arrayId = -1;
+  for (int i = 0; (arrayId < 0) && (i < mdIn->NumArrays); ++i)
     {
-    // see if this array is being used, if not skip it
-    const std::string &array = mdIn->ArrayName[i];
-    if (this->ArrayName != array)
-      continue;
+    if (this->ArrayName == mdIn->ArrayName[i])
+      arrayId = i;
+    }
 
-    // walk blocks and see if any of them are needed
-    const std::vector<double> &vals = this->IsoValues;
-    int nvals = vals.size();
-    for (int j = 0; j < mdIn->NumBlocks; ++j)
-      {
-      std::array<double,2> &rng = mdIn->BlockArrayRange[j][i];
-      for (int k = 0; k < nvals; ++k)
-        {
-        // if the value is in the range then this block is needed
-        double val = vals[k];
-        if ((val >= rng[0]) && (val <= rng[1]))
-          activeBlocks.insert(j);
-        }
-      }
+  int nBlocks = mdIn->NumBlocks;
+  if ((arrayId >= 0) &&
+    (mdIn->BlockArrayRange.size() != static_cast<unsigned int>(nBlocks)))
+    {
+    SENSEI_ERROR("Block array ranges are required")
+    return -1;
     }
 
-  // partition the needed blocks to ranks equally
-  int nRanks = 1;
-  MPI_Comm_size(comm, &nRanks);
+  // gather the inputs. when the array is not present no blocks are needed.
+  std::vector<std::array<double,2>> ranges;
+  if (arrayId >= 0)
+    {
+    ranges.resize(nBlocks);
+    for (int j = 0; j < nBlocks; ++j)
+      ranges[j] = mdIn->BlockArrayRange[j][arrayId];
+    }
 
-  int numActiveBlocks = activeBlocks.size();
+  std::vector<long> numCells(mdIn->BlockNumCells);
+  if (numCells.size() != static_cast<unsigned int>(nBlocks))
+    numCells.assign(nBlocks, 1);
 
-  std::vector<int> activeBlockOwner(numActiveBlocks);
+  int nRanks = 1;
+  MPI_Comm_size(comm, &nRanks);
 
-  int nLocal = numActiveBlocks / nRanks;
-  int nLarge = numActiveBlocks % nRanks;
+  // copy the input metadata and fix up the domain decomp
+  mdOut = mdIn->NewCopy();
 
-  for (int j = 0; j < nRanks; ++j)
+  // reuse the last result when nothing it depends on has changed
+  CacheEntry &cache = this->Cache[mdIn->MeshName];
+  if ((cache.NumRanks == nRanks) && (cache.BlockArrayRange == ranges) &&
+    (cache.BlockNumCells == numCells))
     {
-    // do it for all ranks, so every rank can know who
-    // owns what
-    int rank = j;
-
-    int id0 = nLocal*rank + (rank < nLarge ? rank : nLarge);
-    int id1 = id0 + nLocal + (rank < nLarge ? 1 : 0);
+    mdOut->BlockOwner = cache.BlockOwner;
+    return 0;
+    }
 
-    // allocate the local dataset
-    for (int i = id0; i < id1; ++i)
-      activeBlockOwner[i] = rank;
+  // locate the active blocks and estimate the cost of each
+  std::vector<int> activeBlocks;
+  std::vector<double> activeBlockWeight;
+  for (int j = 0; j < static_cast<int>(ranges.size()); ++j)
+    {
+    double weight = this->GetBlockWeight(numCells[j], ranges[j]);
+    if (weight > 0.0)
+      {
+      activeBlocks.push_back(j);
+      activeBlockWeight.push_back(weight);
+      }
     }
 
-  // copy the input metadata and fix up the domain decomp
-  mdOut = mdIn->NewCopy();
+  // partition the needed blocks to ranks by cost
+  int numActiveBlocks = activeBlocks.size();
+
+  std::vector<int> activeBlockOwner;
+  BlockPartitioner::GetWeightedPartition(nRanks,
+    activeBlockWeight, activeBlockOwner);
 
   // start out with all block assigned to no rank
   for (int i = 0; i < mdOut->NumBlocks; ++i)
     mdOut->BlockOwner[i] = -1;
 
   // assign the active blocks to the correct rank
-  std::set<int>::iterator bit = activeBlocks.begin();
-  for (int i = 0; i < numActiveBlocks; ++i, ++bit)
-    mdOut->BlockOwner[*bit] = activeBlockOwner[i];
+  for (int i = 0; i < numActiveBlocks; ++i)
+    mdOut->BlockOwner[activeBlocks[i]] = activeBlockOwner[i];
+
+  // save the result for the next time
+  cache.NumRanks = nRanks;
+  cache.BlockArrayRange = ranges;
+  cache.BlockNumCells = numCells;
+  cache.BlockOwner = mdOut->BlockOwner;
 
   // report the decomp
   int rank = 0;
@@ -157,7 +203,7 @@ int IsoSurfacePartitioner::GetPartition(MPI_Comm comm,
 
     // report number of blocks moved
     oss << "IsoSurfacePartitioner: it=" << it << " NumBlocks=" << mdIn->NumBlocks
-      << " NumActiveBlocks=" << activeBlocks.size() << " numCellsMoved=" << numCellsMoved
+      << " NumActiveBlocks=" << numActiveBlocks << " numCellsMoved=" << numCellsMoved
       << " numCellsLeft=" << numCellsLeft << " movedFraction="
       << double(numCellsMoved)/double(numCellsMoved + numCellsLeft);
 
@@ -3,7 +3,8 @@
 
 #include "Partitioner.h"
 
-#include <set>
+#include <array>
+#include <map>
 #include <vector>
 #include <string>
 
@@ -17,7 +18,11 @@ using IsoSurfacePartitionerPtr = std::shared_ptr<sensei::IsoSurfacePartitioner>;
 /// The IsoSurfacePartitioner selects only blocks that are needed to
 /// compute the desired set of iso surfaces. These blocks are partitioned
 /// in consecutive spans to ranks such that each rank gets approximately
-/// the same number. The number of blocks per rank will differ by at most 1.
+/// the same amount of work. The work in a block is estimated from its number
+/// of cells and where each iso value falls in the block's range. A value near
+/// the middle of the range is expected to produce more surface than one near
+/// either end. The result is reused while the block ranges, cell counts and
+/// number of ranks are unchanged.
 class IsoSurfacePartitioner : public sensei::Partitioner
 {
 public:
@@ -46,10 +51,24 @@ protected:
   IsoSurfacePartitioner() = default;
   IsoSurfacePartitioner(const IsoSurfacePartitioner &) = default;
 
+  // estimate the cost of extracting the surfaces from a block with the
+  // given number of cells and array range
+  double GetBlockWeight(long numCells, const std::array<double,2> &rng) const;
+
+  // the inputs and result of the last partitioning of a mesh
+  struct CacheEntry
+  {
+    int NumRanks = 0;
+    std::vector<std::array<double,2>> BlockArrayRange;
+    std::vector<long> BlockNumCells;
+    std::vector<int> BlockOwner;
+  };
+
   std::string MeshName;
   std::string ArrayName;
   int ArrayCentering;
   std::vector<double> IsoValues;
+  std::map<std::string, CacheEntry> Cache;
 };
 
 }
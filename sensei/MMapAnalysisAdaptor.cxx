@@ -0,0 +1,269 @@
+#include "MMapAnalysisAdaptor.h"
+#include "MMapSchema.h"
+
+#include "DataAdaptor.h"
+#include "Error.h"
+#include "MPIUtils.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "VTKUtils.h"
+
+#include <vtkCompositeDataIterator.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataSet.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+#include <pugixml.hpp>
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+senseiNewMacro(MMapAnalysisAdaptor);
+
+//----------------------------------------------------------------------------
+MMapAnalysisAdaptor::MMapAnalysisAdaptor() : Directory("."),
+  StreamName("sensei"), StepIndex(0)
+{
+}
+
+//----------------------------------------------------------------------------
+MMapAnalysisAdaptor::~MMapAnalysisAdaptor()
+{
+}
+
+//----------------------------------------------------------------------------
+int MMapAnalysisAdaptor::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapAnalysisAdaptor::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapAnalysisAdaptor::Initialize(pugi::xml_node &node)
+{
+  TimeEvent<128> mark("MMapAnalysisAdaptor::Initialize");
+
+  if (node.attribute("directory"))
+    this->SetDirectory(node.attribute("directory").value());
+
+  if (node.attribute("stream_name"))
+    this->SetStreamName(node.attribute("stream_name").value());
+
+  // set the data requirements
+  DataRequirements req;
+  if (req.Initialize(node))
+    {
+    SENSEI_ERROR("Failed to initialize the mmap transport.")
+    return -1;
+    }
+  this->SetDataRequirements(req);
+
+  SENSEI_STATUS("Configured MMapAnalysisAdaptor directory=\""
+    << this->Directory << "\" stream_name=\"" << this->StreamName << "\"")
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool MMapAnalysisAdaptor::Execute(DataAdaptor* dataAdaptor)
+{
+  TimeEvent<128> mark("MMapAnalysisAdaptor::Execute");
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  // figure out what the simulation can provide
+  MeshMetadataFlags flags;
+  flags.SetBlockDecomp();
+  flags.SetBlockSize();
+
+  MeshMetadataMap mdm;
+  if (mdm.Initialize(dataAdaptor, flags))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  // if no dataAdaptor requirements are given, push all the data
+  // fill in the requirements with every thing
+  if (this->Requirements.Empty())
+    {
+    if (this->Requirements.Initialize(dataAdaptor, false))
+      {
+      SENSEI_ERROR("Failed to initialze dataAdaptor description")
+      return false;
+      }
+    SENSEI_WARNING("No subset specified. Writing all available data")
+    }
+
+  // get the metadata of the meshes being written and generate a global view
+  // of it. the reader uses it to locate the file holding each block
+  std::vector<MeshMetadataPtr> metadata;
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  for (; mit; ++mit)
+    {
+    MeshMetadataPtr md;
+    if (mdm.GetMeshMetadata(mit.MeshName(), md))
+      {
+      SENSEI_ERROR("Failed to get mesh metadata for mesh \""
+        << mit.MeshName() << "\"")
+      return false;
+      }
+
+    if (VTKUtils::AMR(md))
+      {
+      SENSEI_ERROR("AMR mesh \"" << mit.MeshName()
+        << "\" is not supported by the mmap transport")
+      return false;
+      }
+
+    if (!md->GlobalView)
+      {
+      MPIUtils::GlobalViewV(comm, md->BlockOwner);
+      MPIUtils::GlobalViewV(comm, md->BlockIds);
+      MPIUtils::GlobalViewV(comm, md->BlockNumPoints);
+      MPIUtils::GlobalViewV(comm, md->BlockNumCells);
+      MPIUtils::GlobalViewV(comm, md->BlockCellArraySize);
+      MPIUtils::GlobalViewV(comm, md->BlockExtents);
+      md->GlobalView = true;
+      }
+
+    metadata.push_back(md);
+    }
+
+  // write the local blocks. errors are deferred until every rank is done
+  // so that no rank is left waiting below.
+  int ierr = 0;
+
+  senseiMMap::DataFileWriter writer;
+  if (writer.Open(senseiMMap::GetDataFileName(this->Directory,
+    this->StreamName, this->StepIndex, rank)))
+    ierr = -1;
+
+  mit = this->Requirements.GetMeshRequirementsIterator();
+
+  for (unsigned int i = 0; !ierr && mit; ++mit, ++i)
+    {
+    MeshMetadataPtr &md = metadata[i];
+
+    // get the mesh
+    vtkDataObject *dobj = nullptr;
+    if (dataAdaptor->GetMesh(mit.MeshName(), mit.StructureOnly(), dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << mit.MeshName() << "\"")
+      ierr = -1;
+      break;
+      }
+
+    // add the ghost cell arrays to the mesh
+    if (md->NumGhostCells &&
+      dataAdaptor->AddGhostCellsArray(dobj, mit.MeshName()))
+      {
+      SENSEI_ERROR("Failed to get ghost cells for mesh \""
+        << mit.MeshName() << "\"")
+      dobj->Delete();
+      ierr = -1;
+      break;
+      }
+
+    // add the ghost node arrays to the mesh
+    if (md->NumGhostNodes &&
+      dataAdaptor->AddGhostNodesArray(dobj, mit.MeshName()))
+      {
+      SENSEI_ERROR("Failed to get ghost nodes for mesh \""
+        << mit.MeshName() << "\"")
+      dobj->Delete();
+      ierr = -1;
+      break;
+      }
+
+    // add the required arrays
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(mit.MeshName());
+
+    for (; !ierr && ait; ++ait)
+      {
+      if (dataAdaptor->AddArray(dobj, mit.MeshName(),
+        ait.Association(), ait.Array()))
+        {
+        SENSEI_ERROR("Failed to add "
+          << VTKUtils::GetAttributesName(ait.Association())
+          << " data array \"" << ait.Array() << "\" to mesh \""
+          << mit.MeshName() << "\"")
+        ierr = -1;
+        }
+      }
+
+    // write the blocks, the block's position in the composite dataset
+    // identifies it to the reader
+    vtkCompositeDataSetPtr cd = VTKUtils::AsCompositeData(comm, dobj, true);
+
+    vtkSmartPointer<vtkCompositeDataIterator> it;
+    it.TakeReference(cd->NewIterator());
+    it->SetSkipEmptyNodes(0);
+
+    int j = 0;
+    for (it->InitTraversal(); !ierr && !it->IsDoneWithTraversal();
+      it->GoToNextItem(), ++j)
+      {
+      vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
+      if (ds && writer.WriteBlock(mit.MeshName(), j, ds))
+        {
+        SENSEI_ERROR("Failed to write block " << j << " of mesh \""
+          << mit.MeshName() << "\"")
+        ierr = -1;
+        }
+      }
+    }
+
+  if (writer.Close())
+    ierr = -1;
+
+  // the step file marks the step as complete, write it only after every
+  // rank has finished writing its blocks
+  MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, comm);
+  if (ierr)
+    {
+    SENSEI_ERROR("Failed to write step " << this->StepIndex)
+    return false;
+    }
+
+  if ((rank == 0) && senseiMMap::WriteStepFile(
+    senseiMMap::GetStepFileName(this->Directory, this->StreamName,
+    this->StepIndex), dataAdaptor->GetDataTimeStep(),
+    dataAdaptor->GetDataTime(), nRanks, metadata))
+    {
+    SENSEI_ERROR("Failed to write the step file for step " << this->StepIndex)
+    return false;
+    }
+
+  ++this->StepIndex;
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int MMapAnalysisAdaptor::Finalize()
+{
+  TimeEvent<128> mark("MMapAnalysisAdaptor::Finalize");
+  return 0;
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef MMapAnalysisAdaptor_h
+#define MMapAnalysisAdaptor_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <string>
+#include <vector>
+#include <mpi.h>
+
+namespace pugi { class xml_node; }
+
+namespace sensei
+{
+
+/// The write side of the mmap transport. Each rank writes its blocks to a
+/// file in a node local directory, such as a burst buffer or /dev/shm, laid
+/// out so that a reader can map the file and use the arrays in place. After
+/// all ranks have written, rank 0 writes a small step file holding the
+/// metadata, the presence of which marks the step as complete. The files are
+/// replayed by the MMapDataAdaptor, which must run where the files are
+/// visible.
+class MMapAnalysisAdaptor : public AnalysisAdaptor
+{
+public:
+  static MMapAnalysisAdaptor* New();
+  senseiTypeMacro(MMapAnalysisAdaptor, AnalysisAdaptor);
+
+  /// initialize from an XML representation
+  int Initialize(pugi::xml_node &parent);
+
+  /// @brief Set the directory the files are written to.
+  /// Default value is "." The directory must exist.
+  void SetDirectory(const std::string &dir)
+  { this->Directory = dir; }
+
+  std::string GetDirectory() const
+  { return this->Directory; }
+
+  /// @brief Set the prefix used in the file names.
+  /// Default value is "sensei".
+  void SetStreamName(const std::string &name)
+  { this->StreamName = name; }
+
+  std::string GetStreamName() const
+  { return this->StreamName; }
+
+  /// data requirements tell the adaptor what to push
+  /// if none are given then all data is pushed.
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  // SENSEI AnalysisAdaptor API
+  bool Execute(DataAdaptor* data) override;
+  int Finalize() override;
+
+protected:
+  MMapAnalysisAdaptor();
+  ~MMapAnalysisAdaptor();
+
+  MMapAnalysisAdaptor(const MMapAnalysisAdaptor&) = delete;
+  void operator=(const MMapAnalysisAdaptor&) = delete;
+
+  DataRequirements Requirements;
+  std::string Directory;
+  std::string StreamName;
+  unsigned long StepIndex;
+};
+
+}
+
+#endif
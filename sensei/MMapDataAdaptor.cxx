@@ -0,0 +1,459 @@
+#include "MMapDataAdaptor.h"
+#include "MMapSchema.h"
+#include "MeshMetadata.h"
+#include "Partitioner.h"
+#include "Error.h"
+#include "Profiler.h"
+#include "VTKUtils.h"
+
+#include <vtkCompositeDataIterator.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataArray.h>
+#include <vtkDataSet.h>
+#include <vtkFieldData.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+#include <pugixml.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace sensei
+{
+struct MMapDataAdaptor::InternalsType
+{
+  InternalsType() : Directory("."), StreamName("sensei"), StepIndex(0),
+    Good(false), NumWriters(0) {}
+
+  // get the metadata of the named mesh
+  int GetSenderMeshMetadata(const std::string &meshName, MeshMetadataPtr &md);
+
+  // get the data file written by the given rank. it is mapped on first use.
+  senseiMMap::DataFile *GetDataFile(int writer);
+
+  // find the given block in the data file its writer wrote
+  int GetBlock(const MeshMetadataPtr &md, int blockId,
+    senseiMMap::DataFile *&file, const senseiMMap::BlockEntry *&block);
+
+  // unmap the current step's files
+  void Release();
+
+  std::string Directory;
+  std::string StreamName;
+  unsigned long StepIndex;
+  bool Good;
+  int NumWriters;
+  std::vector<MeshMetadataPtr> SenderMetadata;
+  std::map<unsigned int, MeshMetadataPtr> ReceiverMetadata;
+  std::map<int, std::unique_ptr<senseiMMap::DataFile>> Files;
+};
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::InternalsType::GetSenderMeshMetadata(
+  const std::string &meshName, MeshMetadataPtr &md)
+{
+  unsigned int nMeshes = this->SenderMetadata.size();
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    if (this->SenderMetadata[i]->MeshName == meshName)
+      {
+      md = this->SenderMetadata[i];
+      return 0;
+      }
+    }
+
+  SENSEI_ERROR("No mesh named \"" << meshName << "\" in step "
+    << this->StepIndex)
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+senseiMMap::DataFile *MMapDataAdaptor::InternalsType::GetDataFile(int writer)
+{
+  auto it = this->Files.find(writer);
+  if (it != this->Files.end())
+    return it->second.get();
+
+  if ((writer < 0) || (writer >= this->NumWriters))
+    {
+    SENSEI_ERROR("Invalid writer rank " << writer << " of "
+      << this->NumWriters)
+    return nullptr;
+    }
+
+  std::unique_ptr<senseiMMap::DataFile> file(new senseiMMap::DataFile);
+
+  if (file->Open(senseiMMap::GetDataFileName(this->Directory,
+    this->StreamName, this->StepIndex, writer)))
+    return nullptr;
+
+  senseiMMap::DataFile *pFile = file.get();
+  this->Files[writer] = std::move(file);
+
+  return pFile;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::InternalsType::GetBlock(const MeshMetadataPtr &md,
+  int blockId, senseiMMap::DataFile *&file,
+  const senseiMMap::BlockEntry *&block)
+{
+  if (!(file = this->GetDataFile(md->BlockOwner[blockId])))
+    return -1;
+
+  if (!(block = file->GetBlock(md->MeshName, blockId)))
+    {
+    SENSEI_ERROR("Block " << blockId << " of mesh \"" << md->MeshName
+      << "\" was not found in the file written by rank "
+      << md->BlockOwner[blockId])
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void MMapDataAdaptor::InternalsType::Release()
+{
+  this->Files.clear();
+  this->ReceiverMetadata.clear();
+}
+
+
+
+//----------------------------------------------------------------------------
+senseiNewMacro(MMapDataAdaptor);
+
+//----------------------------------------------------------------------------
+MMapDataAdaptor::MMapDataAdaptor() : Internals(nullptr)
+{
+  this->Internals = new InternalsType;
+}
+
+//----------------------------------------------------------------------------
+MMapDataAdaptor::~MMapDataAdaptor()
+{
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void MMapDataAdaptor::SetDirectory(const std::string &dir)
+{
+  this->Internals->Directory = dir;
+}
+
+//----------------------------------------------------------------------------
+void MMapDataAdaptor::SetStreamName(const std::string &name)
+{
+  this->Internals->StreamName = name;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::Initialize(pugi::xml_node &node)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::Initialize");
+
+  // let the base class handle initialization of the partitioner etc
+  if (this->InTransitDataAdaptor::Initialize(node))
+    {
+    SENSEI_ERROR("Failed to intialize the MMapDataAdaptor")
+    return -1;
+    }
+
+  if (node.attribute("directory"))
+    this->SetDirectory(node.attribute("directory").value());
+
+  if (node.attribute("stream_name"))
+    this->SetStreamName(node.attribute("stream_name").value());
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::Finalize()
+{
+  TimeEvent<128> mark("MMapDataAdaptor::Finalize");
+  this->Internals->Release();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::OpenStream()
+{
+  TimeEvent<128> mark("MMapDataAdaptor::OpenStream");
+
+  this->Internals->Release();
+  this->Internals->StepIndex = 0;
+
+  int ierr = this->UpdateTimeStep();
+  if (ierr > 0)
+    {
+    SENSEI_ERROR("No steps named \"" << this->Internals->StreamName
+      << "\" were found in \"" << this->Internals->Directory << "\"")
+    }
+
+  return ierr ? -1 : 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::StreamGood()
+{
+  return this->Internals->Good ? 0 : -1;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::CloseStream()
+{
+  TimeEvent<128> mark("MMapDataAdaptor::CloseStream");
+
+  this->Internals->Release();
+  this->Internals->SenderMetadata.clear();
+  this->Internals->Good = false;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::AdvanceStream()
+{
+  TimeEvent<128> mark("MMapDataAdaptor::AdvanceStream");
+
+  // the previous step's arrays are no longer valid
+  this->Internals->Release();
+
+  ++this->Internals->StepIndex;
+
+  return this->UpdateTimeStep();
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::UpdateTimeStep()
+{
+  TimeEvent<128> mark("MMapDataAdaptor::UpdateTimeStep");
+
+  unsigned long timeStep = 0;
+  double time = 0.0;
+
+  int ierr = senseiMMap::ReadStepFile(this->GetCommunicator(),
+    senseiMMap::GetStepFileName(this->Internals->Directory,
+    this->Internals->StreamName, this->Internals->StepIndex),
+    timeStep, time, this->Internals->NumWriters,
+    this->Internals->SenderMetadata);
+
+  this->Internals->Good = (ierr == 0);
+
+  if (ierr < 0)
+    {
+    SENSEI_ERROR("Failed to read step " << this->Internals->StepIndex)
+    return -1;
+    }
+
+  if (ierr > 0)
+    return 1;
+
+  this->SetDataTimeStep(timeStep);
+  this->SetDataTime(time);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::GetSenderMeshMetadata(unsigned int id,
+  MeshMetadataPtr &metadata)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::GetSenderMeshMetadata");
+
+  if (id >= this->Internals->SenderMetadata.size())
+    {
+    SENSEI_ERROR("Failed to get metadata for object " << id)
+    return -1;
+    }
+
+  metadata = this->Internals->SenderMetadata[id];
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::GetNumberOfMeshes");
+  numMeshes = this->Internals->SenderMetadata.size();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::GetMeshMetadata");
+
+  // check if an analysis told us how the data should land by
+  // passing in reciever metadata
+  if (this->GetReceiverMeshMetadata(id, metadata))
+    {
+    // did we do this already this step?
+    auto it = this->Internals->ReceiverMetadata.find(id);
+    if (it != this->Internals->ReceiverMetadata.end())
+      {
+      metadata = it->second;
+      return 0;
+      }
+
+    // first time through this step. use the partitioner to lay out all of
+    // the meshes at once.
+    std::vector<MeshMetadataPtr> receiverMd;
+    if (this->PartitionMeshes(receiverMd) || (id >= receiverMd.size()))
+      {
+      SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
+      return -1;
+      }
+
+    // cache and return the new layouts
+    unsigned int nMeshes = receiverMd.size();
+    for (unsigned int i = 0; i < nMeshes; ++i)
+      this->Internals->ReceiverMetadata[i] = receiverMd[i];
+
+    metadata = receiverMd[id];
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::GetMesh(const std::string &meshName,
+   bool structureOnly, vtkDataObject *&mesh)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::GetMesh");
+
+  mesh = nullptr;
+
+  // find the mesh and get the layout of its blocks on this rank
+  unsigned int nMeshes = this->Internals->SenderMetadata.size();
+  unsigned int id = 0;
+  while ((id < nMeshes) &&
+    (this->Internals->SenderMetadata[id]->MeshName != meshName))
+    ++id;
+
+  MeshMetadataPtr senderMd;
+  MeshMetadataPtr md;
+  if (this->GetSenderMeshMetadata(id, senderMd) ||
+    this->GetMeshMetadata(id, md))
+    {
+    SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+
+  vtkMultiBlockDataSet *mb = vtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(md->NumBlocks);
+
+  for (int j = 0; j < md->NumBlocks; ++j)
+    {
+    if (md->BlockOwner[j] != rank)
+      continue;
+
+    senseiMMap::DataFile *file = nullptr;
+    const senseiMMap::BlockEntry *block = nullptr;
+    vtkDataSet *ds = nullptr;
+
+    if (this->Internals->GetBlock(senderMd, j, file, block) ||
+      !(ds = file->NewBlock(*block, structureOnly)))
+      {
+      SENSEI_ERROR("Failed to read block " << j << " of mesh \""
+        << meshName << "\"")
+      mb->Delete();
+      return -1;
+      }
+
+    mb->SetBlock(j, ds);
+    ds->Delete();
+    }
+
+  VTKUtils::SetGhostLayerMetadata(mb, md->NumGhostCells, md->NumGhostNodes);
+
+  mesh = mb;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::AddGhostNodesArray(vtkDataObject *mesh,
+  const std::string &meshName)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::AddGhostNodesArray");
+  return AddArray(mesh, meshName, vtkDataObject::POINT, "vtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::AddGhostCellsArray(vtkDataObject *mesh,
+  const std::string &meshName)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::AddGhostCellsArray");
+  return AddArray(mesh, meshName, vtkDataObject::CELL, "vtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::AddArray(vtkDataObject* mesh,
+  const std::string &meshName, int association, const std::string& arrayName)
+{
+  TimeEvent<128> mark("MMapDataAdaptor::AddArray");
+
+  // the mesh should never be null. there must have been an error
+  // upstream.
+  vtkCompositeDataSet *cd = dynamic_cast<vtkCompositeDataSet*>(mesh);
+  if (!cd)
+    {
+    SENSEI_ERROR("Invalid mesh object")
+    return -1;
+    }
+
+  MeshMetadataPtr senderMd;
+  if (this->Internals->GetSenderMeshMetadata(meshName, senderMd))
+    return -1;
+
+  vtkSmartPointer<vtkCompositeDataIterator> it;
+  it.TakeReference(cd->NewIterator());
+  it->SetSkipEmptyNodes(0);
+
+  int j = 0;
+  for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem(), ++j)
+    {
+    vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
+    if (!ds)
+      continue;
+
+    senseiMMap::DataFile *file = nullptr;
+    const senseiMMap::BlockEntry *block = nullptr;
+    const senseiMMap::ArrayEntry *ae = nullptr;
+    vtkDataArray *da = nullptr;
+
+    if (this->Internals->GetBlock(senderMd, j, file, block) ||
+      !(ae = block->GetArray(senseiMMap::DATA_ARRAY, association, arrayName)) ||
+      !(da = file->NewArray(*ae)))
+      {
+      SENSEI_ERROR("Failed to read " << VTKUtils::GetAttributesName(association)
+        << " data array \"" << arrayName << "\" from block " << j
+        << " of mesh \"" << meshName << "\"")
+      return -1;
+      }
+
+    VTKUtils::GetAttributes(ds, association)->AddArray(da);
+    da->Delete();
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MMapDataAdaptor::ReleaseData()
+{
+  TimeEvent<128> mark("MMapDataAdaptor::ReleaseData");
+  return 0;
+}
+
+}
@@ -0,0 +1,82 @@
+#ifndef MMapDataAdaptor_h
+#define MMapDataAdaptor_h
+
+#include "InTransitDataAdaptor.h"
+
+#include <mpi.h>
+#include <string>
+
+namespace pugi { class xml_node; }
+
+namespace sensei
+{
+
+/// The read side of the mmap transport. Replays the steps written by the
+/// MMapAnalysisAdaptor in order. The files holding the blocks assigned to
+/// this rank are mapped into memory and the blocks' arrays are used in place,
+/// nothing is copied. The arrays are valid until the stream is advanced or
+/// closed. Files are mapped privately, analyses may modify the arrays
+/// without changing the files. The stream ends at the first step for which
+/// no step file is found.
+class MMapDataAdaptor : public sensei::InTransitDataAdaptor
+{
+public:
+  static MMapDataAdaptor* New();
+  senseiTypeMacro(MMapDataAdaptor, sensei::InTransitDataAdaptor);
+
+  /// @brief Set the directory the files are read from.
+  /// Default value is "."
+  void SetDirectory(const std::string &dir);
+
+  /// @brief Set the prefix used in the file names.
+  /// Default value is "sensei".
+  void SetStreamName(const std::string &name);
+
+  /// SENSEI InTransitDataAdaptor control API
+  int Initialize(pugi::xml_node &parent) override;
+  int Finalize() override;
+
+  int OpenStream() override;
+  int CloseStream() override;
+  int AdvanceStream() override;
+  int StreamGood() override;
+
+  /// SENSEI InTransitDataAdaptor explicit paritioning API
+  int GetSenderMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  /// SENSEI DataAdaptor API
+  int GetNumberOfMeshes(unsigned int &numMeshes) override;
+
+  int GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  int GetMesh(const std::string &meshName, bool structure_only,
+    vtkDataObject *&mesh) override;
+
+  int AddGhostNodesArray(vtkDataObject* mesh, const std::string &meshName) override;
+  int AddGhostCellsArray(vtkDataObject* mesh, const std::string &meshName) override;
+
+  int AddArray(vtkDataObject* mesh, const std::string &meshName,
+    int association, const std::string &arrayName) override;
+
+  int ReleaseData() override;
+
+protected:
+  MMapDataAdaptor();
+  ~MMapDataAdaptor();
+
+  // reads the step file of the current step, and stores the time and
+  // time step in the base class information object. returns 1 when
+  // there are no more steps.
+  int UpdateTimeStep();
+
+private:
+  struct InternalsType;
+  InternalsType *Internals;
+
+  MMapDataAdaptor(const MMapDataAdaptor&) = delete;
+  void operator=(const MMapDataAdaptor&) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,833 @@
+#include "MMapSchema.h"
+#include "VTKUtils.h"
+#include "Profiler.h"
+#include "Error.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataArray.h>
+#include <vtkDataSet.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPointSet.h>
+#include <vtkPolyData.h>
+#include <vtkRectilinearGrid.h>
+#include <vtkSmartPointer.h>
+#include <vtkStructuredGrid.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+namespace senseiMMap
+{
+
+// identifies the files and the format revision
+static const uint64_t Magic = 0x314d4d4945534e45ull;
+static const int Revision = 1;
+
+// arrays are aligned to this many bytes in the data files
+static const unsigned long long Alignment = 64;
+
+// --------------------------------------------------------------------------
+void ArrayEntry::ToStream(sensei::BinaryStream &bs) const
+{
+  bs.Pack(this->Kind);
+  bs.Pack(this->Association);
+  bs.Pack(this->Name);
+  bs.Pack(this->Type);
+  bs.Pack(this->NumComponents);
+  bs.Pack(this->NumTuples);
+  bs.Pack(this->Offset);
+}
+
+// --------------------------------------------------------------------------
+void ArrayEntry::FromStream(sensei::BinaryStream &bs)
+{
+  bs.Unpack(this->Kind);
+  bs.Unpack(this->Association);
+  bs.Unpack(this->Name);
+  bs.Unpack(this->Type);
+  bs.Unpack(this->NumComponents);
+  bs.Unpack(this->NumTuples);
+  bs.Unpack(this->Offset);
+}
+
+// --------------------------------------------------------------------------
+void BlockEntry::ToStream(sensei::BinaryStream &bs) const
+{
+  bs.Pack(this->MeshName);
+  bs.Pack(this->BlockId);
+  bs.Pack(this->BlockType);
+  bs.Pack(this->NumCells);
+  bs.Pack(this->Extent);
+  bs.Pack(this->Origin);
+  bs.Pack(this->Spacing);
+
+  unsigned int nArrays = this->Arrays.size();
+  bs.Pack(nArrays);
+  for (unsigned int i = 0; i < nArrays; ++i)
+    this->Arrays[i].ToStream(bs);
+}
+
+// --------------------------------------------------------------------------
+void BlockEntry::FromStream(sensei::BinaryStream &bs)
+{
+  bs.Unpack(this->MeshName);
+  bs.Unpack(this->BlockId);
+  bs.Unpack(this->BlockType);
+  bs.Unpack(this->NumCells);
+  bs.Unpack(this->Extent);
+  bs.Unpack(this->Origin);
+  bs.Unpack(this->Spacing);
+
+  unsigned int nArrays = 0;
+  bs.Unpack(nArrays);
+  this->Arrays.resize(nArrays);
+  for (unsigned int i = 0; i < nArrays; ++i)
+    this->Arrays[i].FromStream(bs);
+}
+
+// --------------------------------------------------------------------------
+const ArrayEntry *BlockEntry::GetArray(int kind, int association,
+  const std::string &name) const
+{
+  unsigned int nArrays = this->Arrays.size();
+  for (unsigned int i = 0; i < nArrays; ++i)
+    {
+    const ArrayEntry &ae = this->Arrays[i];
+    if ((ae.Kind == kind) && ((kind != DATA_ARRAY) ||
+      ((ae.Association == association) && (ae.Name == name))))
+      return &ae;
+    }
+  return nullptr;
+}
+
+// --------------------------------------------------------------------------
+std::string GetStepFileName(const std::string &dir,
+  const std::string &name, unsigned long step)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "_%06lu.step", step);
+  return dir + "/" + name + buf;
+}
+
+// --------------------------------------------------------------------------
+std::string GetDataFileName(const std::string &dir,
+  const std::string &name, unsigned long step, int rank)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "_%06lu_%06d.blocks", step, rank);
+  return dir + "/" + name + buf;
+}
+
+// --------------------------------------------------------------------------
+int WriteStepFile(const std::string &fileName, unsigned long timeStep,
+  double time, int numWriters, const std::vector<sensei::MeshMetadataPtr> &md)
+{
+  sensei::TimeEvent<128> mark("senseiMMap::WriteStepFile");
+
+  sensei::BinaryStream bs;
+  bs.Pack(Magic);
+  bs.Pack(Revision);
+  bs.Pack(timeStep);
+  bs.Pack(time);
+  bs.Pack(numWriters);
+
+  unsigned int nMeshes = md.size();
+  bs.Pack(nMeshes);
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    md[i]->ToStream(bs);
+
+  // write to a temporary and rename it, so that a reader never sees
+  // a partially written step
+  std::string tmpName = fileName + ".tmp";
+  FILE *fh = fopen(tmpName.c_str(), "wb");
+  if (!fh)
+    {
+    SENSEI_ERROR("Failed to open \"" << tmpName << "\". " << strerror(errno))
+    return -1;
+    }
+
+  if (fwrite(bs.GetData(), 1, bs.Size(), fh) != bs.Size())
+    {
+    SENSEI_ERROR("Failed to write \"" << tmpName << "\". " << strerror(errno))
+    fclose(fh);
+    return -1;
+    }
+
+  fclose(fh);
+
+  if (rename(tmpName.c_str(), fileName.c_str()))
+    {
+    SENSEI_ERROR("Failed to rename \"" << tmpName << "\" to \""
+      << fileName << "\". " << strerror(errno))
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ReadStepFile(MPI_Comm comm, const std::string &fileName,
+  unsigned long &timeStep, double &time, int &numWriters,
+  std::vector<sensei::MeshMetadataPtr> &md)
+{
+  sensei::TimeEvent<128> mark("senseiMMap::ReadStepFile");
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // rank 0 reads the file, a status code leads the payload
+  sensei::BinaryStream bs;
+  if (rank == 0)
+    {
+    int status = 0;
+    std::vector<unsigned char> buf;
+
+    FILE *fh = fopen(fileName.c_str(), "rb");
+    if (!fh)
+      {
+      status = 1;
+      }
+    else
+      {
+      fseek(fh, 0, SEEK_END);
+      long nBytes = ftell(fh);
+      fseek(fh, 0, SEEK_SET);
+
+      buf.resize(nBytes > 0 ? nBytes : 0);
+      if ((nBytes <= 0) ||
+        (fread(buf.data(), 1, nBytes, fh) != static_cast<size_t>(nBytes)))
+        {
+        SENSEI_ERROR("Failed to read \"" << fileName << "\"")
+        status = -1;
+        }
+
+      fclose(fh);
+      }
+
+    bs.Pack(status);
+    if (status == 0)
+      bs.Pack(buf.data(), buf.size());
+    }
+
+  bs.Broadcast(comm);
+  bs.SetReadPos(0);
+
+  int status = 0;
+  bs.Unpack(status);
+  if (status)
+    return status;
+
+  uint64_t magic = 0;
+  int revision = 0;
+  bs.Unpack(magic);
+  bs.Unpack(revision);
+  if ((magic != Magic) || (revision != Revision))
+    {
+    SENSEI_ERROR("\"" << fileName << "\" is not a revision "
+      << Revision << " step file")
+    return -1;
+    }
+
+  bs.Unpack(timeStep);
+  bs.Unpack(time);
+  bs.Unpack(numWriters);
+
+  unsigned int nMeshes = 0;
+  bs.Unpack(nMeshes);
+
+  md.resize(nMeshes);
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    md[i] = sensei::MeshMetadata::New();
+    if (md[i]->FromStream(bs))
+      {
+      SENSEI_ERROR("Failed to deserialize metadata for mesh " << i)
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+
+
+// --------------------------------------------------------------------------
+DataFileWriter::~DataFileWriter()
+{
+  if (this->File)
+    fclose(this->File);
+}
+
+// --------------------------------------------------------------------------
+int DataFileWriter::Open(const std::string &fileName)
+{
+  this->File = fopen(fileName.c_str(), "wb");
+  if (!this->File)
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\". " << strerror(errno))
+    return -1;
+    }
+
+  this->FileName = fileName;
+  this->Offset = 0;
+  this->Blocks.clear();
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataFileWriter::Open(std::vector<unsigned char> &buffer)
+{
+  this->Buffer = &buffer;
+  this->FileName = "memory";
+  this->Offset = 0;
+  this->Blocks.clear();
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataFileWriter::Write(const void *data, unsigned long long nBytes)
+{
+  if (!nBytes)
+    return 0;
+
+  if (this->Buffer)
+    {
+    const unsigned char *pData = static_cast<const unsigned char*>(data);
+    this->Buffer->insert(this->Buffer->end(), pData, pData + nBytes);
+    return 0;
+    }
+
+  if (fwrite(data, 1, nBytes, this->File) != nBytes)
+    {
+    SENSEI_ERROR("Failed to write \"" << this->FileName << "\". "
+      << strerror(errno))
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataFileWriter::WriteArray(vtkDataSet *ds,
+  sensei::VTKUtils::BlockSerializer &ser, int kind, int type,
+  int numComponents, BlockEntry &block, int association,
+  const std::string &name)
+{
+  unsigned int elemSize = sensei::VTKUtils::Size(type);
+  if (!elemSize)
+    return -1;
+
+  const void *data = nullptr;
+  unsigned long long nBytes = 0;
+  if (sensei::VTKUtils::Serialize(ds, ser, this->Staging, data, nBytes))
+    return -1;
+
+  if (this->Write(data, nBytes))
+    return -1;
+
+  ArrayEntry ae;
+  ae.Kind = kind;
+  ae.Association = association;
+  ae.Name = name;
+  ae.Type = type;
+  ae.NumComponents = numComponents;
+  ae.NumTuples = nBytes/(numComponents*elemSize);
+  ae.Offset = this->Offset;
+  block.Arrays.push_back(ae);
+
+  // pad so the next array is aligned
+  static const unsigned char zeros[Alignment] = {0};
+  unsigned long long nPad = (Alignment - nBytes % Alignment) % Alignment;
+  if (this->Write(zeros, nPad))
+    return -1;
+
+  this->Offset += nBytes + nPad;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataFileWriter::WriteBlock(const std::string &meshName, int blockId,
+  vtkDataSet *ds)
+{
+  sensei::TimeEvent<128> mark("senseiMMap::DataFileWriter::WriteBlock");
+
+  BlockEntry block;
+  block.MeshName = meshName;
+  block.BlockId = blockId;
+  block.BlockType = ds->GetDataObjectType();
+  block.NumCells = ds->GetNumberOfCells();
+  block.Extent = {{0, -1, 0, -1, 0, -1}};
+  block.Origin = {{0.0, 0.0, 0.0}};
+  block.Spacing = {{1.0, 1.0, 1.0}};
+
+  // the structure
+  if (vtkImageData *im = dynamic_cast<vtkImageData*>(ds))
+    {
+    im->GetExtent(block.Extent.data());
+    im->GetOrigin(block.Origin.data());
+    im->GetSpacing(block.Spacing.data());
+    }
+  else if (vtkRectilinearGrid *rg = dynamic_cast<vtkRectilinearGrid*>(ds))
+    {
+    rg->GetExtent(block.Extent.data());
+
+    vtkDataArray *coords[3] = {rg->GetXCoordinates(),
+      rg->GetYCoordinates(), rg->GetZCoordinates()};
+
+    for (int i = 0; i < 3; ++i)
+      {
+      sensei::VTKUtils::CoordinateSerializer cs(i);
+      if (this->WriteArray(ds, cs, X_COORDINATES + i,
+        coords[i]->GetDataType(), 1, block))
+        return -1;
+      }
+    }
+  else if (dynamic_cast<vtkStructuredGrid*>(ds) ||
+    dynamic_cast<vtkUnstructuredGrid*>(ds) || dynamic_cast<vtkPolyData*>(ds))
+    {
+    if (vtkStructuredGrid *sg = dynamic_cast<vtkStructuredGrid*>(ds))
+      sg->GetExtent(block.Extent.data());
+
+    vtkPoints *pts = static_cast<vtkPointSet*>(ds)->GetPoints();
+    if (pts)
+      {
+      sensei::VTKUtils::PointsSerializer ps;
+      if (this->WriteArray(ds, ps, POINTS, pts->GetDataType(), 3, block))
+        return -1;
+      }
+
+    if (!dynamic_cast<vtkStructuredGrid*>(ds))
+      {
+      sensei::VTKUtils::CellTypesSerializer cts;
+      sensei::VTKUtils::CellArraySerializer cas;
+      if (this->WriteArray(ds, cts, CELL_TYPES, VTK_UNSIGNED_CHAR, 1, block) ||
+        this->WriteArray(ds, cas, CELL_ARRAY, VTK_ID_TYPE, 1, block))
+        return -1;
+      }
+    }
+  else
+    {
+    SENSEI_ERROR("Block " << blockId << " of mesh \"" << meshName
+      << "\" is a " << ds->GetClassName() << " which is not supported")
+    return -1;
+    }
+
+  // the point and cell data, this includes any ghost arrays
+  int assocs[2] = {vtkDataObject::POINT, vtkDataObject::CELL};
+  for (int j = 0; j < 2; ++j)
+    {
+    vtkFieldData *fd = sensei::VTKUtils::GetAttributes(ds, assocs[j]);
+    int nArrays = fd->GetNumberOfArrays();
+    for (int i = 0; i < nArrays; ++i)
+      {
+      vtkDataArray *da = fd->GetArray(i);
+      if (!da || !da->GetName())
+        continue;
+
+      sensei::VTKUtils::DataArraySerializer das(da->GetName(), assocs[j]);
+      if (this->WriteArray(ds, das, DATA_ARRAY, da->GetDataType(),
+        da->GetNumberOfComponents(), block, assocs[j], da->GetName()))
+        return -1;
+      }
+    }
+
+  this->Blocks.push_back(block);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataFileWriter::Close()
+{
+  sensei::TimeEvent<128> mark("senseiMMap::DataFileWriter::Close");
+
+  if (!this->File && !this->Buffer)
+    return 0;
+
+  // the index
+  sensei::BinaryStream bs;
+  bs.Pack(Revision);
+
+  unsigned int nBlocks = this->Blocks.size();
+  bs.Pack(nBlocks);
+  for (unsigned int i = 0; i < nBlocks; ++i)
+    this->Blocks[i].ToStream(bs);
+
+  // the footer, locates the index
+  uint64_t footer[3] = {this->Offset, bs.Size(), Magic};
+
+  int ierr = 0;
+  if (this->Write(bs.GetData(), bs.Size()) ||
+    this->Write(footer, sizeof(footer)))
+    ierr = -1;
+
+  if (this->File)
+    fclose(this->File);
+
+  this->File = nullptr;
+  this->Buffer = nullptr;
+  this->Blocks.clear();
+
+  return ierr;
+}
+
+
+
+// --------------------------------------------------------------------------
+DataFile::~DataFile()
+{
+  this->Close();
+}
+
+// --------------------------------------------------------------------------
+int DataFile::Open(const std::string &fileName)
+{
+  sensei::TimeEvent<128> mark("senseiMMap::DataFile::Open");
+
+  this->Close();
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\". " << strerror(errno))
+    return -1;
+    }
+
+  struct stat st;
+  if (fstat(fd, &st) || (st.st_size < static_cast<off_t>(3*sizeof(uint64_t))))
+    {
+    SENSEI_ERROR("\"" << fileName << "\" is not a data file")
+    close(fd);
+    return -1;
+    }
+
+  // a private writable mapping lets VTK treat the arrays as its own, any
+  // modification is copy on write and never reaches the file
+  void *data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (data == MAP_FAILED)
+    {
+    SENSEI_ERROR("Failed to map \"" << fileName << "\". " << strerror(errno))
+    return -1;
+    }
+
+  this->Data = static_cast<unsigned char*>(data);
+  this->Size = st.st_size;
+  this->Mapped = true;
+
+  if (this->ReadIndex(fileName))
+    {
+    this->Close();
+    return -1;
+    }
+
+  // start paging the file in
+  madvise(this->Data, this->Size, MADV_WILLNEED);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataFile::Open(unsigned char *data, unsigned long long size)
+{
+  this->Close();
+
+  if (size < 3*sizeof(uint64_t))
+    {
+    SENSEI_ERROR("The buffer is too small to hold a data file")
+    return -1;
+    }
+
+  this->Data = data;
+  this->Size = size;
+
+  if (this->ReadIndex("memory"))
+    {
+    this->Close();
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataFile::ReadIndex(const std::string &source)
+{
+  // locate and read the index
+  uint64_t footer[3];
+  memcpy(footer, this->Data + this->Size - sizeof(footer), sizeof(footer));
+
+  if ((footer[2] != Magic) ||
+    (footer[0] + footer[1] + sizeof(footer) != this->Size))
+    {
+    SENSEI_ERROR("\"" << source << "\" is not a data file")
+    return -1;
+    }
+
+  sensei::BinaryStream bs;
+  bs.Pack(this->Data + footer[0], footer[1]);
+  bs.SetReadPos(0);
+
+  int revision = 0;
+  bs.Unpack(revision);
+  if (revision != Revision)
+    {
+    SENSEI_ERROR("\"" << source << "\" is revision " << revision
+      << " but revision " << Revision << " is required")
+    return -1;
+    }
+
+  unsigned int nBlocks = 0;
+  bs.Unpack(nBlocks);
+  for (unsigned int i = 0; i < nBlocks; ++i)
+    {
+    BlockEntry be;
+    be.FromStream(bs);
+    this->Blocks[std::make_pair(be.MeshName, be.BlockId)] = be;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void DataFile::Close()
+{
+  if (this->Mapped)
+    munmap(this->Data, this->Size);
+
+  this->Data = nullptr;
+  this->Mapped = false;
+  this->Size = 0;
+  this->Blocks.clear();
+}
+
+// --------------------------------------------------------------------------
+const BlockEntry *DataFile::GetBlock(const std::string &meshName,
+  int blockId) const
+{
+  auto it = this->Blocks.find(std::make_pair(meshName, blockId));
+  if (it == this->Blocks.end())
+    return nullptr;
+  return &it->second;
+}
+
+// --------------------------------------------------------------------------
+vtkDataArray *DataFile::NewArray(const ArrayEntry &ae) const
+{
+  unsigned long long nElem = ae.NumTuples*ae.NumComponents;
+  unsigned long long nBytes = nElem*sensei::VTKUtils::Size(ae.Type);
+
+  if (ae.Offset + nBytes > this->Size)
+    {
+    SENSEI_ERROR("Array \"" << ae.Name << "\" of kind " << ae.Kind
+      << " extends past the end of the file")
+    return nullptr;
+    }
+
+  vtkDataArray *da = vtkDataArray::CreateDataArray(ae.Type);
+  da->SetNumberOfComponents(ae.NumComponents);
+
+  // save = 1, the mapping owns the memory
+  da->SetVoidArray(this->Data + ae.Offset, nElem, 1);
+
+  if (!ae.Name.empty())
+    da->SetName(ae.Name.c_str());
+
+  return da;
+}
+
+// --------------------------------------------------------------------------
+// wraps a range of the cell array as a vtkCellArray
+static
+vtkCellArray *newCellArray(vtkIdType *cells, vtkIdType nCells, vtkIdType nIds)
+{
+  vtkIdTypeArray *ids = vtkIdTypeArray::New();
+  ids->SetArray(cells, nIds, 1);
+
+  vtkCellArray *ca = vtkCellArray::New();
+  ca->SetCells(nCells, ids);
+  ids->Delete();
+
+  return ca;
+}
+
+// --------------------------------------------------------------------------
+vtkDataSet *DataFile::NewBlock(const BlockEntry &be, bool structureOnly) const
+{
+  sensei::TimeEvent<128> mark("senseiMMap::DataFile::NewBlock");
+
+  vtkDataSet *ds = dynamic_cast<vtkDataSet*>(
+    sensei::VTKUtils::NewDataObject(be.BlockType));
+
+  if (!ds)
+    {
+    SENSEI_ERROR("Failed to create a block of type " << be.BlockType)
+    return nullptr;
+    }
+
+  if (vtkImageData *im = dynamic_cast<vtkImageData*>(ds))
+    {
+    im->SetExtent(const_cast<int*>(be.Extent.data()));
+    im->SetOrigin(const_cast<double*>(be.Origin.data()));
+    im->SetSpacing(const_cast<double*>(be.Spacing.data()));
+    return ds;
+    }
+
+  if (vtkRectilinearGrid *rg = dynamic_cast<vtkRectilinearGrid*>(ds))
+    {
+    rg->SetExtent(const_cast<int*>(be.Extent.data()));
+    if (structureOnly)
+      return ds;
+
+    vtkDataArray *coords[3] = {nullptr};
+    for (int i = 0; i < 3; ++i)
+      {
+      const ArrayEntry *ae = be.GetArray(X_COORDINATES + i);
+      if (!ae || !(coords[i] = this->NewArray(*ae)))
+        {
+        SENSEI_ERROR("Failed to get the coordinates of block " << be.BlockId)
+        for (int j = 0; j < i; ++j)
+          coords[j]->Delete();
+        ds->Delete();
+        return nullptr;
+        }
+      }
+
+    rg->SetXCoordinates(coords[0]);
+    rg->SetYCoordinates(coords[1]);
+    rg->SetZCoordinates(coords[2]);
+
+    for (int i = 0; i < 3; ++i)
+      coords[i]->Delete();
+
+    return ds;
+    }
+
+  if (vtkStructuredGrid *sg = dynamic_cast<vtkStructuredGrid*>(ds))
+    sg->SetExtent(const_cast<int*>(be.Extent.data()));
+
+  if (structureOnly)
+    return ds;
+
+  // points
+  const ArrayEntry *ae = be.GetArray(POINTS);
+  if (ae)
+    {
+    vtkDataArray *da = this->NewArray(*ae);
+    if (!da)
+      {
+      ds->Delete();
+      return nullptr;
+      }
+
+    vtkPoints *pts = vtkPoints::New();
+    pts->SetData(da);
+    da->Delete();
+
+    static_cast<vtkPointSet*>(ds)->SetPoints(pts);
+    pts->Delete();
+    }
+
+  if (dynamic_cast<vtkStructuredGrid*>(ds))
+    return ds;
+
+  // cells
+  const ArrayEntry *tae = be.GetArray(CELL_TYPES);
+  const ArrayEntry *cae = be.GetArray(CELL_ARRAY);
+  if (!tae || !cae ||
+    (tae->NumTuples != static_cast<unsigned long long>(be.NumCells)))
+    {
+    SENSEI_ERROR("Failed to get the cells of block " << be.BlockId)
+    ds->Delete();
+    return nullptr;
+    }
+
+  unsigned char *types = this->Data + tae->Offset;
+  vtkIdType *cells = reinterpret_cast<vtkIdType*>(this->Data + cae->Offset);
+  vtkIdType nCells = be.NumCells;
+
+  if (vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(ds))
+    {
+    vtkUnsignedCharArray *cta = vtkUnsignedCharArray::New();
+    cta->SetArray(types, nCells, 1);
+
+    // build locations
+    vtkIdTypeArray *locs = vtkIdTypeArray::New();
+    locs->SetNumberOfTuples(nCells);
+    vtkIdType *pLocs = locs->GetPointer(0);
+    for (vtkIdType i = 0, loc = 0; i < nCells; ++i)
+      {
+      pLocs[i] = loc;
+      loc += cells[loc] + 1;
+      }
+
+    vtkCellArray *ca = newCellArray(cells, nCells, cae->NumTuples);
+
+    ug->SetCells(cta, locs, ca);
+
+    cta->Delete();
+    locs->Delete();
+    ca->Delete();
+    }
+  else if (vtkPolyData *pd = dynamic_cast<vtkPolyData*>(ds))
+    {
+    // cells are ordered verts, lines, polys, strips
+    int kinds[4] = {VTK_VERTEX, VTK_LINE, VTK_POLYGON, VTK_TRIANGLE_STRIP};
+    vtkCellArray *cas[4] = {nullptr};
+
+    vtkIdType i = 0;
+    vtkIdType *pCells = cells;
+    for (int k = 0; k < 4; ++k)
+      {
+      vtkIdType *begin = pCells;
+      vtkIdType n = 0;
+      while ((i < nCells) && (types[i] == kinds[k]))
+        {
+        pCells += pCells[0] + 1;
+        ++n;
+        ++i;
+        }
+      if (n)
+        cas[k] = newCellArray(begin, n, pCells - begin);
+      }
+
+    if (cas[0])
+      pd->SetVerts(cas[0]);
+
+    if (cas[1])
+      pd->SetLines(cas[1]);
+
+    if (cas[2])
+      pd->SetPolys(cas[2]);
+
+    if (cas[3])
+      pd->SetStrips(cas[3]);
+
+    for (int k = 0; k < 4; ++k)
+      if (cas[k])
+        cas[k]->Delete();
+    }
+
+  return ds;
+}
+
+}
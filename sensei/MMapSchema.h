@@ -0,0 +1,171 @@
+#ifndef MMapSchema_h
+#define MMapSchema_h
+
+#include "MeshMetadata.h"
+#include "BinaryStream.h"
+
+#include <mpi.h>
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+class vtkDataArray;
+class vtkDataSet;
+
+namespace sensei { namespace VTKUtils { class BlockSerializer; } }
+
+/// The on disk format of the mmap transport. Each step is stored in a step
+/// file, written by rank 0, holding the time, time step, and the global view
+/// of each mesh's metadata, and a data file per writer rank. A data file is
+/// a flat sequence of arrays, each aligned on a 64 byte boundary, followed by
+/// an index describing the blocks and arrays and a fixed size footer locating
+/// the index. Readers map the data files into memory and use the arrays in
+/// place.
+namespace senseiMMap
+{
+
+/// the kind of data an array holds
+enum
+{
+  POINTS = 0,
+  X_COORDINATES = 1,
+  Y_COORDINATES = 2,
+  Z_COORDINATES = 3,
+  CELL_TYPES = 4,
+  CELL_ARRAY = 5,
+  DATA_ARRAY = 6
+};
+
+/// describes an array in a data file
+struct ArrayEntry
+{
+  void ToStream(sensei::BinaryStream &bs) const;
+  void FromStream(sensei::BinaryStream &bs);
+
+  int Kind;                      // one of the above enums
+  int Association;               // point or cell, for data arrays
+  std::string Name;              // name, for data arrays
+  int Type;                      // VTK type code of the elements
+  int NumComponents;
+  unsigned long long NumTuples;
+  unsigned long long Offset;     // in bytes from the start of the file
+};
+
+/// describes a block in a data file
+struct BlockEntry
+{
+  void ToStream(sensei::BinaryStream &bs) const;
+  void FromStream(sensei::BinaryStream &bs);
+
+  // find an array, returns nullptr if it is not present
+  const ArrayEntry *GetArray(int kind, int association = -1,
+    const std::string &name = "") const;
+
+  std::string MeshName;
+  int BlockId;                   // index of the block in the mesh
+  int BlockType;                 // VTK data object type code
+  long NumCells;
+  std::array<int,6> Extent;      // logically Cartesian blocks
+  std::array<double,3> Origin;   // uniform Cartesian blocks
+  std::array<double,3> Spacing;  // uniform Cartesian blocks
+  std::vector<ArrayEntry> Arrays;
+};
+
+/// names of the files of a step
+std::string GetStepFileName(const std::string &dir,
+  const std::string &name, unsigned long step);
+
+std::string GetDataFileName(const std::string &dir,
+  const std::string &name, unsigned long step, int rank);
+
+/// writes the step file. the metadata must be a global view.
+int WriteStepFile(const std::string &fileName, unsigned long timeStep,
+  double time, int numWriters, const std::vector<sensei::MeshMetadataPtr> &md);
+
+/// rank 0 reads the step file and broadcasts it. returns 1 when the file
+/// does not exist, -1 on error.
+int ReadStepFile(MPI_Comm comm, const std::string &fileName,
+  unsigned long &timeStep, double &time, int &numWriters,
+  std::vector<sensei::MeshMetadataPtr> &md);
+
+/// writes the local blocks of a step to a data file, or to an equivalently
+/// laid out buffer in memory
+class DataFileWriter
+{
+public:
+  DataFileWriter() : File(nullptr), Buffer(nullptr), Offset(0) {}
+  ~DataFileWriter();
+
+  int Open(const std::string &fileName);
+
+  // write to the end of the buffer rather than to a file
+  int Open(std::vector<unsigned char> &buffer);
+
+  // write all the arrays of a block
+  int WriteBlock(const std::string &meshName, int blockId, vtkDataSet *ds);
+
+  // write the index and footer and close the file
+  int Close();
+
+private:
+  int WriteArray(vtkDataSet *ds, sensei::VTKUtils::BlockSerializer &ser,
+    int kind, int type, int numComponents, BlockEntry &block,
+    int association = -1, const std::string &name = "");
+
+  int Write(const void *data, unsigned long long nBytes);
+
+  DataFileWriter(const DataFileWriter&) = delete;
+  void operator=(const DataFileWriter&) = delete;
+
+private:
+  FILE *File;
+  std::vector<unsigned char> *Buffer;
+  std::string FileName;
+  unsigned long long Offset;
+  std::vector<BlockEntry> Blocks;
+  std::vector<unsigned char> Staging;
+};
+
+/// a data file mapped into memory. arrays created from it point into the
+/// mapping and are valid only while the file is open.
+class DataFile
+{
+public:
+  DataFile() : Data(nullptr), Size(0), Mapped(false) {}
+  ~DataFile();
+
+  int Open(const std::string &fileName);
+
+  // use data written to memory by a DataFileWriter. the memory is not
+  // copied and must remain valid while the arrays are in use.
+  int Open(unsigned char *data, unsigned long long size);
+
+  void Close();
+
+  // find a block, returns nullptr if it is not present
+  const BlockEntry *GetBlock(const std::string &meshName, int blockId) const;
+
+  // wrap an array without copying it
+  vtkDataArray *NewArray(const ArrayEntry &ae) const;
+
+  // construct the block, its points and cells are used in place
+  vtkDataSet *NewBlock(const BlockEntry &be, bool structureOnly) const;
+
+private:
+  int ReadIndex(const std::string &source);
+
+  DataFile(const DataFile&) = delete;
+  void operator=(const DataFile&) = delete;
+
+private:
+  unsigned char *Data;
+  unsigned long long Size;
+  bool Mapped;
+  std::map<std::pair<std::string,int>, BlockEntry> Blocks;
+};
+
+}
+
+#endif
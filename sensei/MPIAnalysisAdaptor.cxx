@@ -0,0 +1,369 @@
+#include "MPIAnalysisAdaptor.h"
+#include "MPIRedistributor.h"
+#include "MMapSchema.h"
+
+#include "BinaryStream.h"
+#include "DataAdaptor.h"
+#include "Error.h"
+#include "MPIUtils.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "VTKUtils.h"
+
+#include <vtkCompositeDataIterator.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataSet.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+#include <pugixml.hpp>
+
+#include <string>
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+senseiNewMacro(MPIAnalysisAdaptor);
+
+//----------------------------------------------------------------------------
+MPIAnalysisAdaptor::MPIAnalysisAdaptor() : Timeout(60.0),
+  Intercomm(MPI_COMM_NULL), Method(MPIRedistributor::NEIGHBOR),
+  Redistributor(nullptr)
+{
+}
+
+//----------------------------------------------------------------------------
+MPIAnalysisAdaptor::~MPIAnalysisAdaptor()
+{
+  delete this->Redistributor;
+}
+
+//----------------------------------------------------------------------------
+int MPIAnalysisAdaptor::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIAnalysisAdaptor::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIAnalysisAdaptor::Initialize(pugi::xml_node &node)
+{
+  TimeEvent<128> mark("MPIAnalysisAdaptor::Initialize");
+
+  if (node.attribute("port_file"))
+    this->SetPortFile(node.attribute("port_file").value());
+
+  this->SetTimeout(node.attribute("timeout").as_double(60.0));
+
+  std::string method = node.attribute("method").as_string("neighbor");
+  if (method == "alltoallv")
+    {
+    this->SetMethod(MPIRedistributor::ALLTOALLV);
+    }
+  else if (method != "neighbor")
+    {
+    SENSEI_ERROR("Invalid method \"" << method << "\"")
+    return -1;
+    }
+
+  // set the data requirements
+  DataRequirements req;
+  if (req.Initialize(node))
+    {
+    SENSEI_ERROR("Failed to initialize the MPI transport.")
+    return -1;
+    }
+  this->SetDataRequirements(req);
+
+  SENSEI_STATUS("Configured MPIAnalysisAdaptor port_file=\""
+    << this->PortFile << "\" method=" << method)
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool MPIAnalysisAdaptor::Execute(DataAdaptor* dataAdaptor)
+{
+  TimeEvent<128> mark("MPIAnalysisAdaptor::Execute");
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  // join the receivers the first time through
+  if (!this->Redistributor)
+    {
+    this->Redistributor = new MPIRedistributor;
+    this->Redistributor->SetMethod(this->Method);
+
+    if (((this->Intercomm != MPI_COMM_NULL) &&
+      this->Redistributor->SetIntercommunicator(this->Intercomm, true)) ||
+      ((this->Intercomm == MPI_COMM_NULL) &&
+      this->Redistributor->Connect(comm, this->PortFile, this->Timeout)))
+      {
+      SENSEI_ERROR("Failed to connect to the receiver")
+      delete this->Redistributor;
+      this->Redistributor = nullptr;
+      return false;
+      }
+    }
+
+  MPIRedistributor *redist = this->Redistributor;
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // figure out what the simulation can provide
+  MeshMetadataFlags flags;
+  flags.SetBlockDecomp();
+  flags.SetBlockSize();
+
+  MeshMetadataMap mdm;
+  if (mdm.Initialize(dataAdaptor, flags))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  // if no dataAdaptor requirements are given, push all the data
+  // fill in the requirements with every thing
+  if (this->Requirements.Empty())
+    {
+    if (this->Requirements.Initialize(dataAdaptor, false))
+      {
+      SENSEI_ERROR("Failed to initialze dataAdaptor description")
+      return false;
+      }
+    SENSEI_WARNING("No subset specified. Writing all available data")
+    }
+
+  // get the metadata of the meshes being sent and generate a global view
+  // of it. the receiver partitions the blocks based on it
+  std::vector<MeshMetadataPtr> metadata;
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  for (; mit; ++mit)
+    {
+    MeshMetadataPtr md;
+    if (mdm.GetMeshMetadata(mit.MeshName(), md))
+      {
+      SENSEI_ERROR("Failed to get mesh metadata for mesh \""
+        << mit.MeshName() << "\"")
+      return false;
+      }
+
+    if (VTKUtils::AMR(md))
+      {
+      SENSEI_ERROR("AMR mesh \"" << mit.MeshName()
+        << "\" is not supported by the MPI transport")
+      return false;
+      }
+
+    if (!md->GlobalView)
+      {
+      MPIUtils::GlobalViewV(comm, md->BlockOwner);
+      MPIUtils::GlobalViewV(comm, md->BlockIds);
+      MPIUtils::GlobalViewV(comm, md->BlockNumPoints);
+      MPIUtils::GlobalViewV(comm, md->BlockNumCells);
+      MPIUtils::GlobalViewV(comm, md->BlockCellArraySize);
+      MPIUtils::GlobalViewV(comm, md->BlockExtents);
+      md->GlobalView = true;
+      }
+
+    metadata.push_back(md);
+    }
+
+  // send the time and metadata. the leading 1 tells the receiver a
+  // step follows
+  unsigned int nMeshes = metadata.size();
+
+  BinaryStream header;
+  if (rank == 0)
+    {
+    header.Pack(int(1));
+    header.Pack(dataAdaptor->GetDataTimeStep());
+    header.Pack(dataAdaptor->GetDataTime());
+    header.Pack(nMeshes);
+    for (unsigned int i = 0; i < nMeshes; ++i)
+      metadata[i]->ToStream(header);
+    }
+  redist->Broadcast(header, true);
+
+  // receive the layout the receiver chose and update the plan
+  BinaryStream layout;
+  redist->Broadcast(layout, false);
+
+  std::vector<std::vector<int>> recvOwner(nMeshes);
+  std::vector<int> allSendOwner;
+  std::vector<int> allRecvOwner;
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    layout.Unpack(recvOwner[i]);
+
+    allSendOwner.insert(allSendOwner.end(), metadata[i]->BlockOwner.begin(),
+      metadata[i]->BlockOwner.end());
+
+    allRecvOwner.insert(allRecvOwner.end(), recvOwner[i].begin(),
+      recvOwner[i].end());
+    }
+
+  int ierr = 0;
+  if (redist->SetPlan(allSendOwner, allRecvOwner))
+    {
+    SENSEI_ERROR("Failed to compute the plan")
+    return false;
+    }
+
+  // fetch the meshes. errors are deferred until the data has been
+  // exchanged so that no rank is left waiting.
+  std::vector<vtkCompositeDataSetPtr> meshes(nMeshes);
+
+  mit = this->Requirements.GetMeshRequirementsIterator();
+
+  for (unsigned int i = 0; !ierr && mit; ++mit, ++i)
+    {
+    MeshMetadataPtr &md = metadata[i];
+
+    // get the mesh
+    vtkDataObject *dobj = nullptr;
+    if (dataAdaptor->GetMesh(mit.MeshName(), mit.StructureOnly(), dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << mit.MeshName() << "\"")
+      ierr = -1;
+      break;
+      }
+
+    // add the ghost cell arrays to the mesh
+    if (md->NumGhostCells &&
+      dataAdaptor->AddGhostCellsArray(dobj, mit.MeshName()))
+      {
+      SENSEI_ERROR("Failed to get ghost cells for mesh \""
+        << mit.MeshName() << "\"")
+      ierr = -1;
+      }
+
+    // add the ghost node arrays to the mesh
+    if (!ierr && md->NumGhostNodes &&
+      dataAdaptor->AddGhostNodesArray(dobj, mit.MeshName()))
+      {
+      SENSEI_ERROR("Failed to get ghost nodes for mesh \""
+        << mit.MeshName() << "\"")
+      ierr = -1;
+      }
+
+    // add the required arrays
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(mit.MeshName());
+
+    for (; !ierr && ait; ++ait)
+      {
+      if (dataAdaptor->AddArray(dobj, mit.MeshName(),
+        ait.Association(), ait.Array()))
+        {
+        SENSEI_ERROR("Failed to add "
+          << VTKUtils::GetAttributesName(ait.Association())
+          << " data array \"" << ait.Array() << "\" to mesh \""
+          << mit.MeshName() << "\"")
+        ierr = -1;
+        }
+      }
+
+    meshes[i] = VTKUtils::AsCompositeData(comm, dobj, true);
+    }
+
+  // serialize the blocks, one section per receiver. the block's position in
+  // the composite dataset identifies it to the receiver
+  const std::vector<int> &peers = redist->GetPeers();
+  int nPeers = peers.size();
+  int nSenders = redist->GetNumberOfSenders();
+
+  std::vector<unsigned char> sendBuf;
+  std::vector<unsigned long long> sendSizes(nPeers, 0);
+
+  for (int p = 0; !ierr && (p < nPeers); ++p)
+    {
+    size_t start = sendBuf.size();
+
+    senseiMMap::DataFileWriter writer;
+    writer.Open(sendBuf);
+
+    for (unsigned int i = 0; !ierr && (i < nMeshes); ++i)
+      {
+      vtkSmartPointer<vtkCompositeDataIterator> it;
+      it.TakeReference(meshes[i]->NewIterator());
+      it->SetSkipEmptyNodes(0);
+
+      int j = 0;
+      for (it->InitTraversal(); !ierr && !it->IsDoneWithTraversal();
+        it->GoToNextItem(), ++j)
+        {
+        if ((j >= static_cast<int>(recvOwner[i].size())) ||
+          (nSenders + recvOwner[i][j] != peers[p]))
+          continue;
+
+        vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
+        if (ds && writer.WriteBlock(metadata[i]->MeshName, j, ds))
+          {
+          SENSEI_ERROR("Failed to serialize block " << j << " of mesh \""
+            << metadata[i]->MeshName << "\"")
+          ierr = -1;
+          }
+        }
+      }
+
+    if (writer.Close())
+      ierr = -1;
+
+    sendSizes[p] = sendBuf.size() - start;
+    }
+
+  // send empty sections after an error, the receiver will report it
+  if (ierr)
+    sendSizes.assign(nPeers, 0);
+
+  // move the data
+  std::vector<unsigned char*> recvData;
+  std::vector<unsigned long long> recvSizes;
+  if (redist->Exchange(sendBuf.data(), sendSizes, recvData, recvSizes))
+    {
+    SENSEI_ERROR("Failed to send the data")
+    return false;
+    }
+
+  return !ierr;
+}
+
+//----------------------------------------------------------------------------
+int MPIAnalysisAdaptor::Finalize()
+{
+  TimeEvent<128> mark("MPIAnalysisAdaptor::Finalize");
+
+  if (!this->Redistributor)
+    return 0;
+
+  // a leading 0 tells the receiver the stream has ended
+  BinaryStream header;
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+  if (rank == 0)
+    header.Pack(int(0));
+
+  this->Redistributor->Broadcast(header, true);
+  this->Redistributor->Disconnect();
+
+  delete this->Redistributor;
+  this->Redistributor = nullptr;
+
+  return 0;
+}
+
+}
@@ -0,0 +1,77 @@
+#ifndef MPIAnalysisAdaptor_h
+#define MPIAnalysisAdaptor_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <string>
+#include <vector>
+#include <mpi.h>
+
+namespace pugi { class xml_node; }
+
+namespace sensei
+{
+class MPIRedistributor;
+
+/// The write side of the MPI transport. Blocks are sent directly to the
+/// ranks of the MPIDataAdaptor that the receiver's partitioner assigns them
+/// to. See MPIRedistributor for how the two sides are joined and how data
+/// is moved.
+class MPIAnalysisAdaptor : public AnalysisAdaptor
+{
+public:
+  static MPIAnalysisAdaptor* New();
+  senseiTypeMacro(MPIAnalysisAdaptor, AnalysisAdaptor);
+
+  /// initialize from an XML representation
+  int Initialize(pugi::xml_node &parent);
+
+  /// @brief Set the file the receiver writes its port name to.
+  void SetPortFile(const std::string &portFile)
+  { this->PortFile = portFile; }
+
+  /// @brief Set how long to wait for the receiver in seconds.
+  /// Default value is 60.
+  void SetTimeout(double timeout)
+  { this->Timeout = timeout; }
+
+  /// @brief Use an existing intercommunicator rather than connecting
+  /// through the port file.
+  void SetIntercommunicator(MPI_Comm intercomm)
+  { this->Intercomm = intercomm; }
+
+  /// @brief Set the method used to move the data.
+  /// One of MPIRedistributor::NEIGHBOR (default) or ALLTOALLV.
+  void SetMethod(int method)
+  { this->Method = method; }
+
+  /// data requirements tell the adaptor what to push
+  /// if none are given then all data is pushed.
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  // SENSEI AnalysisAdaptor API
+  bool Execute(DataAdaptor* data) override;
+  int Finalize() override;
+
+protected:
+  MPIAnalysisAdaptor();
+  ~MPIAnalysisAdaptor();
+
+  MPIAnalysisAdaptor(const MPIAnalysisAdaptor&) = delete;
+  void operator=(const MPIAnalysisAdaptor&) = delete;
+
+  DataRequirements Requirements;
+  std::string PortFile;
+  double Timeout;
+  MPI_Comm Intercomm;
+  int Method;
+  MPIRedistributor *Redistributor;
+};
+
+}
+
+#endif
@@ -0,0 +1,554 @@
+#include "MPIDataAdaptor.h"
+#include "MPIRedistributor.h"
+#include "MMapSchema.h"
+#include "MeshMetadata.h"
+#include "Partitioner.h"
+#include "Error.h"
+#include "Profiler.h"
+#include "VTKUtils.h"
+
+#include <vtkCompositeDataIterator.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataArray.h>
+#include <vtkDataSet.h>
+#include <vtkFieldData.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+#include <pugixml.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace sensei
+{
+struct MPIDataAdaptor::InternalsType
+{
+  InternalsType() : Intercomm(MPI_COMM_NULL), Good(false) {}
+
+  // get the metadata of the named mesh
+  int GetSenderMeshMetadata(const std::string &meshName, MeshMetadataPtr &md);
+
+  // find the given block in the data sent by its owner
+  int GetBlock(const MeshMetadataPtr &md, int blockId,
+    senseiMMap::DataFile *&file, const senseiMMap::BlockEntry *&block);
+
+  // release the current step's data
+  void Release();
+
+  std::string PortFile;
+  MPI_Comm Intercomm;
+  MPIRedistributor Redistributor;
+  bool Good;
+  std::vector<MeshMetadataPtr> SenderMetadata;
+  std::map<unsigned int, MeshMetadataPtr> ReceiverMetadata;
+  std::map<int, std::unique_ptr<senseiMMap::DataFile>> Files;
+};
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::InternalsType::GetSenderMeshMetadata(
+  const std::string &meshName, MeshMetadataPtr &md)
+{
+  unsigned int nMeshes = this->SenderMetadata.size();
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    if (this->SenderMetadata[i]->MeshName == meshName)
+      {
+      md = this->SenderMetadata[i];
+      return 0;
+      }
+    }
+
+  SENSEI_ERROR("No mesh named \"" << meshName << "\"")
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::InternalsType::GetBlock(const MeshMetadataPtr &md,
+  int blockId, senseiMMap::DataFile *&file,
+  const senseiMMap::BlockEntry *&block)
+{
+  int sender = md->BlockOwner[blockId];
+
+  auto it = this->Files.find(sender);
+  if ((it == this->Files.end()) ||
+    !(block = it->second->GetBlock(md->MeshName, blockId)))
+    {
+    SENSEI_ERROR("Block " << blockId << " of mesh \"" << md->MeshName
+      << "\" was not received from rank " << sender)
+    return -1;
+    }
+
+  file = it->second.get();
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void MPIDataAdaptor::InternalsType::Release()
+{
+  this->Files.clear();
+  this->ReceiverMetadata.clear();
+}
+
+
+
+//----------------------------------------------------------------------------
+senseiNewMacro(MPIDataAdaptor);
+
+//----------------------------------------------------------------------------
+MPIDataAdaptor::MPIDataAdaptor() : Internals(nullptr)
+{
+  this->Internals = new InternalsType;
+}
+
+//----------------------------------------------------------------------------
+MPIDataAdaptor::~MPIDataAdaptor()
+{
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void MPIDataAdaptor::SetPortFile(const std::string &portFile)
+{
+  this->Internals->PortFile = portFile;
+}
+
+//----------------------------------------------------------------------------
+void MPIDataAdaptor::SetIntercommunicator(MPI_Comm intercomm)
+{
+  this->Internals->Intercomm = intercomm;
+}
+
+//----------------------------------------------------------------------------
+void MPIDataAdaptor::SetMethod(int method)
+{
+  this->Internals->Redistributor.SetMethod(method);
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::Initialize(pugi::xml_node &node)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::Initialize");
+
+  // let the base class handle initialization of the partitioner etc
+  if (this->InTransitDataAdaptor::Initialize(node))
+    {
+    SENSEI_ERROR("Failed to intialize the MPIDataAdaptor")
+    return -1;
+    }
+
+  if (node.attribute("port_file"))
+    this->SetPortFile(node.attribute("port_file").value());
+
+  std::string method = node.attribute("method").as_string("neighbor");
+  if (method == "alltoallv")
+    {
+    this->SetMethod(MPIRedistributor::ALLTOALLV);
+    }
+  else if (method != "neighbor")
+    {
+    SENSEI_ERROR("Invalid method \"" << method << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::Finalize()
+{
+  TimeEvent<128> mark("MPIDataAdaptor::Finalize");
+  this->CloseStream();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::OpenStream()
+{
+  TimeEvent<128> mark("MPIDataAdaptor::OpenStream");
+
+  MPIRedistributor &redist = this->Internals->Redistributor;
+
+  if (!redist.Connected() &&
+    (((this->Internals->Intercomm != MPI_COMM_NULL) &&
+    redist.SetIntercommunicator(this->Internals->Intercomm, false)) ||
+    ((this->Internals->Intercomm == MPI_COMM_NULL) &&
+    redist.Accept(this->GetCommunicator(), this->Internals->PortFile))))
+    {
+    SENSEI_ERROR("Failed to connect to the sender")
+    return -1;
+    }
+
+  int ierr = this->UpdateTimeStep();
+  if (ierr > 0)
+    {
+    SENSEI_ERROR("The sender ended the stream before sending any data")
+    }
+
+  return ierr ? -1 : 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::StreamGood()
+{
+  return this->Internals->Good ? 0 : -1;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::CloseStream()
+{
+  TimeEvent<128> mark("MPIDataAdaptor::CloseStream");
+
+  this->Internals->Release();
+  this->Internals->SenderMetadata.clear();
+  this->Internals->Redistributor.Disconnect();
+  this->Internals->Good = false;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::AdvanceStream()
+{
+  TimeEvent<128> mark("MPIDataAdaptor::AdvanceStream");
+
+  // the previous step's arrays are no longer valid
+  this->Internals->Release();
+
+  return this->UpdateTimeStep();
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::UpdateTimeStep()
+{
+  TimeEvent<128> mark("MPIDataAdaptor::UpdateTimeStep");
+
+  MPIRedistributor &redist = this->Internals->Redistributor;
+
+  this->Internals->Release();
+  this->Internals->Good = false;
+
+  if (!redist.Connected())
+    return -1;
+
+  // receive the time and metadata. a leading 0 marks the end of the stream
+  BinaryStream header;
+  redist.Broadcast(header, true);
+
+  int more = 0;
+  header.Unpack(more);
+  if (!more)
+    return 1;
+
+  unsigned long timeStep = 0;
+  double time = 0.0;
+  unsigned int nMeshes = 0;
+
+  header.Unpack(timeStep);
+  header.Unpack(time);
+  header.Unpack(nMeshes);
+
+  int ierr = 0;
+  this->Internals->SenderMetadata.resize(nMeshes);
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    this->Internals->SenderMetadata[i] = MeshMetadata::New();
+    if (this->Internals->SenderMetadata[i]->FromStream(header))
+      {
+      SENSEI_ERROR("Failed to deserialize metadata for mesh " << i)
+      return -1;
+      }
+    }
+
+  this->SetDataTimeStep(timeStep);
+  this->SetDataTime(time);
+
+  // decide where the blocks land. errors are deferred until the data has
+  // been exchanged so that the sender is not left waiting
+  std::vector<int> allSendOwner;
+  std::vector<int> allRecvOwner;
+  BinaryStream layout;
+
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+
+  // lay out all of the meshes at once
+  std::vector<MeshMetadataPtr> receiverMd;
+  if (this->PartitionMeshes(receiverMd) || (receiverMd.size() != nMeshes))
+    {
+    SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
+    ierr = -1;
+    }
+
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    MeshMetadataPtr &senderMd = this->Internals->SenderMetadata[i];
+
+    // the sender and receiver must agree on the number of blocks, else the
+    // plan can't be made. on error the blocks are sent to rank 0
+    std::vector<int> owner;
+    if (!ierr && (receiverMd[i]->BlockOwner.size() !=
+      static_cast<size_t>(senderMd->NumBlocks)))
+      {
+      SENSEI_ERROR("The layout of mesh " << i << " has "
+        << receiverMd[i]->BlockOwner.size() << " blocks but the sender has "
+        << senderMd->NumBlocks)
+      ierr = -1;
+      }
+
+    if (ierr)
+      {
+      owner.assign(senderMd->NumBlocks, 0);
+      }
+    else
+      {
+      this->Internals->ReceiverMetadata[i] = receiverMd[i];
+      owner = receiverMd[i]->BlockOwner;
+      }
+
+    if (rank == 0)
+      layout.Pack(owner);
+
+    allSendOwner.insert(allSendOwner.end(), senderMd->BlockOwner.begin(),
+      senderMd->BlockOwner.end());
+
+    allRecvOwner.insert(allRecvOwner.end(), owner.begin(), owner.end());
+    }
+
+  // send the layout to the sender and update the plan
+  redist.Broadcast(layout, false);
+
+  // the exchange is attempted even if the plan failed, the sender is
+  // waiting in it
+  if (redist.SetPlan(allSendOwner, allRecvOwner))
+    {
+    SENSEI_ERROR("Failed to compute the plan")
+    ierr = -1;
+    }
+
+  // receive the blocks
+  std::vector<unsigned char*> recvData;
+  std::vector<unsigned long long> recvSizes;
+  if (redist.Exchange(nullptr, std::vector<unsigned long long>(),
+    recvData, recvSizes))
+    {
+    SENSEI_ERROR("Failed to receive the data")
+    return -1;
+    }
+
+  if (ierr)
+    return -1;
+
+  const std::vector<int> &peers = redist.GetPeers();
+  unsigned int nPeers = peers.size();
+  for (unsigned int i = 0; i < nPeers; ++i)
+    {
+    std::unique_ptr<senseiMMap::DataFile> file(new senseiMMap::DataFile);
+    if (file->Open(recvData[i], recvSizes[i]))
+      {
+      SENSEI_ERROR("Invalid data received from rank " << peers[i])
+      ierr = -1;
+      continue;
+      }
+    this->Internals->Files[peers[i]] = std::move(file);
+    }
+
+  this->Internals->Good = (ierr == 0);
+
+  return ierr;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::GetSenderMeshMetadata(unsigned int id,
+  MeshMetadataPtr &metadata)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::GetSenderMeshMetadata");
+
+  if (id >= this->Internals->SenderMetadata.size())
+    {
+    SENSEI_ERROR("Failed to get metadata for object " << id)
+    return -1;
+    }
+
+  metadata = this->Internals->SenderMetadata[id];
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::GetNumberOfMeshes");
+  numMeshes = this->Internals->SenderMetadata.size();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::GetMeshMetadata");
+
+  // the layout is fixed when the step is received
+  auto it = this->Internals->ReceiverMetadata.find(id);
+  if (it != this->Internals->ReceiverMetadata.end())
+    {
+    metadata = it->second;
+    return 0;
+    }
+
+  // use the partitioner or the layout set by an analysis
+  std::vector<MeshMetadataPtr> receiverMd;
+  if (this->PartitionMeshes(receiverMd) || (id >= receiverMd.size()))
+    {
+    SENSEI_ERROR("Failed to determine a suitable layout to receive the data")
+    return -1;
+    }
+
+  // cache and return the layouts
+  unsigned int nMeshes = receiverMd.size();
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    this->Internals->ReceiverMetadata[i] = receiverMd[i];
+
+  metadata = receiverMd[id];
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::GetMesh(const std::string &meshName,
+   bool structureOnly, vtkDataObject *&mesh)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::GetMesh");
+
+  mesh = nullptr;
+
+  // find the mesh and get the layout of its blocks on this rank
+  unsigned int nMeshes = this->Internals->SenderMetadata.size();
+  unsigned int id = 0;
+  while ((id < nMeshes) &&
+    (this->Internals->SenderMetadata[id]->MeshName != meshName))
+    ++id;
+
+  MeshMetadataPtr senderMd;
+  MeshMetadataPtr md;
+  if (this->GetSenderMeshMetadata(id, senderMd) ||
+    this->GetMeshMetadata(id, md))
+    {
+    SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+
+  vtkMultiBlockDataSet *mb = vtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(md->NumBlocks);
+
+  for (int j = 0; j < md->NumBlocks; ++j)
+    {
+    if (md->BlockOwner[j] != rank)
+      continue;
+
+    senseiMMap::DataFile *file = nullptr;
+    const senseiMMap::BlockEntry *block = nullptr;
+    vtkDataSet *ds = nullptr;
+
+    if (this->Internals->GetBlock(senderMd, j, file, block) ||
+      !(ds = file->NewBlock(*block, structureOnly)))
+      {
+      SENSEI_ERROR("Failed to get block " << j << " of mesh \""
+        << meshName << "\"")
+      mb->Delete();
+      return -1;
+      }
+
+    mb->SetBlock(j, ds);
+    ds->Delete();
+    }
+
+  VTKUtils::SetGhostLayerMetadata(mb, md->NumGhostCells, md->NumGhostNodes);
+
+  mesh = mb;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::AddGhostNodesArray(vtkDataObject *mesh,
+  const std::string &meshName)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::AddGhostNodesArray");
+  return AddArray(mesh, meshName, vtkDataObject::POINT, "vtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::AddGhostCellsArray(vtkDataObject *mesh,
+  const std::string &meshName)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::AddGhostCellsArray");
+  return AddArray(mesh, meshName, vtkDataObject::CELL, "vtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::AddArray(vtkDataObject* mesh,
+  const std::string &meshName, int association, const std::string& arrayName)
+{
+  TimeEvent<128> mark("MPIDataAdaptor::AddArray");
+
+  // the mesh should never be null. there must have been an error
+  // upstream.
+  vtkCompositeDataSet *cd = dynamic_cast<vtkCompositeDataSet*>(mesh);
+  if (!cd)
+    {
+    SENSEI_ERROR("Invalid mesh object")
+    return -1;
+    }
+
+  MeshMetadataPtr senderMd;
+  if (this->Internals->GetSenderMeshMetadata(meshName, senderMd))
+    return -1;
+
+  vtkSmartPointer<vtkCompositeDataIterator> it;
+  it.TakeReference(cd->NewIterator());
+  it->SetSkipEmptyNodes(0);
+
+  int j = 0;
+  for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem(), ++j)
+    {
+    vtkDataSet *ds = dynamic_cast<vtkDataSet*>(it->GetCurrentDataObject());
+    if (!ds)
+      continue;
+
+    senseiMMap::DataFile *file = nullptr;
+    const senseiMMap::BlockEntry *block = nullptr;
+    const senseiMMap::ArrayEntry *ae = nullptr;
+    vtkDataArray *da = nullptr;
+
+    if (this->Internals->GetBlock(senderMd, j, file, block) ||
+      !(ae = block->GetArray(senseiMMap::DATA_ARRAY, association, arrayName)) ||
+      !(da = file->NewArray(*ae)))
+      {
+      SENSEI_ERROR("Failed to get " << VTKUtils::GetAttributesName(association)
+        << " data array \"" << arrayName << "\" of block " << j
+        << " of mesh \"" << meshName << "\"")
+      return -1;
+      }
+
+    VTKUtils::GetAttributes(ds, association)->AddArray(da);
+    da->Delete();
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int MPIDataAdaptor::ReleaseData()
+{
+  TimeEvent<128> mark("MPIDataAdaptor::ReleaseData");
+  return 0;
+}
+
+}
@@ -0,0 +1,84 @@
+#ifndef MPIDataAdaptor_h
+#define MPIDataAdaptor_h
+
+#include "InTransitDataAdaptor.h"
+
+#include <mpi.h>
+#include <string>
+
+namespace pugi { class xml_node; }
+
+namespace sensei
+{
+
+/// The read side of the MPI transport. At the start of each step the
+/// partitioner, or the receiver metadata set by an analysis, decides where
+/// each block lands. The layout is sent back to the MPIAnalysisAdaptor which
+/// sends each rank its blocks directly. The received arrays are used in place
+/// and are valid until the stream is advanced or closed. Receiver metadata
+/// set by an analysis applies to the steps received after it is set.
+class MPIDataAdaptor : public sensei::InTransitDataAdaptor
+{
+public:
+  static MPIDataAdaptor* New();
+  senseiTypeMacro(MPIDataAdaptor, sensei::InTransitDataAdaptor);
+
+  /// @brief Set the file the port name is written to.
+  void SetPortFile(const std::string &portFile);
+
+  /// @brief Use an existing intercommunicator rather than accepting
+  /// a connection through the port file.
+  void SetIntercommunicator(MPI_Comm intercomm);
+
+  /// @brief Set the method used to move the data.
+  /// One of MPIRedistributor::NEIGHBOR (default) or ALLTOALLV. The sender
+  /// must use the same method.
+  void SetMethod(int method);
+
+  /// SENSEI InTransitDataAdaptor control API
+  int Initialize(pugi::xml_node &parent) override;
+  int Finalize() override;
+
+  int OpenStream() override;
+  int CloseStream() override;
+  int AdvanceStream() override;
+  int StreamGood() override;
+
+  /// SENSEI InTransitDataAdaptor explicit paritioning API
+  int GetSenderMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  /// SENSEI DataAdaptor API
+  int GetNumberOfMeshes(unsigned int &numMeshes) override;
+
+  int GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  int GetMesh(const std::string &meshName, bool structure_only,
+    vtkDataObject *&mesh) override;
+
+  int AddGhostNodesArray(vtkDataObject* mesh, const std::string &meshName) override;
+  int AddGhostCellsArray(vtkDataObject* mesh, const std::string &meshName) override;
+
+  int AddArray(vtkDataObject* mesh, const std::string &meshName,
+    int association, const std::string &arrayName) override;
+
+  int ReleaseData() override;
+
+protected:
+  MPIDataAdaptor();
+  ~MPIDataAdaptor();
+
+  // receives the next step. stores the time and time step in the base class
+  // information object. returns 1 when the sender has ended the stream.
+  int UpdateTimeStep();
+
+private:
+  struct InternalsType;
+  InternalsType *Internals;
+
+  MPIDataAdaptor(const MPIDataAdaptor&) = delete;
+  void operator=(const MPIDataAdaptor&) = delete;
+};
+
+}
+
+#endif
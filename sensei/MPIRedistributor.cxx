@@ -0,0 +1,400 @@
+#include "MPIRedistributor.h"
+#include "Profiler.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+namespace sensei
+{
+
+// received sections are aligned to this many bytes
+static const unsigned long long Alignment = 64;
+
+// --------------------------------------------------------------------------
+MPIRedistributor::MPIRedistributor() : Method(NEIGHBOR), Sender(false),
+  OwnIntercomm(false), Intercomm(MPI_COMM_NULL), Comm(MPI_COMM_NULL),
+  GraphComm(MPI_COMM_NULL), NumSenders(0), NumReceivers(0),
+  RecvBuf(nullptr), RecvBufSize(0)
+{
+}
+
+// --------------------------------------------------------------------------
+MPIRedistributor::~MPIRedistributor()
+{
+  this->Disconnect();
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::Accept(MPI_Comm comm, const std::string &portFile)
+{
+  TimeEvent<128> mark("MPIRedistributor::Accept");
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // rank 0 opens the port and publishes its name
+  char port[MPI_MAX_PORT_NAME] = {'\0'};
+  int ierr = 0;
+  if (rank == 0)
+    {
+    MPI_Open_port(MPI_INFO_NULL, port);
+
+    // write to a temporary and rename it so that the senders never
+    // see a partially written name
+    std::string tmpName = portFile + ".tmp";
+    FILE *fh = fopen(tmpName.c_str(), "w");
+    if (!fh || (fprintf(fh, "%s", port) < 0) || fclose(fh) ||
+      rename(tmpName.c_str(), portFile.c_str()))
+      {
+      SENSEI_ERROR("Failed to write the port file \"" << portFile << "\". "
+        << strerror(errno))
+      ierr = -1;
+      }
+    }
+
+  MPI_Bcast(&ierr, 1, MPI_INT, 0, comm);
+  if (ierr)
+    {
+    if (rank == 0)
+      MPI_Close_port(port);
+    return -1;
+    }
+
+  MPI_Comm intercomm = MPI_COMM_NULL;
+  MPI_Comm_accept(port, MPI_INFO_NULL, 0, comm, &intercomm);
+
+  if (rank == 0)
+    {
+    MPI_Close_port(port);
+    remove(portFile.c_str());
+    }
+
+  this->OwnIntercomm = true;
+
+  return this->Merge(intercomm, false);
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::Connect(MPI_Comm comm, const std::string &portFile,
+  double timeout)
+{
+  TimeEvent<128> mark("MPIRedistributor::Connect");
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // rank 0 waits for the receivers to publish the port name
+  char port[MPI_MAX_PORT_NAME] = {'\0'};
+  if (rank == 0)
+    {
+    double t0 = MPI_Wtime();
+    FILE *fh = nullptr;
+    while (!(fh = fopen(portFile.c_str(), "r")) &&
+      ((MPI_Wtime() - t0) < timeout))
+      usleep(100000);
+
+    if (fh)
+      {
+      if (!fgets(port, MPI_MAX_PORT_NAME, fh))
+        port[0] = '\0';
+      fclose(fh);
+      }
+
+    if (port[0] == '\0')
+      {
+      SENSEI_ERROR("Failed to read the port name from \"" << portFile
+        << "\" within " << timeout << " seconds")
+      }
+    }
+
+  MPI_Bcast(port, MPI_MAX_PORT_NAME, MPI_CHAR, 0, comm);
+  if (port[0] == '\0')
+    return -1;
+
+  MPI_Comm intercomm = MPI_COMM_NULL;
+  MPI_Comm_connect(port, MPI_INFO_NULL, 0, comm, &intercomm);
+
+  this->OwnIntercomm = true;
+
+  return this->Merge(intercomm, true);
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::SetIntercommunicator(MPI_Comm intercomm, bool sender)
+{
+  this->OwnIntercomm = false;
+  return this->Merge(intercomm, sender);
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::Merge(MPI_Comm intercomm, bool sender)
+{
+  int localSize = 0;
+  int remoteSize = 0;
+  MPI_Comm_size(intercomm, &localSize);
+  MPI_Comm_remote_size(intercomm, &remoteSize);
+
+  this->Intercomm = intercomm;
+  this->Sender = sender;
+  this->NumSenders = sender ? localSize : remoteSize;
+  this->NumReceivers = sender ? remoteSize : localSize;
+
+  // order the senders first
+  MPI_Intercomm_merge(intercomm, sender ? 0 : 1, &this->Comm);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void MPIRedistributor::FreePlan()
+{
+  if (this->GraphComm != MPI_COMM_NULL)
+    MPI_Comm_free(&this->GraphComm);
+
+  this->SenderOwner.clear();
+  this->ReceiverOwner.clear();
+  this->Peers.clear();
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::Disconnect()
+{
+  this->FreePlan();
+
+  free(this->RecvBuf);
+  this->RecvBuf = nullptr;
+  this->RecvBufSize = 0;
+
+  if (this->Comm != MPI_COMM_NULL)
+    MPI_Comm_free(&this->Comm);
+
+  if (this->OwnIntercomm && (this->Intercomm != MPI_COMM_NULL))
+    MPI_Comm_disconnect(&this->Intercomm);
+
+  this->Intercomm = MPI_COMM_NULL;
+  this->OwnIntercomm = false;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::Broadcast(BinaryStream &bs, bool fromSenders)
+{
+  TimeEvent<128> mark("MPIRedistributor::Broadcast");
+
+  if (bs.Broadcast(this->Comm, fromSenders ? 0 : this->NumSenders))
+    return -1;
+
+  bs.SetReadPos(0);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::SetPlan(const std::vector<int> &senderOwner,
+  const std::vector<int> &receiverOwner)
+{
+  TimeEvent<128> mark("MPIRedistributor::SetPlan");
+
+  // reuse the current plan
+  if ((this->GraphComm != MPI_COMM_NULL || this->Method == ALLTOALLV) &&
+    !this->SenderOwner.empty() && (senderOwner == this->SenderOwner) &&
+    (receiverOwner == this->ReceiverOwner))
+    return 0;
+
+  this->FreePlan();
+
+  size_t nBlocks = senderOwner.size();
+  if (receiverOwner.size() != nBlocks)
+    {
+    SENSEI_ERROR("The sender and receiver have " << nBlocks << " and "
+      << receiverOwner.size() << " blocks")
+    return -1;
+    }
+
+  int rank = 0;
+  MPI_Comm_rank(this->Comm, &rank);
+
+  // find the ranks this rank exchanges data with. receiver rank r is
+  // NumSenders + r in the merged communicator
+  for (size_t j = 0; j < nBlocks; ++j)
+    {
+    if (this->Sender && (senderOwner[j] == rank))
+      this->Peers.push_back(this->NumSenders + receiverOwner[j]);
+    else if (!this->Sender && (this->NumSenders + receiverOwner[j] == rank))
+      this->Peers.push_back(senderOwner[j]);
+    }
+
+  std::sort(this->Peers.begin(), this->Peers.end());
+  this->Peers.erase(std::unique(this->Peers.begin(), this->Peers.end()),
+    this->Peers.end());
+
+  // a directed graph from the senders to the receivers
+  if (this->Method == NEIGHBOR)
+    {
+    std::vector<int> none;
+    const std::vector<int> &sources = this->Sender ? none : this->Peers;
+    const std::vector<int> &dests = this->Sender ? this->Peers : none;
+
+    MPI_Dist_graph_create_adjacent(this->Comm,
+      sources.size(), sources.data(), MPI_UNWEIGHTED,
+      dests.size(), dests.data(), MPI_UNWEIGHTED,
+      MPI_INFO_NULL, 0, &this->GraphComm);
+    }
+
+  this->SenderOwner = senderOwner;
+  this->ReceiverOwner = receiverOwner;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int MPIRedistributor::Exchange(const unsigned char *sendBuf,
+  const std::vector<unsigned long long> &sendSizes,
+  std::vector<unsigned char*> &recvData,
+  std::vector<unsigned long long> &recvSizes)
+{
+  TimeEvent<128> mark("MPIRedistributor::Exchange");
+
+  if ((this->Method == NEIGHBOR) && (this->GraphComm == MPI_COMM_NULL))
+    {
+    SENSEI_ERROR("No plan has been set")
+    return -1;
+    }
+
+  int nPeers = this->Peers.size();
+  int nSend = this->Sender ? nPeers : 0;
+  int nRecv = this->Sender ? 0 : nPeers;
+
+  if (nSend != static_cast<int>(sendSizes.size()))
+    {
+    SENSEI_ERROR("A send size is required for each of the "
+      << nSend << " peers")
+    return -1;
+    }
+
+  // exchange the sizes
+  recvSizes.resize(nRecv);
+
+  if (this->Method == NEIGHBOR)
+    {
+    MPI_Neighbor_alltoall(sendSizes.data(), 1, MPI_UNSIGNED_LONG_LONG,
+      recvSizes.data(), 1, MPI_UNSIGNED_LONG_LONG, this->GraphComm);
+    }
+  else
+    {
+    int nRanks = 0;
+    MPI_Comm_size(this->Comm, &nRanks);
+
+    std::vector<unsigned long long> allSend(nRanks, 0);
+    std::vector<unsigned long long> allRecv(nRanks, 0);
+    for (int i = 0; i < nSend; ++i)
+      allSend[this->Peers[i]] = sendSizes[i];
+
+    MPI_Alltoall(allSend.data(), 1, MPI_UNSIGNED_LONG_LONG,
+      allRecv.data(), 1, MPI_UNSIGNED_LONG_LONG, this->Comm);
+
+    for (int i = 0; i < nRecv; ++i)
+      recvSizes[i] = allRecv[this->Peers[i]];
+    }
+
+  // lay out the sections, the received sections are aligned
+  std::vector<int> sendCounts(nSend);
+  std::vector<int> sendDispls(nSend);
+  unsigned long long offs = 0;
+  for (int i = 0; i < nSend; ++i)
+    {
+    sendCounts[i] = sendSizes[i];
+    sendDispls[i] = offs;
+    offs += sendSizes[i];
+    }
+
+  std::vector<int> recvCounts(nRecv);
+  std::vector<int> recvDispls(nRecv);
+  unsigned long long recvOffs = 0;
+  for (int i = 0; i < nRecv; ++i)
+    {
+    recvCounts[i] = recvSizes[i];
+    recvDispls[i] = recvOffs;
+    recvOffs += recvSizes[i] + (Alignment - recvSizes[i] % Alignment) % Alignment;
+    }
+
+  int ierr = 0;
+  if ((offs > INT_MAX) || (recvOffs > INT_MAX))
+    {
+    SENSEI_ERROR("The data exceeds the " << INT_MAX
+      << " bytes that can be moved per rank")
+    ierr = -1;
+    }
+
+  if (recvOffs > this->RecvBufSize)
+    {
+    free(this->RecvBuf);
+    this->RecvBuf = nullptr;
+    this->RecvBufSize = 0;
+
+    void *buf = nullptr;
+    if (posix_memalign(&buf, Alignment, recvOffs))
+      {
+      SENSEI_ERROR("Failed to allocate " << recvOffs << " bytes")
+      ierr = -1;
+      }
+    else
+      {
+      this->RecvBuf = static_cast<unsigned char*>(buf);
+      this->RecvBufSize = recvOffs;
+      }
+    }
+
+  // don't move anything if any rank failed
+  MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, this->Comm);
+  if (ierr)
+    return -1;
+
+  // move the data
+  if (this->Method == NEIGHBOR)
+    {
+    MPI_Neighbor_alltoallv(sendBuf, sendCounts.data(), sendDispls.data(),
+      MPI_BYTE, this->RecvBuf, recvCounts.data(), recvDispls.data(), MPI_BYTE,
+      this->GraphComm);
+    }
+  else
+    {
+    int nRanks = 0;
+    MPI_Comm_size(this->Comm, &nRanks);
+
+    std::vector<int> allSendCounts(nRanks, 0);
+    std::vector<int> allSendDispls(nRanks, 0);
+    for (int i = 0; i < nSend; ++i)
+      {
+      allSendCounts[this->Peers[i]] = sendCounts[i];
+      allSendDispls[this->Peers[i]] = sendDispls[i];
+      }
+
+    std::vector<int> allRecvCounts(nRanks, 0);
+    std::vector<int> allRecvDispls(nRanks, 0);
+    for (int i = 0; i < nRecv; ++i)
+      {
+      allRecvCounts[this->Peers[i]] = recvCounts[i];
+      allRecvDispls[this->Peers[i]] = recvDispls[i];
+      }
+
+    MPI_Alltoallv(sendBuf, allSendCounts.data(), allSendDispls.data(),
+      MPI_BYTE, this->RecvBuf, allRecvCounts.data(), allRecvDispls.data(),
+      MPI_BYTE, this->Comm);
+    }
+
+  recvData.resize(nRecv);
+  for (int i = 0; i < nRecv; ++i)
+    recvData[i] = this->RecvBuf + recvDispls[i];
+
+  return 0;
+}
+
+}
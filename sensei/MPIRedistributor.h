@@ -0,0 +1,116 @@
+#ifndef MPIRedistributor_h
+#define MPIRedistributor_h
+
+#include "BinaryStream.h"
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/// Moves blocks from a group of M sender ranks to a group of N receiver
+/// ranks using MPI directly, independent of any I/O library. The groups are
+/// joined either through MPI_Comm_connect/MPI_Comm_accept, with the port
+/// name passed through a file, or through an existing intercommunicator.
+/// The two groups are merged into a single communicator in which the senders
+/// come first.
+///
+/// A plan is computed from the sender's and receiver's BlockOwner arrays. It
+/// records for each rank the ranks it exchanges data with. Since the layout
+/// rarely changes, the plan, and the MPI resources it needs, are reused until
+/// either BlockOwner array changes. Data is then moved with neighborhood
+/// collectives over a distributed graph holding only the ranks that
+/// communicate, or optionally with MPI_Alltoallv over the merged
+/// communicator.
+class MPIRedistributor
+{
+public:
+  MPIRedistributor();
+  ~MPIRedistributor();
+
+  /// methods used to move the data
+  enum { NEIGHBOR = 0, ALLTOALLV = 1 };
+
+  /// select the method used to move the data. the default is NEIGHBOR.
+  void SetMethod(int method) { this->Method = method; }
+  int GetMethod() const { return this->Method; }
+
+  /// called by the receivers to open a port and wait for the senders to
+  /// connect. the port name is written to the named file.
+  int Accept(MPI_Comm comm, const std::string &portFile);
+
+  /// called by the senders to connect to the receivers. waits up to timeout
+  /// seconds for the receivers to write the port file.
+  int Connect(MPI_Comm comm, const std::string &portFile, double timeout);
+
+  /// use an existing intercommunicator joining the two groups, such as
+  /// one made by MPI_Intercomm_create in an MPMD launch.
+  int SetIntercommunicator(MPI_Comm intercomm, bool sender);
+
+  /// release all MPI resources and disconnect from the other group
+  int Disconnect();
+
+  /// returns true once the groups are joined
+  bool Connected() const { return this->Comm != MPI_COMM_NULL; }
+
+  /// the merged communicator, the senders come first
+  MPI_Comm GetCommunicator() const { return this->Comm; }
+
+  bool IsSender() const { return this->Sender; }
+  int GetNumberOfSenders() const { return this->NumSenders; }
+  int GetNumberOfReceivers() const { return this->NumReceivers; }
+
+  /// broadcast a stream to all ranks of both groups from rank 0 of either
+  /// the senders or the receivers
+  int Broadcast(BinaryStream &bs, bool fromSenders);
+
+  /// compute the plan from the BlockOwner arrays of the sender and receiver.
+  /// element j of each array gives the sender and receiver rank of block j.
+  /// When more than one mesh is moved the arrays are concatenated. The
+  /// current plan is kept if the arrays have not changed.
+  int SetPlan(const std::vector<int> &senderOwner,
+    const std::vector<int> &receiverOwner);
+
+  /// the merged ranks this rank exchanges data with under the current plan,
+  /// in ascending order. senders send to the receivers listed here and
+  /// receivers receive from the senders listed here. merged rank i of a
+  /// receiver is GetNumberOfSenders() + i.
+  const std::vector<int> &GetPeers() const { return this->Peers; }
+
+  /// move the data. senders pass a buffer holding a section for each peer,
+  /// in the order of GetPeers, and the size of each section. receivers get a
+  /// pointer to and the size of the section sent by each peer. received
+  /// sections are 64 byte aligned and valid until the next exchange.
+  int Exchange(const unsigned char *sendBuf,
+    const std::vector<unsigned long long> &sendSizes,
+    std::vector<unsigned char*> &recvData,
+    std::vector<unsigned long long> &recvSizes);
+
+private:
+  int Merge(MPI_Comm intercomm, bool sender);
+  void FreePlan();
+
+  MPIRedistributor(const MPIRedistributor&) = delete;
+  void operator=(const MPIRedistributor&) = delete;
+
+private:
+  int Method;
+  bool Sender;
+  bool OwnIntercomm;
+  MPI_Comm Intercomm;
+  MPI_Comm Comm;
+  MPI_Comm GraphComm;
+  int NumSenders;
+  int NumReceivers;
+  std::vector<int> SenderOwner;
+  std::vector<int> ReceiverOwner;
+  std::vector<int> Peers;
+  unsigned char *RecvBuf;
+  unsigned long long RecvBufSize;
+};
+
+}
+
+#endif
@@ -52,6 +52,9 @@
 #include <iomanip>
 #include <limits>
 #include <cstdio>
+#include <atomic>
+#include <algorithm>
+#include <memory>
 
 
 // *****************************************************************************
@@ -191,15 +194,39 @@ int GetFieldsFromCommand(const char* command, const char** field_names,
 namespace sensei
 {
 
+// a high resolution sample. only the memory value is accessed while the
+// sampling thread is running.
+struct MemorySample
+{
+  MemorySample() : Time(0.0), Mem(-1), Tag(nullptr) {}
+
+  double Time;
+  std::atomic<long long> Mem;
+  const char *Tag;
+};
+
 // intrernal data used by the memory profiler
 struct MemoryProfiler::InternalsType
 {
   InternalsType() : Comm(MPI_COMM_WORLD), Filename("mem_prof.csv"),
     Interval(60.0), DataMutex(PTHREAD_MUTEX_INITIALIZER),
+    WakeCond(PTHREAD_COND_INITIALIZER),
     TotalVirtualMemory(0), AvailableVirtualMemory(0),
-    TotalPhysicalMemory(0), AvailablePhysicalMemory(0)
+    TotalPhysicalMemory(0), AvailablePhysicalMemory(0),
+    HighRes(0), StatmFd(-1), PageSizeKiB(4), RingSize(65536),
+    NextSample(0), Tag(nullptr)
       {}
 
+  // high resolution sampling. read the resident set size from the
+  // preopened statm file and store it in the ring buffer
+  int OpenStatm();
+  void CloseStatm();
+  long long ReadStatm();
+  void TakeSample();
+
+  // tell the sampling thread to quit, waking it if it's sleeping
+  void Stop();
+
   // initialize member vars with data about ram available on this system
   int InitializeMemory();
   int InitializeAppleMemory();
@@ -243,15 +270,23 @@ struct MemoryProfiler::InternalsType
 
   MPI_Comm Comm;
   std::string Filename;
-  double Interval;
+  std::atomic<double> Interval;
   std::deque<long long> MemUse;
   std::deque<double> TimePt;
   pthread_t Thread;
   pthread_mutex_t DataMutex;
+  pthread_cond_t WakeCond;
   long long TotalVirtualMemory;
   long long AvailableVirtualMemory;
   long long TotalPhysicalMemory;
   long long AvailablePhysicalMemory;
+  int HighRes;
+  int StatmFd;
+  long long PageSizeKiB;
+  long RingSize;
+  std::unique_ptr<MemorySample[]> Ring;
+  std::atomic<unsigned long long> NextSample;
+  std::atomic<const char*> Tag;
 };
 
 // --------------------------------------------------------------------------
@@ -269,6 +304,22 @@ MemoryProfiler::~MemoryProfiler()
 // --------------------------------------------------------------------------
 int MemoryProfiler::Initialize()
 {
+  if (this->Internals->HighRes)
+    {
+    if (this->Internals->OpenStatm())
+      {
+      SENSEI_WARNING("High resolution memory profiling is not available,"
+        " falling back to the default sampler")
+      this->Internals->HighRes = 0;
+      }
+    else
+      {
+      this->Internals->Ring.reset(
+        new MemorySample[this->Internals->RingSize]);
+      this->Internals->NextSample = 0;
+      }
+    }
+
   if (pthread_create(&this->Internals->Thread,
     nullptr, profile, this->Internals))
     {
@@ -296,35 +347,59 @@ int MemoryProfiler::Finalize()
     MPI_Comm_size(this->Internals->Comm, &n_ranks);
     }
 
-  pthread_mutex_lock(&this->Internals->DataMutex);
-
-  // tell the thread to quit
-  this->Internals->Interval = -1;
-
   // create the ascii buffer
   // use ascii in the file as a convenince
   std::ostringstream oss;
   oss.precision(std::numeric_limits<double>::digits10 + 2);
   oss.setf(std::ios::scientific, std::ios::floatfield);
 
-  if (rank == 0)
-    oss << "# rank, time, memory kiB" << std::endl;
-
-  long n_elem = this->Internals->MemUse.size();
-  for (long i = 0; i < n_elem; ++i)
+  if (this->Internals->HighRes)
     {
-    oss << rank << ", " << this->Internals->TimePt[i]
-      << ", " << this->Internals->MemUse[i] << std::endl;
+    // tell the thread to quit, and wait for it
+    this->Internals->Stop();
+    pthread_join(this->Internals->Thread, nullptr);
+
+    if (rank == 0)
+      oss << "# rank, time, memory kiB, event" << std::endl;
+
+    // the ring buffer holds the most recent samples
+    unsigned long long n_samples = this->Internals->NextSample;
+    unsigned long long ring_size = this->Internals->RingSize;
+    unsigned long long first = n_samples > ring_size ? n_samples - ring_size : 0;
+    for (unsigned long long i = first; i < n_samples; ++i)
+      {
+      const MemorySample &sample = this->Internals->Ring[i % ring_size];
+      oss << rank << ", " << sample.Time << ", " << sample.Mem
+        << ", \"" << (sample.Tag ? sample.Tag : "") << "\"" << std::endl;
+      }
+
+    // free resources
+    this->Internals->Ring.reset();
+    this->Internals->CloseStatm();
     }
+  else
+    {
+    // tell the thread to quit
+    this->Internals->Stop();
 
-  // free resources
-  this->Internals->TimePt.clear();
-  this->Internals->MemUse.clear();
+    pthread_mutex_lock(&this->Internals->DataMutex);
 
-  pthread_mutex_unlock(&this->Internals->DataMutex);
+    if (rank == 0)
+      oss << "# rank, time, memory kiB" << std::endl;
 
-  // cancle the profiler thread
-  pthread_cancel(this->Internals->Thread);
+    long n_elem = this->Internals->MemUse.size();
+    for (long i = 0; i < n_elem; ++i)
+      {
+      oss << rank << ", " << this->Internals->TimePt[i]
+        << ", " << this->Internals->MemUse[i] << std::endl;
+      }
+
+    // free resources
+    this->Internals->TimePt.clear();
+    this->Internals->MemUse.clear();
+
+    pthread_mutex_unlock(&this->Internals->DataMutex);
+    }
 
   // compute the file offset
   long n_bytes = oss.str().size();
@@ -383,7 +458,8 @@ int MemoryProfiler::Finalize()
     }
 
   // wait for the proiler thread to finish
-  pthread_join(this->Internals->Thread, nullptr);
+  if (!this->Internals->HighRes)
+    pthread_join(this->Internals->Thread, nullptr);
 
   return 0;
 }
@@ -399,9 +475,73 @@ void MemoryProfiler::SetInterval(double interval)
 {
   pthread_mutex_lock(&this->Internals->DataMutex);
   this->Internals->Interval = interval;
+  pthread_cond_signal(&this->Internals->WakeCond);
   pthread_mutex_unlock(&this->Internals->DataMutex);
 }
 
+// --------------------------------------------------------------------------
+void MemoryProfiler::SetHighResolution(int val)
+{
+  this->Internals->HighRes = val;
+}
+
+// --------------------------------------------------------------------------
+int MemoryProfiler::GetHighResolution() const
+{
+  return this->Internals->HighRes;
+}
+
+// --------------------------------------------------------------------------
+void MemoryProfiler::SetRingBufferSize(long n)
+{
+  this->Internals->RingSize = n < 1 ? 1 : n;
+}
+
+// --------------------------------------------------------------------------
+void MemoryProfiler::SetTag(const char *tag)
+{
+  this->Internals->Tag.store(tag, std::memory_order_release);
+}
+
+// --------------------------------------------------------------------------
+long long MemoryProfiler::GetCurrentMemory()
+{
+  if (this->Internals->StatmFd >= 0)
+    return this->Internals->ReadStatm();
+
+  return this->Internals->GetProcMemoryUsed();
+}
+
+// --------------------------------------------------------------------------
+unsigned long long MemoryProfiler::GetSampleIndex() const
+{
+  return this->Internals->NextSample.load(std::memory_order_acquire);
+}
+
+// --------------------------------------------------------------------------
+long long MemoryProfiler::GetPeakMemory(unsigned long long first)
+{
+  long long peak = this->GetCurrentMemory();
+
+  if (!this->Internals->Ring)
+    return peak;
+
+  // samples older than the ring buffer have been overwritten
+  unsigned long long last = this->GetSampleIndex();
+  unsigned long long ring_size = this->Internals->RingSize;
+  if (last > ring_size)
+    first = std::max(first, last - ring_size);
+
+  for (unsigned long long i = first; i < last; ++i)
+    {
+    long long mem = this->Internals->Ring[i % ring_size].Mem.load(
+      std::memory_order_relaxed);
+    peak = std::max(peak, mem);
+    }
+
+  return peak;
+}
+
 // --------------------------------------------------------------------------
 void MemoryProfiler::SetCommunicator(MPI_Comm comm)
 {
@@ -437,6 +577,77 @@ std::string system_information::get_memory_description(
 }
 */
 
+// --------------------------------------------------------------------------
+int MemoryProfiler::InternalsType::OpenStatm()
+{
+#if defined(__linux)
+  this->StatmFd = open("/proc/self/statm", O_RDONLY);
+  if (this->StatmFd < 0)
+    return -1;
+
+  this->PageSizeKiB = sysconf(_SC_PAGESIZE) / 1024;
+
+  return this->ReadStatm() < 0 ? -1 : 0;
+#else
+  return -1;
+#endif
+}
+
+// --------------------------------------------------------------------------
+void MemoryProfiler::InternalsType::CloseStatm()
+{
+#if defined(__linux)
+  if (this->StatmFd >= 0)
+    close(this->StatmFd);
+#endif
+  this->StatmFd = -1;
+}
+
+// --------------------------------------------------------------------------
+long long MemoryProfiler::InternalsType::ReadStatm()
+{
+#if defined(__linux)
+  // statm holds page counts: size resident shared text lib data dt
+  char buf[256];
+  ssize_t n_read = pread(this->StatmFd, buf, sizeof(buf) - 1, 0);
+  if (n_read <= 0)
+    return -1;
+  buf[n_read] = '\0';
+
+  char *end = nullptr;
+  strtoll(buf, &end, 10);
+  long long resident = strtoll(end, nullptr, 10);
+
+  return resident*this->PageSizeKiB;
+#else
+  return -1;
+#endif
+}
+
+// --------------------------------------------------------------------------
+void MemoryProfiler::InternalsType::Stop()
+{
+  pthread_mutex_lock(&this->DataMutex);
+  this->Interval = -1;
+  pthread_cond_signal(&this->WakeCond);
+  pthread_mutex_unlock(&this->DataMutex);
+}
+
+// --------------------------------------------------------------------------
+void MemoryProfiler::InternalsType::TakeSample()
+{
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+
+  // there's a single writer, publish the sample after it's complete
+  unsigned long long i = this->NextSample.load(std::memory_order_relaxed);
+  MemorySample &sample = this->Ring[i % this->RingSize];
+  sample.Time = tv.tv_sec + tv.tv_usec/1.0e6;
+  sample.Mem.store(this->ReadStatm(), std::memory_order_relaxed);
+  sample.Tag = this->Tag.load(std::memory_order_acquire);
+  this->NextSample.store(i + 1, std::memory_order_release);
+}
+
 // --------------------------------------------------------------------------
 int MemoryProfiler::InternalsType::InitializeMemory()
 {
@@ -929,42 +1140,65 @@ extern "C" void *profile(void *argp)
 
   while (1)
     {
-    // capture the current time and memory usage.
-    struct timeval tv;
-    gettimeofday(&tv, nullptr);
+    if (internals->HighRes)
+      {
+      // lock free sampling into the ring buffer
+      internals->TakeSample();
+      }
+    else
+      {
+      // capture the current time and memory usage.
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
 
-    double cur_time = tv.tv_sec + tv.tv_usec/1.0e6;
-    long long cur_mem = internals->GetProcMemoryUsed();
+      double cur_time = tv.tv_sec + tv.tv_usec/1.0e6;
+      long long cur_mem = internals->GetProcMemoryUsed();
 
-    pthread_mutex_lock(&internals->DataMutex);
+      pthread_mutex_lock(&internals->DataMutex);
+
+      // log time and mem use
+      internals->TimePt.push_back(cur_time);
+      internals->MemUse.push_back(cur_mem);
+
+      pthread_mutex_unlock(&internals->DataMutex);
+      }
 
-    // log time and mem use
-    internals->TimePt.push_back(cur_time);
-    internals->MemUse.push_back(cur_mem);
+    pthread_mutex_lock(&internals->DataMutex);
 
     // get next interval
     double interval = internals->Interval;
 
+    // suspend the thread for the requested interval. Finalize signals
+    // the condition so that shut down doesn't wait out the interval
+    if (interval >= 0)
+      {
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
+
+      double wake = tv.tv_sec + tv.tv_usec/1.0e6 + interval;
+      long long secs = floor(wake);
+      long nsecs = (wake - secs)*1e9;
+      struct timespec wake_time = {secs, std::min(nsecs, 999999999l)};
+
+      int ierr = 0;
+      while (((interval = internals->Interval) >= 0) &&
+        !(ierr = pthread_cond_timedwait(&internals->WakeCond,
+          &internals->DataMutex, &wake_time)));
+
+      if (ierr && (ierr != ETIMEDOUT))
+        {
+        const char *estr = strerror(ierr);
+        SENSEI_ERROR("Error: pthread_cond_timedwait had an error \""
+          << estr << "\"")
+        abort();
+        }
+      }
+
     pthread_mutex_unlock(&internals->DataMutex);
 
     // check for shut down code
     if (interval < 0)
       pthread_exit(nullptr);
-
-    // suspend the thread for the requested interval
-    long long secs = floor(interval);
-    long nsecs = (interval - secs)*1e9;
-    struct timespec sleep_time = {secs, nsecs};
-
-    int ierr = 0;
-    int tries = 0;
-    while ((ierr = nanosleep(&sleep_time, &sleep_time)) && (errno == EINTR) && (++tries < 1000));
-    if (ierr)
-      {
-      const char *estr = strerror(errno);
-      SENSEI_ERROR("Error: nanosleep had an error \"" << estr << "\"")
-      abort();
-      }
     }
 
   return nullptr;
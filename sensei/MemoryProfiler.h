@@ -17,6 +17,13 @@ given in seconds. For each sample the time is aquired. Calling
 Initialize starts profiling, and Finalize ends it. During
 Finaliziation the buffers are written using MPI-I/O to the
 file name provided
+
+In high resolution mode the resident set size is read from a preopened
+/proc/self/statm with pread, no parsing or allocation takes place, and
+samples are stored without locking in a fixed size ring buffer, so that
+millisecond intervals are practical. Each sample is tagged with the name
+passed to SetTag, which the Profiler uses to record the innermost active
+event. Only the most recent RingBufferSize samples are kept.
 */
 class MemoryProfiler
 {
@@ -36,6 +43,30 @@ public:
   void SetInterval(double interval);
   double GetInterval() const;
 
+  // Enable high resolution mode. This must be called prior to Initialize.
+  void SetHighResolution(int val);
+  int GetHighResolution() const;
+
+  // Set the number of samples kept in high resolution mode. This must be
+  // called prior to Initialize. default value: 65536
+  void SetRingBufferSize(long n);
+
+  // Tag subsequent samples with the given name. The string must remain
+  // valid until Finalize. Only used in high resolution mode.
+  void SetTag(const char *tag);
+
+  // Get the process's current resident set size in KiB
+  long long GetCurrentMemory();
+
+  // Get the index of the next sample to be taken. Only used in high
+  // resolution mode.
+  unsigned long long GetSampleIndex() const;
+
+  // Get the peak resident set size in KiB over the samples from index
+  // first up to now that are still in the ring buffer, and the current
+  // value. Only used in high resolution mode.
+  long long GetPeakMemory(unsigned long long first);
+
   // Set the comunicator for parallel I/O
   void SetCommunicator(MPI_Comm comm);
 
@@ -0,0 +1,917 @@
+#include "senseiConfig.h"
+#include "ParticleDeposition.h"
+#include "DataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "VTKDataAdaptor.h"
+#include "VTKUtils.h"
+#include "Profiler.h"
+#include "Error.h"
+#if defined(ENABLE_VTK_IO)
+#include "VTKPosthocIO.h"
+#endif
+
+#include <vtkCellData.h>
+#include <vtkCompositeDataIterator.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataArray.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPointSet.h>
+#include <vtkPoints.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <sdiy/thread-pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace sensei
+{
+
+namespace
+{
+// the number of particles, or grid values, handled by a task
+const long ChunkSize = 8192;
+
+// the geometry of the grid
+struct Grid
+{
+  std::array<double,6> Bounds;
+  std::array<double,3> Spacing;
+  std::array<long,3> Dims;
+  long NumCells;
+};
+
+// the cells and weights the particles of a chunk deposit to. NGP touches 1
+// cell and CIC 8 cells per particle. particles outside of the grid and
+// ghost particles are given a weight of 0
+struct Stencil
+{
+  std::vector<long> Cell;
+  std::vector<double> Weight;
+};
+
+// the local particles of a block
+struct ParticleBlock
+{
+  long NumParticles;
+  vtkDataArray *Coords;
+  std::vector<vtkDataArray*> Arrays;
+  const unsigned char *Ghosts;
+};
+
+// a range of particles of one block
+struct Task
+{
+  int Block;
+  long P0;
+  long P1;
+};
+
+// accumulate the bounding box of the particles
+template <typename n_t>
+void GetBounds(const n_t *x, long n, std::array<double,6> &bounds)
+{
+  for (long p = 0; p < n; ++p)
+    {
+    const n_t *xp = x + 3*p;
+    for (int q = 0; q < 3; ++q)
+      {
+      double v = static_cast<double>(xp[q]);
+      bounds[2*q] = std::min(bounds[2*q], v);
+      bounds[2*q+1] = std::max(bounds[2*q+1], v);
+      }
+    }
+}
+
+// compute the cells and weights of particles [p0, p1)
+template <typename n_t>
+void GetStencil(const Grid &g, int method, const n_t *x,
+  const unsigned char *ghost, long p0, long p1, Stencil &st)
+{
+  int nw = method == ParticleDeposition::METHOD_CIC ? 8 : 1;
+  long n = p1 - p0;
+
+  st.Cell.resize(nw*n);
+  st.Weight.resize(nw*n);
+
+  for (long p = 0; p < n; ++p)
+    {
+    const n_t *xp = x + 3*(p0 + p);
+    long *cell = st.Cell.data() + nw*p;
+    double *wt = st.Weight.data() + nw*p;
+
+    double u[3];
+    bool inside = !(ghost && ghost[p0 + p]);
+    for (int q = 0; q < 3; ++q)
+      {
+      double v = static_cast<double>(xp[q]);
+      inside = inside && (v >= g.Bounds[2*q]) && (v <= g.Bounds[2*q+1]);
+      u[q] = (v - g.Bounds[2*q])/g.Spacing[q];
+      }
+
+    if (!inside)
+      {
+      for (int c = 0; c < nw; ++c)
+        {
+        cell[c] = 0;
+        wt[c] = 0.0;
+        }
+      continue;
+      }
+
+    if (nw == 1)
+      {
+      // the cell containing the particle, the upper boundary belongs to
+      // the last cell
+      long i[3];
+      for (int q = 0; q < 3; ++q)
+        i[q] = std::min(static_cast<long>(u[q]), g.Dims[q] - 1);
+
+      cell[0] = (i[2]*g.Dims[1] + i[1])*g.Dims[0] + i[0];
+      wt[0] = 1.0;
+      continue;
+      }
+
+    // the 8 cells whose centers surround the particle. at the boundary the
+    // weight that falls outside of the grid is given to the edge cell so
+    // that the total is conserved
+    long i0[3];
+    long i1[3];
+    double f[3];
+    for (int q = 0; q < 3; ++q)
+      {
+      double s = u[q] - 0.5;
+      double fs = std::floor(s);
+      long i = static_cast<long>(fs);
+      f[q] = s - fs;
+      i0[q] = std::max(i, 0l);
+      i1[q] = std::min(i + 1, g.Dims[q] - 1);
+      }
+
+    for (int c = 0; c < 8; ++c)
+      {
+      int a = c & 1;
+      int b = (c >> 1) & 1;
+      int d = (c >> 2) & 1;
+
+      cell[c] = ((d ? i1[2] : i0[2])*g.Dims[1] +
+        (b ? i1[1] : i0[1]))*g.Dims[0] + (a ? i1[0] : i0[0]);
+
+      wt[c] = (a ? f[0] : 1.0 - f[0])*(b ? f[1] : 1.0 - f[1])*
+        (d ? f[2] : 1.0 - f[2]);
+      }
+    }
+}
+
+// deposit the weights, the first value of each cell
+void DepositWeight(const Stencil &st, long nVals, double *grid)
+{
+  long n = st.Cell.size();
+  for (long i = 0; i < n; ++i)
+    grid[st.Cell[i]*nVals] += st.Weight[i];
+}
+
+// deposit the weighted values of an array for particles [p0, p1) starting
+// at value off of each cell
+template <typename n_t>
+void DepositArray(const Stencil &st, int nw, const n_t *a, int nComps,
+  long p0, long nVals, long off, double *grid)
+{
+  long n = st.Cell.size();
+  for (long i = 0; i < n; ++i)
+    {
+    // skip particles that were not deposited, their values may be garbage
+    double w = st.Weight[i];
+    if (w == 0.0)
+      continue;
+
+    const n_t *ap = a + (p0 + i/nw)*nComps;
+    double *gp = grid + st.Cell[i]*nVals + off;
+    for (int c = 0; c < nComps; ++c)
+      gp[c] += w*static_cast<double>(ap[c]);
+    }
+}
+
+// get an array with the standard memory layout, copying it if needed
+vtkDataArray *GetContiguous(vtkDataArray *da,
+  std::vector<vtkSmartPointer<vtkDataArray>> &copies)
+{
+  if (da->HasStandardMemoryLayout())
+    return da;
+
+  vtkDoubleArray *cp = vtkDoubleArray::New();
+  cp->DeepCopy(da);
+
+  copies.push_back(vtkSmartPointer<vtkDataArray>());
+  copies.back().TakeReference(cp);
+
+  return cp;
+}
+}
+
+struct ParticleDeposition::InternalsType
+{
+  InternalsType() : WriterEnabled(0), PoolThreads(0)
+  {
+#if defined(ENABLE_VTK_IO)
+    this->Writer = VTKPosthocIOPtr::New();
+#endif
+  }
+
+  // deposit the particles of a task onto a grid
+  int Deposit(const Grid &g, int method, const std::vector<ParticleBlock> &blocks,
+    const std::vector<long> &offsets, long nVals, const Task &task,
+    Stencil &st, double *grid);
+
+  // get the thread pool, it is created on first use and when the number of
+  // threads changes
+  sdiy::ThreadPool &GetThreadPool(int nThreads);
+
+  int WriterEnabled;
+#if defined(ENABLE_VTK_IO)
+  VTKPosthocIOPtr Writer;
+#endif
+
+  // the slab of the most recent result owned by this rank, per mesh
+  std::map<std::string, vtkSmartPointer<vtkImageData>> Output;
+
+  // worker threads used by the deposition, kept across steps
+  std::unique_ptr<sdiy::ThreadPool> Pool;
+  int PoolThreads;
+};
+
+// --------------------------------------------------------------------------
+sdiy::ThreadPool &ParticleDeposition::InternalsType::GetThreadPool(int nThreads)
+{
+  // compare against the requested count, the pool reports a size of 1 when
+  // threading is disabled
+  if (!this->Pool || (this->PoolThreads != nThreads))
+    {
+    this->Pool.reset();
+    this->Pool.reset(new sdiy::ThreadPool(nThreads));
+    this->PoolThreads = nThreads;
+    }
+  return *this->Pool;
+}
+
+// --------------------------------------------------------------------------
+int ParticleDeposition::InternalsType::Deposit(const Grid &g, int method,
+  const std::vector<ParticleBlock> &blocks, const std::vector<long> &offsets,
+  long nVals, const Task &task, Stencil &st, double *grid)
+{
+  const ParticleBlock &blk = blocks[task.Block];
+
+  vtkDataArray *coords = blk.Coords;
+  switch (coords->GetDataType())
+    {
+    vtkTemplateMacro(
+      GetStencil(g, method, static_cast<const VTK_TT*>(coords->GetVoidPointer(0)),
+        blk.Ghosts, task.P0, task.P1, st);
+      );
+    default:
+      SENSEI_ERROR("Invalid coordinate array type " << coords->GetClassName())
+      return -1;
+    }
+
+  DepositWeight(st, nVals, grid);
+
+  int nw = method == ParticleDeposition::METHOD_CIC ? 8 : 1;
+  unsigned int nArrays = blk.Arrays.size();
+  for (unsigned int j = 0; j < nArrays; ++j)
+    {
+    vtkDataArray *da = blk.Arrays[j];
+    switch (da->GetDataType())
+      {
+      vtkTemplateMacro(
+        DepositArray(st, nw, static_cast<const VTK_TT*>(da->GetVoidPointer(0)),
+          da->GetNumberOfComponents(), task.P0, nVals, offsets[j], grid);
+        );
+      default:
+        SENSEI_ERROR("Invalid data array type " << da->GetClassName())
+        return -1;
+      }
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+senseiNewMacro(ParticleDeposition);
+
+//-----------------------------------------------------------------------------
+ParticleDeposition::ParticleDeposition() : Method(METHOD_CIC),
+  NumberOfThreads(1), BoundsSet(0), Bounds{0.,1.,0.,1.,0.,1.},
+  Resolution{64,64,64}, Internals(new InternalsType)
+{
+}
+
+//-----------------------------------------------------------------------------
+ParticleDeposition::~ParticleDeposition()
+{
+  delete this->Internals;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetMethod(int method)
+{
+  if ((method != METHOD_NGP) && (method != METHOD_CIC))
+    {
+    SENSEI_ERROR("Invalid deposition method " << method)
+    return -1;
+    }
+
+  this->Method = method;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetMethod(const std::string &method)
+{
+  if (method == "ngp")
+    return this->SetMethod(METHOD_NGP);
+  else if (method == "cic")
+    return this->SetMethod(METHOD_CIC);
+
+  SENSEI_ERROR("Invalid deposition method \"" << method
+    << "\". Valid methods are \"ngp\" and \"cic\"")
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetBounds(const std::array<double,6> &bounds)
+{
+  for (int q = 0; q < 3; ++q)
+    {
+    if (bounds[2*q+1] < bounds[2*q])
+      {
+      SENSEI_ERROR("Invalid bounds [" << bounds[0] << ", " << bounds[1]
+        << ", " << bounds[2] << ", " << bounds[3] << ", " << bounds[4]
+        << ", " << bounds[5] << "]")
+      return -1;
+      }
+    }
+
+  this->Bounds = bounds;
+  this->BoundsSet = 1;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetResolution(const std::array<int,3> &res)
+{
+  if ((res[0] < 1) || (res[1] < 1) || (res[2] < 1))
+    {
+    SENSEI_ERROR("Invalid resolution " << res[0] << ", " << res[1]
+      << ", " << res[2])
+    return -1;
+    }
+
+  this->Resolution = res;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetWriterOutputDir(const std::string &outputDir)
+{
+#if defined(ENABLE_VTK_IO)
+  this->Internals->WriterEnabled = 1;
+  return this->Internals->Writer->SetOutputDir(outputDir);
+#else
+  (void)outputDir;
+  SENSEI_ERROR("Writing the grid requires VTK IO, which is disabled in this build")
+  return -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetWriterMode(const std::string &mode)
+{
+#if defined(ENABLE_VTK_IO)
+  return this->Internals->Writer->SetMode(mode);
+#else
+  (void)mode;
+  SENSEI_ERROR("Writing the grid requires VTK IO, which is disabled in this build")
+  return -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::SetWriterWriter(const std::string &writer)
+{
+#if defined(ENABLE_VTK_IO)
+  return this->Internals->Writer->SetWriter(writer);
+#else
+  (void)writer;
+  SENSEI_ERROR("Writing the grid requires VTK IO, which is disabled in this build")
+  return -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+vtkImageData *ParticleDeposition::GetOutput(const std::string &meshName)
+{
+  std::map<std::string, vtkSmartPointer<vtkImageData>>::iterator it =
+    this->Internals->Output.find(meshName);
+
+  if (it == this->Internals->Output.end())
+    return nullptr;
+
+  return it->second.GetPointer();
+}
+
+//-----------------------------------------------------------------------------
+bool ParticleDeposition::Execute(DataAdaptor* data)
+{
+  TimeEvent<128> mark("ParticleDeposition::Execute");
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  // see what the simulation is providing
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(data))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  long step = data->GetDataTimeStep();
+  double time = data->GetDataTime();
+
+  int nThreads = std::max(1, this->NumberOfThreads);
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  for (; mit; ++mit)
+    {
+    const std::string &meshName = mit.MeshName();
+
+    MeshMetadataPtr mmd;
+    if (mdMap.GetMeshMetadata(meshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    // the arrays are processed in the same order on all ranks
+    std::vector<std::string> arrays;
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(meshName);
+    for (; ait; ++ait)
+      {
+      if (ait.Association() != vtkDataObject::POINT)
+        {
+        SENSEI_ERROR("Can't deposit " << VTKUtils::GetAttributesName(
+          ait.Association()) << " data array \"" << ait.Array()
+          << "\". Only point data arrays can be deposited")
+        return false;
+        }
+      arrays.push_back(ait.Array());
+      }
+
+    unsigned int nArrays = arrays.size();
+
+    // a failure on this rank is recorded and the rank goes on without its
+    // particles. it's reported after the reductions below so that the
+    // other ranks are not left waiting
+    int ierr = 0;
+
+    // get the mesh and the arrays
+    vtkDataObject *mesh = nullptr;
+    if (data->GetMesh(meshName, false, mesh))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      mesh = nullptr;
+      ierr = -1;
+      }
+
+    if (mesh && mmd->NumGhostNodes && data->AddGhostNodesArray(mesh, meshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
+      ierr = -1;
+      }
+
+    for (unsigned int j = 0; mesh && !ierr && (j < nArrays); ++j)
+      {
+      if (data->AddArray(mesh, meshName, vtkDataObject::POINT, arrays[j]))
+        {
+        SENSEI_ERROR(<< data->GetClassName() << " failed to add point data"
+          " array \"" << arrays[j] << "\"")
+        ierr = -1;
+        }
+      }
+
+    // collect the local blocks
+    std::vector<vtkDataObject*> dobjs;
+    if (vtkCompositeDataSet *cd = dynamic_cast<vtkCompositeDataSet*>(mesh))
+      {
+      vtkSmartPointer<vtkCompositeDataIterator> iter;
+      iter.TakeReference(cd->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+        dobjs.push_back(iter->GetCurrentDataObject());
+      }
+    else if (mesh)
+      {
+      dobjs.push_back(mesh);
+      }
+
+    for (unsigned int i = 0; !ierr && (i < dobjs.size()); ++i)
+      {
+      if (!dynamic_cast<vtkPointSet*>(dobjs[i]))
+        {
+        SENSEI_ERROR("Can't deposit a " << dobjs[i]->GetClassName()
+          << ". A vtkPointSet is required")
+        ierr = -1;
+        }
+      }
+
+    if (ierr)
+      dobjs.clear();
+
+    // the number of components of each array. ranks without particles
+    // get them from the others so that all agree on the layout of the grid
+    std::vector<int> nComps(nArrays, 0);
+    unsigned int nDobjs = dobjs.size();
+    for (unsigned int i = 0; i < nDobjs; ++i)
+      {
+      vtkPointSet *ps = static_cast<vtkPointSet*>(dobjs[i]);
+      vtkPointData *pd = ps->GetPointData();
+      for (unsigned int j = 0; j < nArrays; ++j)
+        {
+        vtkDataArray *da = pd->GetArray(arrays[j].c_str());
+        if (da)
+          nComps[j] = std::max(nComps[j], da->GetNumberOfComponents());
+        }
+      }
+
+    if (nArrays)
+      MPI_Allreduce(MPI_IN_PLACE, nComps.data(), nArrays, MPI_INT,
+        MPI_MAX, comm);
+
+    // the values of a cell are stored contiguously, the weight followed by
+    // the weighted sum of each array
+    std::vector<long> offsets(nArrays);
+    long nVals = 1;
+    for (unsigned int j = 0; j < nArrays; ++j)
+      {
+      if (nComps[j] < 1)
+        {
+        SENSEI_ERROR("Mesh \"" << meshName << "\" has no point data array \""
+          << arrays[j] << "\"")
+        if (mesh)
+          mesh->Delete();
+        return false;
+        }
+      offsets[j] = nVals;
+      nVals += nComps[j];
+      }
+
+    // get raw access to the coordinates and arrays of each block
+    std::vector<vtkSmartPointer<vtkDataArray>> copies;
+    std::vector<ParticleBlock> blocks;
+    for (unsigned int i = 0; !ierr && (i < nDobjs); ++i)
+      {
+      vtkPointSet *ps = static_cast<vtkPointSet*>(dobjs[i]);
+
+      long np = ps->GetNumberOfPoints();
+      if (np < 1)
+        continue;
+
+      ParticleBlock blk;
+      blk.NumParticles = np;
+      blk.Coords = GetContiguous(ps->GetPoints()->GetData(), copies);
+
+      vtkPointData *pd = ps->GetPointData();
+
+      vtkUnsignedCharArray *ghosts = dynamic_cast<vtkUnsignedCharArray*>(
+        pd->GetArray(vtkDataSetAttributes::GhostArrayName()));
+      blk.Ghosts = ghosts ? ghosts->GetPointer(0) : nullptr;
+
+      for (unsigned int j = 0; !ierr && (j < nArrays); ++j)
+        {
+        vtkDataArray *da = pd->GetArray(arrays[j].c_str());
+        if (!da || (da->GetNumberOfComponents() != nComps[j]))
+          {
+          SENSEI_ERROR("Mesh \"" << meshName << "\" has a block with "
+            << np << " particles and no point data array \"" << arrays[j]
+            << "\" with " << nComps[j] << " components")
+          ierr = -1;
+          break;
+          }
+        blk.Arrays.push_back(GetContiguous(da, copies));
+        }
+
+      if (!ierr)
+        blocks.push_back(blk);
+      }
+
+    unsigned int nBlocks = blocks.size();
+
+    // the region covered by the grid
+    Grid g;
+    g.Bounds = this->Bounds;
+    if (!this->BoundsSet)
+      {
+      std::array<double,6> bounds{std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::lowest()};
+
+      for (unsigned int i = 0; !ierr && (i < nBlocks); ++i)
+        {
+        vtkDataArray *coords = blocks[i].Coords;
+        switch (coords->GetDataType())
+          {
+          vtkTemplateMacro(
+            GetBounds(static_cast<const VTK_TT*>(coords->GetVoidPointer(0)),
+              blocks[i].NumParticles, bounds);
+            );
+          default:
+            SENSEI_ERROR("Invalid coordinate array type " << coords->GetClassName())
+            ierr = -1;
+          }
+        }
+
+      // reduce the lower and upper bounds in one call
+      for (int q = 0; q < 3; ++q)
+        bounds[2*q+1] = -bounds[2*q+1];
+
+      MPI_Allreduce(MPI_IN_PLACE, bounds.data(), 6, MPI_DOUBLE, MPI_MIN, comm);
+
+      for (int q = 0; q < 3; ++q)
+        bounds[2*q+1] = -bounds[2*q+1];
+
+      if (bounds[1] < bounds[0])
+        {
+        if (mesh)
+          mesh->Delete();
+
+        // all ranks are here, agree on failure before moving on
+        MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, comm);
+        if (ierr)
+          {
+          SENSEI_ERROR("Failed to deposit mesh \"" << meshName << "\"")
+          return false;
+          }
+
+        SENSEI_WARNING("Mesh \"" << meshName << "\" has no particles")
+        continue;
+        }
+
+      g.Bounds = bounds;
+      }
+
+    g.NumCells = 1;
+    for (int q = 0; q < 3; ++q)
+      {
+      g.Dims[q] = this->Resolution[q];
+      g.NumCells *= g.Dims[q];
+
+      // particles in a plane or a line get a single layer of unit thickness
+      double dx = (g.Bounds[2*q+1] - g.Bounds[2*q])/g.Dims[q];
+      g.Spacing[q] = dx > 0.0 ? dx : 1.0;
+      }
+
+    // split the particles into tasks, there's nothing to deposit after a
+    // failure
+    std::vector<Task> tasks;
+    for (unsigned int i = 0; !ierr && (i < nBlocks); ++i)
+      for (long p0 = 0; p0 < blocks[i].NumParticles; p0 += ChunkSize)
+        tasks.push_back({static_cast<int>(i), p0,
+          std::min(blocks[i].NumParticles, p0 + ChunkSize)});
+
+    int nTasks = tasks.size();
+
+    // deposit. each thread has a grid of its own, the grids are summed into
+    // the first one
+    long nGridVals = g.NumCells*nVals;
+
+    std::vector<std::vector<double>> grids(1);
+    grids[0].resize(nGridVals, 0.0);
+
+    int nActive = std::max(1, std::min(nThreads, nTasks));
+    if (nActive < 2)
+      {
+      Stencil st;
+      for (int i = 0; (i < nTasks) && !ierr; ++i)
+        {
+        if (this->Internals->Deposit(g, this->Method, blocks, offsets,
+          nVals, tasks[i], st, grids[0].data()))
+          ierr = -1;
+        }
+      }
+    else
+      {
+      sdiy::ThreadPool &pool = this->Internals->GetThreadPool(nThreads);
+      int nPoolThreads = pool.size();
+
+      std::atomic<int> terr(0);
+      std::vector<Stencil> st(nPoolThreads);
+      grids.resize(nPoolThreads);
+
+      pool.run(nTasks, [&](int i, int t)
+        {
+        std::vector<double> &grid = grids[t];
+        if (grid.empty())
+          grid.resize(nGridVals, 0.0);
+
+        if (this->Internals->Deposit(g, this->Method, blocks, offsets,
+          nVals, tasks[i], st[t], grid.data()))
+          terr = -1;
+        });
+
+      ierr = terr;
+
+      long nSums = (nGridVals + ChunkSize - 1)/ChunkSize;
+      pool.run(nSums, [&](int i, int)
+        {
+        long i0 = i*ChunkSize;
+        long i1 = std::min(nGridVals, i0 + ChunkSize);
+        double *out = grids[0].data();
+        for (int t = 1; t < nPoolThreads; ++t)
+          {
+          if (grids[t].empty())
+            continue;
+
+          const double *in = grids[t].data();
+          for (long j = i0; j < i1; ++j)
+            out[j] += in[j];
+          }
+        });
+      }
+
+    if (mesh)
+      mesh->Delete();
+
+    // split the grid into slabs along the slowest varying axis that has
+    // more than one cell, each rank receives the sum of one slab
+    int axis = g.Dims[2] > 1 ? 2 : (g.Dims[1] > 1 ? 1 : 0);
+    long nLayers = g.Dims[axis];
+    long layerVals = nGridVals/nLayers;
+
+    std::vector<long> firstLayer(nRanks + 1);
+    std::vector<int> counts(nRanks);
+    for (int i = 0; i <= nRanks; ++i)
+      firstLayer[i] = nLayers*i/nRanks;
+
+    for (int i = 0; i < nRanks; ++i)
+      {
+      long n = (firstLayer[i+1] - firstLayer[i])*layerVals;
+      if (n > std::numeric_limits<int>::max())
+        {
+        SENSEI_ERROR("The grid is too large to reduce, run with more ranks "
+          "or use a lower resolution")
+        return false;
+        }
+      counts[i] = n;
+      }
+
+    std::vector<double> slab(counts[rank]);
+    MPI_Reduce_scatter(grids[0].data(), slab.data(), counts.data(),
+      MPI_DOUBLE, MPI_SUM, comm);
+
+    grids.clear();
+
+    // all ranks agree on failure so that none go on to the next mesh alone
+    MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, comm);
+    if (ierr)
+      {
+      SENSEI_ERROR("Failed to deposit mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    // convert the sums into density and means
+    vtkImageData *im = nullptr;
+    long nSlabCells = counts[rank]/nVals;
+    if (nSlabCells)
+      {
+      int ext[6] = {0, int(g.Dims[0]), 0, int(g.Dims[1]), 0, int(g.Dims[2])};
+      ext[2*axis] = firstLayer[rank];
+      ext[2*axis+1] = firstLayer[rank+1];
+
+      im = vtkImageData::New();
+      im->SetOrigin(g.Bounds[0], g.Bounds[2], g.Bounds[4]);
+      im->SetSpacing(g.Spacing.data());
+      im->SetExtent(ext);
+
+      double cellVol = g.Spacing[0]*g.Spacing[1]*g.Spacing[2];
+      const double *ps = slab.data();
+
+      vtkDoubleArray *density = vtkDoubleArray::New();
+      density->SetName("density");
+      density->SetNumberOfTuples(nSlabCells);
+      double *pd = density->GetPointer(0);
+      for (long i = 0; i < nSlabCells; ++i)
+        pd[i] = ps[i*nVals]/cellVol;
+
+      im->GetCellData()->AddArray(density);
+      density->Delete();
+
+      for (unsigned int j = 0; j < nArrays; ++j)
+        {
+        int nc = nComps[j];
+        vtkDoubleArray *mean = vtkDoubleArray::New();
+        mean->SetName(arrays[j].c_str());
+        mean->SetNumberOfComponents(nc);
+        mean->SetNumberOfTuples(nSlabCells);
+        double *pm = mean->GetPointer(0);
+        for (long i = 0; i < nSlabCells; ++i)
+          {
+          const double *pv = ps + i*nVals;
+          double w = pv[0] > 0.0 ? 1.0/pv[0] : 0.0;
+          for (int c = 0; c < nc; ++c)
+            pm[i*nc + c] = w*pv[offsets[j] + c];
+          }
+
+        im->GetCellData()->AddArray(mean);
+        mean->Delete();
+        }
+      }
+
+    // cache the result, the simulation can access it
+    this->Internals->Output[meshName].TakeReference(im);
+
+    if (!this->Internals->WriterEnabled)
+      continue;
+
+#if defined(ENABLE_VTK_IO)
+    // write the slabs, block i holds the slab of rank i
+    vtkMultiBlockDataSet *mb = vtkMultiBlockDataSet::New();
+    mb->SetNumberOfBlocks(nRanks);
+    mb->SetBlock(rank, im);
+
+    VTKDataAdaptor *dataAdaptor = VTKDataAdaptor::New();
+    dataAdaptor->SetDataObject(meshName + "_deposition", mb);
+    dataAdaptor->SetDataTimeStep(step);
+    dataAdaptor->SetDataTime(time);
+    mb->Delete();
+
+    if (!this->Internals->Writer->Execute(dataAdaptor))
+      {
+      SENSEI_ERROR("Failed to write time step " << step)
+      dataAdaptor->Delete();
+      return false;
+      }
+
+    dataAdaptor->ReleaseData();
+    dataAdaptor->Delete();
+#else
+    (void)step;
+    (void)time;
+#endif
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::Finalize()
+{
+  TimeEvent<128> mark("ParticleDeposition::Finalize");
+
+  this->Internals->Output.clear();
+
+#if defined(ENABLE_VTK_IO)
+  if (this->Internals->WriterEnabled && this->Internals->Writer->Finalize())
+    {
+    SENSEI_ERROR("Failed to finalize the writer")
+    return -1;
+    }
+#endif
+
+  return 0;
+}
+
+}
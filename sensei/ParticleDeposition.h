@@ -0,0 +1,97 @@
+#ifndef sensei_ParticleDeposition_h
+#define sensei_ParticleDeposition_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+class vtkImageData;
+
+namespace sensei
+{
+
+/// @class ParticleDeposition
+/// @brief Deposits particles onto a uniform grid.
+///
+/// The points of each requested mesh are binned onto a uniform grid using
+/// nearest grid point (NGP) or cloud in cell (CIC) weights. The grid holds
+/// the number density and, for each requested point data array, the weighted
+/// mean of the array in each cell. Coordinates and arrays are read through
+/// their raw pointers, there are no per particle VTK calls. Each thread
+/// deposits its share of the particles onto a private grid, the private grids
+/// are summed and then reduced across ranks with MPI_Reduce_scatter so that
+/// each rank owns a slab of the result. The slabs are written with
+/// VTKPosthocIO when an output directory is set and are available to the
+/// simulation through GetOutput.
+class ParticleDeposition : public AnalysisAdaptor
+{
+public:
+  static ParticleDeposition *New();
+  senseiTypeMacro(ParticleDeposition, AnalysisAdaptor);
+
+  /// the meshes to deposit and the point data arrays to deposit with them
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  /// set the deposition scheme. Valid values are METHOD_NGP=0, METHOD_CIC=1
+  enum {METHOD_NGP=0, METHOD_CIC=1};
+  int SetMethod(int method);
+
+  /// set the deposition scheme. Valid values are "ngp", "cic"
+  int SetMethod(const std::string &method);
+
+  /// set the region covered by the grid [x0,x1, y0,y1, z0,z1]. particles
+  /// outside of it are ignored. when not set the bounds of the particles
+  /// are computed at each step.
+  int SetBounds(const std::array<double,6> &bounds);
+
+  /// set the number of cells in each direction
+  int SetResolution(const std::array<int,3> &res);
+
+  /// set the number of threads used for the deposition
+  void SetNumberOfThreads(int n) { this->NumberOfThreads = n; }
+  int GetNumberOfThreads() { return this->NumberOfThreads; }
+
+  /// set writer parameters. the grid is written only when an output
+  /// directory has been set
+  int SetWriterOutputDir(const std::string &outputDir);
+  int SetWriterMode(const std::string &mode);
+  int SetWriterWriter(const std::string &writer);
+
+  /// get the slab of the most recent result for the named mesh owned by
+  /// this rank. the slab has the cell data arrays "density" and one array
+  /// for each requested array. returns nullptr if this rank owns no part of
+  /// the grid.
+  vtkImageData *GetOutput(const std::string &meshName);
+
+  bool Execute(DataAdaptor* data) override;
+
+  int Finalize() override;
+
+protected:
+  ParticleDeposition();
+  ~ParticleDeposition();
+
+  ParticleDeposition(const ParticleDeposition&) = delete;
+  void operator=(const ParticleDeposition&) = delete;
+
+private:
+  DataRequirements Requirements;
+  int Method;
+  int NumberOfThreads;
+  int BoundsSet;
+  std::array<double,6> Bounds;
+  std::array<int,3> Resolution;
+
+  struct InternalsType;
+  InternalsType *Internals;
+};
+
+}
+
+#endif
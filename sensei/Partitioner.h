@@ -5,6 +5,7 @@
 #include "Error.h"
 
 #include <memory>
+#include <vector>
 #include <mpi.h>
 
 namespace pugi { class xml_node; }
@@ -33,6 +34,24 @@ public:
   virtual int GetPartition(MPI_Comm comm, const sensei::MeshMetadataPtr &in,
     sensei::MeshMetadataPtr &out) = 0;
 
+  // given the existing partitioning of a set of meshes, return a new
+  // partitioning of each. the default calls GetPartition for each mesh.
+  // partitioners that communicate should override this so that all of the
+  // meshes are handled in a single collective.
+  virtual int GetPartitions(MPI_Comm comm,
+    const std::vector<sensei::MeshMetadataPtr> &in,
+    std::vector<sensei::MeshMetadataPtr> &out)
+  {
+    unsigned int n = in.size();
+    out.resize(n);
+    for (unsigned int i = 0; i < n; ++i)
+      {
+      if (this->GetPartition(comm, in[i], out[i]))
+        return -1;
+      }
+    return 0;
+  }
+
   // initialize the partitioner from the XML node.
   virtual int Initialize(pugi::xml_node &)
   {
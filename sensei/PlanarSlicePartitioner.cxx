@@ -1,9 +1,12 @@
 #include "PlanarSlicePartitioner.h"
+#include "BlockPartitioner.h"
 #include "XMLUtils.h"
 #include "STLUtils.h"
 #include "VTKUtils.h"
 #include "Profiler.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <sstream>
 #include <limits>
@@ -36,79 +39,168 @@ int PlanarSlicePartitioner::Initialize(pugi::xml_node &node)
 }
 
 // --------------------------------------------------------------------------
-int PlanarSlicePartitioner::GetPartition(MPI_Comm comm,
-  const MeshMetadataPtr &mdIn, MeshMetadataPtr &mdOut)
+double PlanarSlicePartitioner::GetBlockWeight(long numCells,
+  const std::array<double,6> &bounds) const
 {
-  TimeEvent<128>("PlanarSlicePartitioner::GetPartition");
+  double len = std::sqrt(this->Normal[0]*this->Normal[0] +
+    this->Normal[1]*this->Normal[1] + this->Normal[2]*this->Normal[2]);
 
-  // require block bounds
-  if (mdIn->BlockBounds.size() != static_cast<unsigned int>(mdIn->NumBlocks))
+  if (len <= 0.0)
+    return 0.0;
+
+  double n[3] = {this->Normal[0]/len, this->Normal[1]/len, this->Normal[2]/len};
+
+  // the corners of the block bounding box and their distance to the plane
+  double pts[8][3];
+  double dist[8];
+  for (int q = 0; q < 8; ++q)
     {
-    SENSEI_ERROR("Block bounds are required")
-    return -1;
+    pts[q][0] = bounds[q & 1];
+    pts[q][1] = bounds[2 + ((q >> 1) & 1)];
+    pts[q][2] = bounds[4 + ((q >> 2) & 1)];
+
+    dist[q] = 0.0;
+    for (int j = 0; j < 3; ++j)
+      dist[q] += n[j]*(pts[q][j] - this->Point[j]);
     }
 
-  // build the list of active blocks
-  std::vector<int> activeBlocks;
-  for (int i = 0; i < mdIn->NumBlocks; ++i)
+  // intersect the plane with the 12 edges of the box. the corners at either
+  // end of an edge differ in one bit. if the plane passes through the block
+  // at least one edge has corners on either side of it
+  std::vector<std::array<double,3>> poly;
+  for (int q = 0; q < 8; ++q)
     {
-    // compute the distance from  each corner of the block bounding box
-    // to the plane. if the block intersects the plane, at least one
-    // corner will have a different sign.
-    const std::array<double,6> &bounds = mdIn->BlockBounds[i];
-
-    // triplets defining corner points
-    int pt_ids[] = {0,2,4, 0,3,4, 1,3,4, 1,2,4,
-      0,2,5, 0,3,5, 1,3,5, 1,2,5};
+    for (int b = 1; b < 8; b <<= 1)
+      {
+      int r = q | b;
+      if ((q & b) || ((dist[q] <= 0.0) == (dist[r] <= 0.0)))
+        continue;
 
-    double min_d = std::numeric_limits<double>::max();
-    double max_d = std::numeric_limits<double>::lowest();
+      double t = dist[q]/(dist[q] - dist[r]);
 
-    for (int q = 0; q < 8; ++q)
-      {
-      double d = 0.0;
+      std::array<double,3> x;
       for (int j = 0; j < 3; ++j)
-        d += this->Normal[j] * (bounds[pt_ids[q*3 + j]] - this->Point[j]);
-
-      min_d = std::min(min_d, d);
-      max_d = std::max(max_d, d);
+        x[j] = pts[q][j] + t*(pts[r][j] - pts[q][j]);
 
-      if ((min_d <= 0.0) && (max_d > 0.0))
-        {
-        activeBlocks.push_back(i);
-        break;
-        }
+      poly.push_back(x);
       }
     }
 
-  // partition the remaining blocks to ranks equally
-  int nRanks = 1;
-  MPI_Comm_size(comm, &nRanks);
+  if (poly.empty())
+    return 0.0;
 
-  int numActiveBlocks = activeBlocks.size();
+  // the number of cells cut is about the area of the slice over the area
+  // of a cell's face. flat blocks are assumed to be cut everywhere.
+  double vol = (bounds[1] - bounds[0])*(bounds[3] - bounds[2])*
+    (bounds[5] - bounds[4]);
+
+  if (vol <= 0.0)
+    return std::max(numCells, 1l);
 
-  std::vector<int> activeBlockOwner(numActiveBlocks);
+  // make a basis in the plane and order the points around their center
+  double c[3] = {0.0, 0.0, 0.0};
+  int nPts = poly.size();
+  for (int i = 0; i < nPts; ++i)
+    for (int j = 0; j < 3; ++j)
+      c[j] += poly[i][j]/nPts;
 
-  int nLocal = numActiveBlocks / nRanks;
-  int nLarge = numActiveBlocks % nRanks;
+  double a[3] = {0.0, 0.0, 0.0};
+  a[std::fabs(n[0]) < 0.9 ? 0 : 1] = 1.0;
 
-  for (int j = 0; j < nRanks; ++j)
+  double an = a[0]*n[0] + a[1]*n[1] + a[2]*n[2];
+  double u[3] = {a[0] - an*n[0], a[1] - an*n[1], a[2] - an*n[2]};
+  double ul = std::sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+  for (int j = 0; j < 3; ++j)
+    u[j] /= ul;
+
+  double v[3] = {n[1]*u[2] - n[2]*u[1], n[2]*u[0] - n[0]*u[2],
+    n[0]*u[1] - n[1]*u[0]};
+
+  std::vector<std::array<double,3>> uva(nPts);
+  for (int i = 0; i < nPts; ++i)
     {
-    // do it for all ranks, so every rank can know who
-    // owns what
-    int rank = j;
+    double pu = 0.0;
+    double pv = 0.0;
+    for (int j = 0; j < 3; ++j)
+      {
+      pu += (poly[i][j] - c[j])*u[j];
+      pv += (poly[i][j] - c[j])*v[j];
+      }
+    uva[i] = {{std::atan2(pv, pu), pu, pv}};
+    }
 
-    int id0 = nLocal*rank + (rank < nLarge ? rank : nLarge);
-    int id1 = id0 + nLocal + (rank < nLarge ? 1 : 0);
+  std::sort(uva.begin(), uva.end());
 
-    // allocate the local dataset
-    for (int i = id0; i < id1; ++i)
-      activeBlockOwner[i] = rank;
+  // the area of the slice
+  double area = 0.0;
+  for (int i = 0; i < nPts; ++i)
+    {
+    const std::array<double,3> &p0 = uva[i];
+    const std::array<double,3> &p1 = uva[(i + 1) % nPts];
+    area += p0[1]*p1[2] - p1[1]*p0[2];
     }
+  area = 0.5*std::fabs(area);
+
+  double cut = area*std::pow(numCells/vol, 2.0/3.0);
+
+  // a block touched by the plane costs at least one cell
+  return std::max(std::min(cut, double(numCells)), 1.0);
+}
+
+// --------------------------------------------------------------------------
+int PlanarSlicePartitioner::GetPartition(MPI_Comm comm,
+  const MeshMetadataPtr &mdIn, MeshMetadataPtr &mdOut)
+{
+  TimeEvent<128>("PlanarSlicePartitioner::GetPartition");
+
+  // require block bounds
+  if (mdIn->BlockBounds.size() != static_cast<unsigned int>(mdIn->NumBlocks))
+    {
+    SENSEI_ERROR("Block bounds are required")
+    return -1;
+    }
+
+  int nBlocks = mdIn->NumBlocks;
+
+  std::vector<long> numCells(mdIn->BlockNumCells);
+  if (numCells.size() != static_cast<unsigned int>(nBlocks))
+    numCells.assign(nBlocks, 1);
+
+  int nRanks = 1;
+  MPI_Comm_size(comm, &nRanks);
 
   // update the metadata with the new decomp
   mdOut = mdIn->NewCopy();
 
+  // reuse the last result when nothing it depends on has changed
+  CacheEntry &cache = this->Cache[mdIn->MeshName];
+  if ((cache.NumRanks == nRanks) && (cache.BlockBounds == mdIn->BlockBounds) &&
+    (cache.BlockNumCells == numCells))
+    {
+    mdOut->BlockOwner = cache.BlockOwner;
+    return 0;
+    }
+
+  // build the list of active blocks and estimate the cost of each
+  std::vector<int> activeBlocks;
+  std::vector<double> activeBlockWeight;
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    double weight = this->GetBlockWeight(numCells[i], mdIn->BlockBounds[i]);
+    if (weight > 0.0)
+      {
+      activeBlocks.push_back(i);
+      activeBlockWeight.push_back(weight);
+      }
+    }
+
+  // partition the active blocks to ranks by cost
+  int numActiveBlocks = activeBlocks.size();
+
+  std::vector<int> activeBlockOwner;
+  BlockPartitioner::GetWeightedPartition(nRanks,
+    activeBlockWeight, activeBlockOwner);
+
   // start out with all block assigned to no rank
   for (int i = 0; i < mdOut->NumBlocks; ++i)
     mdOut->BlockOwner[i] = -1;
@@ -117,6 +209,12 @@ int PlanarSlicePartitioner::GetPartition(MPI_Comm comm,
   for (int i = 0; i < numActiveBlocks; ++i)
     mdOut->BlockOwner[activeBlocks[i]] = activeBlockOwner[i];
 
+  // save the result for the next time
+  cache.NumRanks = nRanks;
+  cache.BlockBounds = mdIn->BlockBounds;
+  cache.BlockNumCells = numCells;
+  cache.BlockOwner = mdOut->BlockOwner;
+
   // report the decomp
   int rank = 0;
   MPI_Comm_rank(comm, &rank);
@@ -147,7 +245,7 @@ int PlanarSlicePartitioner::GetPartition(MPI_Comm comm,
 
     // report number of blocks moved
     oss << "PlanarSlicePartitioner: NumBlocks=" << mdIn->NumBlocks
-      << " NumActiveBlocks=" << activeBlocks.size() << " numCellsMoved=" << numCellsMoved
+      << " NumActiveBlocks=" << numActiveBlocks << " numCellsMoved=" << numCellsMoved
       << " numCellsLeft=" << numCellsLeft << " movedFraction="
       << double(numCellsMoved)/double(numCellsMoved + numCellsLeft);
 
@@ -3,6 +3,9 @@
 
 #include "Partitioner.h"
 #include <array>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace sensei
 {
@@ -14,7 +17,10 @@ using PlanarSlicePartitionerPtr = std::shared_ptr<sensei::PlanarSlicePartitioner
 /// The slice paritioner determins which blocks intersect the plane
 /// defined by a given point and normal. This blocks are partitioned
 /// in consecutive blocks to ranks such that each rank gets approximately
-/// the same number. Ranks will differ by at most 1 block.
+/// the same amount of work. The work in a block is estimated from the area
+/// of the plane inside the block's bounds and the block's cell size. The
+/// result is reused while the block bounds, cell counts and number of ranks
+/// are unchanged.
 class PlanarSlicePartitioner : public sensei::Partitioner
 {
 public:
@@ -24,11 +30,13 @@ public:
   const char *GetClassName() override { return "PlanarSlicePartitioner"; }
 
   // set the point defining the slice plane
-  void SetPoint(const std::array<double,3> &p) { this->Point = p; }
+  void SetPoint(const std::array<double,3> &p)
+  { this->Point = p; this->Cache.clear(); }
   void GetPoint(std::array<double,3> &p) { p = this->Point; }
 
   // set the normal defining the slice plane
-  void SetNormal(const std::array<double,3> &n) { this->Normal = n; }
+  void SetNormal(const std::array<double,3> &n)
+  { this->Normal = n; this->Cache.clear(); }
   void GetNormal(std::array<double,3> &n) { n = this->Normal; }
 
   // Initialize from XML
@@ -43,8 +51,23 @@ protected:
   PlanarSlicePartitioner() : Point{0.,0.,0.}, Normal{1.,0.,0.} {}
   PlanarSlicePartitioner(const PlanarSlicePartitioner &) = default;
 
+  // estimate the number of cells the plane passes through in a block with
+  // the given bounds and number of cells. returns 0 if the plane misses the
+  // block.
+  double GetBlockWeight(long numCells, const std::array<double,6> &bounds) const;
+
+  // the inputs and result of the last partitioning of a mesh
+  struct CacheEntry
+  {
+    int NumRanks = 0;
+    std::vector<std::array<double,6>> BlockBounds;
+    std::vector<long> BlockNumCells;
+    std::vector<int> BlockOwner;
+  };
+
   std::array<double,3> Point;
   std::array<double,3> Normal;
+  std::map<std::string, CacheEntry> Cache;
 };
 
 }
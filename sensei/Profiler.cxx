@@ -18,7 +18,9 @@
 #include <vector>
 #include <iomanip>
 #include <limits>
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 
 namespace impl
@@ -50,6 +52,18 @@ struct Event
   // how deep is the Event stack
   int Depth;
 
+  // peak resident set size in KiB while the Event was active, when high
+  // resolution memory profiling is enabled, else -1. StartSample is
+  // the index of the first memory sample taken during the Event
+  long long PeakMem;
+  unsigned long long StartSample;
+
+  // bytes allocated, freed, and peak bytes in use, and the number of
+  // vtkObjects created and deleted during the Event, when allocation
+  // tracking is in use, else -1
+  enum { ALLOCATED=0, FREED=1, PEAK=2, VTK_OBJECTS=3, VTK_OBJECTS_FREED=4 };
+  long long Alloc[5];
+
   // the thread id that generated the Event
   std::thread::id Tid;
 };
@@ -74,6 +88,16 @@ static std::mutex eventLogMutex;
 // memory profiler
 static sensei::MemoryProfiler memProf;
 
+// memory samples are tagged with the innermost event on this thread. the
+// names are interned so that the tags remain valid until finalize
+static std::thread::id mainThread;
+static std::unordered_set<std::string> eventNames;
+
+static const char *internName(const std::string &name)
+{
+  return eventNames.insert(name).first->c_str();
+}
+
 // return high res system Time relative to system epoch
 static double getSystemTime()
 {
@@ -84,8 +108,8 @@ static double getSystemTime()
 
 
 // --------------------------------------------------------------------------
-Event::Event() : Time{0,0,0}, NumBytes(-1ll), Depth(0),
-  Tid(std::this_thread::get_id())
+Event::Event() : Time{0,0,0}, NumBytes(-1ll), Depth(0), PeakMem(-1ll),
+  StartSample(0), Alloc{-1ll,-1ll,-1ll,-1ll,-1ll}, Tid(std::this_thread::get_id())
 {
 }
 
@@ -104,7 +128,10 @@ void Event::ToStream(std::ostream &str) const
   str << rank << ", " << this->Tid << ", \"" << this->Name << "\", "
     << this->Time[START] << ", " << this->Time[END] << ", "
     << this->Time[DELTA] << ", " << this->NumBytes  << ", "
-    << this->Depth << std::endl;
+    << this->Depth << ", " << this->PeakMem << ", "
+    << this->Alloc[ALLOCATED] << ", " << this->Alloc[FREED] << ", "
+    << this->Alloc[PEAK] << ", " << this->Alloc[VTK_OBJECTS] << ", "
+    << this->Alloc[VTK_OBJECTS_FREED] << std::endl;
 #else
   (void)str;
 #endif
@@ -156,7 +183,7 @@ void Profiler::SetMemProfLogFile(const std::string &file)
 }
 
 // ----------------------------------------------------------------------------
-void Profiler::SetMemProfInterval(int interval)
+void Profiler::SetMemProfInterval(double interval)
 {
 #if defined(ENABLE_PROFILER)
   impl::memProf.SetInterval(interval);
@@ -165,6 +192,16 @@ void Profiler::SetMemProfInterval(int interval)
 #endif
 }
 
+// ----------------------------------------------------------------------------
+void Profiler::SetMemProfRingBufferSize(long n)
+{
+#if defined(ENABLE_PROFILER)
+  impl::memProf.SetRingBufferSize(n);
+#else
+  (void)n;
+#endif
+}
+
 // ----------------------------------------------------------------------------
 int Profiler::Validate()
 {
@@ -256,9 +293,30 @@ int Profiler::Initialize()
   if ((tmp = getenv("MEMPROF_INTERVAL")))
     impl::memProf.SetInterval(atof(tmp));
 
+  if ((tmp = getenv("MEMPROF_RING_SIZE")))
+    impl::memProf.SetRingBufferSize(atol(tmp));
+
+  // high resolution mode implies memory profiling, and samples every
+  // millisecond unless an interval was given
+  if (impl::loggingEnabled & 0x04)
+    {
+    impl::loggingEnabled |= 0x02;
+    impl::memProf.SetHighResolution(1);
+
+    if (!getenv("MEMPROF_INTERVAL"))
+      impl::memProf.SetInterval(1.0e-3);
+    }
+
+  impl::mainThread = std::this_thread::get_id();
+
   if (impl::loggingEnabled & 0x02)
     impl::memProf.Initialize();
 
+  // Initialize falls back to the default sampler when high resolution
+  // sampling isn't available
+  if (!impl::memProf.GetHighResolution())
+    impl::loggingEnabled &= ~0x04;
+
   // report what options are in use
   if ((rank == 0) && impl::loggingEnabled)
     std::cerr << "Profiler configured with Event logging "
@@ -267,7 +325,8 @@ int Profiler::Initialize()
       << ", timer log file \"" << impl::timerLogFile
       << "\", memory profiler log file \"" << impl::memProf.GetFilename()
       << "\", sampling interval " << impl::memProf.GetInterval()
-      << " seconds" << std::endl;
+      << " seconds" << (impl::loggingEnabled & 0x04 ? ", high resolution" : "")
+      << std::endl;
 #endif
   return 0;
 }
@@ -395,7 +454,9 @@ int Profiler::Finalize()
     std::ostringstream oss;
 
     if (rank == 0)
-      oss << "# rank, thread, Name, start Time, end Time, delta, Depth" << std::endl;
+      oss << "# rank, thread, Name, start Time, end Time, delta, nBytes, Depth, peak mem kiB, "
+        "allocated bytes, freed bytes, peak allocated bytes, vtkObjects created, "
+        "vtkObjects deleted" << std::endl;
 
     Profiler::ToStream(oss);
 
@@ -412,6 +473,8 @@ int Profiler::Finalize()
   if (impl::loggingEnabled & 0x02)
     impl::memProf.Finalize();
 
+  impl::eventNames.clear();
+
   // free up other resources
 #if defined(SENSEI_HAS_MPI)
   if (ok)
@@ -463,7 +526,17 @@ int Profiler::StartEvent(const char* eventname, long long nbytes)
     evt.Time[impl::Event::START] = impl::getSystemTime();
     evt.NumBytes = nbytes;
 
+    if (impl::loggingEnabled & 0x04)
+      {
+      evt.StartSample = impl::memProf.GetSampleIndex();
+      evt.PeakMem = impl::memProf.GetCurrentMemory();
+      }
+
     std::lock_guard<std::mutex> lock(impl::eventLogMutex);
+
+    if ((impl::loggingEnabled & 0x04) && (evt.Tid == impl::mainThread))
+      impl::memProf.SetTag(impl::internName(evt.Name));
+
     impl::activeEvents[evt.Tid].push_back(evt);
     }
 #else
@@ -485,7 +558,7 @@ int Profiler::EndEvent(const char* eventname, long long nbytes)
     // get this thread's Event log
     std::thread::id tid = std::this_thread::get_id();
 
-    std::lock_guard<std::mutex> lock(impl::eventLogMutex);
+    std::unique_lock<std::mutex> lock(impl::eventLogMutex);
     impl::threadMapType::iterator iter = impl::activeEvents.find(tid);
     if (iter == impl::activeEvents.end())
       {
@@ -497,6 +570,17 @@ int Profiler::EndEvent(const char* eventname, long long nbytes)
     impl::Event evt(std::move(iter->second.back()));
     iter->second.pop_back();
 
+    // the memory samples taken during the event are scanned without holding
+    // the lock, it may be a long way back for long running events
+    if (impl::loggingEnabled & 0x04)
+      {
+      lock.unlock();
+      evt.PeakMem = std::max(evt.PeakMem,
+        impl::memProf.GetPeakMemory(evt.StartSample));
+      lock.lock();
+      iter = impl::activeEvents.find(tid);
+      }
+
 #ifdef NDEBUG
     (void)eventname;
 #else
@@ -512,6 +596,14 @@ int Profiler::EndEvent(const char* eventname, long long nbytes)
     evt.NumBytes = nbytes;
     evt.Depth = iter->second.size();
 
+    // subsequent samples belong to the enclosing event
+    if (impl::loggingEnabled & 0x04)
+      {
+      if (tid == impl::mainThread)
+        impl::memProf.SetTag(iter->second.empty() ? nullptr :
+          impl::internName(iter->second.back().Name));
+      }
+
     impl::eventLog.emplace_back(std::move(evt));
     }
 #else
@@ -521,4 +613,39 @@ int Profiler::EndEvent(const char* eventname, long long nbytes)
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int Profiler::SetEventAllocations(long long allocated, long long freed,
+  long long peak, long long vtkObjects, long long vtkObjectsFreed)
+{
+#if defined(ENABLE_PROFILER)
+  if (impl::loggingEnabled & 0x01)
+    {
+    std::thread::id tid = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(impl::eventLogMutex);
+    impl::threadMapType::iterator iter = impl::activeEvents.find(tid);
+    if ((iter == impl::activeEvents.end()) || iter->second.empty())
+      {
+      SENSEI_ERROR("failed to set allocations, thread  "
+        << tid << " has no events")
+      return -1;
+      }
+
+    impl::Event &evt = iter->second.back();
+    evt.Alloc[impl::Event::ALLOCATED] = allocated;
+    evt.Alloc[impl::Event::FREED] = freed;
+    evt.Alloc[impl::Event::PEAK] = peak;
+    evt.Alloc[impl::Event::VTK_OBJECTS] = vtkObjects;
+    evt.Alloc[impl::Event::VTK_OBJECTS_FREED] = vtkObjectsFreed;
+    }
+#else
+  (void)allocated;
+  (void)freed;
+  (void)peak;
+  (void)vtkObjects;
+  (void)vtkObjectsFreed;
+#endif
+  return 0;
+}
+
 }
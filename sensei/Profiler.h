@@ -28,9 +28,17 @@ public:
   //   PROFILER_ENABLE     : bit mask turns on or off logging,
   //               0x01 -- event profiling enabled
   //               0x02 -- memory profiling enabled
+  //               0x04 -- high resolution memory profiling enabled
   //   PROFILER_LOG_FILE   : path to write timer log to
   //   MEMPROF_LOG_FILE    : path to write memory profiler log to
-  //   MEMPROF_INTERVAL    : number of seconds between memory recordings
+  //   MEMPROF_INTERVAL    : number of seconds between memory recordings,
+  //                         defaults to 0.001 in high resolution mode
+  //   MEMPROF_RING_SIZE   : number of samples kept in high resolution mode
+  //
+  // In high resolution mode memory samples are tagged with the innermost
+  // event active on the thread that initialized the profiler, and the
+  // peak resident set size observed during each event is recorded in the
+  // timer log.
   //
   static int Initialize();
 
@@ -61,7 +69,11 @@ public:
 
   // Sets the number of seconds in between memory use recordings
   // overriden by MEMPROF_INTERVAL environment variable.
-  static void SetMemProfInterval(int interval);
+  static void SetMemProfInterval(double interval);
+
+  // Sets the number of samples kept in high resolution mode
+  // overriden by MEMPROF_RING_SIZE environment variable.
+  static void SetMemProfRingBufferSize(long n);
 
   // Enable/Disable logging. Overriden by PROFILER_ENABLE environment
   // variable. In the default format a CSV file is generated capturing each
@@ -85,6 +97,15 @@ public:
   // must match when calling endEvent() to mark the end of the event.
   static int EndEvent(const char *eventname, long long nbytes=-1ll);
 
+  // @brief Attach allocation counts to the innermost active event.
+  //
+  // Records the number of bytes allocated, freed, and the peak number of
+  // bytes in use while the calling thread's innermost active event was
+  // running, and optionally the number of vtkObjects created and deleted.
+  // The values are written in the timer log. See AllocationTracker.
+  static int SetEventAllocations(long long allocated, long long freed,
+    long long peak, long long vtkObjects=-1ll, long long vtkObjectsFreed=-1ll);
+
   // write contents of the string to the file.
   static int WriteCStdio(const char *fileName, const char *mode,
      const std::string &str);
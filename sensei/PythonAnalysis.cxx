@@ -1,5 +1,6 @@
 #include "PythonAnalysis.h"
 #include "Error.h"
+#include "Profiler.h"
 
 #include <vtkObjectFactory.h>
 #include <mpi4py/mpi4py.MPI_api.h>
@@ -258,8 +259,11 @@ int PythonAnalysis::Finalize()
 int PythonAnalysis::Initialize()
 {
   // initialize the interpreter
+  {
+  TimeEvent<128> event("PythonAnalysis::Initialize::Interpreter");
   Py_SetProgramName(C_STRING_LITERAL("PythonAnalysis"));
   Py_Initialize();
+  }
 
   if (!this->Internals->ScriptFile.empty() && !this->Internals->ScriptModule.empty())
     {
@@ -278,6 +282,7 @@ int PythonAnalysis::Initialize()
   if (!this->Internals->ScriptFile.empty())
     {
     // read, boradcast, and run the script
+    TimeEvent<128> event("PythonAnalysis::Initialize::LoadScript");
     if (loadScript(this->GetCommunicator(), this->Internals->ScriptFile,
       this->Internals->Module))
       return -1;
@@ -285,6 +290,7 @@ int PythonAnalysis::Initialize()
   else
     {
     // import the script
+    TimeEvent<128> event("PythonAnalysis::Initialize::ImportModule");
     PyObject *module = PyImport_ImportModule(this->Internals->ScriptModule.c_str());
 
     if (!module || PyErr_Occurred())
@@ -0,0 +1,644 @@
+#include "Statistics.h"
+#include "DataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "VTKUtils.h"
+#include "Error.h"
+
+#include <vtkCompositeDataIterator.h>
+#include <vtkCompositeDataSet.h>
+#include <vtkDataArray.h>
+#include <vtkDataObject.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkFieldData.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace sensei
+{
+
+namespace
+{
+// the central moments of a set of values. the layout is 7 contiguous doubles
+// so that an array of them can be reduced with an MPI_Op.
+struct Moments
+{
+  Moments() : Count(0.0), Mean(0.0), M2(0.0), M3(0.0), M4(0.0),
+    Min(std::numeric_limits<double>::max()),
+    Max(std::numeric_limits<double>::lowest()) {}
+
+  // merge the moments of another set into this one. see Chan et al. 1979
+  // and Pebay 2008 for the higher order terms.
+  void Merge(const Moments &b)
+  {
+    if (b.Count <= 0.0)
+      return;
+
+    if (this->Count <= 0.0)
+      {
+      *this = b;
+      return;
+      }
+
+    double na = this->Count;
+    double nb = b.Count;
+    double n = na + nb;
+    double d = b.Mean - this->Mean;
+    double dn = d/n;
+    double dn2 = dn*dn;
+    double nanb = na*nb;
+
+    double m2 = this->M2 + b.M2 + d*dn*nanb;
+
+    double m3 = this->M3 + b.M3 + d*dn2*nanb*(na - nb)
+      + 3.0*dn*(na*b.M2 - nb*this->M2);
+
+    double m4 = this->M4 + b.M4 + d*dn2*dn*nanb*(na*na - nanb + nb*nb)
+      + 6.0*dn2*(na*na*b.M2 + nb*nb*this->M2) + 4.0*dn*(na*b.M3 - nb*this->M3);
+
+    this->Mean += dn*nb;
+    this->M2 = m2;
+    this->M3 = m3;
+    this->M4 = m4;
+    this->Count = n;
+    this->Min = std::min(this->Min, b.Min);
+    this->Max = std::max(this->Max, b.Max);
+  }
+
+  // count, min, max, mean, variance, skewness, kurtosis
+  void GetStatistics(std::vector<double> &stats) const
+  {
+    double var = this->Count > 0.0 ? this->M2/this->Count : 0.0;
+    double skew = this->M2 > 0.0 ?
+      std::sqrt(this->Count)*this->M3/std::pow(this->M2, 1.5) : 0.0;
+    double kurt = this->M2 > 0.0 ?
+      this->Count*this->M4/(this->M2*this->M2) - 3.0 : 0.0;
+
+    stats = {this->Count, this->Count > 0.0 ? this->Min : 0.0,
+      this->Count > 0.0 ? this->Max : 0.0, this->Mean, var, skew, kurt};
+  }
+
+  double Count;
+  double Mean;
+  double M2;
+  double M3;
+  double M4;
+  double Min;
+  double Max;
+};
+
+// MPI_Op merging arrays of Moments
+void MergeMoments(void *in, void *inout, int *len, MPI_Datatype *)
+{
+  const Moments *pin = static_cast<const Moments*>(in);
+  Moments *pio = static_cast<Moments*>(inout);
+  for (int i = 0; i < *len; ++i)
+    pio[i].Merge(pin[i]);
+}
+
+// accumulates the moments of the non ghost values of a block. the block is
+// processed in chunks that stay in cache. the mean of a chunk is computed
+// first and then its central sums, both loops are free of loop carried
+// dependencies other than the sums and vectorize. the chunk is merged into
+// the result using the pairwise update.
+template <typename n_t>
+void Accumulate(const n_t *x, const unsigned char *ghost, long n,
+  Moments &mom)
+{
+  const long chunkSize = 1024;
+  for (long i0 = 0; i0 < n; i0 += chunkSize)
+    {
+    long i1 = std::min(n, i0 + chunkSize);
+
+    double cnt = 0.0;
+    double sum = 0.0;
+    double mn = std::numeric_limits<double>::max();
+    double mx = std::numeric_limits<double>::lowest();
+    for (long i = i0; i < i1; ++i)
+      {
+      double w = (ghost && ghost[i]) ? 0.0 : 1.0;
+      double v = static_cast<double>(x[i]);
+      cnt += w;
+      sum += w*v;
+      mn = w > 0.0 ? std::min(mn, v) : mn;
+      mx = w > 0.0 ? std::max(mx, v) : mx;
+      }
+
+    if (cnt <= 0.0)
+      continue;
+
+    Moments cm;
+    cm.Count = cnt;
+    cm.Mean = sum/cnt;
+    cm.Min = mn;
+    cm.Max = mx;
+
+    double m2 = 0.0;
+    double m3 = 0.0;
+    double m4 = 0.0;
+    for (long i = i0; i < i1; ++i)
+      {
+      double w = (ghost && ghost[i]) ? 0.0 : 1.0;
+      double d = static_cast<double>(x[i]) - cm.Mean;
+      double d2 = d*d;
+      m2 += w*d2;
+      m3 += w*d2*d;
+      m4 += w*d2*d2;
+      }
+
+    cm.M2 = m2;
+    cm.M3 = m3;
+    cm.M4 = m4;
+
+    mom.Merge(cm);
+    }
+}
+
+// accumulate the moments of an array of any type. multi-component arrays
+// are reduced to the magnitude
+int Accumulate(vtkDataArray *da, vtkUnsignedCharArray *ghosts, Moments &mom)
+{
+  long nTups = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+
+  const unsigned char *pGhosts = ghosts ? ghosts->GetPointer(0) : nullptr;
+
+  if ((nComps == 1) && da->HasStandardMemoryLayout())
+    {
+    switch (da->GetDataType())
+      {
+      vtkTemplateMacro(
+        Accumulate(static_cast<const VTK_TT*>(da->GetVoidPointer(0)),
+          pGhosts, nTups, mom);
+        );
+      default:
+        SENSEI_ERROR("Invalid data array type " << da->GetClassName())
+        return -1;
+      }
+    return 0;
+    }
+
+  // a single component with a non-standard layout, keep the sign
+  if (nComps == 1)
+    {
+    std::vector<double> vals(nTups);
+    for (long i = 0; i < nTups; ++i)
+      vals[i] = da->GetComponent(i, 0);
+
+    Accumulate(vals.data(), pGhosts, nTups, mom);
+
+    return 0;
+    }
+
+  std::vector<double> mag(nTups);
+  std::vector<double> tup(nComps);
+  for (long i = 0; i < nTups; ++i)
+    {
+    da->GetTuple(i, tup.data());
+    double m = 0.0;
+    for (int j = 0; j < nComps; ++j)
+      m += tup[j]*tup[j];
+    mag[i] = std::sqrt(m);
+    }
+
+  Accumulate(mag.data(), pGhosts, nTups, mom);
+
+  return 0;
+}
+
+// print the statistics of one array
+void Print(std::ostream &os, const Moments &mom)
+{
+  std::vector<double> st;
+  mom.GetStatistics(st);
+
+  os << "count " << static_cast<long>(st[0]) << " min " << st[1]
+    << " max " << st[2] << " mean " << st[3] << " variance " << st[4]
+    << " skewness " << st[5] << " kurtosis " << st[6];
+}
+
+// identifies an array of a mesh
+struct ArrayId
+{
+  int Association;
+  std::string Name;
+};
+}
+
+struct Statistics::InternalsType
+{
+  InternalsType() : MomentsType(MPI_DATATYPE_NULL), MergeOp(MPI_OP_NULL) {}
+
+  // create the datatype and reduction operator
+  void Initialize();
+
+  // free the datatype and reduction operator
+  void Finalize();
+
+  // get the result key of an array
+  static std::string GetKey(const std::string &mesh, int assoc,
+    const std::string &array)
+  { return mesh + "/" + VTKUtils::GetAttributesName(assoc) + "/" + array; }
+
+  MPI_Datatype MomentsType;
+  MPI_Op MergeOp;
+
+  // the global moments of the most recent steps, per mesh, the most recent
+  // at the back
+  std::map<std::string, std::deque<std::vector<Moments>>> History;
+
+  // the latest result and the window result, per array
+  std::map<std::string, Moments> Current;
+  std::map<std::string, Moments> Windowed;
+};
+
+// --------------------------------------------------------------------------
+void Statistics::InternalsType::Initialize()
+{
+  if (this->MomentsType != MPI_DATATYPE_NULL)
+    return;
+
+  MPI_Type_contiguous(sizeof(Moments)/sizeof(double), MPI_DOUBLE,
+    &this->MomentsType);
+
+  MPI_Type_commit(&this->MomentsType);
+
+  MPI_Op_create(MergeMoments, 1, &this->MergeOp);
+}
+
+// --------------------------------------------------------------------------
+void Statistics::InternalsType::Finalize()
+{
+  if (this->MomentsType != MPI_DATATYPE_NULL)
+    MPI_Type_free(&this->MomentsType);
+
+  if (this->MergeOp != MPI_OP_NULL)
+    MPI_Op_free(&this->MergeOp);
+
+  this->History.clear();
+}
+
+//-----------------------------------------------------------------------------
+senseiNewMacro(Statistics);
+
+//-----------------------------------------------------------------------------
+Statistics::Statistics() : Window(0), PerBlock(0),
+  Internals(new InternalsType)
+{
+}
+
+//-----------------------------------------------------------------------------
+Statistics::~Statistics()
+{
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+
+  if (!finalized)
+    this->Internals->Finalize();
+
+  delete this->Internals;
+}
+
+//-----------------------------------------------------------------------------
+int Statistics::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Statistics::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Statistics::GetStatistics(const std::string &meshName, int association,
+  const std::string &arrayName, std::vector<double> &stats, bool windowed)
+{
+  std::map<std::string, Moments> &res = windowed ?
+    this->Internals->Windowed : this->Internals->Current;
+
+  std::string key =
+    InternalsType::GetKey(meshName, association, arrayName);
+
+  std::map<std::string, Moments>::iterator it = res.find(key);
+  if (it == res.end())
+    {
+    SENSEI_ERROR("No " << (windowed ? "window " : "") << "statistics for "
+      << VTKUtils::GetAttributesName(association) << " data array \""
+      << arrayName << "\" on mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  it->second.GetStatistics(stats);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool Statistics::Execute(DataAdaptor* data)
+{
+  TimeEvent<128> mark("Statistics::Execute");
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  this->Internals->Initialize();
+
+  // see what the simulation is providing
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(data))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  long step = data->GetDataTimeStep();
+  double time = data->GetDataTime();
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  for (; mit; ++mit)
+    {
+    const std::string &meshName = mit.MeshName();
+
+    MeshMetadataPtr mmd;
+    if (mdMap.GetMeshMetadata(meshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    // the arrays are processed in the same order on all ranks
+    std::vector<ArrayId> arrays;
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(meshName);
+    for (; ait; ++ait)
+      arrays.push_back({ait.Association(), ait.Array()});
+
+    unsigned int nArrays = arrays.size();
+    if (nArrays == 0)
+      continue;
+
+    // a failure on this rank is recorded and the rank goes on without its
+    // blocks. it's reported after the reduction below so that the other
+    // ranks are not left waiting
+    int ierr = 0;
+
+    // get the mesh and the arrays
+    vtkDataObject *mesh = nullptr;
+    if (data->GetMesh(meshName, true, mesh))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      mesh = nullptr;
+      ierr = -1;
+      }
+
+    if (mesh && (mmd->NumGhostCells || VTKUtils::AMR(mmd)) &&
+      data->AddGhostCellsArray(mesh, meshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
+      ierr = -1;
+      }
+
+    if (mesh && !ierr && mmd->NumGhostNodes &&
+      data->AddGhostNodesArray(mesh, meshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
+      ierr = -1;
+      }
+
+    for (unsigned int j = 0; mesh && !ierr && (j < nArrays); ++j)
+      {
+      if (data->AddArray(mesh, meshName, arrays[j].Association, arrays[j].Name))
+        {
+        SENSEI_ERROR(<< data->GetClassName() << " failed to add "
+          << VTKUtils::GetAttributesName(arrays[j].Association)
+          << " data array \"" << arrays[j].Name << "\"")
+        ierr = -1;
+        }
+      }
+
+    if (ierr && mesh)
+      {
+      mesh->Delete();
+      mesh = nullptr;
+      }
+
+    // collect the local blocks
+    std::vector<vtkDataObject*> blocks;
+    std::vector<long> blockIds;
+    if (vtkCompositeDataSet *cd = dynamic_cast<vtkCompositeDataSet*>(mesh))
+      {
+      vtkSmartPointer<vtkCompositeDataIterator> iter;
+      iter.TakeReference(cd->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+        {
+        blocks.push_back(iter->GetCurrentDataObject());
+        blockIds.push_back(iter->GetCurrentFlatIndex() - 1);
+        }
+      }
+    else if (mesh)
+      {
+      blocks.push_back(mesh);
+      blockIds.push_back(rank);
+      }
+
+    // compute the moments of each block and merge them into the local
+    // moments
+    unsigned int nBlocks = blocks.size();
+    std::vector<Moments> localMom(nArrays);
+    std::vector<Moments> blockMom(this->PerBlock ? nBlocks*nArrays : 0);
+    for (unsigned int i = 0; (i < nBlocks) && !ierr; ++i)
+      {
+      for (unsigned int j = 0; j < nArrays; ++j)
+        {
+        vtkFieldData *fd =
+          blocks[i]->GetAttributesAsFieldData(arrays[j].Association);
+
+        vtkDataArray *da = fd ? fd->GetArray(arrays[j].Name.c_str()) : nullptr;
+        if (!da)
+          {
+          SENSEI_WARNING("Block " << blockIds[i] << " has no "
+            << VTKUtils::GetAttributesName(arrays[j].Association)
+            << " data array \"" << arrays[j].Name << "\"")
+          continue;
+          }
+
+        vtkUnsignedCharArray *ghosts = dynamic_cast<vtkUnsignedCharArray*>(
+          fd->GetArray(vtkDataSetAttributes::GhostArrayName()));
+
+        Moments mom;
+        if (Accumulate(da, ghosts, mom))
+          {
+          ierr = -1;
+          break;
+          }
+
+        localMom[j].Merge(mom);
+
+        if (this->PerBlock)
+          blockMom[i*nArrays + j] = mom;
+        }
+      }
+
+    if (mesh)
+      mesh->Delete();
+
+    // merge the moments of all arrays across ranks
+    std::vector<Moments> globalMom(nArrays);
+    MPI_Allreduce(localMom.data(), globalMom.data(), nArrays,
+      this->Internals->MomentsType, this->Internals->MergeOp, comm);
+
+    // all ranks agree on failure so that none go on to the next mesh alone
+    MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, comm);
+    if (ierr)
+      {
+      SENSEI_ERROR("Failed to compute the moments of mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    // merge the steps in the window
+    std::vector<Moments> windowMom;
+    if (this->Window > 1)
+      {
+      std::deque<std::vector<Moments>> &hist = this->Internals->History[meshName];
+
+      hist.push_back(globalMom);
+      while (hist.size() > static_cast<unsigned int>(this->Window))
+        hist.pop_front();
+
+      windowMom.resize(nArrays);
+      for (unsigned int k = 0; k < hist.size(); ++k)
+        for (unsigned int j = 0; j < nArrays; ++j)
+          windowMom[j].Merge(hist[k][j]);
+      }
+
+    // cache the results, the simulation can access them
+    for (unsigned int j = 0; j < nArrays; ++j)
+      {
+      std::string key = InternalsType::GetKey(meshName,
+        arrays[j].Association, arrays[j].Name);
+
+      this->Internals->Current[key] = globalMom[j];
+
+      if (this->Window > 1)
+        this->Internals->Windowed[key] = windowMom[j];
+      }
+
+    // gather the per block results to rank 0
+    std::vector<long> allBlockIds;
+    std::vector<Moments> allBlockMom;
+    if (this->PerBlock)
+      {
+      int nLocal = nBlocks;
+      std::vector<int> counts(nRanks);
+      MPI_Gather(&nLocal, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm);
+
+      std::vector<int> displ(nRanks, 0);
+      for (int i = 1; i < nRanks; ++i)
+        displ[i] = displ[i-1] + counts[i-1];
+
+      int nTotal = rank == 0 ? displ[nRanks-1] + counts[nRanks-1] : 0;
+      allBlockIds.resize(nTotal);
+
+      MPI_Gatherv(blockIds.data(), nLocal, MPI_LONG, allBlockIds.data(),
+        counts.data(), displ.data(), MPI_LONG, 0, comm);
+
+      for (int i = 0; i < nRanks; ++i)
+        {
+        counts[i] *= nArrays;
+        displ[i] *= nArrays;
+        }
+
+      allBlockMom.resize(nTotal*nArrays);
+
+      MPI_Gatherv(blockMom.data(), nLocal*nArrays, this->Internals->MomentsType,
+        allBlockMom.data(), counts.data(), displ.data(),
+        this->Internals->MomentsType, 0, comm);
+      }
+
+    if (rank != 0)
+      continue;
+
+    // report the results
+    std::ostringstream oss;
+    oss << std::setprecision(8)
+      << "Statistics mesh \"" << meshName << "\" step " << step
+      << " time " << time << std::endl;
+
+    for (unsigned int j = 0; j < nArrays; ++j)
+      {
+      oss << "  " << VTKUtils::GetAttributesName(arrays[j].Association)
+        << " data array \"" << arrays[j].Name << "\" ";
+      Print(oss, globalMom[j]);
+      oss << std::endl;
+
+      if (this->Window > 1)
+        {
+        oss << "    last " << this->Internals->History[meshName].size()
+          << " steps ";
+        Print(oss, windowMom[j]);
+        oss << std::endl;
+        }
+
+      unsigned int nTotal = allBlockIds.size();
+      for (unsigned int i = 0; i < nTotal; ++i)
+        {
+        oss << "    block " << allBlockIds[i] << " ";
+        Print(oss, allBlockMom[i*nArrays + j]);
+        oss << std::endl;
+        }
+      }
+
+    if (this->FileName.empty())
+      {
+      std::cout << oss.str();
+      }
+    else
+      {
+      std::ostringstream fname;
+      fname << this->FileName << "_" << meshName << "_" << step << ".txt";
+
+      std::ofstream ofs(fname.str());
+      if (!ofs.good())
+        {
+        SENSEI_ERROR("Failed to open \"" << fname.str() << "\"")
+        return false;
+        }
+
+      ofs << oss.str();
+      }
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int Statistics::Finalize()
+{
+  this->Internals->Finalize();
+  return 0;
+}
+
+}
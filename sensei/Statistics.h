@@ -0,0 +1,80 @@
+#ifndef sensei_Statistics_h
+#define sensei_Statistics_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/// @class Statistics
+/// @brief Computes descriptive statistics of one or more arrays.
+///
+/// For each requested array the count, min, max, mean, variance, skewness
+/// and excess kurtosis of the non-ghost values are computed over all blocks
+/// on all ranks. Moments are accumulated in a single pass over each block
+/// and merged pairwise (Welford/Chan), all arrays of a mesh are reduced in
+/// one MPI_Allreduce. Optionally the statistics of each block are reported
+/// and the global moments of the last N steps are merged into running
+/// window statistics. Arrays with more than one component are reduced to
+/// their magnitude.
+class Statistics : public AnalysisAdaptor
+{
+public:
+  static Statistics* New();
+  senseiTypeMacro(Statistics, AnalysisAdaptor);
+
+  /// the meshes and arrays to compute statistics of
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  /// the number of steps merged into the window statistics. values less
+  /// than 2 disable the window.
+  void SetWindow(int window) { this->Window = window; }
+  int GetWindow() { return this->Window; }
+
+  /// when set the statistics of each block are also reported
+  void SetPerBlock(int val) { this->PerBlock = val; }
+  int GetPerBlock() { return this->PerBlock; }
+
+  /// results are written to <fileName>_<mesh>_<step>.txt. when empty
+  /// results are written to stdout
+  void SetFileName(const std::string &fileName) { this->FileName = fileName; }
+
+  /// get the result of the last step, or of the current window, for the
+  /// named array. the result is available on all ranks and is ordered
+  /// count, min, max, mean, variance, skewness, kurtosis.
+  int GetStatistics(const std::string &meshName, int association,
+    const std::string &arrayName, std::vector<double> &stats,
+    bool windowed = false);
+
+  bool Execute(DataAdaptor* data) override;
+
+  int Finalize() override;
+
+protected:
+  Statistics();
+  ~Statistics();
+
+  Statistics(const Statistics&) = delete;
+  void operator=(const Statistics&) = delete;
+
+private:
+  DataRequirements Requirements;
+  int Window;
+  int PerBlock;
+  std::string FileName;
+
+  struct InternalsType;
+  InternalsType *Internals;
+};
+
+}
+
+#endif
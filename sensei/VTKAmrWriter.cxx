@@ -142,6 +142,10 @@ bool VTKAmrWriter::Execute(DataAdaptor* dataAdaptor)
   int rank = 0;
   MPI_Comm_rank(this->GetCommunicator(), &rank);
 
+  // pass AMR level limits to the simulation so that finer patches
+  // are never built nor written
+  MaxLevelScope levels(this->Requirements, dataAdaptor);
+
   // see what the simulation is providing
   MeshMetadataMap mdMap;
   if (mdMap.Initialize(dataAdaptor))
@@ -55,8 +55,7 @@
 #include <vtkSmartPointer.h>
 #include <vtkIntArray.h>
 #include <vtkVersionMacros.h>
-#if ((VTK_VERSION_MAJOR >= 8) && (VTK_VERSION_MINOR >= 2))
-#include <vtkAOSDataArrayTemplate.h>
+#if (VTK_MAJOR_VERSION > 8) || ((VTK_MAJOR_VERSION == 8) && (VTK_MINOR_VERSION >= 2))
 #include <vtkSOADataArrayTemplate.h>
 #endif
 #if defined(ENABLE_VTK_IO)
@@ -69,8 +68,13 @@
 
 #include <sstream>
 #include <functional>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <mpi.h>
 
+#include <sdiy/thread-pool.hpp>
+
 using vtkDataObjectPtr = vtkSmartPointer<vtkDataObject>;
 using vtkCompositeDataIteratorPtr = vtkSmartPointer<vtkCompositeDataIterator>;
 
@@ -859,57 +863,100 @@ vtkCompositeDataSetPtr AsCompositeData(MPI_Comm comm,
   return cd;
 }
 
-/*
-int arrayCpy(void *&wptr, vtkDataArray *da)
+// --------------------------------------------------------------------------
+unsigned long long arraySize(vtkDataArray *da)
 {
-  unsigned long nt = da->GetNumberOfTuples();
+  return da->GetNumberOfTuples()*da->GetNumberOfComponents()*
+    Size(da->GetDataType());
+}
+
+// --------------------------------------------------------------------------
+// copies an array that is not in the AOS layout, interleaving the components
+template <typename n_t>
+void interleavedCpy(n_t *pw, vtkDataArray *da)
+{
+  unsigned long long nt = da->GetNumberOfTuples();
   unsigned int nc = da->GetNumberOfComponents();
 
+#if (VTK_MAJOR_VERSION > 8) || ((VTK_MAJOR_VERSION == 8) && (VTK_MINOR_VERSION >= 2))
+  if (vtkSOADataArrayTemplate<n_t> *soada =
+    dynamic_cast<vtkSOADataArrayTemplate<n_t>*>(da))
+    {
+    for (unsigned int j = 0; j < nc; ++j)
+      {
+      const n_t *pc = soada->GetComponentArrayPointer(j);
+      for (unsigned long long q = 0; q < nt; ++q)
+        pw[q*nc + j] = pc[q];
+      }
+    return;
+    }
+#endif
+
+  // some other implicit layout, go through the generic API
+  for (unsigned long long q = 0; q < nt; ++q)
+    for (unsigned int j = 0; j < nc; ++j)
+      pw[q*nc + j] = static_cast<n_t>(da->GetComponent(q, j));
+}
+
+// --------------------------------------------------------------------------
+// copies the array's data to wptr in AOS order and advances wptr past it
+int arrayCpy(unsigned char *&wptr, vtkDataArray *da)
+{
+  if (da->HasStandardMemoryLayout())
+    {
+    unsigned long long nb = arraySize(da);
+    memcpy(wptr, da->GetVoidPointer(0), nb);
+    wptr += nb;
+    return 0;
+    }
+
   switch (da->GetDataType())
     {
     vtkTemplateMacro(
-      if (vtkAOSDataArrayTemplate<VTK_TT> *aosda =
-        dynamic_cast<vtkAOSDataArrayTemplate<VTK_TT>*>(da))
-        {
-        unsigned long long nb = nt*nc*sizeof(VTK_TT);
-        VTK_TT *pda = aosda->GetPointer(0);
-        memcpy(wptr, pda, nb);
-        ((char*)wptr) += nb;
-        }
-      else if (vtkSOADataArrayTemplate<VTK_TT> *soada =
-        dynamic_cast<vtkSOADataArrayTemplate<VTK_TT>*>(da))
-        {
-        unsigned long long nb = nt*sizeof(VTK_TT);
-        for (unsigned int j = 0; j < nc; ++j)
-          {
-          VTK_TT *pda = soada->GetComponentArrayPointer(j);
-          memcpy(wptr, pda, nb);
-          ((char*)wptr) += nb;
-          }
-        }
-      else
-        {
-        SENSEI_ERROR("Invalid data array type " << da->GetClassName())
-        return -1;
-        }
-    )
+      interleavedCpy(reinterpret_cast<VTK_TT*>(wptr), da);
+      wptr += arraySize(da);
+      );
+    default:
+      SENSEI_ERROR("Invalid data array type " << da->GetClassName())
+      return -1;
     }
 
   return 0;
 }
 
+// --------------------------------------------------------------------------
+vtkDataArray *getArray(vtkDataSet *ds, const std::string &name, int centering)
+{
+  vtkFieldData *fd = GetAttributes(ds, centering);
+  vtkDataArray *da = fd ? fd->GetArray(name.c_str()) : nullptr;
+  if (!da)
+    {
+    SENSEI_ERROR("Failed to get " << GetAttributesName(centering)
+      << " data array \"" << name << "\"")
+    }
+  return da;
+}
 
 // --------------------------------------------------------------------------
-int DataArraySerializer::operator()(vtkDataSet *ds)
+int DataArraySerializer::GetSize(vtkDataSet *ds, unsigned long long &nBytes)
 {
-  vtkDataArray *da = m_centering == vtkDataObject::POINT ?
-    ds->GetPointData()->GetName(m_name) : ds->GetCellData()->GetName(m_name);
+  vtkDataArray *da = getArray(ds, this->Name, this->Centering);
+  if (!da)
+    return -1;
+
+  nBytes = arraySize(da);
+  return 0;
+}
 
-  if (!da || arrayCpy(m_write_ptr, da))
+// --------------------------------------------------------------------------
+int DataArraySerializer::Copy(vtkDataSet *ds, unsigned char *wptr)
+{
+  vtkDataArray *da = getArray(ds, this->Name, this->Centering);
+  if (!da || arrayCpy(wptr, da))
     {
     SENSEI_ERROR("Failed to serialize "
-      << GetAttributesName(m_centering) << " data array \""
-      << m_name << "\"")
+      << GetAttributesName(this->Centering) << " data array \""
+      << this->Name << "\"")
     return -1;
     }
 
@@ -917,17 +964,48 @@ int DataArraySerializer::operator()(vtkDataSet *ds)
 }
 
 // --------------------------------------------------------------------------
-int PointsSerializer::operator()(vtkDataSet *ds)
+const void *DataArraySerializer::GetPointer(vtkDataSet *ds)
 {
-  vtkPointSet *ps = dynamic_cast<vtkPointSet*>(ps);
+  vtkDataArray *da = getArray(ds, this->Name, this->Centering);
+  return da && da->HasStandardMemoryLayout() ? da->GetVoidPointer(0) : nullptr;
+}
+
+// --------------------------------------------------------------------------
+vtkDataArray *getPoints(vtkDataSet *ds)
+{
+  vtkPointSet *ps = dynamic_cast<vtkPointSet*>(ds);
   if (!ps)
     {
     SENSEI_ERROR("Invalid dataset type " << ds->GetClassName())
-    return -1;
+    return nullptr;
     }
 
-  vtkDataArray *da = ps->GetPoints()->GetData();
-  if (!da || arrayCpy(m_write_ptr, da))
+  vtkPoints *pts = ps->GetPoints();
+  if (!pts)
+    {
+    SENSEI_ERROR("Dataset has no points")
+    return nullptr;
+    }
+
+  return pts->GetData();
+}
+
+// --------------------------------------------------------------------------
+int PointsSerializer::GetSize(vtkDataSet *ds, unsigned long long &nBytes)
+{
+  vtkDataArray *da = getPoints(ds);
+  if (!da)
+    return -1;
+
+  nBytes = arraySize(da);
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int PointsSerializer::Copy(vtkDataSet *ds, unsigned char *wptr)
+{
+  vtkDataArray *da = getPoints(ds);
+  if (!da || arrayCpy(wptr, da))
     {
     SENSEI_ERROR("Failed to serialize points")
     return -1;
@@ -937,13 +1015,93 @@ int PointsSerializer::operator()(vtkDataSet *ds)
 }
 
 // --------------------------------------------------------------------------
-int CellTypesSerializer::operator()(vtkDataSet *ds)
+const void *PointsSerializer::GetPointer(vtkDataSet *ds)
+{
+  vtkDataArray *da = getPoints(ds);
+  return da && da->HasStandardMemoryLayout() ? da->GetVoidPointer(0) : nullptr;
+}
+
+// --------------------------------------------------------------------------
+vtkDataArray *getCoordinates(vtkDataSet *ds, int axis)
+{
+  vtkRectilinearGrid *rg = dynamic_cast<vtkRectilinearGrid*>(ds);
+  if (!rg)
+    {
+    SENSEI_ERROR("Invalid dataset type " << ds->GetClassName())
+    return nullptr;
+    }
+
+  vtkDataArray *da = axis == 0 ? rg->GetXCoordinates() :
+    (axis == 1 ? rg->GetYCoordinates() : rg->GetZCoordinates());
+
+  if (!da)
+    {
+    SENSEI_ERROR("Dataset has no coordinates for axis " << axis)
+    return nullptr;
+    }
+
+  return da;
+}
+
+// --------------------------------------------------------------------------
+int CoordinateSerializer::GetSize(vtkDataSet *ds, unsigned long long &nBytes)
+{
+  vtkDataArray *da = getCoordinates(ds, this->Axis);
+  if (!da)
+    return -1;
+
+  nBytes = arraySize(da);
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int CoordinateSerializer::Copy(vtkDataSet *ds, unsigned char *wptr)
+{
+  vtkDataArray *da = getCoordinates(ds, this->Axis);
+  if (!da || arrayCpy(wptr, da))
+    {
+    SENSEI_ERROR("Failed to serialize coordinates for axis " << this->Axis)
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+const void *CoordinateSerializer::GetPointer(vtkDataSet *ds)
+{
+  vtkDataArray *da = getCoordinates(ds, this->Axis);
+  return da && da->HasStandardMemoryLayout() ? da->GetVoidPointer(0) : nullptr;
+}
+
+// --------------------------------------------------------------------------
+int CellTypesSerializer::GetSize(vtkDataSet *ds, unsigned long long &nBytes)
+{
+  if (vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(ds))
+    {
+    nBytes = ug->GetNumberOfCells();
+    }
+  else if (vtkPolyData *pd = dynamic_cast<vtkPolyData*>(ds))
+    {
+    nBytes = pd->GetNumberOfVerts() + pd->GetNumberOfLines() +
+      pd->GetNumberOfPolys() + pd->GetNumberOfStrips();
+    }
+  else
+    {
+    SENSEI_ERROR("Invalid dataset type " << ds->GetClassName())
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int CellTypesSerializer::Copy(vtkDataSet *ds, unsigned char *wptr)
 {
-  vtkDataArray *da = nullptr;
   if (vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(ds))
     {
-    da = ug->GetCellTypesArray();
-    if (!da || arrayCpy(m_write_ptr, da))
+    vtkDataArray *da = ug->GetCellTypesArray();
+    if (da && arrayCpy(wptr, da))
       {
       SENSEI_ERROR("Failed to serialize cell types")
       return -1;
@@ -952,20 +1110,19 @@ int CellTypesSerializer::operator()(vtkDataSet *ds)
   else if (vtkPolyData *pd = dynamic_cast<vtkPolyData*>(ds))
     {
     vtkIdType nv = pd->GetNumberOfVerts();
-    memset(m_write_ptr, nv, VTK_VERTEX);
-    m_write_ptr += nv;
+    memset(wptr, VTK_VERTEX, nv);
+    wptr += nv;
 
     vtkIdType nl = pd->GetNumberOfLines();
-    memset(m_write_ptr, nl, VTK_LINE);
-    m_write_ptr += nl;
+    memset(wptr, VTK_LINE, nl);
+    wptr += nl;
 
     vtkIdType np = pd->GetNumberOfPolys();
-    memset(m_write_ptr, np, VTK_POLYGON);
-    m_write_ptr += np;
+    memset(wptr, VTK_POLYGON, np);
+    wptr += np;
 
     vtkIdType ns = pd->GetNumberOfStrips();
-    memset(m_write_ptr, ns, VTK_TRIANGLE_STRIP)
-    m_write_ptr += ns;
+    memset(wptr, VTK_TRIANGLE_STRIP, ns);
     }
   else
     {
@@ -977,47 +1134,36 @@ int CellTypesSerializer::operator()(vtkDataSet *ds)
 }
 
 // --------------------------------------------------------------------------
-int CellArraySerializer::operator()(vtkDataSet *ds)
+const void *CellTypesSerializer::GetPointer(vtkDataSet *ds)
+{
+  vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(ds);
+  vtkDataArray *da = ug ? ug->GetCellTypesArray() : nullptr;
+  return da ? da->GetVoidPointer(0) : nullptr;
+}
+
+// --------------------------------------------------------------------------
+// the cell arrays of the block, polydata cells are ordered verts, lines,
+// polys, strips. empty cell arrays are skipped.
+int getCellArrays(vtkDataSet *ds, std::vector<vtkCellArray*> &cas)
 {
-  vtkDataArray *da = nullptr;
   if (vtkUnstructuredGrid *ug = dynamic_cast<vtkUnstructuredGrid*>(ds))
     {
-    da = ug->GetCells()->GetData();
-    if (!da || arrayCpy(m_write_ptr, da))
-      {
-      SENSEI_ERROR("Failed to serialize cells")
-      return -1;
-      }
+    if (ug->GetCells())
+      cas.push_back(ug->GetCells());
     }
   else if (vtkPolyData *pd = dynamic_cast<vtkPolyData*>(ds))
     {
-    da = pd->GetVerts()->GetData();
-    if (!da || arrayCpy(m_write_ptr, da))
-      {
-      SENSEI_ERROR("Failed to serialize verts")
-      return -1;
-      }
+    if (pd->GetNumberOfVerts())
+      cas.push_back(pd->GetVerts());
 
-    da = pd->GetLines()->GetData();
-    if (!da || arrayCpy(m_write_ptr, da))
-      {
-      SENSEI_ERROR("Failed to serialize lines")
-      return -1;
-      }
+    if (pd->GetNumberOfLines())
+      cas.push_back(pd->GetLines());
 
-    da = pd->GetLines()->GetPolys();
-    if (!da || arrayCpy(m_write_ptr, da))
-      {
-      SENSEI_ERROR("Failed to serialize polys")
-      return -1;
-      }
+    if (pd->GetNumberOfPolys())
+      cas.push_back(pd->GetPolys());
 
-    da = pd->GetStrips()->GetData();
-    if (!da || arrayCpy(m_write_ptr, da))
-      {
-      SENSEI_ERROR("Failed to serialize strips")
-      return -1;
-      }
+    if (pd->GetNumberOfStrips())
+      cas.push_back(pd->GetStrips());
     }
   else
     {
@@ -1029,98 +1175,185 @@ int CellArraySerializer::operator()(vtkDataSet *ds)
 }
 
 // --------------------------------------------------------------------------
-int GetSizesAndOffsets(MPI_Comm comm,
-  const sensei::MeshMetadataPtr &md,
-  unsigned long long &num_points_total,
-  unsigned long long &num_points_local,
-  unsigned long long &point_offset_local,
-  unsigned long long &num_cells_total,
-  unsigned long long &num_cells_local,
-  unsigned long long &cell_offset_local,
-  unsigned long long &cell_array_size_total,
-  unsigned long long &cell_array_size_local,
-  unsigned long long &cell_array_offset_local)
+int CellArraySerializer::GetSize(vtkDataSet *ds, unsigned long long &nBytes)
 {
-  int rank = 0;
-  MPI_Comm_rank(comm, &rank);
+  std::vector<vtkCellArray*> cas;
+  if (getCellArrays(ds, cas))
+    return -1;
 
-  num_points_total = 0;
-  num_points_local = 0;
-  point_offset_local = 0;
-  num_cells_total = 0;
-  num_cells_local = 0;
-  cell_offset_local = 0;
-  cell_array_size_total = 0;
-  cell_array_size_local = 0;
-  cell_array_offset_local = 0;
-
-  // calculate the number of points and cells total
-  // and the local offset to each type of data
-  unsigned int num_blocks = md->NumBlocks;
-  for (unsigned int i = 0; i < num_blocks; ++i)
-    {
-    num_points_total += md->BlockNumPoints[i];
-    num_cells_total += md->BlockNumCells[i];
+  // this is the size of the legacy format, without converting to it
+  nBytes = 0;
+  unsigned int nCas = cas.size();
+  for (unsigned int i = 0; i < nCas; ++i)
+    nBytes += cas[i]->GetNumberOfConnectivityEntries()*sizeof(vtkIdType);
 
-    if ((md->BlockType == VTK_POLYDATA) || (md->MeshType == VTK_POLYDATA) ||
-     (md->BlockType == VTK_UNSTRUCTURED_GRID) || (md->MeshType == VTK_UNSTRUCTURED_GRID))
-     {
-     cell_array_size_total += md->BlockCellArraySize[i];
-     }
+  return 0;
+}
 
-    if (md->BlockOwner[i] < rank)
+// --------------------------------------------------------------------------
+int CellArraySerializer::Copy(vtkDataSet *ds, unsigned char *wptr)
+{
+  std::vector<vtkCellArray*> cas;
+  if (getCellArrays(ds, cas))
+    return -1;
+
+  unsigned int nCas = cas.size();
+  for (unsigned int i = 0; i < nCas; ++i)
+    {
+    vtkDataArray *da = cas[i]->GetData();
+    if (!da || arrayCpy(wptr, da))
       {
-      point_offset_local += md->BlockNumPoints[i];
-      cell_offset_local += md->BlockNumCells[i];
-      if ((md->BlockType == VTK_POLYDATA) || (md->MeshType == VTK_POLYDATA) ||
-        (md->BlockType == VTK_UNSTRUCTURED_GRID) || (md->MeshType == VTK_UNSTRUCTURED_GRID))
-        {
-        cell_array_offset_local += md->BlockCellArraySize[i];
-        }
+      SENSEI_ERROR("Failed to serialize cells")
+      return -1;
       }
-    else if (md->BlockOwner[i] == rank)
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int GetBlockOffsets(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, std::vector<unsigned long long> &offsets)
+{
+  unsigned int nBlocks = blocks.size();
+
+  offsets.resize(nBlocks + 1);
+  offsets[0] = 0;
+
+  for (unsigned int i = 0; i < nBlocks; ++i)
+    {
+    unsigned long long nBytes = 0;
+    if (serializer.GetSize(blocks[i], nBytes))
       {
-      num_points_local += md->BlockNumPoints[i]
-      num_cells_local += md->BlockNumCells[i]
-      if ((md->BlockType == VTK_POLYDATA) || (md->MeshType == VTK_POLYDATA) ||
-        (md->BlockType == VTK_UNSTRUCTURED_GRID) || (md->MeshType == VTK_UNSTRUCTURED_GRID))
-        {
-        cell_array_size_local += md->BlockCellArraySize[i];
-        }
+      SENSEI_ERROR("Failed to get the serialized size of block " << i)
+      return -1;
       }
+    offsets[i+1] = offsets[i] + nBytes;
     }
 
   return 0;
 }
 
 // --------------------------------------------------------------------------
-int GetLocalGeometrySizes(MPI_Comm comm,
-  const sensei::MeshMetadataPtr &md,
-  unsigned long long &num_points_local,
-  unsigned long long &num_cells_local,
-  unsigned long long &cell_array_size_local)
+int Serialize(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, const std::vector<unsigned long long> &offsets,
+  unsigned char *buffer, int nThreads)
 {
-  int rank = 0;
-  MPI_Comm_rank(comm, &rank);
+  int nBlocks = blocks.size();
 
-  unsigned int num_blocks = md->NumBlocks;
-  for (unsigned int i = 0; i < num_blocks; ++i)
+  // the blocks land in disjoint parts of the buffer so they can be
+  // copied in any order
+  if ((nThreads < 2) || (nBlocks < 2))
     {
-    if (md->BlockOwner[i] == rank)
+    for (int i = 0; i < nBlocks; ++i)
       {
-      num_points_local += md->BlockNumPoints[i]
-      num_cells_local += md->BlockNumCells[i]
-      if ((md->BlockType == VTK_POLYDATA) || (md->MeshType == VTK_POLYDATA) ||
-        (md->BlockType == VTK_UNSTRUCTURED_GRID) || (md->MeshType == VTK_UNSTRUCTURED_GRID))
+      if (serializer.Copy(blocks[i], buffer + offsets[i]))
         {
-        cell_array_size_local += md->BlockCellArraySize[i];
+        SENSEI_ERROR("Failed to serialize block " << i)
+        return -1;
         }
       }
+    return 0;
+    }
+
+  std::atomic<int> ierr(0);
+
+  sdiy::ThreadPool pool(std::min(nThreads, nBlocks));
+  pool.run(nBlocks, [&](int i, int)
+    {
+    if (serializer.Copy(blocks[i], buffer + offsets[i]))
+      ierr = -1;
+    });
+
+  if (ierr)
+    {
+    SENSEI_ERROR("Failed to serialize " << nBlocks << " blocks")
+    return -1;
     }
 
   return 0;
 }
-*/
+
+// --------------------------------------------------------------------------
+int Serialize(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, std::vector<unsigned char> &buffer,
+  int nThreads)
+{
+  std::vector<unsigned long long> offsets;
+  if (GetBlockOffsets(blocks, serializer, offsets))
+    return -1;
+
+  buffer.resize(offsets.back());
+
+  return Serialize(blocks, serializer, offsets, buffer.data(), nThreads);
+}
+
+// --------------------------------------------------------------------------
+int Serialize(vtkDataSet *ds, BlockSerializer &serializer,
+  std::vector<unsigned char> &buffer, const void *&data,
+  unsigned long long &nBytes)
+{
+  if (serializer.GetSize(ds, nBytes))
+    return -1;
+
+  // use the block's data in place
+  if ((data = serializer.GetPointer(ds)))
+    return 0;
+
+  if (buffer.size() < nBytes)
+    buffer.resize(nBytes);
+
+  if (serializer.Copy(ds, buffer.data()))
+    return -1;
+
+  data = buffer.data();
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void GetLocalBlockRuns(int rank, const std::vector<int> &blockOwner,
+  std::vector<BlockRun> &runs)
+{
+  runs.clear();
+
+  unsigned int numBlocks = blockOwner.size();
+  for (unsigned int j = 0; j < numBlocks; ++j)
+    {
+    if (blockOwner[j] != rank)
+      continue;
+
+    if (!runs.empty() && (runs.back().End == j))
+      runs.back().End = j + 1;
+    else
+      runs.push_back({j, j + 1});
+    }
+}
+
+// --------------------------------------------------------------------------
+int Serialize(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, std::vector<unsigned char> &buffer,
+  const void *&data, unsigned long long &nBytes)
+{
+  // a single block may be used in place
+  if (blocks.size() == 1)
+    return Serialize(blocks[0], serializer, buffer, data, nBytes);
+
+  std::vector<unsigned long long> offsets;
+  if (GetBlockOffsets(blocks, serializer, offsets))
+    return -1;
+
+  nBytes = offsets.back();
+  if (buffer.size() < nBytes)
+    buffer.resize(nBytes);
+
+  if (Serialize(blocks, serializer, offsets, buffer.data()))
+    return -1;
+
+  data = buffer.data();
+
+  return 0;
+}
 
 // helper for creating hexahedron
 static
@@ -129,6 +129,130 @@ inline bool LogicallyCartesian(const MeshMetadataPtr &md)
   return Structured(md) || UniformCartesian(md) || StretchedCartesian(md);
 }
 
+/// Serializers flatten some part of a block, an array, the points, or the
+/// cells, into a contiguous buffer. Data is always written in AOS order,
+/// SOA arrays are interleaved while they are copied. GetSize reports the
+/// exact number of bytes a block contributes and Copy writes that many bytes
+/// to wptr. Copy may be called concurrently on different blocks.
+class BlockSerializer
+{
+public:
+  virtual ~BlockSerializer() {}
+
+  /// get the number of bytes the block's data occupies when serialized
+  virtual int GetSize(vtkDataSet *ds, unsigned long long &nBytes) = 0;
+
+  /// serialize the block's data to wptr
+  virtual int Copy(vtkDataSet *ds, unsigned char *wptr) = 0;
+
+  /// when the block's data is held by a single AOS array return a pointer
+  /// to it so that it can be used in place, otherwise return nullptr
+  virtual const void *GetPointer(vtkDataSet *) { return nullptr; }
+};
+
+/// serializes the named point or cell data array
+class DataArraySerializer : public BlockSerializer
+{
+public:
+  DataArraySerializer(const std::string &name, int centering) :
+    Name(name), Centering(centering) {}
+
+  int GetSize(vtkDataSet *ds, unsigned long long &nBytes) override;
+  int Copy(vtkDataSet *ds, unsigned char *wptr) override;
+  const void *GetPointer(vtkDataSet *ds) override;
+
+private:
+  std::string Name;
+  int Centering;
+};
+
+/// serializes the points of a vtkPointSet
+class PointsSerializer : public BlockSerializer
+{
+public:
+  int GetSize(vtkDataSet *ds, unsigned long long &nBytes) override;
+  int Copy(vtkDataSet *ds, unsigned char *wptr) override;
+  const void *GetPointer(vtkDataSet *ds) override;
+};
+
+/// serializes the x, y, or z coordinates of a vtkRectilinearGrid
+class CoordinateSerializer : public BlockSerializer
+{
+public:
+  CoordinateSerializer(int axis) : Axis(axis) {}
+
+  int GetSize(vtkDataSet *ds, unsigned long long &nBytes) override;
+  int Copy(vtkDataSet *ds, unsigned char *wptr) override;
+  const void *GetPointer(vtkDataSet *ds) override;
+
+private:
+  int Axis;
+};
+
+/// serializes the cell types of an unstructured grid or polydata. polydata
+/// cells are ordered verts, lines, polys, strips.
+class CellTypesSerializer : public BlockSerializer
+{
+public:
+  int GetSize(vtkDataSet *ds, unsigned long long &nBytes) override;
+  int Copy(vtkDataSet *ds, unsigned char *wptr) override;
+  const void *GetPointer(vtkDataSet *ds) override;
+};
+
+/// serializes the cell array, in the legacy VTK format, of an unstructured
+/// grid or polydata. polydata cells are ordered verts, lines, polys, strips.
+class CellArraySerializer : public BlockSerializer
+{
+public:
+  int GetSize(vtkDataSet *ds, unsigned long long &nBytes) override;
+  int Copy(vtkDataSet *ds, unsigned char *wptr) override;
+};
+
+/// Computes the byte offset of each block in the serialized buffer. offsets
+/// gets one entry per block plus one, the last entry is the total size.
+int GetBlockOffsets(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, std::vector<unsigned long long> &offsets);
+
+/// Serializes the blocks into buffer at the offsets computed by
+/// GetBlockOffsets. The blocks are copied concurrently when nThreads > 1.
+int Serialize(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, const std::vector<unsigned long long> &offsets,
+  unsigned char *buffer, int nThreads = 1);
+
+/// Serializes the blocks into a single contiguous buffer, which is resized
+/// as needed. The blocks are copied concurrently when nThreads > 1.
+int Serialize(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, std::vector<unsigned char> &buffer,
+  int nThreads = 1);
+
+/// Serializes a single block. When the block's data can be used in place
+/// data points to it, otherwise the block is copied into buffer and data
+/// points there. nBytes is set to the size of the serialized data.
+int Serialize(vtkDataSet *ds, BlockSerializer &serializer,
+  std::vector<unsigned char> &buffer, const void *&data,
+  unsigned long long &nBytes);
+
+/// Serializes a run of blocks into a single contiguous buffer. A run of one
+/// block is used in place when possible. data points to the serialized run
+/// and nBytes is set to its size. buffer is only grown, so it can be reused
+/// across runs.
+int Serialize(const std::vector<vtkDataSet*> &blocks,
+  BlockSerializer &serializer, std::vector<unsigned char> &buffer,
+  const void *&data, unsigned long long &nBytes);
+
+/// A run of consecutive blocks owned by one rank. The transports lay blocks
+/// out in the global arrays in block order, so the blocks of a run are
+/// adjacent and can be written from a single contiguous buffer.
+struct BlockRun
+{
+  unsigned int First;  ///< first block in the run
+  unsigned int End;    ///< one past the last block in the run
+};
+
+/// Finds the runs of consecutive blocks owned by rank.
+void GetLocalBlockRuns(int rank, const std::vector<int> &blockOwner,
+  std::vector<BlockRun> &runs);
+
 // rank 0 writes a dataset for visualizing the domain decomp
 int WriteDomainDecomp(MPI_Comm comm, const sensei::MeshMetadataPtr &md,
   const std::string fileName);
@@ -96,6 +96,29 @@ void VTKmCDFAnalysis::Initialize(
   this->Helper->SetSampleSize(this->NumberOfQuantiles);
 }
 
+//-----------------------------------------------------------------------------
+void VTKmCDFAnalysis::SetNumberOfWriterThreads(int n)
+{
+  if (this->Helper)
+    this->Helper->SetNumberOfWriterThreads(n);
+}
+
+//-----------------------------------------------------------------------------
+void VTKmCDFAnalysis::SetRoundRobinWriting(bool val)
+{
+  if (this->Helper)
+    this->Helper->SetRoundRobinWriting(val);
+}
+
+//-----------------------------------------------------------------------------
+int VTKmCDFAnalysis::Finalize()
+{
+  // make sure the output is on disk
+  if (this->Helper)
+    this->Helper->Flush();
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 bool VTKmCDFAnalysis::Execute(DataAdaptor* data)
 {
@@ -24,9 +24,17 @@ public:
     int requestSize,
     MPI_Comm comm);
 
+  // number of threads writing the Cinema output in the background, call
+  // after Initialize. 0, the default, writes synchronously.
+  void SetNumberOfWriterThreads(int n);
+
+  // write the output of time step i on rank i % size rather than on rank 0,
+  // call after Initialize.
+  void SetRoundRobinWriting(bool val);
+
   bool Execute(DataAdaptor* data) override;
 
-  int Finalize() override { return 0; }
+  int Finalize() override;
 
 protected:
   VTKmCDFAnalysis();
@@ -14,26 +14,20 @@
 #include <vtkMultiBlockDataSet.h>
 #include <vtkCompositeDataSet.h>
 #include <vtkDataSet.h>
+#include <vtkDataArray.h>
+#include <vtkCellData.h>
+#include <vtkPolyData.h>
 #include <vtkMPIController.h>
 #include <vtkMPICommunicator.h>
 #include <vtkMPI.h>
 #include <vtkXMLPMultiBlockDataWriter.h>
-#include <vtkCompositeDataIterator.h>
 #include <vtkImageData.h>
-#include <vtkStructuredGridConnectivity.h>
 #include <vtkStructuredExtent.h>
-#include <vtkExtractVOI.h>
-#include <vtkStructuredPointsWriter.h>
-#include <vtkStructuredPointsReader.h>
-#include <vtkStructuredPoints.h>
-
-#include <sdiy/master.hpp>
-#include <sdiy/mpi.hpp>
 
 #include <algorithm>
 #include <vector>
 #include <sstream>
-#include <map>
+#include <cstring>
 
 
 namespace sensei
@@ -45,148 +39,450 @@ VTKmContourAnalysis *VTKmContourAnalysis::New() { return new VTKmContourAnalysis
 vtkStandardNewMacro(VTKmContourAnalysis);
 #endif
 
-//-----------------------------------------------------------------------------
-VTKmContourAnalysis::VTKmContourAnalysis()
+
+namespace
+{
+// number of layers of ghost cells exchanged
+const int NumberOfGhosts = 2;
+
+// tag of the ghost exchange messages
+const int GhostTag = 4001;
+
+// --------------------------------------------------------------------------
+// intersect two point extents. returns false if they are disjoint.
+bool intersect(const int *a, const int *b, int *c)
 {
+  for (int i = 0; i < 3; ++i)
+    {
+    c[2*i] = std::max(a[2*i], b[2*i]);
+    c[2*i+1] = std::min(a[2*i+1], b[2*i+1]);
+    if (c[2*i] > c[2*i+1])
+      return false;
+    }
+  return true;
 }
 
-//-----------------------------------------------------------------------------
-VTKmContourAnalysis::~VTKmContourAnalysis()
+// --------------------------------------------------------------------------
+// the region of data, a block's point extent, that lies in the ghosted
+// extent of another block. returns false if the region has no cells. in
+// flat directions, where the block is one point thick, the single layer of
+// cells is kept.
+bool ghostRegion(const int *data, const int *ghosted, int *region)
 {
+  if (!intersect(data, ghosted, region))
+    return false;
+
+  for (int i = 0; i < 3; ++i)
+    {
+    if ((data[2*i] != data[2*i+1]) && (region[2*i] == region[2*i+1]))
+      return false;
+    }
+
+  return true;
 }
 
-//-----------------------------------------------------------------------------
-void VTKmContourAnalysis::Initialize(const std::string& meshName,
-  const std::string& arrayName, double value, bool writeOutput)
+// --------------------------------------------------------------------------
+// convert a point extent to a cell extent. flat directions keep one cell.
+void cellExtent(const int *pext, int *cext)
 {
-  this->MeshName = meshName;
-  this->ArrayName = arrayName;
-  this->Value = value;
-  this->WriteOutput = writeOutput;
+  for (int i = 0; i < 3; ++i)
+    {
+    cext[2*i] = pext[2*i];
+    cext[2*i+1] = std::max(pext[2*i], pext[2*i+1] - 1);
+    }
+}
+
+// --------------------------------------------------------------------------
+// copy the cells of region, a point extent, between the cell array of a
+// dataset with point extent ext and a packed buffer. when pack is true the
+// cells are copied from the array into the buffer, otherwise from the buffer
+// into the array.
+void copyRegion(vtkDataArray *da, const int *ext, const int *region,
+  unsigned char *buffer, bool pack)
+{
+  int cext[6];
+  cellExtent(ext, cext);
+
+  int creg[6];
+  cellExtent(region, creg);
+
+  long nx = cext[1] - cext[0] + 1;
+  long ny = cext[3] - cext[2] + 1;
+
+  long tupleSize = da->GetNumberOfComponents()*da->GetDataTypeSize();
+  long rowSize = (creg[1] - creg[0] + 1)*tupleSize;
+
+  unsigned char *data = static_cast<unsigned char*>(da->GetVoidPointer(0));
+
+  for (int k = creg[4]; k <= creg[5]; ++k)
+    {
+    for (int j = creg[2]; j <= creg[3]; ++j)
+      {
+      long id = ((k - cext[4])*ny + (j - cext[2]))*nx + (creg[0] - cext[0]);
+      unsigned char *row = data + id*tupleSize;
+
+      if (pack)
+        memcpy(buffer, row, rowSize);
+      else
+        memcpy(row, buffer, rowSize);
+
+      buffer += rowSize;
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+// number of cells in region, a point extent
+long numberOfCells(const int *region)
+{
+  int creg[6];
+  cellExtent(region, creg);
+  return long(creg[1] - creg[0] + 1)*long(creg[3] - creg[2] + 1)*
+    long(creg[5] - creg[4] + 1);
+}
+
+// a region of cells sent to, or received from, a block on another rank
+struct GhostLink
+{
+  int Rank;        // rank of the other block
+  long Source;     // global id of the sending block
+  long Dest;       // global id of the receiving block
+  int Local;       // local index of the block on this rank
+  int Region[6];   // point extent of the cells exchanged
+  std::vector<unsigned char> Buffer;
+};
+
+// the order in which messages are posted. a rank sends, and its peer
+// receives, in this order so that messages with the same tag match
+bool operator<(const GhostLink &l, const GhostLink &r)
+{
+  if (l.Rank != r.Rank)
+    return l.Rank < r.Rank;
+
+  if (l.Dest != r.Dest)
+    return l.Dest < r.Dest;
+
+  return l.Source < r.Source;
 }
 
-struct Block
+// --------------------------------------------------------------------------
+// a uniform grid of bins over the whole index space. each block is placed in
+// every bin its extent overlaps. the bin size is the largest block size in
+// each direction so that blocks land in a few bins and queries for a
+// ghosted extent visit a few bins.
+class BlockIndex
 {
-  Block(int* extent, int gl, vtkImageData* data,  vtkImageData* ghosted,
-        vtkStructuredGridConnectivity* con)
-       : GhostLevels(gl), Data(data), GhostedData(ghosted), Connectivity(con), Neighbors(0)
+public:
+  BlockIndex(const int *wholeExtent, const std::vector<int> &extents)
   {
-    memcpy(this->Extent, extent, 6*sizeof(int));
+    long nBlocks = extents.size()/6;
+
+    for (int i = 0; i < 3; ++i)
+      {
+      this->Origin[i] = wholeExtent[2*i];
+      this->BinSize[i] = 1;
+      }
+
+    for (long q = 0; q < nBlocks; ++q)
+      {
+      const int *ext = &extents[6*q];
+      for (int i = 0; i < 3; ++i)
+        this->BinSize[i] = std::max(this->BinSize[i], ext[2*i+1] - ext[2*i]);
+      }
+
+    for (int i = 0; i < 3; ++i)
+      this->NumBins[i] = (wholeExtent[2*i+1] - wholeExtent[2*i])/this->BinSize[i] + 1;
+
+    this->Bins.resize(long(this->NumBins[0])*this->NumBins[1]*this->NumBins[2]);
+
+    for (long q = 0; q < nBlocks; ++q)
+      {
+      int bins[6];
+      this->GetBins(&extents[6*q], bins);
+      for (int k = bins[4]; k <= bins[5]; ++k)
+        for (int j = bins[2]; j <= bins[3]; ++j)
+          for (int i = bins[0]; i <= bins[1]; ++i)
+            this->Bins[(long(k)*this->NumBins[1] + j)*this->NumBins[0] + i].push_back(q);
+      }
   }
 
-  ~Block()
+  // get the ids of the blocks that may intersect the extent
+  void Query(const int *ext, std::vector<long> &ids) const
   {
-    delete this->Neighbors;
+    ids.clear();
+
+    int bins[6];
+    this->GetBins(ext, bins);
+    for (int k = bins[4]; k <= bins[5]; ++k)
+      for (int j = bins[2]; j <= bins[3]; ++j)
+        for (int i = bins[0]; i <= bins[1]; ++i)
+          {
+          const std::vector<long> &bin =
+            this->Bins[(long(k)*this->NumBins[1] + j)*this->NumBins[0] + i];
+          ids.insert(ids.end(), bin.begin(), bin.end());
+          }
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
   }
 
-  int Extent[6];
-  int GhostLevels;
-  vtkImageData* Data;
-  vtkImageData* GhostedData;
-  vtkStructuredGridConnectivity* Connectivity;
-  std::map<vtkIdType, vtkStructuredNeighbor>* Neighbors;
+private:
+  void GetBins(const int *ext, int *bins) const
+  {
+    for (int i = 0; i < 3; ++i)
+      {
+      bins[2*i] = std::max(0, (ext[2*i] - this->Origin[i])/this->BinSize[i]);
+      bins[2*i+1] = std::min(this->NumBins[i] - 1,
+        (ext[2*i+1] - this->Origin[i])/this->BinSize[i]);
+      }
+  }
+
+  int Origin[3];
+  int BinSize[3];
+  int NumBins[3];
+  std::vector<std::vector<long>> Bins;
+};
+}
+
+struct VTKmContourAnalysis::InternalsType
+{
+  InternalsType() : Comm(MPI_COMM_NULL), ArrayType(-1), NumComponents(0) {}
+  ~InternalsType();
+
+  // frees the requests and the communicator
+  void Release();
+
+  // finds the neighbors of the local blocks
+  int UpdateLinks(const std::vector<vtkImageData*> &datasets);
+
+  // allocates buffers and creates the persistent requests
+  int UpdateRequests();
+
+  // frees the persistent requests
+  void FreeRequests();
+
+  // exchanges NumberOfGhosts layers of ghost cells of the named cell data
+  // array between blocks. A new set of datasets with ghost levels is
+  // returned.
+  vtkSmartPointer<vtkMultiBlockDataSet> ExchangeGhosts(MPI_Comm comm,
+    vtkDataObject *mesh, const std::string &arrayName);
+
+  MPI_Comm Comm;                      // duplicate used for the exchange
+  std::vector<int> Extents;           // extents of the local blocks
+  std::vector<int> GhostedExtents;    // ghosted extents of the local blocks
+  std::vector<GhostLink> Sends;
+  std::vector<GhostLink> Recvs;
+  std::vector<MPI_Request> Requests;  // receives first, then sends
+  int ArrayType;
+  int NumComponents;
 };
 
-void SendGhostRegion(Block* b, const sdiy::Master::ProxyWithLink& cp,
-  std::vector<int>& ext, sdiy::BlockID& target)
+//-----------------------------------------------------------------------------
+VTKmContourAnalysis::InternalsType::~InternalsType()
+{
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (!finalized)
+    this->Release();
+}
+
+//-----------------------------------------------------------------------------
+void VTKmContourAnalysis::InternalsType::Release()
 {
-  vtkNew<vtkExtractVOI> evoi;
-  evoi->SetInputData(b->GhostedData);
-  evoi->SetVOI(&ext[0]);
-  evoi->Update();
+  this->FreeRequests();
 
-  vtkNew<vtkStructuredPointsWriter> writer;
-  writer->SetWriteToOutputString(1);
-  writer->SetFileTypeToBinary();
-  writer->SetInputData(evoi->GetOutput());
-  writer->SetWriteExtent(true);
-  writer->Write();
+  if (this->Comm != MPI_COMM_NULL)
+    MPI_Comm_free(&this->Comm);
 
-  unsigned char* buffer = writer->GetBinaryOutputString();
-  int len = writer->GetOutputStringLength();
+  this->Extents.clear();
+  this->GhostedExtents.clear();
+  this->Sends.clear();
+  this->Recvs.clear();
+  this->ArrayType = -1;
+  this->NumComponents = 0;
+}
 
-  std::vector<unsigned char> bufferv(buffer, buffer+len);
+//-----------------------------------------------------------------------------
+void VTKmContourAnalysis::InternalsType::FreeRequests()
+{
+  unsigned int nReqs = this->Requests.size();
+  for (unsigned int i = 0; i < nReqs; ++i)
+    MPI_Request_free(&this->Requests[i]);
 
-  cp.enqueue(target, bufferv);
+  this->Requests.clear();
 }
 
-void SendGhosts(Block* b,
-                const sdiy::Master::ProxyWithLink& cp,
-                void*)
+//-----------------------------------------------------------------------------
+int VTKmContourAnalysis::InternalsType::UpdateLinks(
+  const std::vector<vtkImageData*> &datasets)
 {
-  sdiy::Link*    l = cp.link();
-  for (int i = 0; i < l->size(); ++i)
+  TimeEvent<128> mark("VTKmContourAnalysis::UpdateLinks");
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(this->Comm, &rank);
+  MPI_Comm_size(this->Comm, &nRanks);
+
+  // gather the extents of all blocks
+  int nLocal = datasets.size();
+  std::vector<int> counts(nRanks);
+  MPI_Allgather(&nLocal, 1, MPI_INT, counts.data(), 1, MPI_INT, this->Comm);
+
+  std::vector<int> offsets(nRanks + 1, 0);
+  for (int i = 0; i < nRanks; ++i)
+    offsets[i+1] = offsets[i] + counts[i];
+
+  std::vector<int> extCounts(nRanks);
+  std::vector<int> extOffsets(nRanks);
+  for (int i = 0; i < nRanks; ++i)
     {
-    vtkIdType neighborID = l->target(i).gid;
-    vtkStructuredNeighbor& ninfo = (*b->Neighbors)[neighborID];
-    const int* sExt = ninfo.OverlapExtent;
-    std::vector<int> sExtC(sExt, sExt+6);
-    vtkStructuredExtent::Clamp(&sExtC[0], b->Data->GetExtent());
-    SendGhostRegion(b, cp, sExtC, l->target(i));
+    extCounts[i] = 6*counts[i];
+    extOffsets[i] = 6*offsets[i];
     }
 
-}
+  long nBlocks = offsets[nRanks];
+  std::vector<int> extents(6*nBlocks);
+  MPI_Allgatherv(this->Extents.data(), 6*nLocal, MPI_INT, extents.data(),
+    extCounts.data(), extOffsets.data(), MPI_INT, this->Comm);
 
-void ReceiveGhosts(Block* b,
-                   const sdiy::Master::ProxyWithLink& cp,
-                   void*)
-{
-  vtkNew<vtkStructuredPointsReader> reader;
+  this->Sends.clear();
+  this->Recvs.clear();
+  this->GhostedExtents.clear();
+
+  if (nBlocks == 0)
+    return 0;
+
+  // block to rank map
+  std::vector<int> owner(nBlocks);
+  for (int i = 0; i < nRanks; ++i)
+    std::fill(owner.begin() + offsets[i], owner.begin() + offsets[i+1], i);
+
+  // the overall extent of all blocks
+  int wholeExtent[6] = {VTK_INT_MAX, -VTK_INT_MAX,
+                        VTK_INT_MAX, -VTK_INT_MAX,
+                        VTK_INT_MAX, -VTK_INT_MAX};
+  for (long q = 0; q < nBlocks; ++q)
+    {
+    const int *ext = &extents[6*q];
+    for (int i = 0; i < 3; ++i)
+      {
+      wholeExtent[2*i] = std::min(wholeExtent[2*i], ext[2*i]);
+      wholeExtent[2*i+1] = std::max(wholeExtent[2*i+1], ext[2*i+1]);
+      }
+    }
+
+  // the ghosted extents of all blocks
+  std::vector<int> ghostedExtents(extents);
+  for (long q = 0; q < nBlocks; ++q)
+    vtkStructuredExtent::Grow(&ghostedExtents[6*q], NumberOfGhosts, wholeExtent);
 
-  // gids of incoming neighbors in the link
-  std::vector<int> in;
-  cp.incoming(in);
+  this->GhostedExtents.assign(ghostedExtents.begin() + 6*offsets[rank],
+    ghostedExtents.begin() + 6*offsets[rank+1]);
 
-  for (unsigned int i = 0; i < in.size(); ++i)
+  // find the neighbors of the local blocks. ghosts are grown by the same
+  // amount everywhere, so the blocks that a block sends to are the same as
+  // those it receives from, the blocks that intersect its ghosted extent
+  BlockIndex index(wholeExtent, extents);
+
+  std::vector<long> candidates;
+  for (int i = 0; i < nLocal; ++i)
     {
-    std::vector<unsigned char> buffer;
-    cp.dequeue(in[i], buffer);
-    reader->SetInputString(reinterpret_cast<char*>(&buffer[0]), buffer.size());
-    reader->SetReadFromInputString(1);
-    reader->Update();
-
-    // Here we copy the ghost cells values to the output
-    // dataset. For now, we copy only cell data.
-    vtkImageData* ghosted = b->GhostedData;
-
-    vtkImageData* ghosts = reader->GetOutput();
-
-    // Extents are based on points so convert them
-    // to cell extents.
-    int gExt[6];
-    ghosted->GetExtent(gExt);
-    int recvExt[6];
-    ghosts->GetExtent(recvExt);
-    for (unsigned int i=0; i<3; i++)
+    long gid = offsets[rank] + i;
+    const int *ext = &extents[6*gid];
+    const int *gext = &ghostedExtents[6*gid];
+
+    index.Query(gext, candidates);
+
+    unsigned int nCandidates = candidates.size();
+    for (unsigned int j = 0; j < nCandidates; ++j)
       {
-      gExt[2*i+1]--;
-      recvExt[2*i+1]--;
+      long nid = candidates[j];
+      if (nid == gid)
+        continue;
+
+      GhostLink link;
+      link.Rank = owner[nid];
+      link.Local = i;
+
+      // the cells of this block in the neighbor's ghost layers
+      if (ghostRegion(ext, &ghostedExtents[6*nid], link.Region))
+        {
+        link.Source = gid;
+        link.Dest = nid;
+        this->Sends.push_back(link);
+        }
+
+      // the cells of the neighbor in this block's ghost layers
+      if (ghostRegion(&extents[6*nid], gext, link.Region))
+        {
+        link.Source = nid;
+        link.Dest = gid;
+        this->Recvs.push_back(link);
+        }
       }
+    }
+
+  std::sort(this->Sends.begin(), this->Sends.end());
+  std::sort(this->Recvs.begin(), this->Recvs.end());
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int VTKmContourAnalysis::InternalsType::UpdateRequests()
+{
+  this->FreeRequests();
+
+  int tupleSize = this->NumComponents*vtkDataArray::GetDataTypeSize(this->ArrayType);
+
+  unsigned int nRecvs = this->Recvs.size();
+  unsigned int nSends = this->Sends.size();
+
+  this->Requests.resize(nRecvs + nSends, MPI_REQUEST_NULL);
+
+  for (unsigned int i = 0; i < nRecvs; ++i)
+    {
+    GhostLink &link = this->Recvs[i];
+    long nBytes = numberOfCells(link.Region)*tupleSize;
+    link.Buffer.resize(nBytes);
+    MPI_Recv_init(link.Buffer.data(), nBytes, MPI_BYTE, link.Rank,
+      GhostTag, this->Comm, &this->Requests[i]);
+    }
 
-    ghosted->GetCellData()->CopyStructuredData(
-      ghosts->GetCellData(), recvExt, gExt, false);
+  for (unsigned int i = 0; i < nSends; ++i)
+    {
+    GhostLink &link = this->Sends[i];
+    long nBytes = numberOfCells(link.Region)*tupleSize;
+    link.Buffer.resize(nBytes);
+    MPI_Send_init(link.Buffer.data(), nBytes, MPI_BYTE, link.Rank,
+      GhostTag, this->Comm, &this->Requests[nRecvs + i]);
     }
 
+  return 0;
 }
 
-// This method exchanges 2 layers of ghost cells between
-// blocks. A new set of datasets with ghost levels is
-// returned
-vtkSmartPointer<vtkMultiBlockDataSet> ExchangeGhosts(
-  vtkDataObject* mesh, vtkMPIController* contr)
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkMultiBlockDataSet>
+VTKmContourAnalysis::InternalsType::ExchangeGhosts(MPI_Comm comm,
+  vtkDataObject *mesh, const std::string &arrayName)
 {
-  vtkMultiBlockDataSet* mb = vtkMultiBlockDataSet::SafeDownCast(
-    mesh);
+  TimeEvent<128> mark("VTKmContourAnalysis::ExchangeGhosts");
+
+  vtkMultiBlockDataSet* mb = vtkMultiBlockDataSet::SafeDownCast(mesh);
   if (!mb)
     {
     return nullptr;
     }
 
+  if (this->Comm == MPI_COMM_NULL)
+    MPI_Comm_dup(comm, &this->Comm);
+
   vtkSmartPointer<vtkCompositeDataIterator> iter;
   iter.TakeReference(mb->NewIterator());
 
   // Create a flat vector of datasets for simplicity.
-  std::vector<vtkSmartPointer<vtkImageData> > datasets;
+  std::vector<vtkImageData*> datasets;
+  std::vector<vtkDataArray*> arrays;
   iter->InitTraversal();
   while (!iter->IsDoneWithTraversal())
     {
@@ -194,181 +490,141 @@ vtkSmartPointer<vtkMultiBlockDataSet> ExchangeGhosts(
       iter->GetCurrentDataObject());
     if (cur)
       {
+      vtkDataArray *da = cur->GetCellData()->GetArray(arrayName.c_str());
+      if (!da)
+        {
+        SENSEI_ERROR("No cell data array named \"" << arrayName << "\"")
+        return nullptr;
+        }
       datasets.push_back(cur);
+      arrays.push_back(da);
       }
     iter->GoToNextItem();
     }
 
-  vtkIdType nblocks = datasets.size();
-  int nranks = contr->GetNumberOfProcesses();
-  int rank = contr->GetLocalProcessId();
-
-  // Find out how many blocks all processes have.
-  std::vector<vtkIdType> allnblocks(nranks);
-  contr->AllGather(&nblocks, &allnblocks[0], 1);
-
-  // We need to gather information about extents to
-  // figure out block neighbors as well as which
-  // regions to exchange.
-  std::vector<vtkIdType> offsets(nranks);
-  std::vector<vtkIdType> extoffsets(nranks);
-  std::vector<vtkIdType> recvLength(nranks);
-  offsets[0] = 0;
-  extoffsets[0] = 0;
-  recvLength[0] = allnblocks[0] * 6;
-  for(vtkIdType i=1; i<nranks; i++)
-    {
-    offsets[i] = offsets[i-1] + allnblocks[i-1];
-    extoffsets[i] = offsets[i]*6;
-    recvLength[i] = allnblocks[i] * 6;
-    }
-  vtkIdType totnblocks = offsets[nranks - 1] + allnblocks[nranks - 1];
-  std::vector<int> localExtents(nblocks*6);
-  for(vtkIdType i=0; i<nblocks; i++)
-    {
-    datasets[i]->GetExtent(&localExtents[i*6]);
-    }
-  std::vector<int> allExtents(totnblocks*6);
-  contr->AllGatherV(
-    &localExtents[0], &allExtents[0], nblocks*6, &recvLength[0], &extoffsets[0]);
+  int nLocal = datasets.size();
 
-  // Figure out the overall extent of all blocks.
-  int wholeExtent[6] = {VTK_INT_MAX, -VTK_INT_MAX,
-                        VTK_INT_MAX, -VTK_INT_MAX,
-                        VTK_INT_MAX, -VTK_INT_MAX};
-  for (vtkIdType i=0; i<totnblocks; i++)
-    {
-    int* extent = &allExtents[i*6];
-    for (vtkIdType j=0; j<3; j++)
-      {
-      if (extent[2*j] < wholeExtent[2*j])
-        {
-        wholeExtent[2*j] = extent[2*j];
-        }
-      if (extent[2*j+1] > wholeExtent[2*j+1])
-        {
-        wholeExtent[2*j+1] = extent[2*j+1];
-        }
-      }
-    }
+  // the neighbors and requests are kept while the extents of the blocks and
+  // the type of the array are unchanged. this is the case for static meshes.
+  std::vector<int> extents(6*nLocal);
+  for (int i = 0; i < nLocal; ++i)
+    datasets[i]->GetExtent(&extents[6*i]);
 
-  // Create a map from global block id to rank
-  std::vector<int> blockToRank(totnblocks);
-  for(vtkIdType irank=0; irank<nranks; irank++)
-    {
-    vtkIdType offset = offsets[irank];
-    vtkIdType nblocks = allnblocks[irank];
-    for (vtkIdType iblock=offset; iblock<offset+nblocks; iblock++)
-      {
-      blockToRank[iblock] = irank;
-      }
-    }
+  int state[3] = {extents != this->Extents ? 1 : 0,
+    nLocal ? arrays[0]->GetDataType() : -1,
+    nLocal ? arrays[0]->GetNumberOfComponents() : 0};
 
-  const int nGhosts = 2;
+  MPI_Allreduce(MPI_IN_PLACE, state, 3, MPI_INT, MPI_MAX, this->Comm);
 
-  // Use vtkStructuredGridConnectivity to compute
-  // neighborhood info.
-  std::vector<int> ghostedExtents(allExtents);
+  if (state[0])
+    {
+    this->Extents.swap(extents);
+    this->UpdateLinks(datasets);
+    this->FreeRequests();
+    }
 
-  vtkNew<vtkStructuredGridConnectivity> sgc;
-  sgc->SetNumberOfGrids(totnblocks);
-  sgc->SetWholeExtent(wholeExtent);
-  for (vtkIdType i=0; i<totnblocks; i++)
+  if ((state[1] != this->ArrayType) || (state[2] != this->NumComponents))
     {
-    int* gExt = &ghostedExtents[i*6];
-    vtkStructuredExtent::Grow(gExt, nGhosts, wholeExtent);
-    sgc->RegisterGrid(i, gExt, 0, 0, 0, 0, 0);
+    this->ArrayType = state[1];
+    this->NumComponents = state[2];
+    this->FreeRequests();
     }
-  sgc->ComputeNeighbors();
+
+  if (this->Requests.empty() && (this->Recvs.size() || this->Sends.size()))
+    this->UpdateRequests();
 
   // Allocate a new set of blocks that will contain the
   // ghost cells. Also copy the information from input
   // datasets.
-  std::vector<vtkSmartPointer<vtkImageData> > ghostedDatasets;
-  ghostedDatasets.resize(nblocks);
-  vtkIdType offset = offsets[rank];
-  for (vtkIdType id=0; id<nblocks; id++)
+  std::vector<vtkSmartPointer<vtkImageData> > ghostedDatasets(nLocal);
+  std::vector<vtkDataArray*> ghostedArrays(nLocal);
+  for (int i = 0; i < nLocal; ++i)
     {
-    vtkImageData* dataset = datasets[id].GetPointer();
-    vtkImageData* ghosted = vtkImageData::New();
-    ghosted->SetExtent(&ghostedExtents[(id+offset)*6]);
-    vtkDataSetAttributes* cd = dataset->GetCellData();
-    vtkDataSetAttributes* gcd = ghosted->GetCellData();
-    gcd->CopyAllocate(cd, ghosted->GetNumberOfCells());
-
-    int numArrays = gcd->GetNumberOfArrays();
-
-    int ext[6], gExt[6];
-    dataset->GetExtent(ext);
-    ghosted->GetExtent(gExt);
-    for (int i=0; i<3; i++)
-      {
-      ext[2*i+1]--;
-      gExt[2*i+1]--;
-      }
-    gcd->CopyStructuredData(cd, ext, gExt, false);
-    for (int i=0; i<numArrays; i++)
-      {
-      gcd->GetAbstractArray(i)->SetNumberOfTuples(ghosted->GetNumberOfCells());
-      }
-    ghostedDatasets[id].TakeReference(ghosted);
+    vtkImageData *ghosted = vtkImageData::New();
+    ghosted->SetExtent(&this->GhostedExtents[6*i]);
+
+    vtkDataArray *da = arrays[i];
+    vtkDataArray *gda = da->NewInstance();
+    gda->SetName(da->GetName());
+    gda->SetNumberOfComponents(da->GetNumberOfComponents());
+    gda->SetNumberOfTuples(ghosted->GetNumberOfCells());
+    memset(gda->GetVoidPointer(0), 0, ghosted->GetNumberOfCells()*
+      gda->GetNumberOfComponents()*gda->GetDataTypeSize());
+
+    // the block's own cells go in the interior. packed, the block's extent
+    // is laid out as the array itself
+    copyRegion(gda, &this->GhostedExtents[6*i], &this->Extents[6*i],
+      static_cast<unsigned char*>(da->GetVoidPointer(0)), false);
+
+    ghosted->GetCellData()->AddArray(gda);
+    gda->Delete();
+
+    ghostedArrays[i] = gda;
+    ghostedDatasets[i].TakeReference(ghosted);
     }
 
-  vtkMPICommunicator *vtkcomm = vtkMPICommunicator::SafeDownCast(
-    contr->GetCommunicator());
-  sdiy::mpi::communicator comm(*vtkcomm->GetMPIComm()->GetHandle());
-
-  sdiy::Master master(comm);
+  // post the receives, then pack and send
+  unsigned int nRecvs = this->Recvs.size();
+  unsigned int nSends = this->Sends.size();
 
-  std::vector<Block> blocks;
-  blocks.reserve(nblocks);
+  if (nRecvs)
+    MPI_Startall(nRecvs, this->Requests.data());
 
-  // Setup the blocks for DIY.
-  for (vtkIdType iblock=offset; iblock<offset+nblocks; iblock++)
+  for (unsigned int i = 0; i < nSends; ++i)
     {
-    vtkIdType myBlock = iblock - offset;
-    blocks[myBlock] = Block(&localExtents[myBlock*6], nGhosts, datasets[myBlock], ghostedDatasets[myBlock], sgc.GetPointer());
+    GhostLink &link = this->Sends[i];
+    copyRegion(arrays[link.Local], &this->Extents[6*link.Local],
+      link.Region, link.Buffer.data(), true);
+    }
 
-    sdiy::Link* link = new sdiy::Link;
+  if (nSends)
+    MPI_Startall(nSends, this->Requests.data() + nRecvs);
 
-    std::map<vtkIdType, vtkStructuredNeighbor>* ns =
-      new std::map<vtkIdType, vtkStructuredNeighbor>;
-    blocks[myBlock].Neighbors = ns;
+  MPI_Waitall(nRecvs + nSends, this->Requests.data(), MPI_STATUSES_IGNORE);
 
-    int nNeighbors = sgc->GetNumberOfNeighbors(iblock);
-    for (int j=0; j<nNeighbors; j++)
-      {
-      vtkStructuredNeighbor neighborInfo =
-        sgc->GetGridNeighbor(iblock, j);
-      sdiy::BlockID  neighbor;
-      vtkIdType id = neighborInfo.NeighborID;
-      (*ns)[id] = neighborInfo;
-      neighbor.gid = id;
-      neighbor.proc = blockToRank[id];
-      link->add_neighbor(neighbor);
-      }
-    master.add(iblock, &blocks[myBlock], link);
+  // copy the received cells into the ghost layers
+  for (unsigned int i = 0; i < nRecvs; ++i)
+    {
+    GhostLink &link = this->Recvs[i];
+    copyRegion(ghostedArrays[link.Local], &this->GhostedExtents[6*link.Local],
+      link.Region, link.Buffer.data(), false);
     }
 
-  // Now exchange ghosts.
-  master.foreach<Block>(&SendGhosts);
-  master.exchange();
-  master.foreach<Block>(&ReceiveGhosts);
-
   // Finalize the return data structure.
   vtkSmartPointer<vtkMultiBlockDataSet> ghosted =
     vtkSmartPointer<vtkMultiBlockDataSet>::New();
-  for (vtkIdType id=0; id<nblocks; id++)
+  for (int i = 0; i < nLocal; ++i)
     {
     // We need ghost cell information so that ghost cells
     // can be ignored in post processing.
-    ghostedDatasets[id]->GenerateGhostArray(datasets[id]->GetExtent(), true);
+    ghostedDatasets[i]->GenerateGhostArray(datasets[i]->GetExtent(), true);
 
-    ghosted->SetBlock(id, ghostedDatasets[id]);
+    ghosted->SetBlock(i, ghostedDatasets[i]);
     }
   return ghosted;
 }
 
+//-----------------------------------------------------------------------------
+VTKmContourAnalysis::VTKmContourAnalysis() : Internals(new InternalsType)
+{
+}
+
+//-----------------------------------------------------------------------------
+VTKmContourAnalysis::~VTKmContourAnalysis()
+{
+  delete this->Internals;
+}
+
+//-----------------------------------------------------------------------------
+void VTKmContourAnalysis::Initialize(const std::string& meshName,
+  const std::string& arrayName, double value, bool writeOutput)
+{
+  this->MeshName = meshName;
+  this->ArrayName = arrayName;
+  this->Value = value;
+  this->WriteOutput = writeOutput;
+}
+
 //-----------------------------------------------------------------------------
 bool VTKmContourAnalysis::Execute(sensei::DataAdaptor* data)
 {
@@ -408,7 +664,14 @@ bool VTKmContourAnalysis::Execute(sensei::DataAdaptor* data)
     }
 
   vtkSmartPointer<vtkMultiBlockDataSet> ghosted =
-    ExchangeGhosts(mesh, con.GetPointer());
+    this->Internals->ExchangeGhosts(comm, mesh, this->ArrayName);
+
+  if (!ghosted)
+    {
+    SENSEI_ERROR("Failed to exchange ghost cells of \"" << this->ArrayName
+      << "\" on mesh \"" << this->MeshName << "\"")
+    return false;
+    }
 
   vtkNew<vtkmAverageToPoints> cell2Point;
   cell2Point->SetInputDataObject(0, ghosted.GetPointer());
@@ -474,6 +737,7 @@ bool VTKmContourAnalysis::Execute(sensei::DataAdaptor* data)
 //-----------------------------------------------------------------------------
 int VTKmContourAnalysis::Finalize()
 {
+  this->Internals->Release();
   return 0;
 }
 
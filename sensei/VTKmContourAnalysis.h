@@ -35,6 +35,12 @@ protected:
   double Value;
   bool WriteOutput;
 
+  // block neighbors and communication state for the ghost exchange.
+  // these are reused across time steps while the block extents are
+  // unchanged.
+  struct InternalsType;
+  InternalsType *Internals;
+
 private:
   VTKmContourAnalysis(const VTKmContourAnalysis&);
   void operator=(const VTKmContourAnalysis&);
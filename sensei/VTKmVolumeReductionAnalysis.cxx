@@ -229,6 +229,29 @@ void VTKmVolumeReductionAnalysis::Initialize(
   this->Helper->SetExportType("vtk-volume");
 }
 
+//-----------------------------------------------------------------------------
+void VTKmVolumeReductionAnalysis::SetNumberOfWriterThreads(int n)
+{
+  if (this->Helper)
+    this->Helper->SetNumberOfWriterThreads(n);
+}
+
+//-----------------------------------------------------------------------------
+void VTKmVolumeReductionAnalysis::SetRoundRobinWriting(bool val)
+{
+  if (this->Helper)
+    this->Helper->SetRoundRobinWriting(val);
+}
+
+//-----------------------------------------------------------------------------
+int VTKmVolumeReductionAnalysis::Finalize()
+{
+  // make sure the output is on disk
+  if (this->Helper)
+    this->Helper->Flush();
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 bool VTKmVolumeReductionAnalysis::Execute(DataAdaptor* data)
 {
@@ -1,5 +1,7 @@
 #include "XMLUtils.h"
 #include "Error.h"
+#include "Profiler.h"
+#include "BinaryStream.h"
 
 #include <pugixml.hpp>
 
@@ -36,65 +38,176 @@ int RequireChild(const pugi::xml_node &node, const char *childName)
   return 0;
 }
 
+//----------------------------------------------------------------------------
+static
+int ReadAndParse(const std::string &filename, pugi::xml_document &doc)
+{
+  TimeEvent<128> event("XMLUtils::Parse::Read");
+
+  FILE *f = fopen(filename.c_str(), "rb");
+  if (!f)
+    {
+    SENSEI_ERROR("failed to open \""  << filename << "\"" << std::endl << strerror(errno))
+    return -1;
+    }
+
+  setvbuf(f, nullptr, _IONBF, 0);
+  fseek(f, 0, SEEK_END);
+  unsigned long nbytes = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *buffer = static_cast<char*>(pugi::get_memory_allocation_function()(nbytes));
+  unsigned long nread = fread(buffer, 1, nbytes, f);
+  fclose(f);
+
+  if (nread != nbytes)
+    {
+    SENSEI_ERROR("read error on \""  << filename << "\"" << std::endl << strerror(errno))
+    pugi::get_memory_deallocation_function()(buffer);
+    return -1;
+    }
+
+  pugi::xml_parse_result result = doc.load_buffer_inplace_own(buffer, nbytes);
+  if (!result)
+    {
+    SENSEI_ERROR("XML [" << filename << "] parsed with errors, attr value: ["
+      << doc.child("node").attribute("attr").value() << "]" << std::endl
+      << "Error description: " << result.description() << std::endl
+      << "Error offset: " << result.offset << std::endl)
+    return -1;
+    }
+
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 int Parse(MPI_Comm comm, const std::string &filename, pugi::xml_document &doc)
 {
+  TimeEvent<128> event("XMLUtils::Parse");
+
   int rank = 0;
   MPI_Comm_rank(comm, &rank);
 
-  unsigned long nbytes = 0;
-  char *buffer = nullptr;
+  // rank 0 reads and parses, the result is sent as a status flag followed
+  // by the document's top level nodes
+  BinaryStream str;
   if (rank == 0)
     {
-    FILE *f = fopen(filename.c_str(), "rb");
-    if (f)
+    int status = ReadAndParse(filename, doc);
+    str.Pack(status);
+    if (!status)
       {
-      setvbuf(f, nullptr, _IONBF, 0);
-      fseek(f, 0, SEEK_END);
-      nbytes = ftell(f);
-      fseek(f, 0, SEEK_SET);
-      buffer = static_cast<char*>(pugi::get_memory_allocation_function()(nbytes));
-      unsigned long nread = fread(buffer, 1, nbytes, f);
-      fclose(f);
-      if (nread == nbytes)
-        {
-        MPI_Bcast(&nbytes, 1, MPI_UNSIGNED_LONG, 0, comm);
-        MPI_Bcast(buffer, nbytes, MPI_CHAR, 0, comm);
-        }
-      else
+      unsigned int nChildren = 0;
+      for (pugi::xml_node child = doc.first_child(); child; child = child.next_sibling())
+        ++nChildren;
+
+      str.Pack(nChildren);
+      for (pugi::xml_node child = doc.first_child(); child; child = child.next_sibling())
+        Pack(child, str);
+      }
+    }
+
+  {
+  TimeEvent<128> bcastEvent("XMLUtils::Parse::Broadcast");
+  str.Broadcast(comm);
+  }
+
+  int status = 0;
+  str.Unpack(status);
+  if (status)
+    return -1;
+
+  if (rank != 0)
+    {
+    TimeEvent<128> unpackEvent("XMLUtils::Parse::Unpack");
+
+    doc.reset();
+
+    unsigned int nChildren = 0;
+    str.Unpack(nChildren);
+    for (unsigned int i = 0; i < nChildren; ++i)
+      {
+      if (Unpack(str, doc))
         {
-        SENSEI_ERROR("read error on \""  << filename << "\"" << endl << strerror(errno))
-        nbytes = 0;
-        MPI_Bcast(&nbytes, 1, MPI_UNSIGNED_LONG, 0, comm);
+        SENSEI_ERROR("Failed to unpack \"" << filename << "\"")
         return -1;
         }
       }
-    else
-      {
-      SENSEI_ERROR("failed to open \""  << filename << "\"" << endl << strerror(errno))
-      MPI_Bcast(&nbytes, 1, MPI_UNSIGNED_LONG, 0, comm);
-      return -1;
-      }
     }
-  else
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int Pack(const pugi::xml_node &node, BinaryStream &str)
+{
+  str.Pack(static_cast<int>(node.type()));
+  str.Pack(std::string(node.name()));
+  str.Pack(std::string(node.value()));
+
+  unsigned int nAttributes = 0;
+  for (pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute())
+    ++nAttributes;
+
+  str.Pack(nAttributes);
+  for (pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute())
     {
-    MPI_Bcast(&nbytes, 1, MPI_UNSIGNED_LONG, 0, comm);
-    if (!nbytes)
-      return -1;
-    buffer = static_cast<char*>(pugi::get_memory_allocation_function()(nbytes));
-    MPI_Bcast(buffer, nbytes, MPI_CHAR, 0, comm);
+    str.Pack(std::string(attr.name()));
+    str.Pack(std::string(attr.value()));
     }
 
-  pugi::xml_parse_result result = doc.load_buffer_inplace_own(buffer, nbytes);
-  if (!result)
+  unsigned int nChildren = 0;
+  for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+    ++nChildren;
+
+  str.Pack(nChildren);
+  for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling())
+    Pack(child, str);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int Unpack(BinaryStream &str, pugi::xml_node &parent)
+{
+  int type = 0;
+  std::string name;
+  std::string value;
+
+  str.Unpack(type);
+  str.Unpack(name);
+  str.Unpack(value);
+
+  pugi::xml_node node = parent.append_child(static_cast<pugi::xml_node_type>(type));
+  if (!node)
     {
-    SENSEI_ERROR("XML [" << filename << "] parsed with errors, attr value: ["
-      << doc.child("node").attribute("attr").value() << "]" << endl
-      << "Error description: " << result.description() << endl
-      << "Error offset: " << result.offset << endl)
+    SENSEI_ERROR("Failed to append a node of type " << type
+      << " to \"" << parent.name() << "\"")
     return -1;
     }
 
+  if (!name.empty())
+    node.set_name(name.c_str());
+
+  if (!value.empty())
+    node.set_value(value.c_str());
+
+  unsigned int nAttributes = 0;
+  str.Unpack(nAttributes);
+  for (unsigned int i = 0; i < nAttributes; ++i)
+    {
+    str.Unpack(name);
+    str.Unpack(value);
+    node.append_attribute(name.c_str()).set_value(value.c_str());
+    }
+
+  unsigned int nChildren = 0;
+  str.Unpack(nChildren);
+  for (unsigned int i = 0; i < nChildren; ++i)
+    {
+    if (Unpack(str, node))
+      return -1;
+    }
+
   return 0;
 }
 
@@ -2,6 +2,7 @@
 #define sensei_XMLUtils_h
 
 #include "Error.h"
+#include "BinaryStream.h"
 
 #include <mpi.h>
 #include <string>
@@ -25,10 +26,20 @@ int RequireAttribute(const pugi::xml_node &node, const char *attributeName);
 int RequireChild(const pugi::xml_node &node, const char *childName);
 
 // Parallel collective read, parse, and distribute the XML file. Rank 0 does
-// the I/O and parse and will broadcast to the other ranks in the communicator.
-// return of 0 indicates success.
+// the I/O and parse and will broadcast the parsed document in the binary form
+// produced by Pack to the other ranks in the communicator, which rebuild it
+// with Unpack rather than parsing the text themselves. return of 0 indicates
+// success.
 int Parse(MPI_Comm comm, const std::string &filename, pugi::xml_document &doc);
 
+// serialize the node, its attributes and all of its descendants into the
+// stream. return of 0 indicates success.
+int Pack(const pugi::xml_node &node, BinaryStream &str);
+
+// deserialize a node serialized by Pack from the stream and append it to
+// parent. return of 0 indicates success.
+int Unpack(BinaryStream &str, pugi::xml_node &parent);
+
 
 // helper for string to numeric type conversions
 template <typename num_t> struct numeric_traits;
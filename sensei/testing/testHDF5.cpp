@@ -586,6 +586,7 @@ AAWrap* GetWriteAdaptor(const std::string& file_name,
 
 TimedAdaptorWrap* GetReadAdaptor(const std::string& file_name,
                                  const std::string& method,
+                                 int aggregators,
                                  MPI_Comm& comm)
 {
   // if  (file_name.find(".h5") != std::string::npos) {
@@ -612,6 +613,7 @@ TimedAdaptorWrap* GetReadAdaptor(const std::string& file_name,
       da->SetCommunicator(comm);
       da->SetStreaming(doStreaming);
       da->SetCollective(doCollective);
+      da->SetAggregators(aggregators);
       da->SetStreamName(file_name);
       da->OpenStream();
       TimedAdaptorWrap* result = new TimedAdaptorWrap(da);
@@ -644,10 +646,11 @@ int main(int argc, char** argv)
     {
       std::cout << " please use the following options: " << std::endl;
       std::cout << argv[0] << "  w iter mode file-name " << std::endl;
-      std::cout << argv[0] << "  r file-name mode" << std::endl;
+      std::cout << argv[0] << "  r file-name mode [aggregators]" << std::endl;
       return 0;
     }
 
+  int retval = 0;
   std::string method = "MPI"; // or "POSIX"
   if (argv[1][0] == 'w')
     {
@@ -691,13 +694,20 @@ int main(int argc, char** argv)
           method = argv[3];
         }
 
-      TimedAdaptorWrap* result = GetReadAdaptor(file_name, method, comm);
+      int aggregators = 0;
+      if (argc > 4)
+        {
+          aggregators = atoi(argv[4]);
+        }
 
-      readMe(result, comm);
+      TimedAdaptorWrap* result =
+        GetReadAdaptor(file_name, method, aggregators, comm);
+
+      retval = readMe(result, comm);
 
       delete result;
     }
 
   MPI_Finalize();
-  return 0;
+  return retval;
 }
@@ -0,0 +1,114 @@
+#include <random>
+#include <vector>
+#include <cstring>
+#include <mpi.h>
+#include "Error.h"
+#include "ImageCompositor.h"
+
+// generate images where about half of the pixels are empty. the color of a
+// pixel encodes the rank and pixel it came from
+void generate(int rank, long nPixels, std::vector<float> &depth,
+  std::vector<unsigned char> &rgba)
+{
+  std::mt19937 gen(17 + rank);
+  std::uniform_real_distribution<float> dist(0.0f, 2.0f);
+
+  depth.resize(nPixels);
+  rgba.resize(4*nPixels);
+
+  for (long i = 0; i < nPixels; ++i)
+    {
+    float d = dist(gen);
+    depth[i] = d < 1.0f ? d : 1.0f;
+    rgba[4*i] = rank;
+    rgba[4*i + 1] = i % 256;
+    rgba[4*i + 2] = (i/256) % 256;
+    rgba[4*i + 3] = d < 1.0f ? 255 : 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int width = 67, height = 43, nImages = 3;
+  long nPixels = long(width)*height*nImages;
+
+  std::vector<float> depth;
+  std::vector<unsigned char> rgba;
+  generate(rank, nPixels, depth, rgba);
+
+  // the reference result. the nearest depth and the lowest rank having it
+  std::vector<float> refDepth(depth);
+  MPI_Allreduce(MPI_IN_PLACE, refDepth.data(), nPixels, MPI_FLOAT,
+    MPI_MIN, MPI_COMM_WORLD);
+
+  std::vector<int> refRank(nPixels);
+  for (long i = 0; i < nPixels; ++i)
+    refRank[i] = depth[i] == refDepth[i] ? rank : nRanks;
+
+  MPI_Allreduce(MPI_IN_PLACE, refRank.data(), nPixels, MPI_INT,
+    MPI_MIN, MPI_COMM_WORLD);
+
+  int ierr = 0;
+  int radix[] = {2, 4, 2, 4};
+  int root[] = {0, nRanks - 1, -1, -1};
+  for (int t = 0; t < 4; ++t)
+    {
+    std::vector<float> d(depth);
+    std::vector<unsigned char> c(rgba);
+
+    sensei::ImageCompositor compositor;
+    compositor.SetRadix(radix[t]);
+    compositor.SetRoot(root[t]);
+
+    if (compositor.Composite(width, height, nImages, d, c))
+      {
+      ++ierr;
+      continue;
+      }
+
+    long first = 0, last = 0;
+    compositor.GetPixelRange(first, last);
+
+    // all pixels are covered exactly once
+    long n = last - first;
+    MPI_Allreduce(MPI_IN_PLACE, &n, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if ((n != nPixels) || (long(d.size()) != last - first) ||
+      (long(c.size()) != 4*(last - first)))
+      {
+      SENSEI_ERROR("radix " << radix[t] << " root " << root[t]
+        << " produced " << n << " pixels but should have produced " << nPixels)
+      ++ierr;
+      continue;
+      }
+
+    for (long i = first; i < last; ++i)
+      {
+      const unsigned char *px = c.data() + 4*(i - first);
+
+      bool ok = d[i - first] == refDepth[i];
+      if (ok && (refDepth[i] < 1.0f))
+        ok = (px[0] == refRank[i]) && (px[1] == i % 256) &&
+          (px[2] == (i/256) % 256) && (px[3] == 255);
+
+      if (!ok)
+        {
+        SENSEI_ERROR("radix " << radix[t] << " root " << root[t] << " pixel "
+          << i << " has depth " << d[i - first] << " from rank " << int(px[0])
+          << " but should have depth " << refDepth[i] << " from rank " << refRank[i])
+        ++ierr;
+        break;
+        }
+      }
+    }
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
@@ -0,0 +1,343 @@
+#include "MMapAnalysisAdaptor.h"
+#include "MMapDataAdaptor.h"
+#include "VTKDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "Error.h"
+
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkDataObject.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkIntArray.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkCellType.h>
+
+#include <mpi.h>
+#include <cmath>
+#include <string>
+
+// the value stored at point or cell i of block gid in the given step
+double value(int step, int gid, int i)
+{
+  return 100.0*step + 10.0*gid + i;
+}
+
+// makes a block with a single tetrahedron. the point data array "f" and
+// cell data array "g" hold known values
+vtkUnstructuredGrid *newTet(int step, int gid)
+{
+  vtkFloatArray *x = vtkFloatArray::New();
+  x->SetNumberOfComponents(3);
+  x->SetNumberOfTuples(4);
+  for (int i = 0; i < 4; ++i)
+    {
+    x->SetComponent(i, 0, gid + (i == 1));
+    x->SetComponent(i, 1, (i == 2));
+    x->SetComponent(i, 2, (i == 3));
+    }
+
+  vtkPoints *pts = vtkPoints::New();
+  pts->SetData(x);
+  x->Delete();
+
+  vtkUnstructuredGrid *ug = vtkUnstructuredGrid::New();
+  ug->SetPoints(pts);
+  pts->Delete();
+
+  vtkIdType ids[4] = {0, 1, 2, 3};
+  ug->Allocate(1);
+  ug->InsertNextCell(VTK_TETRA, 4, ids);
+
+  vtkDoubleArray *f = vtkDoubleArray::New();
+  f->SetName("f");
+  f->SetNumberOfTuples(4);
+  for (int i = 0; i < 4; ++i)
+    f->SetValue(i, value(step, gid, i));
+
+  vtkIntArray *g = vtkIntArray::New();
+  g->SetName("g");
+  g->SetNumberOfTuples(1);
+  g->SetValue(0, value(step, gid, 0));
+
+  ug->GetPointData()->AddArray(f);
+  ug->GetCellData()->AddArray(g);
+  f->Delete();
+  g->Delete();
+
+  return ug;
+}
+
+// makes a 4x3x1 image block with a point data array "f" holding known values
+vtkImageData *newImage(int step, int gid)
+{
+  vtkImageData *im = vtkImageData::New();
+  im->SetExtent(4*gid, 4*gid + 3, 0, 2, 0, 0);
+
+  vtkIdType nPts = im->GetNumberOfPoints();
+
+  vtkDoubleArray *f = vtkDoubleArray::New();
+  f->SetName("f");
+  f->SetNumberOfTuples(nPts);
+  for (vtkIdType i = 0; i < nPts; ++i)
+    f->SetValue(i, value(step, gid, i));
+
+  im->GetPointData()->AddArray(f);
+  f->Delete();
+
+  return im;
+}
+
+#define CHECK(_cond, _msg)          \
+  if (!(_cond))                     \
+    {                               \
+    SENSEI_ERROR(_msg)              \
+    return -1;                      \
+    }
+
+// --------------------------------------------------------------------------
+int write(MPI_Comm comm, const std::string &dir, int nSteps)
+{
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  sensei::MMapAnalysisAdaptor *aa = sensei::MMapAnalysisAdaptor::New();
+  aa->SetCommunicator(comm);
+  aa->SetDirectory(dir);
+  aa->SetStreamName("testMMap");
+
+  int ierr = 0;
+  for (int step = 0; !ierr && (step < nSteps); ++step)
+    {
+    // each rank owns one block of each mesh
+    vtkMultiBlockDataSet *ugrid = vtkMultiBlockDataSet::New();
+    ugrid->SetNumberOfBlocks(nRanks);
+    vtkUnstructuredGrid *ug = newTet(step, rank);
+    ugrid->SetBlock(rank, ug);
+    ug->Delete();
+
+    vtkMultiBlockDataSet *image = vtkMultiBlockDataSet::New();
+    image->SetNumberOfBlocks(nRanks);
+    vtkImageData *im = newImage(step, rank);
+    image->SetBlock(rank, im);
+    im->Delete();
+
+    sensei::VTKDataAdaptor *da = sensei::VTKDataAdaptor::New();
+    da->SetCommunicator(comm);
+    da->SetDataTimeStep(step);
+    da->SetDataTime(0.5*step);
+    da->SetDataObject("ugrid", ugrid);
+    da->SetDataObject("image", image);
+    ugrid->Delete();
+    image->Delete();
+
+    if (!aa->Execute(da))
+      {
+      SENSEI_ERROR("Failed to write step " << step)
+      ierr = -1;
+      }
+
+    da->ReleaseData();
+    da->Delete();
+    }
+
+  aa->Finalize();
+  aa->Delete();
+
+  return ierr;
+}
+
+// --------------------------------------------------------------------------
+int checkArray(vtkDataArray *da, int step, int gid, vtkIdType nTups)
+{
+  CHECK(da, "Array missing from block " << gid)
+
+  CHECK(da->GetNumberOfTuples() == nTups, "Array \"" << da->GetName()
+    << "\" of block " << gid << " has " << da->GetNumberOfTuples()
+    << " tuples, expected " << nTups)
+
+  for (vtkIdType i = 0; i < nTups; ++i)
+    {
+    double v = da->GetTuple1(i);
+    double ref = value(step, gid, i);
+    CHECK(std::fabs(v - ref) < 1.e-6, "Array \"" << da->GetName()
+      << "\" of block " << gid << " has " << v << " at " << i
+      << " expected " << ref)
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int checkMesh(sensei::MMapDataAdaptor *da, const std::string &meshName,
+  int step, int nBlocks)
+{
+  int rank = 0;
+  MPI_Comm_rank(da->GetCommunicator(), &rank);
+
+  // find the mesh and check its metadata
+  unsigned int nMeshes = 0;
+  CHECK(!da->GetNumberOfMeshes(nMeshes) && (nMeshes == 2),
+    "Expected 2 meshes but found " << nMeshes)
+
+  sensei::MeshMetadataPtr md;
+  unsigned int id = 0;
+  for (; id < nMeshes; ++id)
+    {
+    CHECK(!da->GetMeshMetadata(id, md), "Failed to get metadata " << id)
+    if (md->MeshName == meshName)
+      break;
+    }
+
+  CHECK(id < nMeshes, "Mesh \"" << meshName << "\" was not found")
+
+  CHECK(md->NumBlocks == nBlocks, "Mesh \"" << meshName << "\" has "
+    << md->NumBlocks << " blocks, expected " << nBlocks)
+
+  bool ugrid = (meshName == "ugrid");
+
+  CHECK(md->BlockType == (ugrid ? VTK_UNSTRUCTURED_GRID : VTK_IMAGE_DATA),
+    "Mesh \"" << meshName << "\" has the wrong block type " << md->BlockType)
+
+  unsigned int nArrays = ugrid ? 2 : 1;
+  CHECK(md->NumArrays == static_cast<int>(nArrays) &&
+    (md->ArrayName.size() == nArrays), "Mesh \"" << meshName << "\" has "
+    << md->NumArrays << " arrays, expected " << nArrays)
+
+  // read the blocks this rank was assigned and check the arrays
+  vtkDataObject *dobj = nullptr;
+  CHECK(!da->GetMesh(meshName, false, dobj) &&
+    !da->AddArray(dobj, meshName, vtkDataObject::POINT, "f") &&
+    (!ugrid || !da->AddArray(dobj, meshName, vtkDataObject::CELL, "g")),
+    "Failed to read mesh \"" << meshName << "\"")
+
+  vtkMultiBlockDataSet *mb = dynamic_cast<vtkMultiBlockDataSet*>(dobj);
+  CHECK(mb && (static_cast<int>(mb->GetNumberOfBlocks()) == nBlocks),
+    "Mesh \"" << meshName << "\" is not a multiblock of "
+    << nBlocks << " blocks")
+
+  int ierr = 0;
+  for (int j = 0; !ierr && (j < nBlocks); ++j)
+    {
+    vtkDataSet *ds = dynamic_cast<vtkDataSet*>(mb->GetBlock(j));
+
+    if (md->BlockOwner[j] != rank)
+      {
+      if (ds)
+        {
+        SENSEI_ERROR("Block " << j << " is not assigned to rank " << rank)
+        ierr = -1;
+        }
+      continue;
+      }
+
+    if (!ds)
+      {
+      SENSEI_ERROR("Block " << j << " of mesh \"" << meshName
+        << "\" is missing")
+      ierr = -1;
+      continue;
+      }
+
+    vtkIdType nPts = ugrid ? 4 : 12;
+    vtkIdType nCells = ugrid ? 1 : 6;
+
+    if ((ds->GetNumberOfPoints() != nPts) ||
+      (ds->GetNumberOfCells() != nCells))
+      {
+      SENSEI_ERROR("Block " << j << " of mesh \"" << meshName << "\" has "
+        << ds->GetNumberOfPoints() << " points and "
+        << ds->GetNumberOfCells() << " cells")
+      ierr = -1;
+      continue;
+      }
+
+    if (checkArray(ds->GetPointData()->GetArray("f"), step, j, nPts) ||
+      (ugrid && checkArray(ds->GetCellData()->GetArray("g"), step, j, 1)))
+      ierr = -1;
+    }
+
+  dobj->Delete();
+
+  return ierr;
+}
+
+// --------------------------------------------------------------------------
+int read(MPI_Comm comm, const std::string &dir, int nSteps)
+{
+  int nRanks = 1;
+  MPI_Comm_size(comm, &nRanks);
+
+  sensei::MMapDataAdaptor *da = sensei::MMapDataAdaptor::New();
+  da->SetCommunicator(comm);
+  da->SetDirectory(dir);
+  da->SetStreamName("testMMap");
+
+  int ierr = 0;
+  if (da->OpenStream())
+    {
+    SENSEI_ERROR("Failed to open the stream")
+    ierr = -1;
+    }
+
+  int step = 0;
+  while (!ierr && !da->StreamGood())
+    {
+    if ((static_cast<int>(da->GetDataTimeStep()) != step) ||
+      (da->GetDataTime() != 0.5*step))
+      {
+      SENSEI_ERROR("Step " << step << " has time step "
+        << da->GetDataTimeStep() << " and time " << da->GetDataTime())
+      ierr = -1;
+      }
+
+    if (checkMesh(da, "ugrid", step, nRanks) ||
+      checkMesh(da, "image", step, nRanks))
+      ierr = -1;
+
+    da->ReleaseData();
+
+    ++step;
+
+    if (da->AdvanceStream() < 0)
+      ierr = -1;
+    }
+
+  if (!ierr && (step != nSteps))
+    {
+    SENSEI_ERROR("Read " << step << " steps, expected " << nSteps)
+    ierr = -1;
+    }
+
+  da->CloseStream();
+  da->Finalize();
+  da->Delete();
+
+  return ierr;
+}
+
+// --------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  std::string dir = argc > 1 ? argv[1] : ".";
+  int nSteps = 2;
+
+  int ierr = write(MPI_COMM_WORLD, dir, nSteps);
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (!ierr)
+    ierr = read(MPI_COMM_WORLD, dir, nSteps);
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
@@ -0,0 +1,146 @@
+#include "MPIRedistributor.h"
+#include "Error.h"
+
+#include <mpi.h>
+#include <vector>
+
+using sensei::MPIRedistributor;
+
+// each block is filled with a byte derived from its id and the step, and its
+// size depends on both
+unsigned long long blockSize(int bid, int step) { return 8 + 3*bid + step; }
+unsigned char blockValue(int bid, int step) { return 7*bid + step; }
+
+// --------------------------------------------------------------------------
+int testExchange(MPI_Comm intercomm, bool sender, int method)
+{
+  MPIRedistributor redist;
+  redist.SetMethod(method);
+  redist.SetIntercommunicator(intercomm, sender);
+
+  int nSenders = redist.GetNumberOfSenders();
+  int nReceivers = redist.GetNumberOfReceivers();
+
+  int rank = 0;
+  MPI_Comm_rank(redist.GetCommunicator(), &rank);
+
+  int localRank = sender ? rank : rank - nSenders;
+
+  int ierr = 0;
+  for (int step = 0; step < 4; ++step)
+    {
+    // the layout changes half way through
+    int nBlocks = 3*(nSenders + nReceivers);
+    std::vector<int> senderOwner(nBlocks);
+    std::vector<int> receiverOwner(nBlocks);
+    for (int j = 0; j < nBlocks; ++j)
+      {
+      senderOwner[j] = j % nSenders;
+      receiverOwner[j] = (step < 2 ? j : j/3) % nReceivers;
+      }
+
+    if (redist.SetPlan(senderOwner, receiverOwner))
+      return -1;
+
+    const std::vector<int> &peers = redist.GetPeers();
+    int nPeers = peers.size();
+
+    // senders pack the blocks for each peer in order of block id
+    std::vector<unsigned char> sendBuf;
+    std::vector<unsigned long long> sendSizes(sender ? nPeers : 0, 0);
+    for (int p = 0; sender && (p < nPeers); ++p)
+      {
+      for (int j = 0; j < nBlocks; ++j)
+        {
+        if ((senderOwner[j] != localRank) ||
+          (nSenders + receiverOwner[j] != peers[p]))
+          continue;
+
+        sendBuf.insert(sendBuf.end(), blockSize(j, step), blockValue(j, step));
+        sendSizes[p] += blockSize(j, step);
+        }
+      }
+
+    std::vector<unsigned char*> recvData;
+    std::vector<unsigned long long> recvSizes;
+    if (redist.Exchange(sendBuf.data(), sendSizes, recvData, recvSizes))
+      return -1;
+
+    // receivers unpack and validate
+    for (int p = 0; !sender && (p < nPeers); ++p)
+      {
+      unsigned long long offs = 0;
+      for (int j = 0; j < nBlocks; ++j)
+        {
+        if ((receiverOwner[j] != localRank) || (senderOwner[j] != peers[p]))
+          continue;
+
+        for (unsigned long long i = 0; i < blockSize(j, step); ++i)
+          {
+          if ((offs + i >= recvSizes[p]) ||
+            (recvData[p][offs + i] != blockValue(j, step)))
+            {
+            SENSEI_ERROR("method " << method << " step " << step
+              << " block " << j << " from " << peers[p] << " is incorrect")
+            ++ierr;
+            break;
+            }
+          }
+
+        offs += blockSize(j, step);
+        }
+
+      if (offs != recvSizes[p])
+        {
+        SENSEI_ERROR("method " << method << " step " << step << " received "
+          << recvSizes[p] << " bytes from " << peers[p] << " but expected "
+          << offs)
+        ++ierr;
+        }
+      }
+    }
+
+  redist.Disconnect();
+
+  return ierr;
+}
+
+// --------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  if (nRanks < 2)
+    {
+    SENSEI_ERROR("testMPIRedistributor requires at least 2 ranks")
+    MPI_Finalize();
+    return -1;
+    }
+
+  // the lower half of the ranks send to the upper half
+  int nSenders = nRanks/2;
+  bool sender = rank < nSenders;
+
+  MPI_Comm local = MPI_COMM_NULL;
+  MPI_Comm_split(MPI_COMM_WORLD, sender, rank, &local);
+
+  MPI_Comm intercomm = MPI_COMM_NULL;
+  MPI_Intercomm_create(local, 0, MPI_COMM_WORLD,
+    sender ? nSenders : 0, 0, &intercomm);
+
+  int ierr = 0;
+  ierr += testExchange(intercomm, sender, MPIRedistributor::NEIGHBOR);
+  ierr += testExchange(intercomm, sender, MPIRedistributor::ALLTOALLV);
+
+  MPI_Comm_free(&intercomm);
+  MPI_Comm_free(&local);
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <mpi.h>
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include "Error.h"
+#include "ParticleDeposition.h"
+#include "VTKDataAdaptor.h"
+
+// check the slab owned by this rank against the reference counts. the sum of
+// the counts on this rank is returned in total
+int compare(const char *method, vtkImageData *im, int nx, int ny,
+  const std::vector<double> &ref, double &total)
+{
+  total = 0.0;
+
+  if (!im)
+    return 0;
+
+  int ext[6] = {0};
+  im->GetExtent(ext);
+
+  double *sp = im->GetSpacing();
+  double vol = sp[0]*sp[1]*sp[2];
+
+  vtkDoubleArray *density =
+    dynamic_cast<vtkDoubleArray*>(im->GetCellData()->GetArray("density"));
+
+  vtkDoubleArray *velocity =
+    dynamic_cast<vtkDoubleArray*>(im->GetCellData()->GetArray("velocity"));
+
+  if (!density || !velocity || (velocity->GetNumberOfComponents() != 3))
+    {
+    SENSEI_ERROR(<< method << " result is missing arrays")
+    return -1;
+    }
+
+  long q = 0;
+  for (int k = ext[4]; k < ext[5]; ++k)
+    {
+    for (int j = 0; j < ny; ++j)
+      {
+      for (int i = 0; i < nx; ++i, ++q)
+        {
+        double n = density->GetValue(q)*vol;
+        total += n;
+
+        // NGP counts are exact
+        double r = ref.empty() ? n : ref[(k*ny + j)*nx + i];
+        if (std::fabs(n - r) > 1.0e-6)
+          {
+          SENSEI_ERROR(<< method << " cell " << i << ", " << j << ", " << k
+            << " has " << n << " particles but should have " << r)
+          return -1;
+          }
+
+        // the mean of a constant is the constant
+        for (int c = 0; (n > 0.0) && (c < 3); ++c)
+          {
+          double v = velocity->GetComponent(q, c);
+          if (std::fabs(v - (c + 1.0)) > 1.0e-6)
+            {
+            SENSEI_ERROR(<< method << " cell " << i << ", " << j << ", " << k
+              << " velocity " << c << " is " << v << " but should be " << c + 1)
+            return -1;
+            }
+          }
+        }
+      }
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  // particles clustered near the center of the unit cube
+  std::mt19937 gen(11 + rank);
+  std::normal_distribution<float> dist(0.5f, 0.15f);
+
+  int nx = 16, ny = 12, nz = 10;
+  long nLocal = 50000;
+
+  vtkFloatArray *coords = vtkFloatArray::New();
+  coords->SetNumberOfComponents(3);
+  coords->SetNumberOfTuples(nLocal);
+  float *pc = coords->GetPointer(0);
+
+  vtkFloatArray *vel = vtkFloatArray::New();
+  vel->SetName("velocity");
+  vel->SetNumberOfComponents(3);
+  vel->SetNumberOfTuples(nLocal);
+  float *pv = vel->GetPointer(0);
+
+  // the reference NGP result
+  std::vector<double> ref(nx*ny*nz, 0.0);
+  long nInside = 0;
+
+  for (long p = 0; p < nLocal; ++p)
+    {
+    bool inside = true;
+    for (int q = 0; q < 3; ++q)
+      {
+      pc[3*p + q] = dist(gen);
+      pv[3*p + q] = q + 1.0f;
+      inside = inside && (pc[3*p + q] >= 0.0f) && (pc[3*p + q] <= 1.0f);
+      }
+
+    if (!inside)
+      continue;
+
+    int i = std::min(int(pc[3*p]/(1.0/nx)), nx - 1);
+    int j = std::min(int(pc[3*p + 1]/(1.0/ny)), ny - 1);
+    int k = std::min(int(pc[3*p + 2]/(1.0/nz)), nz - 1);
+
+    ref[(k*ny + j)*nx + i] += 1.0;
+    ++nInside;
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, ref.data(), ref.size(), MPI_DOUBLE,
+    MPI_SUM, MPI_COMM_WORLD);
+
+  MPI_Allreduce(MPI_IN_PLACE, &nInside, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+  vtkPoints *pts = vtkPoints::New();
+  pts->SetData(coords);
+  coords->Delete();
+
+  vtkPolyData *pd = vtkPolyData::New();
+  pd->SetPoints(pts);
+  pd->GetPointData()->AddArray(vel);
+  pts->Delete();
+  vel->Delete();
+
+  sensei::VTKDataAdaptor *dataAdaptor = sensei::VTKDataAdaptor::New();
+  dataAdaptor->SetDataObject("particles", pd);
+  pd->Delete();
+
+  int ierr = 0;
+  const char *methods[] = {"ngp", "cic"};
+  for (int m = 0; m < 2; ++m)
+    {
+    sensei::ParticleDeposition *analysisAdaptor =
+      sensei::ParticleDeposition::New();
+
+    analysisAdaptor->AddDataRequirement("particles",
+      vtkDataObject::POINT, {"velocity"});
+
+    analysisAdaptor->SetMethod(methods[m]);
+    analysisAdaptor->SetBounds({0.0, 1.0, 0.0, 1.0, 0.0, 1.0});
+    analysisAdaptor->SetResolution({nx, ny, nz});
+    analysisAdaptor->SetNumberOfThreads(3);
+
+    double total = 0.0;
+    if (!analysisAdaptor->Execute(dataAdaptor) ||
+      compare(methods[m], analysisAdaptor->GetOutput("particles"), nx, ny,
+      m == 0 ? ref : std::vector<double>(), total))
+      ++ierr;
+
+    // both methods conserve the number of particles
+    MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    if (std::fabs(total - nInside) > 1.0e-6*nInside)
+      {
+      SENSEI_ERROR(<< methods[m] << " deposited " << total
+        << " particles but should have deposited " << nInside)
+      ++ierr;
+      }
+
+    analysisAdaptor->Finalize();
+    analysisAdaptor->Delete();
+    }
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
@@ -0,0 +1,305 @@
+#include "VTKUtils.h"
+#include "Error.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellType.h>
+#include <vtkDataObject.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSOADataArrayTemplate.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <mpi.h>
+#include <algorithm>
+#include <vector>
+
+// makes a block with a single tetrahedron. the point data array "soa" has 2
+// components stored in SOA layout, "aos" is the same data in AOS layout
+vtkUnstructuredGrid *newTet(int gid)
+{
+  vtkFloatArray *x = vtkFloatArray::New();
+  x->SetNumberOfComponents(3);
+  x->SetNumberOfTuples(4);
+  for (int i = 0; i < 4; ++i)
+    {
+    x->SetComponent(i, 0, gid);
+    x->SetComponent(i, 1, i);
+    x->SetComponent(i, 2, 0);
+    }
+
+  vtkPoints *pts = vtkPoints::New();
+  pts->SetData(x);
+  x->Delete();
+
+  vtkUnstructuredGrid *ug = vtkUnstructuredGrid::New();
+  ug->SetPoints(pts);
+  pts->Delete();
+
+  vtkIdType ids[4] = {0, 1, 2, 3};
+  ug->Allocate(1);
+  ug->InsertNextCell(VTK_TETRA, 4, ids);
+
+  vtkSOADataArrayTemplate<double> *soa = vtkSOADataArrayTemplate<double>::New();
+  soa->SetName("soa");
+  soa->SetNumberOfComponents(2);
+  soa->SetNumberOfTuples(4);
+
+  vtkDoubleArray *aos = vtkDoubleArray::New();
+  aos->SetName("aos");
+  aos->SetNumberOfComponents(2);
+  aos->SetNumberOfTuples(4);
+
+  for (int i = 0; i < 4; ++i)
+    {
+    double v = 10*gid + i;
+    soa->SetTypedComponent(i, 0, v);
+    soa->SetTypedComponent(i, 1, -v);
+    aos->SetTypedComponent(i, 0, v);
+    aos->SetTypedComponent(i, 1, -v);
+    }
+
+  ug->GetPointData()->AddArray(soa);
+  ug->GetPointData()->AddArray(aos);
+  soa->Delete();
+  aos->Delete();
+
+  return ug;
+}
+
+// makes polydata with 2 verts and a triangle
+vtkPolyData *newPolydata()
+{
+  vtkDoubleArray *x = vtkDoubleArray::New();
+  x->SetNumberOfComponents(3);
+  x->SetNumberOfTuples(3);
+  for (int i = 0; i < 9; ++i)
+    x->SetValue(i, i);
+
+  vtkPoints *pts = vtkPoints::New();
+  pts->SetData(x);
+  x->Delete();
+
+  vtkPolyData *pd = vtkPolyData::New();
+  pd->SetPoints(pts);
+  pts->Delete();
+
+  vtkCellArray *verts = vtkCellArray::New();
+  vtkIdType v0 = 0;
+  vtkIdType v1 = 1;
+  verts->InsertNextCell(1, &v0);
+  verts->InsertNextCell(1, &v1);
+  pd->SetVerts(verts);
+  verts->Delete();
+
+  vtkCellArray *polys = vtkCellArray::New();
+  vtkIdType tri[3] = {0, 1, 2};
+  polys->InsertNextCell(3, tri);
+  pd->SetPolys(polys);
+  polys->Delete();
+
+  return pd;
+}
+
+#define CHECK(_cond, _msg)          \
+  if (!(_cond))                     \
+    {                               \
+    SENSEI_ERROR(_msg)              \
+    return -1;                      \
+    }
+
+// --------------------------------------------------------------------------
+int testArrays(int gid0, const std::vector<vtkDataSet*> &blocks)
+{
+  unsigned int nBlocks = blocks.size();
+
+  // the SOA array is interleaved and matches the AOS array
+  std::vector<unsigned char> soaBuf;
+  sensei::VTKUtils::DataArraySerializer soaSer("soa", vtkDataObject::POINT);
+  CHECK(!sensei::VTKUtils::Serialize(blocks, soaSer, soaBuf, 4),
+    "Failed to serialize the SOA array")
+
+  std::vector<unsigned char> aosBuf;
+  sensei::VTKUtils::DataArraySerializer aosSer("aos", vtkDataObject::POINT);
+  CHECK(!sensei::VTKUtils::Serialize(blocks, aosSer, aosBuf),
+    "Failed to serialize the AOS array")
+
+  CHECK(soaBuf.size() == nBlocks*8*sizeof(double), "Wrong SOA size")
+  CHECK(soaBuf == aosBuf, "SOA and AOS serializations differ")
+
+  const double *pa = reinterpret_cast<const double*>(soaBuf.data());
+  for (unsigned int j = 0; j < nBlocks; ++j)
+    {
+    for (int i = 0; i < 4; ++i)
+      {
+      double v = 10*(gid0 + j) + i;
+      CHECK((pa[8*j + 2*i] == v) && (pa[8*j + 2*i + 1] == -v),
+        "Wrong array value block " << j << " point " << i)
+      }
+    }
+
+  // the AOS array is used in place, the SOA array is copied
+  std::vector<unsigned char> buf;
+  const void *data = nullptr;
+  unsigned long long nBytes = 0;
+  CHECK(!sensei::VTKUtils::Serialize(blocks[0], aosSer, buf, data, nBytes) &&
+    (data != buf.data()) && (nBytes == 8*sizeof(double)),
+    "The AOS array was not used in place")
+
+  CHECK(!sensei::VTKUtils::Serialize(blocks[0], soaSer, buf, data, nBytes) &&
+    (data == buf.data()) && (nBytes == 8*sizeof(double)),
+    "The SOA array was not copied")
+
+  // missing arrays are reported
+  sensei::VTKUtils::DataArraySerializer badSer("bad", vtkDataObject::POINT);
+  CHECK(sensei::VTKUtils::Serialize(blocks, badSer, buf),
+    "Serializing a missing array did not fail")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int testGeometry(int gid0, const std::vector<vtkDataSet*> &blocks)
+{
+  unsigned int nBlocks = blocks.size();
+
+  // points, with precomputed offsets
+  sensei::VTKUtils::PointsSerializer ptSer;
+  std::vector<unsigned long long> offsets;
+  CHECK(!sensei::VTKUtils::GetBlockOffsets(blocks, ptSer, offsets) &&
+    (offsets.size() == nBlocks + 1) &&
+    (offsets.back() == nBlocks*12*sizeof(float)), "Wrong point offsets")
+
+  std::vector<float> pts(nBlocks*12);
+  CHECK(!sensei::VTKUtils::Serialize(blocks, ptSer, offsets,
+    reinterpret_cast<unsigned char*>(pts.data()), 2),
+    "Failed to serialize the points")
+
+  for (unsigned int j = 0; j < nBlocks; ++j)
+    {
+    for (int i = 0; i < 4; ++i)
+      {
+      CHECK((pts[12*j + 3*i] == gid0 + j) && (pts[12*j + 3*i + 1] == i) &&
+        (pts[12*j + 3*i + 2] == 0.0f), "Wrong point block " << j
+        << " point " << i)
+      }
+    }
+
+  // cells
+  std::vector<unsigned char> types;
+  sensei::VTKUtils::CellTypesSerializer ctSer;
+  CHECK(!sensei::VTKUtils::Serialize(blocks, ctSer, types, 3) &&
+    (types.size() == nBlocks), "Failed to serialize the cell types")
+
+  std::vector<unsigned char> cells;
+  sensei::VTKUtils::CellArraySerializer caSer;
+  CHECK(!sensei::VTKUtils::Serialize(blocks, caSer, cells, 3) &&
+    (cells.size() == nBlocks*5*sizeof(vtkIdType)),
+    "Failed to serialize the cell array")
+
+  const vtkIdType *pc = reinterpret_cast<const vtkIdType*>(cells.data());
+  for (unsigned int j = 0; j < nBlocks; ++j)
+    {
+    CHECK(types[j] == VTK_TETRA, "Wrong cell type block " << j)
+    CHECK((pc[5*j] == 4) && (pc[5*j + 1] == 0) && (pc[5*j + 2] == 1) &&
+      (pc[5*j + 3] == 2) && (pc[5*j + 4] == 3), "Wrong cells block " << j)
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int testPolydata()
+{
+  vtkPolyData *pd = newPolydata();
+
+  std::vector<unsigned char> buf;
+  const void *data = nullptr;
+  unsigned long long nBytes = 0;
+
+  sensei::VTKUtils::CellTypesSerializer ctSer;
+  int ierr = sensei::VTKUtils::Serialize(pd, ctSer, buf, data, nBytes);
+  std::vector<unsigned char> types(buf.begin(), buf.begin() + nBytes);
+
+  sensei::VTKUtils::CellArraySerializer caSer;
+  ierr += sensei::VTKUtils::Serialize(pd, caSer, buf, data, nBytes);
+  std::vector<vtkIdType> cells(reinterpret_cast<const vtkIdType*>(data),
+    reinterpret_cast<const vtkIdType*>(data) + nBytes/sizeof(vtkIdType));
+
+  pd->Delete();
+
+  CHECK(!ierr, "Failed to serialize the polydata")
+
+  std::vector<unsigned char> typesRef = {VTK_VERTEX, VTK_VERTEX, VTK_POLYGON};
+  CHECK(types == typesRef, "Wrong polydata cell types")
+
+  std::vector<vtkIdType> cellsRef = {1, 0, 1, 1, 3, 0, 1, 2};
+  CHECK(cells == cellsRef, "Wrong polydata cells")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int testBlockRuns(const std::vector<vtkDataSet*> &blocks)
+{
+  // runs of consecutive blocks owned by rank 1
+  std::vector<int> owner = {1, 1, 0, 1, 2, 2, 1};
+  std::vector<sensei::VTKUtils::BlockRun> runs;
+  sensei::VTKUtils::GetLocalBlockRuns(1, owner, runs);
+
+  CHECK((runs.size() == 3) && (runs[0].First == 0) && (runs[0].End == 2) &&
+    (runs[1].First == 3) && (runs[1].End == 4) && (runs[2].First == 6) &&
+    (runs[2].End == 7), "Wrong block runs")
+
+  // a run of one block is used in place, a longer run is copied
+  sensei::VTKUtils::DataArraySerializer aosSer("aos", vtkDataObject::POINT);
+  std::vector<unsigned char> buf;
+  const void *data = nullptr;
+  unsigned long long nBytes = 0;
+
+  std::vector<vtkDataSet*> one(1, blocks[0]);
+  CHECK(!sensei::VTKUtils::Serialize(one, aosSer, buf, data, nBytes) &&
+    (data != buf.data()) && (nBytes == 8*sizeof(double)),
+    "The single block run was not used in place")
+
+  std::vector<unsigned char> ref;
+  CHECK(!sensei::VTKUtils::Serialize(blocks, aosSer, ref) &&
+    !sensei::VTKUtils::Serialize(blocks, aosSer, buf, data, nBytes) &&
+    (nBytes == ref.size()) && ((blocks.size() == 1) ||
+    ((data == buf.data()) && std::equal(ref.begin(), ref.end(), buf.begin()))),
+    "Wrong run")
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  // rank r has r+1 blocks, with global ids following those of lower ranks
+  int nBlocks = rank + 1;
+  int gid0 = rank*(rank + 1)/2;
+
+  std::vector<vtkDataSet*> blocks;
+  for (int j = 0; j < nBlocks; ++j)
+    blocks.push_back(newTet(gid0 + j));
+
+  int ierr = 0;
+  ierr += testArrays(gid0, blocks) ? 1 : 0;
+  ierr += testGeometry(gid0, blocks) ? 1 : 0;
+  ierr += testPolydata() ? 1 : 0;
+  ierr += testBlockRuns(blocks) ? 1 : 0;
+
+  for (int j = 0; j < nBlocks; ++j)
+    blocks[j]->Delete();
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
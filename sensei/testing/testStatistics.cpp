@@ -0,0 +1,142 @@
+#include <random>
+#include <vector>
+#include <cmath>
+#include <mpi.h>
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include "Error.h"
+#include "Statistics.h"
+#include "VTKDataAdaptor.h"
+
+// reference statistics computed with a two pass algorithm over all values.
+// ordered count, min, max, mean, variance, skewness, kurtosis
+void twoPass(const std::vector<double> &vals, std::vector<double> &stats)
+{
+  double n = vals.size();
+  double mn = vals[0];
+  double mx = vals[0];
+  double sum = 0.0;
+  for (double v : vals)
+    {
+    sum += v;
+    mn = std::min(mn, v);
+    mx = std::max(mx, v);
+    }
+
+  double mean = sum/n;
+  double m2 = 0.0;
+  double m3 = 0.0;
+  double m4 = 0.0;
+  for (double v : vals)
+    {
+    double d = v - mean;
+    m2 += d*d;
+    m3 += d*d*d;
+    m4 += d*d*d*d;
+    }
+
+  stats = {n, mn, mx, mean, m2/n, std::sqrt(n)*m3/std::pow(m2, 1.5),
+    n*m4/(m2*m2) - 3.0};
+}
+
+int compare(const char *what, const std::vector<double> &ref,
+  const std::vector<double> &stats)
+{
+  const char *names[] = {"count", "min", "max", "mean", "variance",
+    "skewness", "kurtosis"};
+
+  for (int i = 0; i < 7; ++i)
+    {
+    double tol = 1.0e-6*std::max(1.0, std::fabs(ref[i]));
+    if (std::fabs(ref[i] - stats[i]) > tol)
+      {
+      SENSEI_ERROR(<< what << " " << names[i] << " is " << stats[i]
+        << " but should be " << ref[i])
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  // a skewed distribution with a large offset stresses the stability of
+  // the moment updates
+  std::mt19937 gen(7 + rank);
+  std::gamma_distribution<double> dist(2.0, 3.0);
+
+  int nx = 17, ny = 13, nz = 11;
+  int nLocal = nx*ny*nz;
+
+  sensei::Statistics *analysisAdaptor = sensei::Statistics::New();
+  analysisAdaptor->AddDataRequirement("mesh", vtkDataObject::POINT, {"gamma"});
+  analysisAdaptor->SetWindow(2);
+
+  std::vector<double> prevVals;
+
+  int ierr = 0;
+  for (int step = 0; step < 3; ++step)
+    {
+    std::vector<double> vals(nLocal);
+    for (int i = 0; i < nLocal; ++i)
+      vals[i] = 1.0e6 + step + dist(gen);
+
+    vtkDoubleArray *da = vtkDoubleArray::New();
+    da->SetNumberOfTuples(nLocal);
+    da->SetName("gamma");
+    for (int i = 0; i < nLocal; ++i)
+      *da->GetPointer(i) = vals[i];
+
+    vtkImageData *im = vtkImageData::New();
+    im->SetDimensions(nx, ny, nz);
+    im->GetPointData()->AddArray(da);
+    da->Delete();
+
+    sensei::VTKDataAdaptor *dataAdaptor = sensei::VTKDataAdaptor::New();
+    dataAdaptor->SetDataObject("mesh", im);
+    dataAdaptor->SetDataTimeStep(step);
+    im->Delete();
+
+    analysisAdaptor->Execute(dataAdaptor);
+    dataAdaptor->Delete();
+
+    // the reference result
+    std::vector<double> allVals(nLocal*nRanks);
+    MPI_Allgather(vals.data(), nLocal, MPI_DOUBLE, allVals.data(),
+      nLocal, MPI_DOUBLE, MPI_COMM_WORLD);
+
+    // the window holds this step and the previous one
+    std::vector<double> window(prevVals);
+    window.insert(window.end(), allVals.begin(), allVals.end());
+    prevVals = allVals;
+
+    std::vector<double> ref;
+    std::vector<double> stats;
+
+    twoPass(allVals, ref);
+    if (analysisAdaptor->GetStatistics("mesh", vtkDataObject::POINT,
+      "gamma", stats) || compare("step", ref, stats))
+      ++ierr;
+
+    twoPass(window, ref);
+    if (analysisAdaptor->GetStatistics("mesh", vtkDataObject::POINT,
+      "gamma", stats, true) || compare("window", ref, stats))
+      ++ierr;
+    }
+
+  analysisAdaptor->Finalize();
+  analysisAdaptor->Delete();
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
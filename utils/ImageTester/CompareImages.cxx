@@ -13,11 +13,27 @@
 
 =========================================================================*/
 #include "vtkImageData.h"
+#include "vtkNew.h"
 #include "vtkPNGReader.h"
+#include "vtkPointData.h"
 #include "vtkSmartPointer.h"
 #include "vtkTesting.h"
+#include "vtkUnsignedCharArray.h"
+#include <vtksys/Directory.hxx>
 #include <vtksys/SystemTools.hxx>
 
+#include <sdiy/thread-pool.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
 // Checks to see if the file exists and that it is a png file.
 // Returns 1 for a valid file and 0 for an invalid file.
 int IsFileValid(const char* fileName)
@@ -35,12 +51,332 @@ int IsFileValid(const char* fileName)
   return 1;
 }
 
+namespace
+{
+// number of pixels compared between checks of the threshold
+const long BlockSize = 16384;
+
+// The outcome of comparing one baseline image with its test image.
+struct ImageResult
+{
+  std::string Name;
+  std::string Status; // passed, failed, missing or error
+  std::string Message;
+  double Error = 0.0; // mean per pixel error, a lower bound after an early exit
+  long Pixels = 0; // pixels compared before the result was known
+  bool EarlyExit = false;
+};
+
+// Recursively collects the png files below root/rel. Names are relative to
+// root.
+void FindImages(const std::string& root, const std::string& rel, std::vector<std::string>& names)
+{
+  std::string path = rel.empty() ? root : root + "/" + rel;
+
+  vtksys::Directory dir;
+  if (!dir.Load(path))
+  {
+    vtkGenericWarningMacro("Could not read directory " << path);
+    return;
+  }
+
+  unsigned long nFiles = dir.GetNumberOfFiles();
+  for (unsigned long i = 0; i < nFiles; ++i)
+  {
+    std::string file = dir.GetFile(i);
+    if (file == "." || file == "..")
+    {
+      continue;
+    }
+
+    std::string relFile = rel.empty() ? file : rel + "/" + file;
+    if (vtksys::SystemTools::FileIsDirectory(root + "/" + relFile))
+    {
+      FindImages(root, relFile, names);
+    }
+    else if (vtksys::SystemTools::GetFilenameLastExtension(file) == ".png")
+    {
+      names.push_back(relFile);
+    }
+  }
+}
+
+// Decodes a png. Returns nullptr if the file can't be read.
+vtkSmartPointer<vtkImageData> ReadImage(const std::string& fileName)
+{
+  vtkNew<vtkPNGReader> reader;
+  if (!reader->CanReadFile(fileName.c_str()))
+  {
+    return nullptr;
+  }
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  return reader->GetOutput();
+}
+
+// Sums the absolute differences, larger than the tolerance, of the color
+// channels of n pixels. Alpha is not compared. The loop has no branches so
+// that the compiler vectorizes it.
+unsigned long Difference(
+  const unsigned char* a, const unsigned char* b, long n, int nComps, int nColors, int tolerance)
+{
+  unsigned long sum = 0;
+  for (long i = 0; i < n; ++i)
+  {
+    for (int j = 0; j < nColors; ++j)
+    {
+      long k = i * nComps + j;
+      int d = a[k] > b[k] ? a[k] - b[k] : b[k] - a[k];
+      sum += d > tolerance ? d : 0;
+    }
+  }
+  return sum;
+}
+
+// Compares the baseline image res.Name with the test image of the same name.
+// The error of a pixel is the sum of its color channel differences larger
+// than the tolerance divided by 255 times the number of color channels, so
+// that it lies in [0, 1]. The error of the image is the mean error of its
+// pixels. This is the normalization vtkTesting::RegressionTest uses in VTK
+// 9.1 and later, without its search of the neighboring pixels for a better
+// match, so a threshold such as 0.05 means the same in both modes. The
+// comparison stops as soon as the error is known to exceed the threshold.
+void CompareImage(const std::string& baselineDir, const std::string& testDir, double threshold,
+  int tolerance, ImageResult& res)
+{
+  std::string testFile = testDir + "/" + res.Name;
+  if (!vtksys::SystemTools::FileExists(testFile))
+  {
+    res.Status = "missing";
+    res.Message = "there is no test image";
+    return;
+  }
+
+  vtkSmartPointer<vtkImageData> baseline = ReadImage(baselineDir + "/" + res.Name);
+  vtkSmartPointer<vtkImageData> test = ReadImage(testFile);
+  if (!baseline || !test)
+  {
+    res.Status = "error";
+    res.Message = "failed to decode the image";
+    return;
+  }
+
+  int bdims[3];
+  int tdims[3];
+  baseline->GetDimensions(bdims);
+  test->GetDimensions(tdims);
+
+  vtkUnsignedCharArray* ba =
+    vtkUnsignedCharArray::SafeDownCast(baseline->GetPointData()->GetScalars());
+  vtkUnsignedCharArray* ta =
+    vtkUnsignedCharArray::SafeDownCast(test->GetPointData()->GetScalars());
+  if (!ba || !ta)
+  {
+    res.Status = "error";
+    res.Message = "only 8 bit images are supported";
+    return;
+  }
+
+  if (bdims[0] != tdims[0] || bdims[1] != tdims[1] || bdims[2] != tdims[2] ||
+    ba->GetNumberOfComponents() != ta->GetNumberOfComponents())
+  {
+    res.Status = "failed";
+    res.Message = "the image size or number of channels differ";
+    return;
+  }
+
+  int nComps = ba->GetNumberOfComponents();
+  int nColors = nComps < 3 ? 1 : 3;
+  long nPixels = ba->GetNumberOfTuples();
+  const unsigned char* pb = ba->GetPointer(0);
+  const unsigned char* pt = ta->GetPointer(0);
+
+  // the sum of the pixel errors is compared against the threshold scaled by
+  // the number of pixels, it only grows so the test can stop early
+  double maxSum = threshold * nPixels;
+  double sum = 0.0;
+
+  for (long i = 0; i < nPixels; i += BlockSize)
+  {
+    long n = std::min(BlockSize, nPixels - i);
+    sum += Difference(pb + i * nComps, pt + i * nComps, n, nComps, nColors, tolerance) /
+      (255.0 * nColors);
+    if (sum > maxSum)
+    {
+      res.Status = "failed";
+      res.Error = sum / nPixels;
+      res.Pixels = i + n;
+      res.EarlyExit = i + n < nPixels;
+      return;
+    }
+  }
+
+  res.Status = "passed";
+  res.Error = nPixels ? sum / nPixels : 0.0;
+  res.Pixels = nPixels;
+}
+
+// Escapes a string for use in the json report.
+std::string Quote(const std::string& str)
+{
+  std::string out("\"");
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      out += '\\';
+    }
+    out += c;
+  }
+  out += '"';
+  return out;
+}
+
+// Writes the results as json.
+void WriteReport(std::ostream& os, const std::string& baselineDir, const std::string& testDir,
+  double threshold, int tolerance, const std::vector<ImageResult>& results)
+{
+  long nPassed = 0;
+  long nFailed = 0;
+  long nMissing = 0;
+  long nErrors = 0;
+  for (const ImageResult& res : results)
+  {
+    nPassed += res.Status == "passed";
+    nFailed += res.Status == "failed";
+    nMissing += res.Status == "missing";
+    nErrors += res.Status == "error";
+  }
+
+  os << "{" << std::endl
+     << "  \"baseline\": " << Quote(baselineDir) << "," << std::endl
+     << "  \"test\": " << Quote(testDir) << "," << std::endl
+     << "  \"threshold\": " << threshold << "," << std::endl
+     << "  \"tolerance\": " << tolerance << "," << std::endl
+     << "  \"images\": " << results.size() << "," << std::endl
+     << "  \"passed\": " << nPassed << "," << std::endl
+     << "  \"failed\": " << nFailed << "," << std::endl
+     << "  \"missing\": " << nMissing << "," << std::endl
+     << "  \"errors\": " << nErrors << "," << std::endl
+     << "  \"results\": [";
+
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const ImageResult& res = results[i];
+    os << (i ? "," : "") << std::endl
+       << "    {\"name\": " << Quote(res.Name) << ", \"status\": " << Quote(res.Status)
+       << ", \"error\": " << res.Error << ", \"pixels\": " << res.Pixels
+       << ", \"early_exit\": " << (res.EarlyExit ? "true" : "false")
+       << ", \"message\": " << Quote(res.Message) << "}";
+  }
+
+  os << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
+
+// Compares every png below the baseline directory with the png of the same
+// relative name below the test directory. Images are decoded and compared in
+// parallel. An image passes when its mean per pixel error, a value in [0, 1],
+// is at most the threshold. -t sets the per channel tolerance in [0, 255].
+// Returns 0 when all images pass.
+int BatchCompare(int argc, char* argv[])
+{
+  if (argc < 5)
+  {
+    vtkGenericWarningMacro("<exe> --batch BaselineDirectory TestDirectory <Threshold> "
+                           "[-n NumberOfThreads] [-t Tolerance] [-o Report.json]");
+    return 1;
+  }
+
+  std::string baselineDir = argv[2];
+  std::string testDir = argv[3];
+  double threshold = atof(argv[4]);
+  int nThreads = std::max(1u, std::thread::hardware_concurrency());
+  int tolerance = 0;
+  std::string reportFile;
+
+  for (int i = 5; i < argc; ++i)
+  {
+    if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+    {
+      nThreads = std::max(1, atoi(argv[++i]));
+    }
+    else if (i + 1 < argc && strcmp(argv[i], "-t") == 0)
+    {
+      tolerance = atoi(argv[++i]);
+    }
+    else if (i + 1 < argc && strcmp(argv[i], "-o") == 0)
+    {
+      reportFile = argv[++i];
+    }
+    else
+    {
+      vtkGenericWarningMacro("Invalid argument " << argv[i]);
+      return 1;
+    }
+  }
+
+  if (!vtksys::SystemTools::FileIsDirectory(baselineDir) ||
+    !vtksys::SystemTools::FileIsDirectory(testDir))
+  {
+    vtkGenericWarningMacro("Could not find directories " << baselineDir << " and " << testDir);
+    return 1;
+  }
+
+  std::vector<std::string> names;
+  FindImages(baselineDir, "", names);
+  std::sort(names.begin(), names.end());
+
+  std::vector<ImageResult> results(names.size());
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    results[i].Name = names[i];
+  }
+
+  sdiy::ThreadPool pool(nThreads);
+  pool.run(static_cast<int>(results.size()), [&](int i, int) {
+    CompareImage(baselineDir, testDir, threshold, tolerance, results[i]);
+  });
+
+  if (reportFile.empty())
+  {
+    WriteReport(std::cout, baselineDir, testDir, threshold, tolerance, results);
+  }
+  else
+  {
+    std::ofstream os(reportFile.c_str());
+    if (!os)
+    {
+      vtkGenericWarningMacro("Could not write " << reportFile);
+      return 1;
+    }
+    WriteReport(os, baselineDir, testDir, threshold, tolerance, results);
+  }
+
+  for (const ImageResult& res : results)
+  {
+    if (res.Status != "passed")
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+}
+
 int main(int argc, char* argv[])
 {
+  if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+  {
+    return BatchCompare(argc, argv);
+  }
+
   if (argc != 7)
   {
     vtkGenericWarningMacro("Must specify files to compare.");
     vtkGenericWarningMacro("<exe> TestImage.png <Threshold> -V BaselineImage.png -T TempDirectory");
+    vtkGenericWarningMacro("<exe> --batch BaselineDirectory TestDirectory <Threshold> "
+                           "[-n NumberOfThreads] [-t Tolerance] [-o Report.json]");
     return 1;
   }
   const char* baselineImage = argv[4];
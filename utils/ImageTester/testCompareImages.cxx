@@ -0,0 +1,182 @@
+// Tests the batch mode of CompareImages. Writes baseline and test images to
+// two directory trees, runs CompareImages on them and checks the report.
+//
+// usage: testCompareImages CompareImages WorkingDirectory
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkPNGWriter.h"
+#include "vtkPointData.h"
+#include "vtkUnsignedCharArray.h"
+#include <vtksys/SystemTools.hxx>
+
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+// Writes a 256x256 RGB png. The pixels of rows [row0, row1) are inverted and
+// delta is added to the channels of the other pixels.
+int WriteImage(const std::string& fileName, int row0, int row1, int delta)
+{
+  vtkNew<vtkImageData> im;
+  im->SetDimensions(256, 256, 1);
+  im->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+
+  unsigned char* p =
+    vtkUnsignedCharArray::SafeDownCast(im->GetPointData()->GetScalars())->GetPointer(0);
+
+  for (int j = 0; j < 256; ++j)
+  {
+    for (int i = 0; i < 256; ++i)
+    {
+      unsigned char* px = p + 3 * (256 * j + i);
+      px[0] = i / 2;
+      px[1] = j / 2;
+      px[2] = 64;
+      for (int c = 0; c < 3; ++c)
+      {
+        if (j >= row0 && j < row1)
+        {
+          px[c] = 255 - px[c];
+        }
+        else
+        {
+          px[c] += delta;
+        }
+      }
+    }
+  }
+
+  vtksys::SystemTools::MakeDirectory(vtksys::SystemTools::GetFilenamePath(fileName));
+
+  vtkNew<vtkPNGWriter> writer;
+  writer->SetFileName(fileName.c_str());
+  writer->SetInputData(im);
+  writer->Write();
+
+  if (!vtksys::SystemTools::FileExists(fileName))
+  {
+    std::cerr << "ERROR: failed to write " << fileName << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
+
+// Runs CompareImages in batch mode and reads the report. Returns the exit
+// code of CompareImages.
+int Compare(const std::string& exe, const std::string& dir, const std::string& name,
+  std::string& report)
+{
+  std::string reportFile = dir + "/" + name + ".json";
+  vtksys::SystemTools::RemoveFile(reportFile);
+
+  std::string cmd = "\"" + exe + "\" --batch \"" + dir + "/baseline/" + name + "\" \"" + dir +
+    "/test/" + name + "\" 0.05 -n 2 -o \"" + reportFile + "\"";
+
+  int code = std::system(cmd.c_str());
+
+  std::ifstream is(reportFile.c_str());
+  std::ostringstream os;
+  os << is.rdbuf();
+  report = os.str();
+
+  return code;
+}
+
+// Checks that the report line of the named image contains each of the given
+// strings.
+int CheckResult(
+  const std::string& report, const std::string& name, std::initializer_list<const char*> expect)
+{
+  size_t pos = report.find("{\"name\": \"" + name + "\"");
+  if (pos == std::string::npos)
+  {
+    std::cerr << "ERROR: " << name << " is not in the report" << std::endl << report;
+    return -1;
+  }
+
+  std::string line = report.substr(pos, report.find('\n', pos) - pos);
+  for (const char* str : expect)
+  {
+    if (line.find(str) == std::string::npos)
+    {
+      std::cerr << "ERROR: expected " << str << " in the result " << line << std::endl;
+      return -1;
+    }
+  }
+
+  return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 3)
+  {
+    std::cerr << "usage: testCompareImages CompareImages WorkingDirectory" << std::endl;
+    return 1;
+  }
+
+  std::string exe = argv[1];
+  std::string dir = std::string(argv[2]) + "/testCompareImages";
+  vtksys::SystemTools::RemoveADirectory(dir);
+
+  // pass: an identical image, and one that is off by 1 in every channel
+  // which is well below the threshold of the mean per pixel error
+  // fail: an image with its first 64 rows inverted, the comparison stops
+  // after the first block of rows, an image with no test image, and an
+  // identical image
+  int ierr = WriteImage(dir + "/baseline/pass/same.png", 0, 0, 0) ||
+    WriteImage(dir + "/test/pass/same.png", 0, 0, 0) ||
+    WriteImage(dir + "/baseline/pass/sub/close.png", 0, 0, 0) ||
+    WriteImage(dir + "/test/pass/sub/close.png", 0, 0, 1) ||
+    WriteImage(dir + "/baseline/fail/different.png", 0, 0, 0) ||
+    WriteImage(dir + "/test/fail/different.png", 0, 64, 0) ||
+    WriteImage(dir + "/baseline/fail/missing.png", 0, 0, 0) ||
+    WriteImage(dir + "/baseline/fail/same.png", 0, 0, 0) ||
+    WriteImage(dir + "/test/fail/same.png", 0, 0, 0);
+  if (ierr)
+  {
+    return 1;
+  }
+
+  std::string report;
+  if (Compare(exe, dir, "pass", report) != 0)
+  {
+    std::cerr << "ERROR: the pass directories did not pass" << std::endl << report;
+    return 1;
+  }
+
+  if (report.find("\"passed\": 2,") == std::string::npos ||
+    CheckResult(report, "same.png", { "\"status\": \"passed\"", "\"pixels\": 65536" }) ||
+    CheckResult(report, "sub/close.png", { "\"status\": \"passed\"", "\"early_exit\": false" }))
+  {
+    std::cerr << "ERROR: unexpected report for the pass directories" << std::endl << report;
+    return 1;
+  }
+
+  if (Compare(exe, dir, "fail", report) == 0)
+  {
+    std::cerr << "ERROR: the fail directories passed" << std::endl << report;
+    return 1;
+  }
+
+  if (report.find("\"passed\": 1,") == std::string::npos ||
+    report.find("\"failed\": 1,") == std::string::npos ||
+    report.find("\"missing\": 1,") == std::string::npos ||
+    CheckResult(report, "different.png",
+      { "\"status\": \"failed\"", "\"pixels\": 16384", "\"early_exit\": true" }) ||
+    CheckResult(report, "missing.png", { "\"status\": \"missing\"" }) ||
+    CheckResult(report, "same.png", { "\"status\": \"passed\"", "\"early_exit\": false" }))
+  {
+    std::cerr << "ERROR: unexpected report for the fail directories" << std::endl << report;
+    return 1;
+  }
+
+  return 0;
+}
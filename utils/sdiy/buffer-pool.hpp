@@ -0,0 +1,86 @@
+#ifndef DIY_BUFFER_POOL_HPP
+#define DIY_BUFFER_POOL_HPP
+
+#include <vector>
+
+#include "serialization.hpp"
+#include "thread.hpp"
+
+namespace sdiy
+{
+  // Recycles the storage of MemoryBuffers across exchange rounds.
+  //
+  // Queues that are consumed or sent give their std::vector<char> back to the
+  // pool, and new queues start from one of those vectors, so steady-state
+  // rounds enqueue into already allocated memory instead of regrowing each
+  // queue from empty. The pool is thread safe; it holds at most max_buffers
+  // buffers and discards any buffer larger than max_buffer_size bytes.
+  class BufferPool
+  {
+    public:
+                    BufferPool(size_t max_buffers__     = 256,
+                               size_t max_buffer_size__ = 64*1024*1024):
+                      max_buffers_(max_buffers__),
+                      max_buffer_size_(max_buffer_size__)           {}
+
+                    BufferPool(const BufferPool&)                   = delete;
+      BufferPool&   operator=(const BufferPool&)                    = delete;
+
+      //! move a recycled buffer (if any) into bb. bb is left empty and reset,
+      //! but with the capacity of the recycled buffer.
+      inline void   acquire(MemoryBuffer& bb);
+
+      //! take the storage of bb for reuse. bb is left empty.
+      inline void   release(MemoryBuffer& bb);
+
+      size_t        size() const                                    { return buffers_.const_access()->size(); }
+      void          clear()                                         { buffers_.access()->clear(); }
+
+      size_t        max_buffers() const                             { return max_buffers_; }
+      size_t        max_buffer_size() const                         { return max_buffer_size_; }
+      void          set_max_buffers(size_t n)                       { max_buffers_ = n; }
+      void          set_max_buffer_size(size_t n)                   { max_buffer_size_ = n; }
+
+    private:
+      size_t                                            max_buffers_;
+      size_t                                            max_buffer_size_;
+      critical_resource<std::vector<std::vector<char>>> buffers_;
+  };
+}
+
+void
+sdiy::BufferPool::
+acquire(MemoryBuffer& bb)
+{
+  {
+    auto buffers = buffers_.access();
+    if (buffers->empty())
+        return;
+
+    bb.buffer.swap(buffers->back());
+    buffers->pop_back();
+  }
+  bb.clear();
+}
+
+void
+sdiy::BufferPool::
+release(MemoryBuffer& bb)
+{
+  std::vector<char> tmp;
+  tmp.swap(bb.buffer);
+  bb.reset();
+
+  size_t capacity = tmp.capacity();
+  if (capacity == 0 || capacity > max_buffer_size_)
+      return;
+
+  auto buffers = buffers_.access();
+  if (buffers->size() < max_buffers_)
+  {
+    buffers->emplace_back();
+    buffers->back().swap(tmp);
+  }
+}
+
+#endif
@@ -22,7 +22,7 @@ namespace sdiy
         MessageInfo     info { -1, -1, -1 };
         bool            done = false;
 
-        inline void     recv(mpi::communicator& comm, const mpi::status& status);
+        inline void     recv(mpi::communicator& comm, const mpi::status& status, BufferPool* pool = 0);
         inline void     place(IncomingRound* in, bool unload, ExternalStorage* storage, IExchangeInfo* iexchange);
         void            reset()     { *this = InFlightRecv(); }
     };
@@ -128,11 +128,13 @@ sdiy::Master::inflight_sends()
 // receive message described by status
 void
 sdiy::Master::InFlightRecv::
-recv(mpi::communicator& comm, const mpi::status& status)
+recv(mpi::communicator& comm, const mpi::status& status, BufferPool* pool)
 {
     if (info.from == -1)            // uninitialized
     {
         MemoryBuffer bb;
+        if (pool)
+            pool->acquire(bb);
         comm.recv(status.source(), status.tag(), bb.buffer);
 
         if (status.tag() == tags::piece)     // first piece is the header
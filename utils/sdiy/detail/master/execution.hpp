@@ -1,70 +1,64 @@
 struct sdiy::Master::ProcessBlock
 {
-          ProcessBlock(Master&                    master_,
-                       const std::deque<int>&     blocks__,
-                       int                        local_limit_,
-                       critical_resource<int>&    idx_):
+          ProcessBlock(Master&                            master_,
+                       const std::deque<int>&             blocks__,
+                       int                                local_limit_,
+                       std::vector<std::vector<int>>&     local__):
               master(master_),
               blocks(blocks__),
               local_limit(local_limit_),
-              idx(idx_)
+              local_(local__)
           {}
 
           ProcessBlock(const ProcessBlock&)     = delete;
           ProcessBlock(ProcessBlock&&)          = default;
 
-  void    operator()()
+  // process the cur-th block on the given pool thread
+  void    operator()(int cur, int thread_id)
   {
-    master.log->debug("Processing with thread: {}",  this_thread::get_id());
+    // blocks this thread has loaded, to respect the in-memory limit
+    std::vector<int>& local = local_[thread_id];
 
-    std::vector<int>      local;
-    do
+    int i = blocks[cur];
+    if (master.block(i))
     {
-      int cur = (*idx.access())++;
+        if (local.size() == (size_t)local_limit)
+            master.unload(local);
+        local.push_back(i);
+    }
 
-      if ((size_t)cur >= blocks.size())
-          return;
+    master.log->debug("Processing block: {}", master.gid(i));
 
-      int i = blocks[cur];
-      if (master.block(i))
-      {
-          if (local.size() == (size_t)local_limit)
-              master.unload(local);
-          local.push_back(i);
-      }
-
-      master.log->debug("Processing block: {}", master.gid(i));
-
-      bool skip = all_skip(i);
-
-      IncomingQueuesMap &current_incoming = master.incoming_[master.exchange_round_].map;
+    bool skip = all_skip(i);
 
-      if (master.block(i) == 0)             // block unloaded
-      {
-          if (skip)
-              master.load_queues(i);        // even though we are skipping the block, the queues might be necessary
-          else
-          {
-              if (local.size() == (size_t)local_limit)      // reached the local limit
-                  master.unload(local);
-
-              master.load(i);
-              local.push_back(i);
-          }
-      }
+    IncomingQueuesMap &current_incoming = master.incoming_[master.exchange_round_].map;
 
-      for (auto& cmd : master.commands_)
-      {
-          cmd->execute(skip ? 0 : master.block(i), master.proxy(i));
+    if (master.block(i) == 0)             // block unloaded
+    {
+        if (skip)
+            master.load_queues(i);        // even though we are skipping the block, the queues might be necessary
+        else
+        {
+            if (local.size() == (size_t)local_limit)      // reached the local limit
+                master.unload(local);
+
+            master.load(i);
+            local.push_back(i);
+        }
+    }
+
+    for (auto& cmd : master.commands_)
+    {
+        cmd->execute(skip ? 0 : master.block(i), master.proxy(i));
 
-          // no longer need them, so get rid of them
-          current_incoming[master.gid(i)].queues.clear();
-          current_incoming[master.gid(i)].records.clear();
-      }
+        // no longer need them, so recycle them
+        master.release_queues(current_incoming[master.gid(i)].queues);
+        current_incoming[master.gid(i)].queues.clear();
+        current_incoming[master.gid(i)].records.clear();
+    }
 
-      if (skip && master.block(i) == 0)
-          master.unload_queues(i);    // even though we are skipping the block, the queues might be necessary
-    } while(true);
+    if (skip && master.block(i) == 0)
+        master.unload_queues(i);    // even though we are skipping the block, the queues might be necessary
   }
 
   bool  all_skip(int i) const
@@ -81,10 +75,10 @@ struct sdiy::Master::ProcessBlock
       return skip;
   }
 
-  Master&                 master;
-  const std::deque<int>&  blocks;
-  int                     local_limit;
-  critical_resource<int>& idx;
+  Master&                         master;
+  const std::deque<int>&          blocks;
+  int                             local_limit;
+  std::vector<std::vector<int>>&  local_;
 };
 
 void
@@ -129,24 +123,30 @@ execute()
     blocks_per_thread = limit_/num_threads;
   }
 
-  // idx is shared
-  critical_resource<int> idx(0);
-
-  if (num_threads > 1)
+  // the pool persists across calls, it's only rebuilt when the number of
+  // threads changes. without threads the pool always has a size of 1
+#ifdef DIY_NO_THREADS
+  int pool_threads = 1;
+#else
+  int pool_threads = num_threads;
+#endif
+  if (!pool_ || pool_->size() != pool_threads)
   {
-    // launch the threads
-    std::list<thread>   threads;
-    for (unsigned i = 0; i < (unsigned)num_threads; ++i)
-        threads.emplace_back(ProcessBlock(*this, blocks, blocks_per_thread, idx));
-
-    for (auto& t : threads)
-        t.join();
-  } else
-  {
-      ProcessBlock(*this, blocks, blocks_per_thread, idx)();
+    pool_.reset();
+    pool_.reset(new ThreadPool(num_threads));
+    log->debug("Started thread pool with {} threads", num_threads);
   }
 
+  // blocks are dealt to the per-thread deques in order, so the loaded ones
+  // are still processed first. uneven blocks are balanced by work stealing
+  std::vector<std::vector<int>> local(num_threads);
+  ProcessBlock process(*this, blocks, blocks_per_thread, local);
+  pool_->run(static_cast<int>(blocks.size()),
+             [&process](int cur, int thread_id) { process(cur, thread_id); });
+
   // clear incoming queues
+  for (auto& x : incoming_[exchange_round_].map)
+    release_queues(x.second.queues);
   incoming_[exchange_round_].map.clear();
 
   if (limit() != -1 && in_memory() > limit())
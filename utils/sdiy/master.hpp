@@ -20,6 +20,8 @@
 #include "time.hpp"
 
 #include "thread.hpp"
+#include "thread-pool.hpp"
+#include "buffer-pool.hpp"
 
 #include "detail/block_traits.hpp"
 
@@ -268,6 +270,11 @@ namespace sdiy
       inline CollectivesList&  collectives(int gid__);
       inline CollectivesMap&   collectives();
 
+      //! pool of queue buffers that are recycled across exchange rounds
+      BufferPool&       buffer_pool()                   { return buffer_pool_; }
+      inline void       release_queues(IncomingQueues& queues);
+      inline void       release_queues(OutgoingQueuesMap& queues);
+
       void              set_expected(int expected)      { expected_ = expected; }
       void              add_expected(int i)             { expected_ += i; }
       int               expected() const                { return expected_; }
@@ -328,6 +335,8 @@ namespace sdiy
       int                   exchange_round_     = -1;
       bool                  immediate_          = true;
       Commands              commands_;
+      std::unique_ptr<ThreadPool> pool_;            // persistent worker threads used by execute()
+      BufferPool            buffer_pool_;
 
     private:
       fast_mutex            add_mutex_;
@@ -725,6 +734,7 @@ iexchange_(const ICallback<Block>& f)
     } while (global_work_ > 0);
     log->debug("[{}] ==== Leaving iexchange ====\n", iexchange.comm.rank());
 
+    release_queues(outgoing_);
     outgoing_.clear();
 }
 
@@ -1078,7 +1088,7 @@ check_incoming_queues(IExchangeInfo* iexchange)
     {
         InFlightRecv& ir = inflight_recv(ostatus->source());
 
-        ir.recv(comm_, *ostatus);     // possibly partial recv, in case of a multi-piece message
+        ir.recv(comm_, *ostatus, &buffer_pool_);     // possibly partial recv, in case of a multi-piece message
 
         if (ir.done)                 // all pieces assembled
         {
@@ -1096,6 +1106,23 @@ check_incoming_queues(IExchangeInfo* iexchange)
     }
 }
 
+void
+sdiy::Master::
+release_queues(IncomingQueues& queues)
+{
+  for (auto& x : queues)
+    buffer_pool_.release(x.second);
+}
+
+void
+sdiy::Master::
+release_queues(OutgoingQueuesMap& queues)
+{
+  for (auto& x : queues)
+    for (auto& q : x.second.queues)
+      buffer_pool_.release(q.second);
+}
+
 void
 sdiy::Master::
 flush(bool remote)
@@ -1130,6 +1157,7 @@ flush(bool remote)
       } while (!inflight_sends().empty() || incoming_[exchange_round_].received < expected_ || !gid_order.empty());
   }
 
+  release_queues(outgoing_);
   outgoing_.clear();
 
   log->debug("Done in flush");
@@ -1149,6 +1177,9 @@ nudge()
     if (ostatus)
     {
       success = true;
+      // pieces of a large message share the buffer, recycle it with the last one
+      if (it->message.use_count() == 1)
+        buffer_pool_.release(*it->message);
       it = inflight_sends().erase(it);
     }
     else
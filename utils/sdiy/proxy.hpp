@@ -25,7 +25,7 @@ namespace sdiy
                                 const T&        x,                                      //!< data (eg. STL vector)
                                 void (*save)(BinaryBuffer&, const T&) = &::sdiy::save<T> //!< optional serialization function
                                ) const
-    { OutgoingQueues& out = *outgoing_; save(out[to], x); }
+    { save(outgoing_queue(to), x); }
 
     //! Enqueue data whose size is given explicitly by the user, e.g., an array.
     template<class T>
@@ -35,6 +35,15 @@ namespace sdiy
                                 void (*save)(BinaryBuffer&, const T&) = &::sdiy::save<T> //!< optional serialization function
                                ) const;
 
+    //! Enqueue a contiguous array of trivially copyable elements with a single copy.
+    //! The count is sent along with the data, in the same format as an STL vector,
+    //! so the receiver dequeues it into a `std::vector<T>`.
+    template<class T>
+    void                enqueue_span(const BlockID&  to,                                //!< target block (gid,proc)
+                                     const T*        x,                                 //!< pointer to the data
+                                     size_t          n                                  //!< size in data elements
+                                    ) const;
+
     //! Dequeue data whose size can be determined automatically (e.g., STL vector) and that was
     //! previously enqueued so that sdiy knows its size when it is received.
     //! In this case, sdiy will allocate the receive buffer; the user does not need to do so.
@@ -84,6 +93,9 @@ namespace sdiy
     OutgoingQueues*     outgoing() const                                { return outgoing_; }
     MemoryBuffer&       outgoing(const BlockID& to) const               { return (*outgoing_)[to]; }
 
+    //! return the queue to block to, a new queue starts from a recycled buffer
+    inline MemoryBuffer& outgoing_queue(const BlockID& to) const;
+
 /**
  * \ingroup Communication
  * \brief Post an all-reduce collective using an existing communication proxy.
@@ -268,8 +280,7 @@ sdiy::Master::Proxy::
 enqueue(const BlockID& to, const T* x, size_t n,
         void (*save)(BinaryBuffer&, const T&)) const
 {
-    OutgoingQueues& out = *outgoing_;
-    BinaryBuffer&   bb  = out[to];
+    BinaryBuffer&   bb  = outgoing_queue(to);
     if (save == (void (*)(BinaryBuffer&, const T&)) &::sdiy::save<T>)
         sdiy::save(bb, x, n);       // optimized for unspecialized types
     else
@@ -277,6 +288,40 @@ enqueue(const BlockID& to, const T* x, size_t n,
             save(bb, x[i]);
 }
 
+template<class T>
+void
+sdiy::Master::Proxy::
+enqueue_span(const BlockID& to, const T* x, size_t n) const
+{
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+    static_assert(std::is_trivially_copyable<T>::value, "enqueue_span works only for trivially copyable types");
+#endif
+    MemoryBuffer& bb = outgoing_queue(to);
+
+    // grow once for the whole span rather than geometrically
+    size_t nbytes = sizeof(size_t) + n*sizeof(T);
+    if (bb.position + nbytes > bb.buffer.capacity())
+        bb.reserve(bb.position + nbytes);
+
+    sdiy::save(bb, n);
+    if (n > 0)
+        bb.save_binary((const char*) x, n*sizeof(T));
+}
+
+sdiy::MemoryBuffer&
+sdiy::Master::Proxy::
+outgoing_queue(const BlockID& to) const
+{
+    OutgoingQueues& out = *outgoing_;
+    OutgoingQueues::iterator it = out.find(to);
+    if (it == out.end())
+    {
+        it = out.insert(std::make_pair(to, MemoryBuffer())).first;
+        master_->buffer_pool().acquire(it->second);
+    }
+    return it->second;
+}
+
 template<class T>
 void
 sdiy::Master::Proxy::
@@ -0,0 +1,219 @@
+#ifndef DIY_THREAD_POOL_HPP
+#define DIY_THREAD_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+
+#include "thread.hpp"
+
+#ifndef DIY_NO_THREADS
+#include <condition_variable>
+#include <exception>
+#endif
+
+namespace sdiy
+{
+  // Persistent pool of threads that executes batches of indexed tasks.
+  //
+  // Each thread owns a deque of task indices. A thread pops from the front of
+  // its own deque and, once that is empty, steals from the back of the others.
+  // The calling thread participates in every batch as thread 0, so a pool of
+  // size n launches n-1 workers, which stay alive (sleeping between batches)
+  // until the pool is destroyed.
+  class ThreadPool
+  {
+    public:
+      // f(task, thread): task in [0, ntasks), thread in [0, size())
+      using Task = std::function<void(int, int)>;
+
+#ifdef DIY_NO_THREADS
+      explicit      ThreadPool(int)                         {}
+      int           size() const                            { return 1; }
+      void          run(int ntasks, const Task& f)          { for (int i = 0; i < ntasks; ++i) f(i, 0); }
+#else
+      inline explicit ThreadPool(int nthreads);
+      inline        ~ThreadPool();
+
+                    ThreadPool(const ThreadPool&)           = delete;
+      ThreadPool&   operator=(const ThreadPool&)            = delete;
+
+      int           size() const                            { return static_cast<int>(queues_.size()); }
+
+      //! execute tasks [0, ntasks), blocks until all of them are done.
+      //! the first exception thrown by a task is rethrown here.
+      inline void   run(int ntasks, const Task& f);
+
+    private:
+      struct WorkQueue
+      {
+        fast_mutex          m;
+        std::deque<int>     tasks;
+      };
+
+      inline void   worker(int id);
+      inline void   work(int id);
+      inline bool   pop(int id, int& task);
+      inline bool   steal(int id, int& task);
+
+    private:
+      std::vector<std::unique_ptr<WorkQueue>>   queues_;
+      std::vector<thread>                       workers_;
+
+      std::mutex                m_;
+      std::condition_variable   start_;
+      std::condition_variable   done_;
+      const Task*               task_       = nullptr;
+      unsigned long             generation_ = 0;
+      int                       active_     = 0;
+      bool                      stop_       = false;
+      std::exception_ptr        error_;
+#endif
+  };
+}
+
+#ifndef DIY_NO_THREADS
+
+sdiy::ThreadPool::
+ThreadPool(int nthreads)
+{
+  if (nthreads < 1)
+    nthreads = 1;
+
+  for (int i = 0; i < nthreads; ++i)
+    queues_.emplace_back(new WorkQueue);
+
+  for (int i = 1; i < nthreads; ++i)
+    workers_.emplace_back(&ThreadPool::worker, this, i);
+}
+
+sdiy::ThreadPool::
+~ThreadPool()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_);
+    stop_ = true;
+  }
+  start_.notify_all();
+
+  for (auto& t : workers_)
+    t.join();
+}
+
+void
+sdiy::ThreadPool::
+run(int ntasks, const Task& f)
+{
+  if (ntasks <= 0)
+    return;
+
+  int nthreads = size();
+
+  // deal the tasks round robin, this preserves the relative order of the
+  // tasks within each deque
+  for (int i = 0; i < ntasks; ++i)
+    queues_[i % nthreads]->tasks.push_back(i);
+
+  {
+    std::unique_lock<std::mutex> lock(m_);
+    task_ = &f;
+    active_ = nthreads - 1;
+    error_ = nullptr;
+    ++generation_;
+  }
+  start_.notify_all();
+
+  work(0);
+
+  std::unique_lock<std::mutex> lock(m_);
+  done_.wait(lock, [this]() { return active_ == 0; });
+  task_ = nullptr;
+
+  if (error_)
+  {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void
+sdiy::ThreadPool::
+worker(int id)
+{
+  unsigned long generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_);
+      start_.wait(lock, [this,generation]() { return stop_ || generation_ != generation; });
+      if (stop_)
+        return;
+      generation = generation_;
+    }
+
+    work(id);
+
+    std::unique_lock<std::mutex> lock(m_);
+    if (--active_ == 0)
+      done_.notify_one();
+  }
+}
+
+void
+sdiy::ThreadPool::
+work(int id)
+{
+  // all tasks are queued before the batch starts, so once every deque is
+  // empty there is nothing left to do
+  int task;
+  while (pop(id, task) || steal(id, task))
+  {
+    try
+    {
+      (*task_)(task, id);
+    }
+    catch (...)
+    {
+      std::unique_lock<std::mutex> lock(m_);
+      if (!error_)
+        error_ = std::current_exception();
+    }
+  }
+}
+
+bool
+sdiy::ThreadPool::
+pop(int id, int& task)
+{
+  WorkQueue& q = *queues_[id];
+  lock_guard<fast_mutex> lock(q.m);
+  if (q.tasks.empty())
+    return false;
+  task = q.tasks.front();
+  q.tasks.pop_front();
+  return true;
+}
+
+bool
+sdiy::ThreadPool::
+steal(int id, int& task)
+{
+  int nthreads = size();
+  for (int i = 1; i < nthreads; ++i)
+  {
+    WorkQueue& q = *queues_[(id + i) % nthreads];
+    lock_guard<fast_mutex> lock(q.m);
+    if (q.tasks.empty())
+      continue;
+    task = q.tasks.back();
+    q.tasks.pop_back();
+    return true;
+  }
+  return false;
+}
+
+#endif
+
+#endif